@@ -5,8 +5,209 @@
 #ifndef _ALGO_H_
 #define _ALGO_H_
 
+#include "AlgoBase.h"
+#include "Functional.h"
+#include "Heap.h"
+#include "Iterator.h"
+#include "Move.h"
+
 namespace rayn {
 
+    //-----------------------------------------------------------------
+    // lower_bound
+    template <class ForwardIterator, class T, class Compare>
+    ForwardIterator __lower_bound(ForwardIterator first, ForwardIterator last,
+                                  const T& val, Compare comp, forward_iterator_tag)
+    {
+        typename iterator_traits<ForwardIterator>::difference_type len = rayn::distance(first, last);
+        while (len > 0) {
+            typename iterator_traits<ForwardIterator>::difference_type half = len / 2;
+            ForwardIterator middle = first;
+            rayn::advance(middle, half);
+            if (comp(*middle, val)) {
+                first = ++middle;
+                len -= half + 1;
+            } else {
+                len = half;
+            }
+        }
+        return first;
+    }
+    // The answer stays in [first, first + len], only first moves and by a
+    // conditional amount, so the loop has no unpredictable branch.
+    template <class RandomAccessIterator, class T, class Compare>
+    RandomAccessIterator __lower_bound(RandomAccessIterator first, RandomAccessIterator last,
+                                       const T& val, Compare comp, random_access_iterator_tag)
+    {
+        typename iterator_traits<RandomAccessIterator>::difference_type len = last - first;
+        if (len == 0) {
+            return first;
+        }
+        while (len > 1) {
+            typename iterator_traits<RandomAccessIterator>::difference_type half = len / 2;
+            first += comp(first[half], val) ? half : 0;
+            len -= half;
+        }
+        return comp(*first, val) ? first + 1 : first;
+    }
+    /*
+    ** ForwardIterator lower_bound(first, last, val, comp);
+    ** @brief       The first position in the sorted range where val could be
+    **              inserted without changing the order.
+    ** @complexity  O(logN) comparisons
+    */
+    template <class ForwardIterator, class T, class Compare>
+    inline ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last,
+                                       const T& val, Compare comp)
+    {
+        return __lower_bound(first, last, val, comp, iterator_category(first));
+    }
+    template <class ForwardIterator, class T>
+    inline ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T& val) {
+        return __lower_bound(first, last, val, rayn::less<T>(), iterator_category(first));
+    }
+
+    //-----------------------------------------------------------------
+    // upper_bound
+    template <class T, class Compare>
+    struct __not_greater {
+        Compare comp;
+        explicit __not_greater(Compare c) : comp(c) {}
+        template <class U>
+        bool operator()(const U& x, const T& val) const { return !comp(val, x); }
+    };
+    /*
+    ** ForwardIterator upper_bound(first, last, val, comp);
+    ** @brief       The last position in the sorted range where val could be
+    **              inserted without changing the order.
+    ** @complexity  O(logN) comparisons
+    */
+    template <class ForwardIterator, class T, class Compare>
+    inline ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last,
+                                       const T& val, Compare comp)
+    {
+        return __lower_bound(first, last, val, __not_greater<T, Compare>(comp), iterator_category(first));
+    }
+    template <class ForwardIterator, class T>
+    inline ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last, const T& val) {
+        return rayn::upper_bound(first, last, val, rayn::less<T>());
+    }
+
+    //-----------------------------------------------------------------
+    // sort
+    enum ESortThreshold{ SORT_THRESHOLD = 16 };
+
+    template <class RandomAccessIterator, class Compare>
+    void __insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        if (first == last) {
+            return;
+        }
+        for (RandomAccessIterator i = first + 1; i != last; ++i) {
+            typename iterator_traits<RandomAccessIterator>::value_type val = rayn::move(*i);
+            RandomAccessIterator j = i;
+            for (; j != first && comp(val, *(j - 1)); --j) {
+                *j = rayn::move(*(j - 1));
+            }
+            *j = rayn::move(val);
+        }
+    }
+    // Swap the median of *a, *b and *c into *result.
+    template <class RandomAccessIterator, class Compare>
+    void __move_median_to_first(RandomAccessIterator result, RandomAccessIterator a,
+                                RandomAccessIterator b, RandomAccessIterator c, Compare comp)
+    {
+        if (comp(*a, *b)) {
+            if (comp(*b, *c))       rayn::swap(*result, *b);
+            else if (comp(*a, *c))  rayn::swap(*result, *c);
+            else                    rayn::swap(*result, *a);
+        } else if (comp(*a, *c))    rayn::swap(*result, *a);
+        else if (comp(*b, *c))      rayn::swap(*result, *c);
+        else                        rayn::swap(*result, *b);
+    }
+    // Partition [first, last) around *pivot, which is also a sentinel for both scans.
+    template <class RandomAccessIterator, class Compare>
+    RandomAccessIterator __unguarded_partition(RandomAccessIterator first, RandomAccessIterator last,
+                                               RandomAccessIterator pivot, Compare comp)
+    {
+        while (true) {
+            while (comp(*first, *pivot)) {
+                ++first;
+            }
+            --last;
+            while (comp(*pivot, *last)) {
+                --last;
+            }
+            if (!(first < last)) {
+                return first;
+            }
+            rayn::swap(*first, *last);
+            ++first;
+        }
+    }
+    template <class RandomAccessIterator, class Size, class Compare>
+    void __introsort_loop(RandomAccessIterator first, RandomAccessIterator last,
+                          Size depth_limit, Compare comp)
+    {
+        while (last - first > SORT_THRESHOLD) {
+            if (depth_limit == 0) {
+                // too many bad pivots, fall back to heap sort
+                rayn::make_heap(first, last, comp);
+                rayn::sort_heap(first, last, comp);
+                return;
+            }
+            --depth_limit;
+            __move_median_to_first(first, first + 1, first + (last - first) / 2, last - 1, comp);
+            RandomAccessIterator cut = __unguarded_partition(first + 1, last, first, comp);
+            __introsort_loop(cut, last, depth_limit, comp);
+            last = cut;
+        }
+    }
+    /*
+    ** void sort(first, last, comp);
+    ** @brief       Sort the range with introsort, equal elements may be reordered.
+    ** @complexity  O(NlogN)
+    */
+    template <class RandomAccessIterator, class Compare>
+    void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+        typename iterator_traits<RandomAccessIterator>::difference_type depth_limit = 0;
+        for (typename iterator_traits<RandomAccessIterator>::difference_type n = last - first; n > 1; n >>= 1) {
+            depth_limit += 2;
+        }
+        __introsort_loop(first, last, depth_limit, comp);
+        __insertion_sort(first, last, comp);
+    }
+    template <class RandomAccessIterator>
+    inline void sort(RandomAccessIterator first, RandomAccessIterator last) {
+        rayn::sort(first, last,
+                   rayn::less<typename iterator_traits<RandomAccessIterator>::value_type>());
+    }
+
+    //-----------------------------------------------------------------
+    // unique
+    /*
+    ** ForwardIterator unique(first, last, pred);
+    ** @brief       Keep the first of each group of consecutive equal elements.
+    ** @return      The end of the kept elements.
+    ** @complexity  O(N)
+    */
+    template <class ForwardIterator, class BinaryPredicate>
+    ForwardIterator unique(ForwardIterator first, ForwardIterator last, BinaryPredicate pred) {
+        if (first == last) {
+            return last;
+        }
+        ForwardIterator result = first;
+        while (++first != last) {
+            if (!pred(*result, *first)) {
+                *++result = rayn::move(*first);
+            }
+        }
+        return ++result;
+    }
+    template <class ForwardIterator>
+    inline ForwardIterator unique(ForwardIterator first, ForwardIterator last) {
+        return rayn::unique(first, last,
+                            rayn::equal_to<typename iterator_traits<ForwardIterator>::value_type>());
+    }
 }
 
 #endif
\ No newline at end of file
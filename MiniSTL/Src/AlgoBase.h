@@ -295,10 +295,16 @@ namespace rayn {
 
     // specialization
     inline char* copy(const char* first, const char* last, char* result) {
+        if (first == last) {
+            return result;
+        }
         memmove(result, first, sizeof(char) * (last - first));
         return result + (last - first);
     }
     inline wchar_t* copy(const wchar_t* first, const wchar_t* last, wchar_t* result) {
+        if (first == last) {
+            return result;
+        }
         memmove(result, first, sizeof(wchar_t) * (last - first));
         return result + (last - first);
     }
@@ -6,16 +6,199 @@
 #ifndef _ALLOC_H
 #define _ALLOC_H
 
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>    // for bad_alloc
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <typeinfo>
+
+// Visual Studio 2013 does not support thread_local yet.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define RAYN_THREAD_LOCAL __declspec(thread)
+#else
+#define RAYN_THREAD_LOCAL thread_local
+#endif
 
 namespace rayn {
 
-    class alloc {
+    // ڵǰ߳˳ʱfn(arg)ע෴˳ãʵAlloc.cpp
+    void at_thread_exit(void (*fn)(void *), void *arg);
+
+    /*
+    ** size class
+    ** Ҫṩ
+    **   MAXBYTES               Сޣmalloc
+    **   NCLASSES               size classĸ
+    **   class_index(bytes)     bytes(0 < bytes <= MAXBYTES)Сsize class
+    **   class_size(index)      indexsize classС8ıҵ
+    **   batch_size(index)      ̻߳ÿδڴȡ
+    */
+
+    // Ĭϲԣ8ֽΪ߽磬128ֽڹ16size classÿȡ20
+    struct default_alloc_policy {
+        enum EAlign{ ALIGN = 8 };
+        enum EMaxBytes{ MAXBYTES = 128 };
+        enum ENClasses{ NCLASSES = EMaxBytes::MAXBYTES / EAlign::ALIGN };
+        enum ENObjs{ NOBJS = 20 };
+
+        static size_t class_index(size_t bytes) {
+            return ((bytes + EAlign::ALIGN - 1) / EAlign::ALIGN - 1);
+        }
+        static size_t class_size(size_t index) {
+            return (index + 1) * EAlign::ALIGN;
+        }
+        static size_t batch_size(size_t) {
+            return ENObjs::NOBJS;
+        }
+    };
+
+    // βԣ128ֽ8ֽΪ߽磬֮ÿ2֮Ϊ4size classֱ4KiB
+    // ԽÿȡĸԽ
+    struct geometric_alloc_policy {
+        enum EMaxBytes{ MAXBYTES = 4096 };
+        enum ENClasses{ NCLASSES = 36 };
+
+        static size_t class_index(size_t bytes) {
+            if (bytes <= 128) {
+                return (bytes + 7) / 8 - 1;
+            }
+            // ֲҵһСbytessize class
+            size_t first = 16, last = ENClasses::NCLASSES;
+            while (first != last) {
+                size_t mid = first + (last - first) / 2;
+                if (class_size(mid) < bytes) {
+                    first = mid + 1;
+                } else {
+                    last = mid;
+                }
+            }
+            return first;
+        }
+        static size_t class_size(size_t index) {
+            static const unsigned short sizes[ENClasses::NCLASSES] = {
+                8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120, 128,
+                160, 192, 224, 256, 320, 384, 448, 512,
+                640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+                2560, 3072, 3584, 4096
+            };
+            return sizes[index];
+        }
+        static size_t batch_size(size_t index) {
+            static const unsigned char batches[ENClasses::NCLASSES] = {
+                20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+                16, 16, 16, 16, 8, 8, 8, 8,
+                4, 4, 4, 4, 2, 2, 2, 2,
+                2, 2, 2, 2
+            };
+            return batches[index];
+        }
+    };
+
+    /*
+    ** chunkԴ(backing)
+    ** backingҪṩ
+    **   allocate(bytes)        bytesֽڣ԰bytesϵΪʵʴС(8ı)ʧܷ0
+    **   deallocate(p, bytes)   黹allocateõڴ棬bytesΪϵĴС
+    */
+
+    // ĬԴmalloc/free
+    struct malloc_backing {
+        static void *allocate(size_t& bytes) {
+            return malloc(bytes);
+        }
+        static void deallocate(void *p, size_t) {
+            free(p);
+        }
+    };
+
+    // ֱϵͳӳڴ棬chunkϵ뵽huge page(2MiB)
+    // ͸ҳ(Linux: madvise(MADV_HUGEPAGE)Windows: MEM_LARGE_PAGES)
+    // rb_treelistʱԼTLB miss
+    // ϵͳִ֧ҳʱ˻ΪͨҳʵAlloc.cpp
+    struct huge_page_backing {
+        enum EHugePage{ HUGE_PAGE_SIZE = 2 * 1024 * 1024 };
+
+        static void *allocate(size_t& bytes);
+        static void deallocate(void *p, size_t bytes);
+    };
+
+    // huge_page_backingͬchunk󶨵߳CPUNUMAڵ
+    // ڴ̹߳chunkڴ߳ڵĽڵ
+    struct numa_huge_page_backing {
+        static void *allocate(size_t& bytes);
+        static void deallocate(void *p, size_t bytes) {
+            huge_page_backing::deallocate(p, bytes);
+        }
+        // ߳ڵNUMAڵ㣬޷֪ʱ-1
+        static int current_node();
+    };
+
+    // ֻ߳޸ġ߳̿Զȡļ
+    // relaxedload/storeԭӼӷͨͬ
+    struct alloc_counter {
+        std::atomic<size_t> value;
+
+        size_t get() const {
+            return value.load(std::memory_order_relaxed);
+        }
+        void set(size_t n) {
+            value.store(n, std::memory_order_relaxed);
+        }
+        void add(size_t n) {
+            set(get() + n);
+        }
+    };
+
+    /*
+    ** Сṹ
+    ** ÿ̳߳Լfree-lists(̻߳)ͷŶҪ
+    ** ̻߳Ϊʱڴȡbatch_size飬
+    ** ̻߳е鳬2batch_sizeʱ黹batch_sizeڴء
+    ** ڴ̹߳central_mutex
+    ** ڴϵͳÿһڴ(chunk)¼chunk_listУ
+    ** trim()ҳ鶼ѿеchunk黹ϵͳ
+    ** ͬԵpool_allocӵжڴأchunkBackingṩ
+    ** ÿ߳ԼĻмsnapshot()̵߳ļ
+    ** start_trace()򿪲ÿsample_periodη¼һδС͡
+    */
+    template <class Policy, class Backing = malloc_backing>
+    class pool_alloc {
     private:
-        enum EAlign{ ALIGN = 8 };   //Сϵ߽
-        enum EMaxBytes{ MAXBYTES = 128 };   //Сޣmalloc
-        enum ENFreeLists{ NFREELISTS = (EMaxBytes::MAXBYTES / EAlign::ALIGN) }; //free-listsĸ
-        enum ENObjs{ NOBJS = 20 };  //ÿӵĽڵ
+        enum EAlign{ ALIGN = 8 };   //chunkͷϵ߽
+        enum ENClasses{ NCLASSES = Policy::NCLASSES };  //free-listsĸ
+        enum ETraceCapacity{ TRACE_CAPACITY = 256 };    //Ĳ¼
+    public:
+        //ÿsize classͳ
+        struct class_stats {
+            size_t block_size;
+            size_t hits;    //̻߳еĴ
+            size_t misses;  //̻߳ΪգҪrefillĴ
+            size_t frees;   //ͷŵĴ
+            size_t cached_blocks;   //̻߳еĿ
+            size_t central_blocks;  //free-listеĿ
+        };
+        //snapshot()Ľ
+        struct stats {
+            class_stats classes[ENClasses::NCLASSES];
+            size_t refills;     //ڴȡĴ
+            size_t chunk_allocs;    //ϵͳchunkĴ
+            size_t heap_bytes;  //ڴسеchunkֽ
+            size_t idle_bytes;  //free-listsڴʣռеĿֽ
+            size_t released_bytes;  //ۼƹ黹ϵͳֽ
+            size_t large_allocs;    //MAXBYTESֱmallocĴ
+            size_t large_frees;
+            size_t large_bytes;     //ֱmallocۼֽ
+        };
+        //¼
+        struct trace_record {
+            size_t bytes;
+            const std::type_info *site; //ͣallocator<T>룬Ϊ0
+            std::thread::id thread;
+        };
     private:
         //free-listsĽڵ㹹
         union obj {
@@ -23,31 +206,767 @@ namespace rayn {
             char client[1];
         };
 
-        static obj *free_list[ENFreeLists::NFREELISTS];
+        //̻߳棬ÿ߳һ
+        struct thread_cache {
+            obj *free_list[ENClasses::NCLASSES];
+            alloc_counter length[ENClasses::NCLASSES];
+            alloc_counter hits[ENClasses::NCLASSES];
+            alloc_counter misses[ENClasses::NCLASSES];
+            alloc_counter frees[ENClasses::NCLASSES];
+            alloc_counter large_allocs;
+            alloc_counter large_frees;
+            alloc_counter large_bytes;
+            size_t sample_countdown;    //һβķ
+            thread_cache *prev; //̻߳洮snapshot()
+            thread_cache *next;
+        };
+
+        //ÿchunkͷchunk_list˳chunk
+        struct chunk_header {
+            chunk_header *next;
+            size_t bytes;   //ͷڵܴС
+        };
+        //trim()ʱͳÿchunkпеֽ
+        struct chunk_usage {
+            chunk_header *chunk;
+            size_t free_bytes;
+        };
+        struct trim_worker;
+
+        // ̻߳ڶϷ䣬ֲ߳̾洢ָֻ룬
+        // VS2013__declspec(thread)Ҳʹ
+        static RAYN_THREAD_LOCAL thread_cache *tls_cache;
+        static RAYN_THREAD_LOCAL bool tls_dead;    //߳˳ѹ黹ڴ
+
+        //ڴ
+        static obj *free_list[ENClasses::NCLASSES];
         static char *start_free;    //ڴʼλ
-        static char *end_free;  //ڴʼλ
+        static char *end_free;  //ڴؽλ
         static size_t heap_size;
+        static chunk_header *chunk_list;
+        static size_t released_size;    //ۼƹ黹ϵͳֽ
+        static std::mutex central_mutex;
+        static trim_worker background_trim;
+        static thread_cache *cache_list;    //д̵߳Ļ
+        static stats retired;   //˳߳Լû̻߳ʱļ
+        static size_t central_fetches;
+        static size_t chunk_count;
+
+        //
+        static std::atomic<size_t> trace_period;    //0ʾ
+        static trace_record trace_ring[ETraceCapacity::TRACE_CAPACITY];
+        static size_t trace_count;  //ۼƼ¼
+        static std::mutex trace_mutex;
 
     private:
         // bytesϵ8ı
         static size_t ROUND_UP(size_t bytes) {
             return ((bytes + EAlign::ALIGN - 1) & ~(EAlign::ALIGN - 1));
         }
-        // Сʹõnfree-listn0ʼ
-        static size_t FREELIST_INDEX(size_t bytes) {
-            return ((bytes + EAlign::ALIGN - 1) / EAlign::ALIGN - 1);
-        }
-        // һСΪsizeĶ󣬲ܼСΪsize鵽free-list
-        static void *refill(size_t size);
+        // صǰ̵߳Ļ棬߳˳׶η0
+        static thread_cache *get_thread_cache();
+        // ߳˳ʱã黹ͷ̻߳
+        static void reap_thread_cache(void *cache);
+        // ̻߳ȫ黹ڴ
+        static void flush_thread_cache(thread_cache *cache);
+        // ߳˳ʱѼϲretiredcache_listժ
+        static void retire_thread_cache(thread_cache *cache);
+        // cacheеļۼӵout߱central_mutex
+        static void add_thread_stats(stats& out, const thread_cache *cache);
+        // ھǷ¼η
+        static void sample(thread_cache *cache, size_t bytes, const std::type_info *site);
+        // ڴȡnobjsindexsize class飬
+        // nobjs޸Ϊʵȡĸ
+        static obj *fetch_from_central(size_t index, size_t& nobjs);
+        // [first, last]黹ڴصĵindexfree-list
+        static void release_to_central(size_t index, obj *first, obj *last);
+        // һindexsize classĶ󣬲ܼͬС鵽̻߳
+        static void *refill(size_t index);
         // һռ䣬nobjsСΪsize
         // nobjs㣬nobjsܻή
+        // ߱central_mutex
         static char *chunk_alloc(size_t size, size_t& nobjs);
+        // chunkͷռõĿռ䣬ϵ8ı
+        static size_t CHUNK_HEADER_SIZE() {
+            return ROUND_UP(sizeof(chunk_header));
+        }
+        // qsortʹãchunkַ
+        static int compare_chunk_usage(const void *lhs, const void *rhs);
+        // ڰַusage[0, n)вptrڵchunkҲ0
+        static chunk_usage *find_chunk(chunk_usage *usage, size_t n, const void *ptr);
+        // ͷڴȫеchunk߱central_mutex
+        static size_t trim_central();
 
     public:
-        static void *allocate(size_t bytes);
+        // siteΪͣڲ¼
+        static void *allocate(size_t bytes, const std::type_info *site = 0);
         static void deallocate(void *ptr, size_t bytes);
-        static void *reallocate(void *ptr, size_t old_sz, size_t new_sz);
+        /*
+        ** @brief   ptrָĴСǰmin(old_sz, new_sz)ֽڵݡ
+        ** ͬһsize classλڴĩβʣռ㹻ʱԭ䣬
+        ** ߶Ǵʱrealloc(ڴͨmremap)·䲢ơ
+        ** @return  µַptrͬ
+        */
+        static void *reallocate(void *ptr, size_t old_sz, size_t new_sz, const std::type_info *site = 0);
+
+        /*
+        ** @brief   ڴȫеchunk黹ϵͳ
+        ** @return  ι黹ֽ
+        ** ̵߳Ļȹ黹ڴأ̻߳е鲻Ӱ죬
+        ** ڵchunkᱻͷš
+        */
+        static size_t trim();
+        /*
+        ** @brief   ̨̣߳ÿinterval_msִһtrim
+        ** ظûµļ̨̡߳
+        */
+        static void start_background_trim(unsigned interval_ms);
+        /*
+        ** @brief   ֹ̨ͣtrim̡߳
+        */
+        static void stop_background_trim();
+        /*
+        ** @brief   ۼƹ黹ϵͳֽ(trim̨trim)
+        */
+        static size_t released_bytes();
+
+        /*
+        ** @brief   ߳ڴصͳơ
+        ** ̵߳ļǽֵڼǿڷ䡣
+        */
+        static void snapshot(stats& out);
+        /*
+        ** @brief   ʼÿ߳ÿsample_periodη¼һΣеļ¼ա
+        */
+        static void start_trace(size_t sample_period);
+        /*
+        ** @brief   ֹͣеļ¼
+        */
+        static void stop_trace();
+        /*
+        ** @brief   ʱ˳n¼records
+        ** @return  ƵౣTRACE_CAPACITY
+        */
+        static size_t trace(trace_record *records, size_t n);
     };
+
+    // ̨triṃ߳˳ʱֹͣ߳
+    template <class Policy, class Backing>
+    struct pool_alloc<Policy, Backing>::trim_worker {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::thread worker;
+        bool running;
+
+        trim_worker() : running(false) {}
+        ~trim_worker() {
+            stop();
+        }
+        void start(unsigned interval_ms) {
+            stop();
+            std::lock_guard<std::mutex> guard(mutex);
+            running = true;
+            worker = std::thread([this, interval_ms]() {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (running) {
+                    cond.wait_for(lock, std::chrono::milliseconds(interval_ms));
+                    if (running) {
+                        std::lock_guard<std::mutex> guard(pool_alloc::central_mutex);
+                        pool_alloc::trim_central();
+                    }
+                }
+            });
+        }
+        void stop() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                running = false;
+            }
+            cond.notify_all();
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    };
+
+    template <class Policy, class Backing>
+    char *pool_alloc<Policy, Backing>::start_free = 0;
+    template <class Policy, class Backing>
+    char *pool_alloc<Policy, Backing>::end_free = 0;
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::heap_size = 0;
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::chunk_header *pool_alloc<Policy, Backing>::chunk_list = 0;
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::released_size = 0;
+    template <class Policy, class Backing>
+    std::mutex pool_alloc<Policy, Backing>::central_mutex;
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::trim_worker pool_alloc<Policy, Backing>::background_trim;
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::thread_cache *pool_alloc<Policy, Backing>::cache_list = 0;
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::stats pool_alloc<Policy, Backing>::retired;
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::central_fetches = 0;
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::chunk_count = 0;
+    template <class Policy, class Backing>
+    std::atomic<size_t> pool_alloc<Policy, Backing>::trace_period;
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::trace_record pool_alloc<Policy, Backing>::trace_ring[ETraceCapacity::TRACE_CAPACITY];
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::trace_count = 0;
+    template <class Policy, class Backing>
+    std::mutex pool_alloc<Policy, Backing>::trace_mutex;
+
+    // ̬洢ʼ
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::obj *pool_alloc<Policy, Backing>::free_list[ENClasses::NCLASSES];
+
+    // ֲָ߳̾־ʼ
+    template <class Policy, class Backing>
+    RAYN_THREAD_LOCAL typename pool_alloc<Policy, Backing>::thread_cache *pool_alloc<Policy, Backing>::tls_cache = 0;
+    template <class Policy, class Backing>
+    RAYN_THREAD_LOCAL bool pool_alloc<Policy, Backing>::tls_dead = false;
+
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::thread_cache *pool_alloc<Policy, Backing>::get_thread_cache() {
+        thread_cache *cache = tls_cache;
+        if (!cache) {
+            // ߳˳(羲̬ʱ)ʹ̻߳
+            if (tls_dead) {
+                return 0;
+            }
+            cache = new thread_cache();
+            tls_cache = cache;
+            at_thread_exit(&reap_thread_cache, cache);
+            std::lock_guard<std::mutex> guard(central_mutex);
+            cache->next = cache_list;
+            if (cache_list) {
+                cache_list->prev = cache;
+            }
+            cache_list = cache;
+        }
+        return cache;
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::reap_thread_cache(void *cache) {
+        thread_cache *dying = static_cast<thread_cache *>(cache);
+        flush_thread_cache(dying);
+        retire_thread_cache(dying);
+        tls_cache = 0;
+        tls_dead = true;
+        delete dying;
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::flush_thread_cache(thread_cache *cache) {
+        for (size_t index = 0; index != ENClasses::NCLASSES; ++index) {
+            obj *first = cache->free_list[index];
+            if (first) {
+                obj *last = first;
+                while (last->next) {
+                    last = last->next;
+                }
+                release_to_central(index, first, last);
+                cache->free_list[index] = 0;
+                cache->length[index].set(0);
+            }
+        }
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::retire_thread_cache(thread_cache *cache) {
+        std::lock_guard<std::mutex> guard(central_mutex);
+        add_thread_stats(retired, cache);
+        if (cache->prev) {
+            cache->prev->next = cache->next;
+        } else {
+            cache_list = cache->next;
+        }
+        if (cache->next) {
+            cache->next->prev = cache->prev;
+        }
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::add_thread_stats(stats& out, const thread_cache *cache) {
+        for (size_t index = 0; index != ENClasses::NCLASSES; ++index) {
+            class_stats& cs = out.classes[index];
+            cs.hits += cache->hits[index].get();
+            cs.misses += cache->misses[index].get();
+            cs.frees += cache->frees[index].get();
+            cs.cached_blocks += cache->length[index].get();
+        }
+        out.large_allocs += cache->large_allocs.get();
+        out.large_frees += cache->large_frees.get();
+        out.large_bytes += cache->large_bytes.get();
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::sample(thread_cache *cache, size_t bytes, const std::type_info *site) {
+        size_t period = trace_period.load(std::memory_order_relaxed);
+        if (cache) {
+            if (cache->sample_countdown > 1 && cache->sample_countdown <= period) {
+                --cache->sample_countdown;
+                return;
+            }
+            cache->sample_countdown = period;
+        }
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        trace_record& record = trace_ring[trace_count % ETraceCapacity::TRACE_CAPACITY];
+        record.bytes = bytes;
+        record.site = site;
+        record.thread = std::this_thread::get_id();
+        ++trace_count;
+    }
+
+    template <class Policy, class Backing>
+    void *pool_alloc<Policy, Backing>::allocate(size_t bytes, const std::type_info *site) {
+        thread_cache *cache = get_thread_cache();
+        if (trace_period.load(std::memory_order_relaxed) != 0) {
+            sample(cache, bytes, site);
+        }
+        if (bytes > Policy::MAXBYTES) {
+            if (cache) {
+                cache->large_allocs.add(1);
+                cache->large_bytes.add(bytes);
+            } else {
+                std::lock_guard<std::mutex> guard(central_mutex);
+                ++retired.large_allocs;
+                retired.large_bytes += bytes;
+            }
+            return malloc(bytes);
+        }
+        size_t index = Policy::class_index(bytes);
+        if (!cache) {
+            size_t nobjs = 1;
+            return fetch_from_central(index, nobjs);
+        }
+        obj *list = cache->free_list[index];
+        if (list) {
+            // listпռ
+            cache->free_list[index] = list->next;
+            cache->length[index].add(size_t(-1));
+            cache->hits[index].add(1);
+            return list;
+        } else {
+            // listû㹻Ŀռ䣬Ҫڴȡռ
+            cache->misses[index].add(1);
+            return refill(index);
+        }
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::deallocate(void *ptr, size_t bytes) {
+        thread_cache *cache = get_thread_cache();
+        if (bytes > Policy::MAXBYTES) {
+            if (cache) {
+                cache->large_frees.add(1);
+            } else {
+                std::lock_guard<std::mutex> guard(central_mutex);
+                ++retired.large_frees;
+            }
+            free(ptr);
+            return;
+        }
+        size_t index = Policy::class_index(bytes);
+        obj *node = static_cast<obj *>(ptr);
+        if (!cache) {
+            node->next = 0;
+            release_to_central(index, node, node);
+            return;
+        }
+        node->next = cache->free_list[index];
+        cache->free_list[index] = node;
+        cache->frees[index].add(1);
+        cache->length[index].add(1);
+        size_t batch = Policy::batch_size(index);
+        if (cache->length[index].get() > 2 * batch) {
+            // ̻߳࣬ǰbatch黹ڴ
+            obj *last = node;
+            for (size_t i = 1; i < batch; ++i) {
+                last = last->next;
+            }
+            cache->free_list[index] = last->next;
+            cache->length[index].set(cache->length[index].get() - batch);
+            release_to_central(index, node, last);
+        }
+    }
+
+    template <class Policy, class Backing>
+    void *pool_alloc<Policy, Backing>::reallocate(void *ptr, size_t old_sz, size_t new_sz, const std::type_info *site) {
+        if (!ptr || old_sz == 0) {
+            return allocate(new_sz, site);
+        }
+        if (old_sz > Policy::MAXBYTES && new_sz > Policy::MAXBYTES) {
+            void *result = realloc(ptr, new_sz);
+            if (!result) {
+                throw std::bad_alloc();
+            }
+            // ͳƸİµĴСƣȥold_sznew_szСʱsize_t
+            thread_cache *cache = get_thread_cache();
+            if (cache) {
+                cache->large_bytes.add(new_sz - old_sz);
+            } else {
+                std::lock_guard<std::mutex> guard(central_mutex);
+                retired.large_bytes += new_sz - old_sz;
+            }
+            return result;
+        }
+        if (old_sz <= Policy::MAXBYTES && new_sz <= Policy::MAXBYTES) {
+            size_t old_index = Policy::class_index(old_sz);
+            size_t new_index = Policy::class_index(new_sz);
+            if (old_index == new_index) {
+                return ptr;
+            }
+            if (old_index < new_index) {
+                // ǡڴгһ飬ֱ
+                size_t old_size = Policy::class_size(old_index);
+                size_t new_size = Policy::class_size(new_index);
+                std::lock_guard<std::mutex> guard(central_mutex);
+                if ((char *)ptr + old_size == start_free && new_size - old_size <= (size_t)(end_free - start_free)) {
+                    start_free += new_size - old_size;
+                    return ptr;
+                }
+            }
+        }
+        void *result = allocate(new_sz, site);
+        memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
+        deallocate(ptr, old_sz);
+        return result;
+    }
+
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::obj *pool_alloc<Policy, Backing>::fetch_from_central(size_t index, size_t& nobjs) {
+        std::lock_guard<std::mutex> guard(central_mutex);
+        ++central_fetches;
+        obj **my_free_list = free_list + index;
+        obj *result = *my_free_list;
+        if (result) {
+            // free list飬ժnobjs
+            obj *last = result;
+            size_t n = 1;
+            for (; n < nobjs && last->next; ++n) {
+                last = last->next;
+            }
+            *my_free_list = last->next;
+            last->next = 0;
+            nobjs = n;
+            return result;
+        }
+        //ڴȡ
+        size_t size = Policy::class_size(index);
+        char *chunk = chunk_alloc(size, nobjs);
+        obj *current_obj = (obj *)chunk;
+        for (size_t i = 1; i < nobjs; ++i) {
+            obj *next_obj = (obj *)((char *)current_obj + size);
+            current_obj->next = next_obj;
+            current_obj = next_obj;
+        }
+        current_obj->next = 0;
+        return (obj *)chunk;
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::release_to_central(size_t index, obj *first, obj *last) {
+        std::lock_guard<std::mutex> guard(central_mutex);
+        last->next = free_list[index];
+        free_list[index] = first;
+    }
+
+    // һindexsize classĶ󣬲ʱΪ̻߳ʵfree listӽڵ
+    template <class Policy, class Backing>
+    void *pool_alloc<Policy, Backing>::refill(size_t index) {
+        size_t nobjs = Policy::batch_size(index);
+        obj *result = fetch_from_central(index, nobjs);
+        if (nobjs > 1) {
+            //ȡĶĿռ뵽̻߳Ӧfree listȥ
+            tls_cache->free_list[index] = result->next;
+            tls_cache->length[index].set(nobjs - 1);
+        }
+        return result;
+    }
+
+    // һռ䣬nobjsСΪsize
+    // nobjs㣬nobjsܻή
+    template <class Policy, class Backing>
+    char *pool_alloc<Policy, Backing>::chunk_alloc(size_t size, size_t& nobjs) {
+        char *result = 0;
+        size_t total_bytes = size * nobjs;
+        size_t bytes_left = end_free - start_free;
+
+        if (bytes_left >= total_bytes) {
+            // ڴʣռȫҪ
+            result = start_free;
+            start_free = start_free + total_bytes;
+            return result;
+        } else if (bytes_left >= size) {
+            // ڴʣռ䲻ȫҪ㹻Ӧһϵ
+            nobjs = bytes_left / size;
+            total_bytes = nobjs * size;
+            result = start_free;
+            start_free += total_bytes;
+            return result;
+        } else {
+            // ڴʣռһĴС޷ṩ
+            size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
+            // ڴصʣͷüֵ
+            // size classһͷsize classз
+            while (bytes_left >= Policy::class_size(0)) {
+                size_t index = Policy::class_index(bytes_left);
+                if (Policy::class_size(index) > bytes_left) {
+                    --index;
+                }
+                obj **my_free_list = free_list + index;
+                ((obj *)start_free)->next = *my_free_list;
+                *my_free_list = (obj *)start_free;
+                start_free += Policy::class_size(index);
+                bytes_left -= Policy::class_size(index);
+            }
+            // heapռ䣬ڴأchunkͷ¼chunk_list
+            // BackingܰchunkϵĲͬڴ
+            size_t chunk_bytes = CHUNK_HEADER_SIZE() + bytes_to_get;
+            chunk_header *chunk = (chunk_header *)Backing::allocate(chunk_bytes);
+            start_free = chunk ? (char *)chunk + CHUNK_HEADER_SIZE() : 0;
+            if (!start_free) {
+                obj **my_free_list = 0, *p = 0;
+                for (size_t index = Policy::class_index(size); index != ENClasses::NCLASSES; ++index) {
+                    my_free_list = free_list + index;
+                    p = *my_free_list;
+                    if (p != 0) {
+                        *my_free_list = p->next;
+                        start_free = (char *)p;
+                        end_free = start_free + Policy::class_size(index);
+                        // ݹԼnobjs
+                        return chunk_alloc(size, nobjs);
+                    }
+                }
+                end_free = 0;
+                throw std::bad_alloc();
+            }
+            bytes_to_get = chunk_bytes - CHUNK_HEADER_SIZE();
+            chunk->next = chunk_list;
+            chunk->bytes = chunk_bytes;
+            chunk_list = chunk;
+            ++chunk_count;
+            heap_size += bytes_to_get;
+            end_free = start_free + bytes_to_get;
+            return chunk_alloc(size, nobjs);
+        }
+    }
+
+    template <class Policy, class Backing>
+    int pool_alloc<Policy, Backing>::compare_chunk_usage(const void *lhs, const void *rhs) {
+        const char *a = (const char *)((const chunk_usage *)lhs)->chunk;
+        const char *b = (const char *)((const chunk_usage *)rhs)->chunk;
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+
+    template <class Policy, class Backing>
+    typename pool_alloc<Policy, Backing>::chunk_usage *pool_alloc<Policy, Backing>::find_chunk(chunk_usage *usage, size_t n, const void *ptr) {
+        const char *p = (const char *)ptr;
+        // ֲһʼַpchunk
+        size_t first = 0, last = n;
+        while (first != last) {
+            size_t mid = first + (last - first) / 2;
+            if ((const char *)usage[mid].chunk <= p) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        if (first == 0) {
+            return 0;
+        }
+        chunk_usage *result = usage + first - 1;
+        const char *start = (const char *)result->chunk;
+        return p < start + result->chunk->bytes ? result : 0;
+    }
+
+    // ͳÿchunkпеֽ(free-listsڴʣռ)
+    // ֽchunkchunkûκʹãԹ黹ϵͳ
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::trim_central() {
+        size_t nchunks = 0;
+        for (chunk_header *chunk = chunk_list; chunk; chunk = chunk->next) {
+            ++nchunks;
+        }
+        if (nchunks == 0) {
+            return 0;
+        }
+        chunk_usage *usage = (chunk_usage *)malloc(nchunks * sizeof(chunk_usage));
+        if (!usage) {
+            return 0;
+        }
+        size_t n = 0;
+        for (chunk_header *chunk = chunk_list; chunk; chunk = chunk->next, ++n) {
+            usage[n].chunk = chunk;
+            usage[n].free_bytes = 0;
+        }
+        qsort(usage, nchunks, sizeof(chunk_usage), compare_chunk_usage);
+
+        chunk_usage *pool = 0;
+        if (start_free != end_free) {
+            pool = find_chunk(usage, nchunks, start_free);
+            if (pool) {
+                pool->free_bytes += end_free - start_free;
+            }
+        }
+        for (size_t index = 0; index != ENClasses::NCLASSES; ++index) {
+            size_t size = Policy::class_size(index);
+            for (obj *p = free_list[index]; p; p = p->next) {
+                chunk_usage *u = find_chunk(usage, nchunks, p);
+                if (u) {
+                    u->free_bytes += size;
+                }
+            }
+        }
+
+        size_t released = 0;
+        for (size_t i = 0; i != nchunks; ++i) {
+            if (usage[i].free_bytes == usage[i].chunk->bytes - CHUNK_HEADER_SIZE()) {
+                released += usage[i].chunk->bytes;
+            } else {
+                usage[i].chunk = 0;     //Ϊͷ
+            }
+        }
+        if (released != 0) {
+            // ڿͷchunkfree-listsժ
+            // ͷŵchunkchunkֶαͷŵΪ0Ҫ±Ƚϵַ
+            size_t nfree = 0;
+            for (size_t i = 0; i != nchunks; ++i) {
+                if (usage[i].chunk) {
+                    usage[nfree++] = usage[i];
+                }
+            }
+            for (size_t index = 0; index != ENClasses::NCLASSES; ++index) {
+                obj **link = free_list + index;
+                while (*link) {
+                    if (find_chunk(usage, nfree, *link)) {
+                        *link = (*link)->next;
+                    } else {
+                        link = &(*link)->next;
+                    }
+                }
+            }
+            if (pool && find_chunk(usage, nfree, start_free)) {
+                start_free = end_free = 0;
+            }
+            // usageЩchunkȫchunk_listժͷ
+            chunk_header **link = &chunk_list, *dead = 0;
+            while (*link) {
+                chunk_header *chunk = *link;
+                if (find_chunk(usage, nfree, chunk)) {
+                    *link = chunk->next;
+                    chunk->next = dead;
+                    dead = chunk;
+                } else {
+                    link = &chunk->next;
+                }
+            }
+            while (dead) {
+                chunk_header *chunk = dead;
+                dead = dead->next;
+                heap_size -= chunk->bytes - CHUNK_HEADER_SIZE();
+                Backing::deallocate(chunk, chunk->bytes);
+            }
+            released_size += released;
+        }
+        free(usage);
+        return released;
+    }
+
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::trim() {
+        // Ȱѵ̻߳黹ڴأڵchunk޷ͷ
+        thread_cache *cache = get_thread_cache();
+        if (cache) {
+            flush_thread_cache(cache);
+        }
+        std::lock_guard<std::mutex> guard(central_mutex);
+        return trim_central();
+    }
+
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::released_bytes() {
+        std::lock_guard<std::mutex> guard(central_mutex);
+        return released_size;
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::start_background_trim(unsigned interval_ms) {
+        background_trim.start(interval_ms);
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::stop_background_trim() {
+        background_trim.stop();
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::snapshot(stats& out) {
+        std::lock_guard<std::mutex> guard(central_mutex);
+        out = retired;
+        for (thread_cache *cache = cache_list; cache; cache = cache->next) {
+            add_thread_stats(out, cache);
+        }
+        out.idle_bytes = end_free - start_free;
+        for (size_t index = 0; index != ENClasses::NCLASSES; ++index) {
+            class_stats& cs = out.classes[index];
+            cs.block_size = Policy::class_size(index);
+            cs.central_blocks = 0;
+            for (obj *p = free_list[index]; p; p = p->next) {
+                ++cs.central_blocks;
+            }
+            out.idle_bytes += (cs.cached_blocks + cs.central_blocks) * cs.block_size;
+        }
+        out.refills = central_fetches;
+        out.chunk_allocs = chunk_count;
+        out.heap_bytes = heap_size;
+        out.released_bytes = released_size;
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::start_trace(size_t sample_period) {
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        trace_count = 0;
+        trace_period.store(sample_period, std::memory_order_relaxed);
+    }
+
+    template <class Policy, class Backing>
+    void pool_alloc<Policy, Backing>::stop_trace() {
+        trace_period.store(0, std::memory_order_relaxed);
+    }
+
+    template <class Policy, class Backing>
+    size_t pool_alloc<Policy, Backing>::trace(trace_record *records, size_t n) {
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        const size_t capacity = static_cast<size_t>(ETraceCapacity::TRACE_CAPACITY);
+        size_t kept = trace_count < capacity ? trace_count : capacity;
+        if (n > kept) {
+            n = kept;
+        }
+        for (size_t i = 0; i != n; ++i) {
+            records[i] = trace_ring[(trace_count - n + i) % capacity];
+        }
+        return n;
+    }
+
+    // ʱͨRAYN_ALLOC_POLICY滻Ĭsize class
+#ifndef RAYN_ALLOC_POLICY
+#define RAYN_ALLOC_POLICY default_alloc_policy
+#endif
+    // ͨRAYN_ALLOC_BACKING滻ĬchunkԴhuge_page_backing
+#ifndef RAYN_ALLOC_BACKING
+#define RAYN_ALLOC_BACKING malloc_backing
+#endif
+    typedef pool_alloc<RAYN_ALLOC_POLICY, RAYN_ALLOC_BACKING> alloc;
+
+    // ĬAlloc.cppʽʵ
+    extern template class pool_alloc<RAYN_ALLOC_POLICY, RAYN_ALLOC_BACKING>;
 }
 
 #endif
\ No newline at end of file
@@ -11,10 +11,13 @@
 
 #include <new>      // for placement new
 #include <cassert>
+#include <typeinfo>
 
 namespace rayn {
 
-    template <class T>
+    // PoolΪײĿռĬʹalloc
+    // allocator<T, pool_alloc<geometric_alloc_policy>>ʹüsize classڴ
+    template <class T, class Pool = alloc>
     class allocator {
     public:
         typedef T           value_type;
@@ -25,20 +28,40 @@ namespace rayn {
         typedef size_t      size_type;
         typedef ptrdiff_t   difference_type;
 
+        template <class U>
+        struct rebind {
+            typedef allocator<U, Pool> other;
+        };
+
     public:
+        // ״̬еallocator<T, Pool>ͬһPoolз
+        allocator() {}
+        template <class U>
+        allocator(const allocator<U, Pool>&) {}
+
         static T *allocate() {
-            return static_cast<T *>(alloc::allocate(sizeof(T)));
+            return static_cast<T *>(Pool::allocate(sizeof(T), &typeid(T)));
         }
         static T *allocate(size_t n) {
             if (n == 0) return 0;
-            return static_cast<T *>(alloc::allocate(sizeof(T) * n));
+            return static_cast<T *>(Pool::allocate(sizeof(T) * n, &typeid(T)));
         }
         static void deallocate(T *ptr) {
-            alloc::deallocate(static_cast<void *>(ptr), sizeof(T));
+            Pool::deallocate(static_cast<void *>(ptr), sizeof(T));
         }
         static void deallocate(T *ptr, size_t n) {
             if (n == 0) return;
-            alloc::deallocate(static_cast<void *>(ptr), sizeof(T) * n);
+            Pool::deallocate(static_cast<void *>(ptr), sizeof(T) * n);
+        }
+
+        // ǰmin(old_n, new_n)Ԫصֽڣֻڿ԰λƵT
+        static T *reallocate(T *ptr, size_t old_n, size_t new_n) {
+            if (new_n == 0) {
+                deallocate(ptr, old_n);
+                return 0;
+            }
+            return static_cast<T *>(Pool::reallocate(static_cast<void *>(ptr),
+                sizeof(T) * old_n, sizeof(T) * new_n, &typeid(T)));
         }
 
         static void construct(T *ptr) {
@@ -58,6 +81,15 @@ namespace rayn {
         }
     };
 
+    template <class T1, class T2, class Pool>
+    inline bool operator== (const allocator<T1, Pool>&, const allocator<T2, Pool>&) {
+        return true;
+    }
+    template <class T1, class T2, class Pool>
+    inline bool operator!= (const allocator<T1, Pool>&, const allocator<T2, Pool>&) {
+        return false;
+    }
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1011 @@
+/*
+** BTree.h
+** Created by Rayn on 2026/10/17
+** B-tree with many values per node, the backend of btree_set and btree_map
+*/
+#ifndef _BTREE_H_
+#define _BTREE_H_
+
+#include "Allocator.h"
+#include "AlgoBase.h"
+#include "Construct.h"
+#include "Iterator.h"
+#include "Move.h"
+#include "Pair.h"
+#include "ReverseIterator.h"
+#include "TypeTraits.h"
+
+#include <cstddef>
+
+namespace rayn {
+
+    template <class Value>
+    struct __btree_internal_node;
+
+    /*
+    ** A node keeps its values sorted in one array, so a search inside a node
+    ** is a binary search over contiguous memory and a scan walks a whole
+    ** array before it follows a pointer. Leaves have no child pointers;
+    ** internal nodes are __btree_internal_node and have count + 1 children.
+    ** All leaves are at the same depth.
+    */
+    template <class Value>
+    struct __btree_node {
+        enum EBtreeNodeBytes{ NODE_BYTES = 256 };
+        enum EBtreeNodeValues{
+            MAX_VALUES = sizeof(Value) * 3 > NODE_BYTES ? 3 : NODE_BYTES / sizeof(Value),
+            MIN_VALUES = MAX_VALUES / 2
+        };
+
+        __btree_node   *parent;
+        unsigned short  position;   // index in parent's children
+        unsigned short  count;      // number of values
+        bool            leaf;
+        typename aligned_storage<sizeof(Value) * MAX_VALUES, alignment_of<Value>::value>::type storage;
+
+        Value *values() {
+            return reinterpret_cast<Value *>(&storage);
+        }
+        const Value *values() const {
+            return reinterpret_cast<const Value *>(&storage);
+        }
+        __btree_node *child(int i) const;
+    };
+
+    template <class Value>
+    struct __btree_internal_node : public __btree_node<Value> {
+        __btree_node<Value> *children[__btree_node<Value>::MAX_VALUES + 1];
+    };
+
+    template <class Value>
+    inline __btree_node<Value> *
+    __btree_node<Value>::child(int i) const {
+        return static_cast<const __btree_internal_node<Value> *>(this)->children[i];
+    }
+
+    /*
+    ** Step (node, position) to the next value. The end is one past the last
+    ** value of the rightmost leaf, and stepping past it leaves it there.
+    */
+    template <class NodePtr>
+    void _btree_increment(NodePtr& node, int& position) {
+        if (node->leaf) {
+            if (++position < node->count) {
+                return;
+            }
+            NodePtr save = node;
+            int save_position = position;
+            while (position == node->count && node->parent != 0) {
+                position = node->position;
+                node = node->parent;
+            }
+            if (position == node->count) {
+                node = save;
+                position = save_position;
+            }
+        } else {
+            node = node->child(position + 1);
+            while (!node->leaf) {
+                node = node->child(0);
+            }
+            position = 0;
+        }
+    }
+
+    template <class NodePtr>
+    void _btree_decrement(NodePtr& node, int& position) {
+        if (node->leaf) {
+            if (--position >= 0) {
+                return;
+            }
+            NodePtr save = node;
+            int save_position = position;
+            while (position < 0 && node->parent != 0) {
+                position = node->position - 1;
+                node = node->parent;
+            }
+            if (position < 0) {
+                node = save;
+                position = save_position;
+            }
+        } else {
+            node = node->child(position);
+            while (!node->leaf) {
+                node = node->child(node->count);
+            }
+            position = node->count - 1;
+        }
+    }
+
+    template <class T>
+    struct __btree_iterator {
+        typedef T       value_type;
+        typedef T&      reference;
+        typedef T*      pointer;
+
+        typedef bidirectional_iterator_tag      iterator_category;
+        typedef ptrdiff_t                       difference_type;
+
+        typedef __btree_iterator<T>     self;
+        typedef __btree_node<T>*        node_ptr;
+
+        node_ptr    _m_node;
+        int         _m_position;
+
+        __btree_iterator() : _m_node(0), _m_position(0) {}
+        __btree_iterator(node_ptr x, int position) : _m_node(x), _m_position(position) {}
+
+        reference operator* () const {
+            return _m_node->values()[_m_position];
+        }
+        pointer operator-> () const {
+            return _m_node->values() + _m_position;
+        }
+        self& operator++ () {
+            _btree_increment(_m_node, _m_position);
+            return *this;
+        }
+        self operator++ (int) {
+            self temp = *this;
+            _btree_increment(_m_node, _m_position);
+            return temp;
+        }
+        self& operator-- () {
+            _btree_decrement(_m_node, _m_position);
+            return *this;
+        }
+        self operator-- (int) {
+            self temp = *this;
+            _btree_decrement(_m_node, _m_position);
+            return temp;
+        }
+        bool operator== (const self& x) const {
+            return _m_node == x._m_node && _m_position == x._m_position;
+        }
+        bool operator!= (const self& x) const {
+            return !(*this == x);
+        }
+    };
+
+    template <class T>
+    struct __btree_const_iterator {
+        typedef T               value_type;
+        typedef const T&        reference;
+        typedef const T*        pointer;
+
+        typedef bidirectional_iterator_tag      iterator_category;
+        typedef ptrdiff_t                       difference_type;
+
+        typedef __btree_const_iterator<T>   self;
+        typedef __btree_iterator<T>         iterator;
+        typedef const __btree_node<T>*      node_ptr;
+
+        node_ptr    _m_node;
+        int         _m_position;
+
+        __btree_const_iterator() : _m_node(0), _m_position(0) {}
+        __btree_const_iterator(node_ptr x, int position) : _m_node(x), _m_position(position) {}
+        __btree_const_iterator(const iterator& it) : _m_node(it._m_node), _m_position(it._m_position) {}
+
+        iterator _const_cast() const {
+            return iterator(const_cast<__btree_node<T> *>(_m_node), _m_position);
+        }
+
+        reference operator* () const {
+            return _m_node->values()[_m_position];
+        }
+        pointer operator-> () const {
+            return _m_node->values() + _m_position;
+        }
+        self& operator++ () {
+            _btree_increment(_m_node, _m_position);
+            return *this;
+        }
+        self operator++ (int) {
+            self temp = *this;
+            _btree_increment(_m_node, _m_position);
+            return temp;
+        }
+        self& operator-- () {
+            _btree_decrement(_m_node, _m_position);
+            return *this;
+        }
+        self operator-- (int) {
+            self temp = *this;
+            _btree_decrement(_m_node, _m_position);
+            return temp;
+        }
+        bool operator== (const self& x) const {
+            return _m_node == x._m_node && _m_position == x._m_position;
+        }
+        bool operator!= (const self& x) const {
+            return !(*this == x);
+        }
+    };
+
+    template <class T>
+    inline bool
+    operator==(const __btree_iterator<T>& x, const __btree_const_iterator<T>& y)
+    { return x._m_node == y._m_node && x._m_position == y._m_position; }
+
+    template <class T>
+    inline bool
+    operator!=(const __btree_iterator<T>& x, const __btree_const_iterator<T>& y)
+    { return !(x == y); }
+
+
+    /*
+    ** The same interface as rb_tree. Unlike rb_tree, inserting or erasing
+    ** moves values between nodes, so it invalidates all iterators; the
+    ** iterator returned by insert or erase is valid.
+    */
+    template <class Key, class Value, class KeyOfValue, class Compare,
+              class Alloc = allocator<Value> >
+    class btree {
+    protected:
+        typedef __btree_node<Value>                                             node_type;
+        typedef __btree_internal_node<Value>                                    internal_node_type;
+        typedef typename Alloc::template rebind<node_type>::other               leaf_allocator;
+        typedef typename Alloc::template rebind<internal_node_type>::other      internal_allocator;
+
+        enum EBtreeLimits{ MAX_VALUES = node_type::MAX_VALUES, MIN_VALUES = node_type::MIN_VALUES };
+
+    public:
+        typedef Key                         key_type;
+        typedef Value                       value_type;
+        typedef value_type*                 pointer;
+        typedef const value_type*           const_pointer;
+        typedef value_type&                 reference;
+        typedef const value_type&           const_reference;
+        typedef size_t                      size_type;
+        typedef ptrdiff_t                   difference_type;
+        typedef Alloc                       allocator_type;
+
+        typedef __btree_iterator<value_type>            iterator;
+        typedef __btree_const_iterator<value_type>      const_iterator;
+        typedef reverse_iterator_t<iterator>            reverse_iterator;
+        typedef reverse_iterator_t<const_iterator>      const_reverse_iterator;
+
+    protected:
+        node_type          *root;
+        node_type          *leftmost;
+        node_type          *rightmost;
+        size_type           element_count;
+        Compare             key_compare;
+        leaf_allocator      leaf_alloc;
+        internal_allocator  internal_alloc;
+
+    public:
+        // constructor/destructor
+        btree(const Compare& comp = Compare(),
+              const allocator_type& a = allocator_type())
+        : root(0), leftmost(0), rightmost(0), element_count(0),
+          key_compare(comp), leaf_alloc(a), internal_alloc(a) {}
+
+        // the copy allocates from the same allocator
+        btree(const btree& other)
+        : root(0), leftmost(0), rightmost(0), element_count(0),
+          key_compare(other.key_compare), leaf_alloc(other.leaf_alloc),
+          internal_alloc(other.internal_alloc)
+        {
+            _m_copy_from(other);
+        }
+
+        btree(btree&& other)
+        : root(other.root), leftmost(other.leftmost), rightmost(other.rightmost),
+          element_count(other.element_count), key_compare(other.key_compare),
+          leaf_alloc(other.leaf_alloc), internal_alloc(other.internal_alloc)
+        {
+            other.root = other.leftmost = other.rightmost = 0;
+            other.element_count = 0;
+        }
+
+        ~btree() {
+            clear();
+        }
+
+        btree&
+        operator= (const btree& other) {
+            if (this != &other) {
+                clear();
+                key_compare = other.key_compare;
+                _m_copy_from(other);
+            }
+            return *this;
+        }
+
+        btree&
+        operator= (btree&& other) {
+            swap(other);
+            return *this;
+        }
+
+        // Accessors.
+        Compare
+        key_comp() const
+        { return key_compare; }
+
+        allocator_type
+        get_allocator() const
+        { return allocator_type(leaf_alloc); }
+
+        iterator
+        begin()
+        { return iterator(leftmost, 0); }
+
+        const_iterator
+        begin() const
+        { return const_iterator(leftmost, 0); }
+
+        iterator
+        end()
+        { return iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+        const_iterator
+        end() const
+        { return const_iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+        reverse_iterator
+        rbegin()
+        { return reverse_iterator(end()); }
+
+        const_reverse_iterator
+        rbegin() const
+        { return const_reverse_iterator(end()); }
+
+        reverse_iterator
+        rend()
+        { return reverse_iterator(begin()); }
+
+        const_reverse_iterator
+        rend() const
+        { return const_reverse_iterator(begin()); }
+
+        // capacity
+        bool        empty() const       { return element_count == 0; }
+        size_type   size() const        { return element_count; }
+        size_type   max_size() const    { return size_type(-1); }
+
+        void swap(btree& other) {
+            rayn::swap(root, other.root);
+            rayn::swap(leftmost, other.leftmost);
+            rayn::swap(rightmost, other.rightmost);
+            rayn::swap(element_count, other.element_count);
+            rayn::swap(key_compare, other.key_compare);
+            rayn::swap(leaf_alloc, other.leaf_alloc);
+            rayn::swap(internal_alloc, other.internal_alloc);
+        }
+
+        // modifiers
+        pair<iterator, bool>
+        insert_unique(const value_type& v) {
+            return _m_insert_unique(v);
+        }
+
+        pair<iterator, bool>
+        insert_unique(value_type&& v) {
+            return _m_insert_unique(rayn::move(v));
+        }
+
+        iterator
+        insert_equal(const value_type& v) {
+            return _m_insert_equal(v);
+        }
+
+        iterator
+        insert_equal(value_type&& v) {
+            return _m_insert_equal(rayn::move(v));
+        }
+
+        template <typename InputIterator>
+        void
+        insert_unique(InputIterator first, InputIterator last) {
+            for (; first != last; ++first) {
+                _m_insert_unique(*first);
+            }
+        }
+
+        template <typename InputIterator>
+        void
+        insert_equal(InputIterator first, InputIterator last) {
+            for (; first != last; ++first) {
+                _m_insert_equal(*first);
+            }
+        }
+
+        iterator
+        erase(const_iterator pos);
+
+        iterator
+        erase(const_iterator first, const_iterator last) {
+            if (first == begin() && last == end()) {
+                clear();
+                return end();
+            }
+            // erasing invalidates last, so count instead
+            size_type n = rayn::distance(first, last);
+            iterator it = first._const_cast();
+            while (n-- != 0) {
+                it = erase(it);
+            }
+            return it;
+        }
+
+        size_type
+        erase(const key_type& k) {
+            pair<iterator, iterator> range = equal_range(k);
+            size_type n = rayn::distance(range.first, range.second);
+            erase(range.first, range.second);
+            return n;
+        }
+
+        void
+        clear() {
+            if (root != 0) {
+                _m_destroy(root);
+            }
+            root = leftmost = rightmost = 0;
+            element_count = 0;
+        }
+
+        // find operations.
+        iterator
+        find(const key_type& k) {
+            iterator it = lower_bound(k);
+            return it == end() || key_compare(k, _s_key(it._m_node, it._m_position)) ? end() : it;
+        }
+
+        const_iterator
+        find(const key_type& k) const {
+            const_iterator it = lower_bound(k);
+            return it == end() || key_compare(k, _s_key(it._m_node, it._m_position)) ? end() : it;
+        }
+
+        size_type
+        count(const key_type& k) const {
+            pair<const_iterator, const_iterator> range = equal_range(k);
+            return rayn::distance(range.first, range.second);
+        }
+
+        iterator
+        lower_bound(const key_type& k) {
+            return _m_lower_bound(k)._const_cast();
+        }
+
+        const_iterator
+        lower_bound(const key_type& k) const {
+            return _m_lower_bound(k);
+        }
+
+        iterator
+        upper_bound(const key_type& k) {
+            return _m_upper_bound(k)._const_cast();
+        }
+
+        const_iterator
+        upper_bound(const key_type& k) const {
+            return _m_upper_bound(k);
+        }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k) {
+            return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+        }
+
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const {
+            return pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+        }
+
+    private:
+        static const Key& _s_key(const node_type *x, int i) {
+            return KeyOfValue()(x->values()[i]);
+        }
+        static node_type*& _s_child(node_type *x, int i) {
+            return static_cast<internal_node_type *>(x)->children[i];
+        }
+        // Move the value at from to the raw slot at to, leaving from raw.
+        static void _s_relocate(value_type *to, value_type *from) {
+            rayn::construct(to, rayn::move(*from));
+            rayn::destroy(from);
+        }
+
+        // index of the first value in x not less than k
+        int _m_node_lower_bound(const node_type *x, const key_type& k) const {
+            int first = 0;
+            int len = x->count;
+            while (len > 0) {
+                int half = len / 2;
+                if (key_compare(_s_key(x, first + half), k)) {
+                    first += half + 1;
+                    len -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            return first;
+        }
+        // index of the first value in x greater than k
+        int _m_node_upper_bound(const node_type *x, const key_type& k) const {
+            int first = 0;
+            int len = x->count;
+            while (len > 0) {
+                int half = len / 2;
+                if (!key_compare(k, _s_key(x, first + half))) {
+                    first += half + 1;
+                    len -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            return first;
+        }
+        // The value at or after position i of leaf x, climbing when i is past its end.
+        const_iterator _m_last(const node_type *x, int i) const {
+            while (i == x->count && x->parent != 0) {
+                i = x->position;
+                x = x->parent;
+            }
+            return i == x->count ? end() : const_iterator(x, i);
+        }
+        const_iterator _m_lower_bound(const key_type& k) const {
+            if (root == 0) {
+                return end();
+            }
+            const node_type *x = root;
+            while (true) {
+                int i = _m_node_lower_bound(x, k);
+                if (x->leaf) {
+                    return _m_last(x, i);
+                }
+                x = x->child(i);
+            }
+        }
+        const_iterator _m_upper_bound(const key_type& k) const {
+            if (root == 0) {
+                return end();
+            }
+            const node_type *x = root;
+            while (true) {
+                int i = _m_node_upper_bound(x, k);
+                if (x->leaf) {
+                    return _m_last(x, i);
+                }
+                x = x->child(i);
+            }
+        }
+
+        node_type *_m_new_leaf() {
+            node_type *x = leaf_alloc.allocate();
+            x->parent = 0;
+            x->position = 0;
+            x->count = 0;
+            x->leaf = true;
+            return x;
+        }
+        node_type *_m_new_internal() {
+            internal_node_type *x = internal_alloc.allocate();
+            x->parent = 0;
+            x->position = 0;
+            x->count = 0;
+            x->leaf = false;
+            for (int i = 0; i <= MAX_VALUES; ++i) {
+                x->children[i] = 0;
+            }
+            return x;
+        }
+        // Free a node whose values are gone.
+        void _m_free_node(node_type *x) {
+            if (x->leaf) {
+                leaf_alloc.deallocate(x);
+            } else {
+                internal_alloc.deallocate(static_cast<internal_node_type *>(x));
+            }
+        }
+        // Destroy the subtree of x.
+        void _m_destroy(node_type *x) {
+            if (!x->leaf) {
+                for (int i = 0; i <= x->count; ++i) {
+                    if (x->child(i) != 0) {
+                        _m_destroy(x->child(i));
+                    }
+                }
+            }
+            rayn::destroy(x->values(), x->values() + x->count);
+            _m_free_node(x);
+        }
+        node_type *_m_copy(const node_type *x, node_type *parent);
+        void _m_copy_from(const btree& other);
+
+        // The leaf and the position where k goes, after equal keys if equal is true.
+        void _m_insert_position(const key_type& k, bool equal, node_type*& x, int& i) {
+            if (root == 0) {
+                root = leftmost = rightmost = _m_new_leaf();
+            }
+            x = root;
+            while (true) {
+                i = equal ? _m_node_upper_bound(x, k) : _m_node_lower_bound(x, k);
+                if (x->leaf) {
+                    return;
+                }
+                x = x->child(i);
+            }
+        }
+
+        template <class Arg>
+        pair<iterator, bool>
+        _m_insert_unique(Arg&& v) {
+            node_type *x;
+            int i;
+            _m_insert_position(KeyOfValue()(v), false, x, i);
+            iterator next = _m_last(x, i)._const_cast();
+            if (next != end() && !key_compare(KeyOfValue()(v), _s_key(next._m_node, next._m_position))) {
+                return pair<iterator, bool>(next, false);
+            }
+            return pair<iterator, bool>(_m_insert_at(x, i, rayn::forward<Arg>(v)), true);
+        }
+
+        template <class Arg>
+        iterator
+        _m_insert_equal(Arg&& v) {
+            node_type *x;
+            int i;
+            _m_insert_position(KeyOfValue()(v), true, x, i);
+            return _m_insert_at(x, i, rayn::forward<Arg>(v));
+        }
+
+        template <class Arg>
+        iterator _m_insert_at(node_type *x, int i, Arg&& v);
+
+        void _m_split(node_type *x, int insert_position);
+        void _m_open_slot(node_type *x, int i);
+        void _m_rebalance(iterator& it);
+        void _m_rotate_right(node_type *left, node_type *x, iterator& it);
+        void _m_rotate_left(node_type *x, node_type *right);
+        void _m_merge(node_type *left, node_type *right, iterator& it);
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    inline bool
+    operator==(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+               const btree<Key, Value, KeyOfValue, Compare, Alloc>& y)
+    {
+        return x.size() == y.size() && rayn::equal(x.begin(), x.end(), y.begin());
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    inline bool
+    operator<(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+              const btree<Key, Value, KeyOfValue, Compare, Alloc>& y)
+    {
+        return rayn::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+    }
+
+    // _m_copy
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc>::node_type *
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_copy(const node_type *x, node_type *parent)
+    {
+        node_type *y = x->leaf ? _m_new_leaf() : _m_new_internal();
+        y->parent = parent;
+        y->position = x->position;
+        try {
+            for (; y->count != x->count; ++y->count) {
+                rayn::construct(y->values() + y->count, x->values()[y->count]);
+            }
+            if (!x->leaf) {
+                for (int i = 0; i <= x->count; ++i) {
+                    _s_child(y, i) = _m_copy(x->child(i), y);
+                }
+            }
+        } catch (...) {
+            _m_destroy(y);
+            throw;
+        }
+        return y;
+    }
+
+    // _m_copy_from
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_copy_from(const btree& other)
+    {
+        if (other.root == 0) {
+            return;
+        }
+        root = _m_copy(other.root, 0);
+        for (leftmost = root; !leftmost->leaf; leftmost = leftmost->child(0)) {}
+        for (rightmost = root; !rightmost->leaf; rightmost = rightmost->child(rightmost->count)) {}
+        element_count = other.element_count;
+    }
+
+    /*
+    ** @brief   Make value slot i and child slot i + 1 of x free, x must not be full.
+    */
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_open_slot(node_type *x, int i)
+    {
+        for (int j = x->count; j > i; --j) {
+            _s_relocate(x->values() + j, x->values() + j - 1);
+        }
+        if (!x->leaf) {
+            for (int j = x->count + 1; j > i + 1; --j) {
+                _s_child(x, j) = x->child(j - 1);
+                x->child(j)->position = j;
+            }
+        }
+    }
+
+    /*
+    ** @brief   Split the full node x into x and a new right sibling, moving
+    **          the value between them up to the parent, which is split first
+    **          if it is full too.
+    ** Where the split falls depends on where the next value goes: inserting
+    ** at the end leaves x full and the sibling empty, so ascending input
+    ** fills every node instead of leaving them half empty.
+    */
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_split(node_type *x, int insert_position)
+    {
+        if (x->parent == 0) {
+            node_type *r = _m_new_internal();
+            _s_child(r, 0) = x;
+            x->parent = r;
+            x->position = 0;
+            root = r;
+        } else if (x->parent->count == MAX_VALUES) {
+            _m_split(x->parent, x->position);
+        }
+        node_type *sibling = x->leaf ? _m_new_leaf() : _m_new_internal();
+        node_type *parent = x->parent;
+
+        int moved = insert_position == 0 ? x->count - 1 :
+                    insert_position == MAX_VALUES ? 0 : x->count / 2;
+        int middle = x->count - moved - 1;
+        for (int j = 0; j != moved; ++j) {
+            _s_relocate(sibling->values() + j, x->values() + middle + 1 + j);
+        }
+        sibling->count = moved;
+        if (!x->leaf) {
+            for (int j = 0; j <= moved; ++j) {
+                node_type *c = x->child(middle + 1 + j);
+                _s_child(sibling, j) = c;
+                c->parent = sibling;
+                c->position = j;
+            }
+        }
+
+        int p = x->position;
+        _m_open_slot(parent, p);
+        _s_relocate(parent->values() + p, x->values() + middle);
+        _s_child(parent, p + 1) = sibling;
+        sibling->parent = parent;
+        sibling->position = p + 1;
+        ++parent->count;
+        x->count = middle;
+        if (rightmost == x) {
+            rightmost = sibling;
+        }
+    }
+
+    // _m_insert_at
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    template <class Arg>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_insert_at(node_type *x, int i, Arg&& v)
+    {
+        if (x->count == MAX_VALUES) {
+            _m_split(x, i);
+            if (i > x->count) {
+                i -= x->count + 1;
+                x = x->parent->child(x->position + 1);
+            }
+        }
+        _m_open_slot(x, i);
+        try {
+            rayn::construct(x->values() + i, rayn::forward<Arg>(v));
+        } catch (...) {
+            for (int j = i; j != x->count; ++j) {
+                _s_relocate(x->values() + j, x->values() + j + 1);
+            }
+            throw;
+        }
+        ++x->count;
+        ++element_count;
+        return iterator(x, i);
+    }
+
+    /*
+    ** @brief   Erase the value at pos.
+    ** @return  The iterator to the next value.
+    ** A value in an internal node is replaced by its predecessor, which is
+    ** always in a leaf, so values only ever leave leaves. A node left with
+    ** less than MIN_VALUES then takes a value from a sibling or merges with
+    ** it, which may leave the parent short in turn.
+    */
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    erase(const_iterator pos)
+    {
+        node_type *x = pos._const_cast()._m_node;
+        int i = pos._m_position;
+        bool internal = !x->leaf;
+        rayn::destroy(x->values() + i);
+        if (internal) {
+            node_type *leaf = x->child(i);
+            while (!leaf->leaf) {
+                leaf = leaf->child(leaf->count);
+            }
+            _s_relocate(x->values() + i, leaf->values() + leaf->count - 1);
+            x = leaf;
+            i = --x->count;
+        } else {
+            for (int j = i + 1; j < x->count; ++j) {
+                _s_relocate(x->values() + j - 1, x->values() + j);
+            }
+            --x->count;
+        }
+        --element_count;
+
+        iterator it(x, i);
+        _m_rebalance(it);
+        if (root == 0) {
+            return end();
+        }
+        it = _m_last(it._m_node, it._m_position)._const_cast();
+        if (internal) {
+            // it is at the predecessor moved up
+            ++it;
+        }
+        return it;
+    }
+
+    // _m_rebalance
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_rebalance(iterator& it)
+    {
+        node_type *x = it._m_node;
+        while (x != root && x->count < MIN_VALUES) {
+            node_type *parent = x->parent;
+            int p = x->position;
+            node_type *left = p > 0 ? parent->child(p - 1) : 0;
+            node_type *right = p < parent->count ? parent->child(p + 1) : 0;
+            if (left != 0 && left->count > MIN_VALUES) {
+                _m_rotate_right(left, x, it);
+                return;
+            }
+            if (right != 0 && right->count > MIN_VALUES) {
+                _m_rotate_left(x, right);
+                return;
+            }
+            if (left != 0) {
+                _m_merge(left, x, it);
+            } else {
+                _m_merge(x, right, it);
+            }
+            x = parent;
+        }
+        if (root->count == 0) {
+            node_type *old = root;
+            if (old->leaf) {
+                root = leftmost = rightmost = 0;
+            } else {
+                root = old->child(0);
+                root->parent = 0;
+                root->position = 0;
+            }
+            _m_free_node(old);
+        }
+    }
+
+    // Move the last value of left up to the parent and the parent's value down to the front of x.
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_rotate_right(node_type *left, node_type *x, iterator& it)
+    {
+        node_type *parent = x->parent;
+        int p = left->position;
+        for (int j = x->count; j > 0; --j) {
+            _s_relocate(x->values() + j, x->values() + j - 1);
+        }
+        _s_relocate(x->values(), parent->values() + p);
+        _s_relocate(parent->values() + p, left->values() + left->count - 1);
+        if (!x->leaf) {
+            for (int j = x->count + 1; j > 0; --j) {
+                _s_child(x, j) = x->child(j - 1);
+                x->child(j)->position = j;
+            }
+            node_type *c = left->child(left->count);
+            _s_child(x, 0) = c;
+            c->parent = x;
+            c->position = 0;
+        }
+        --left->count;
+        ++x->count;
+        if (it._m_node == x) {
+            ++it._m_position;
+        }
+    }
+
+    // Move the parent's value down to the end of x and the first value of right up.
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_rotate_left(node_type *x, node_type *right)
+    {
+        node_type *parent = x->parent;
+        int p = x->position;
+        _s_relocate(x->values() + x->count, parent->values() + p);
+        _s_relocate(parent->values() + p, right->values());
+        for (int j = 1; j < right->count; ++j) {
+            _s_relocate(right->values() + j - 1, right->values() + j);
+        }
+        if (!x->leaf) {
+            node_type *c = right->child(0);
+            _s_child(x, x->count + 1) = c;
+            c->parent = x;
+            c->position = x->count + 1;
+            for (int j = 0; j < right->count; ++j) {
+                _s_child(right, j) = right->child(j + 1);
+                right->child(j)->position = j;
+            }
+        }
+        ++x->count;
+        --right->count;
+    }
+
+    // Append the parent's value between them and all of right to left, then free right.
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void
+    btree<Key, Value, KeyOfValue, Compare, Alloc>::
+    _m_merge(node_type *left, node_type *right, iterator& it)
+    {
+        node_type *parent = left->parent;
+        int p = left->position;
+        int n = left->count;
+        _s_relocate(left->values() + n, parent->values() + p);
+        for (int j = 0; j != right->count; ++j) {
+            _s_relocate(left->values() + n + 1 + j, right->values() + j);
+        }
+        if (!left->leaf) {
+            for (int j = 0; j <= right->count; ++j) {
+                node_type *c = right->child(j);
+                _s_child(left, n + 1 + j) = c;
+                c->parent = left;
+                c->position = n + 1 + j;
+            }
+        }
+        left->count = n + 1 + right->count;
+
+        for (int j = p + 1; j < parent->count; ++j) {
+            _s_relocate(parent->values() + j - 1, parent->values() + j);
+        }
+        for (int j = p + 1; j < parent->count; ++j) {
+            _s_child(parent, j) = parent->child(j + 1);
+            parent->child(j)->position = j;
+        }
+        --parent->count;
+
+        if (it._m_node == right) {
+            it._m_node = left;
+            it._m_position += n + 1;
+        }
+        if (rightmost == right) {
+            rightmost = left;
+        }
+        _m_free_node(right);
+    }
+}
+
+#endif
\ No newline at end of file
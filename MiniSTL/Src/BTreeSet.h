@@ -0,0 +1,569 @@
+/*
+** BTreeSet.h
+** Created by Rayn on 2026/10/17
+*/
+#ifndef _BTREE_SET_H_
+#define _BTREE_SET_H_
+
+#include "BTree.h"
+#include "Functional.h"
+
+namespace rayn {
+
+    /*
+    ** set and multiset over a B-tree instead of a red-black tree. Lookups
+    ** and scans touch far fewer cache lines, but insert and erase invalidate
+    ** all iterators, not only those to the erased element.
+    */
+    template <class T, class Compare = rayn::less<T>,
+              class Alloc = allocator<T> >
+    class btree_set {
+    public:
+        // public typedefs
+        typedef T           key_type;
+        typedef T           value_type;
+        typedef Compare     key_compare;
+        typedef Compare     value_compare;
+
+    private:
+        typedef btree<key_type, value_type, identity<value_type>,
+                      key_compare, Alloc>    _rep_type;
+
+        _rep_type   _m_tree;
+
+    public:
+        // public typedefs of iterator.
+        typedef typename _rep_type::const_pointer           pointer;
+        typedef typename _rep_type::const_pointer           const_pointer;
+        typedef typename _rep_type::const_reference         reference;
+        typedef typename _rep_type::const_reference         const_reference;
+        typedef typename _rep_type::const_iterator          iterator;
+        typedef typename _rep_type::const_iterator          const_iterator;
+        typedef typename _rep_type::const_reverse_iterator  reverse_iterator;
+        typedef typename _rep_type::const_reverse_iterator  const_reverse_iterator;
+        typedef typename _rep_type::size_type               size_type;
+        typedef typename _rep_type::difference_type         difference_type;
+        typedef Alloc                                       allocator_type;
+
+        // constructor/destructor
+        btree_set() : _m_tree() {}
+        
+        explicit
+        btree_set(const Compare& comp,
+                  const allocator_type& a = allocator_type())
+        : _m_tree(comp, a) {}
+
+        explicit
+        btree_set(const allocator_type& a) : _m_tree(Compare(), a) {}
+
+        template <typename InputIterator>
+        btree_set(InputIterator first, InputIterator last) : _m_tree()
+        {
+            _m_tree.insert_unique(first, last);
+        }
+
+        template <typename InputIterator>
+        btree_set(InputIterator first, InputIterator last, const Compare& comp,
+                  const allocator_type& a = allocator_type())
+        : _m_tree(comp, a)
+        {
+            _m_tree.insert_unique(first, last);
+        }
+
+        btree_set(const btree_set& s) : _m_tree(s._m_tree) {}
+
+        btree_set(btree_set&& s) : _m_tree(rayn::move(s._m_tree)) {}
+
+        btree_set& operator=(const btree_set& s) {
+            _m_tree = s._m_tree;
+            return *this;
+        }
+
+        // Iterators
+        iterator
+        begin()
+        { return _m_tree.begin(); }
+
+        const_iterator
+        begin() const
+        { return _m_tree.begin(); }
+
+        iterator
+        end()
+        { return _m_tree.end(); }
+
+        const_iterator
+        end() const
+        { return _m_tree.end(); }
+
+        reverse_iterator
+        rbegin()
+        { return _m_tree.rbegin(); }
+
+        const_reverse_iterator
+        rbegin() const
+        { return _m_tree.rbegin(); }
+
+        reverse_iterator
+        rend()
+        { return _m_tree.rend(); }
+
+        const_reverse_iterator
+        rend() const
+        { return _m_tree.rend(); }
+
+        const_iterator
+        cbegin() const
+        { return _m_tree.begin(); }
+
+        const_iterator
+        cend() const
+        { return _m_tree.end(); }
+
+        const_reverse_iterator
+        crbegin() const
+        { return _m_tree.rbegin(); }
+
+        const_reverse_iterator
+        crend() const
+        { return _m_tree.rend(); }
+
+        // Capacity
+        bool        empty() const       { return _m_tree.empty(); }
+        size_type   size() const        { return _m_tree.size(); }
+        size_type   max_size() const    { return _m_tree.max_size(); }
+
+        // Modifiers
+        pair<iterator, bool>
+        insert(const value_type& val)
+        {
+            pair<typename _rep_type::iterator, bool> ret =
+                _m_tree.insert_unique(val);
+            return pair<iterator, bool>(ret.first, ret.second);
+        }
+
+        template <class InputIterator>
+        void
+        insert(InputIterator first, InputIterator last)
+        {
+            _m_tree.insert_unique(first, last);
+        }
+
+        iterator
+        erase(const_iterator pos)
+        {
+            return _m_tree.erase(pos);
+        }
+
+        size_type
+        erase(const key_type& k)
+        {
+            return _m_tree.erase(k);
+        }
+
+        iterator
+        erase(const_iterator first, const_iterator last)
+        {
+            return _m_tree.erase(first, last);
+        }
+
+        void
+        swap(btree_set& x) { _m_tree.swap(x._m_tree); }
+
+        void
+        clear() { _m_tree.clear(); }
+
+        // Observers
+        key_compare     key_comp() const    { return _m_tree.key_comp(); }
+        value_compare   value_comp() const  { return _m_tree.key_comp(); }
+        allocator_type  get_allocator() const { return _m_tree.get_allocator(); }
+
+        // Operations
+        iterator
+        find(const key_type& k) { return _m_tree.find(k); }
+
+        const_iterator
+        find(const key_type& k) const { return _m_tree.find(k); }
+
+        size_type
+        count(const key_type& k) const
+        { return _m_tree.find(k) == _m_tree.end() ? 0 : 1; }
+
+        iterator
+        lower_bound(const key_type& k)
+        { return _m_tree.lower_bound(k); }
+
+        const_iterator
+        lower_bound(const key_type& k) const
+        { return _m_tree.lower_bound(k); }
+
+        iterator
+        upper_bound(const key_type& k)
+        { return _m_tree.upper_bound(k); }
+
+        const_iterator
+        upper_bound(const key_type& k) const
+        { return _m_tree.upper_bound(k); }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k)
+        { return _m_tree.equal_range(k); }
+
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const
+        { return _m_tree.equal_range(k); }
+
+        // friend functions
+        template <class T2, class Compare2, class Alloc2>
+        friend bool
+        operator==(const btree_set<T2, Compare2, Alloc2>&, const btree_set<T2, Compare2, Alloc2>&);
+
+        template <class T2, class Compare2, class Alloc2>
+        friend bool
+        operator<(const btree_set<T2, Compare2, Alloc2>&, const btree_set<T2, Compare2, Alloc2>&);
+    };
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator==(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return x._m_tree == y._m_tree;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator!=(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return !(x == y);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator<(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return x._m_tree < y._m_tree;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator>(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return y < x;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator<=(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return !(y < x);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator>=(const btree_set<T, Compare, Alloc>& x, const btree_set<T, Compare, Alloc>& y)
+    {
+        return !(x < y);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline void
+    swap(btree_set<T, Compare, Alloc>& x, btree_set<T, Compare, Alloc>& y)
+    {
+        x.swap(y);
+    }
+
+    template <class T, class Compare = rayn::less<T>,
+              class Alloc = allocator<T> >
+    class btree_multiset {
+    public:
+        // public typedefs
+        typedef T           key_type;
+        typedef T           value_type;
+        typedef Compare     key_compare;
+        typedef Compare     value_compare;
+
+    private:
+        typedef btree<key_type, value_type, identity<value_type>,
+            key_compare, Alloc>    _rep_type;
+
+        _rep_type   _m_tree;
+
+    public:
+        // public typedefs of iterator.
+        typedef typename _rep_type::const_pointer           pointer;
+        typedef typename _rep_type::const_pointer           const_pointer;
+        typedef typename _rep_type::const_reference         reference;
+        typedef typename _rep_type::const_reference         const_reference;
+        typedef typename _rep_type::const_iterator          iterator;
+        typedef typename _rep_type::const_iterator          const_iterator;
+        typedef typename _rep_type::const_reverse_iterator  reverse_iterator;
+        typedef typename _rep_type::const_reverse_iterator  const_reverse_iterator;
+        typedef typename _rep_type::size_type               size_type;
+        typedef typename _rep_type::difference_type         difference_type;
+        typedef Alloc                                       allocator_type;
+
+        // constructor/destructor
+        btree_multiset() : _m_tree() {}
+
+        explicit
+        btree_multiset(const Compare& comp,
+                       const allocator_type& a = allocator_type())
+        : _m_tree(comp, a) {}
+
+        explicit
+        btree_multiset(const allocator_type& a) : _m_tree(Compare(), a) {}
+
+        template <typename InputIterator>
+        btree_multiset(InputIterator first, InputIterator last) : _m_tree()
+        {
+            _m_tree.insert_equal(first, last);
+        }
+
+        template <typename InputIterator>
+        btree_multiset(InputIterator first, InputIterator last, const Compare& comp,
+                       const allocator_type& a = allocator_type())
+        : _m_tree(comp, a)
+        {
+            _m_tree.insert_equal(first, last);
+        }
+
+        btree_multiset(const btree_multiset& s) : _m_tree(s._m_tree) {}
+
+        btree_multiset(btree_multiset&& s) : _m_tree(rayn::move(s._m_tree)) {}
+
+        btree_multiset& operator=(const btree_multiset& s) {
+            _m_tree = s._m_tree;
+            return *this;
+        }
+
+        // Iterators
+        iterator
+        begin()
+        {
+            return _m_tree.begin();
+        }
+
+        const_iterator
+        begin() const
+        {
+            return _m_tree.begin();
+        }
+
+        iterator
+        end()
+        {
+            return _m_tree.end();
+        }
+
+        const_iterator
+        end() const
+        {
+            return _m_tree.end();
+        }
+
+        reverse_iterator
+        rbegin()
+        {
+            return _m_tree.rbegin();
+        }
+
+        const_reverse_iterator
+        rbegin() const
+        {
+            return _m_tree.rbegin();
+        }
+
+        reverse_iterator
+        rend()
+        {
+            return _m_tree.rend();
+        }
+
+        const_reverse_iterator
+        rend() const
+        {
+            return _m_tree.rend();
+        }
+
+        const_iterator
+        cbegin() const
+        {
+            return _m_tree.begin();
+        }
+
+        const_iterator
+        cend() const
+        {
+            return _m_tree.end();
+        }
+
+        const_reverse_iterator
+        crbegin() const
+        {
+            return _m_tree.rbegin();
+        }
+
+        const_reverse_iterator
+        crend() const
+        {
+            return _m_tree.rend();
+        }
+
+        // Capacity
+        bool        empty() const       { return _m_tree.empty(); }
+        size_type   size() const        { return _m_tree.size(); }
+        size_type   max_size() const    { return _m_tree.max_size(); }
+
+        // Modifiers
+        iterator
+        insert(const value_type& val)
+        {
+            return _m_tree.insert_equal(val);
+        }
+
+        template <class InputIterator>
+        void
+        insert(InputIterator first, InputIterator last)
+        {
+            _m_tree.insert_equal(first, last);
+        }
+
+        iterator
+        erase(const_iterator pos)
+        {
+            return _m_tree.erase(pos);
+        }
+
+        size_type
+        erase(const key_type& k)
+        {
+            return _m_tree.erase(k);
+        }
+
+        iterator
+        erase(const_iterator first, const_iterator last)
+        {
+            return _m_tree.erase(first, last);
+        }
+
+        void
+        swap(btree_multiset& x) { _m_tree.swap(x._m_tree); }
+
+        void
+        clear() { _m_tree.clear(); }
+
+        // Observers
+        key_compare     key_comp() const    { return _m_tree.key_comp(); }
+        value_compare   value_comp() const  { return _m_tree.key_comp(); }
+        allocator_type  get_allocator() const { return _m_tree.get_allocator(); }
+
+        // Operations
+        iterator
+        find(const key_type& k) { return _m_tree.find(k); }
+
+        const_iterator
+        find(const key_type& k) const { return _m_tree.find(k); }
+
+        size_type
+        count(const key_type& k) const
+        {
+            return _m_tree.count(k);
+        }
+
+        iterator
+        lower_bound(const key_type& k)
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        const_iterator
+        lower_bound(const key_type& k) const
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        iterator
+        upper_bound(const key_type& k)
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        const_iterator
+        upper_bound(const key_type& k) const
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k)
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        // friend functions
+        template <class T2, class Compare2, class Alloc2>
+        friend bool
+        operator==(const btree_multiset<T2, Compare2, Alloc2>&, const btree_multiset<T2, Compare2, Alloc2>&);
+
+        template <class T2, class Compare2, class Alloc2>
+        friend bool
+        operator<(const btree_multiset<T2, Compare2, Alloc2>&, const btree_multiset<T2, Compare2, Alloc2>&);
+    };
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator==(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return x._m_tree == y._m_tree;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator!=(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return !(x == y);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator<(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return x._m_tree < y._m_tree;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator>(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return y < x;
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator<=(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return !(y < x);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline bool
+    operator>=(const btree_multiset<T, Compare, Alloc>& x, const btree_multiset<T, Compare, Alloc>& y)
+    {
+        return !(x < y);
+    }
+
+    template <class T, class Compare, class Alloc>
+    inline void
+    swap(btree_multiset<T, Compare, Alloc>& x, btree_multiset<T, Compare, Alloc>& y)
+    {
+        x.swap(y);
+    }
+}
+
+#endif
\ No newline at end of file
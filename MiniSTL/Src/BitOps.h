@@ -0,0 +1,36 @@
+/*
+** BitOps.h
+** Created by Rayn on 2026/10/17
+** bit scan helpers shared by the SIMD search and hash table code
+*/
+#ifndef _BIT_OPS_H_
+#define _BIT_OPS_H_
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace rayn {
+
+    // Index of the lowest / highest set bit, mask must not be 0.
+    inline unsigned _lowest_bit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+    inline unsigned _highest_bit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return index;
+#else
+        return 31 - __builtin_clz(mask);
+#endif
+    }
+}
+
+#endif
\ No newline at end of file
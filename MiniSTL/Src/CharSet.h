@@ -0,0 +1,181 @@
+/*
+** CharSet.h
+** Created by Rayn on 2026/10/17
+** character set matcher shared by the find_first_of family of basic_string
+*/
+#ifndef _CHAR_SET_H_
+#define _CHAR_SET_H_
+
+#include "Searcher.h"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define RAYN_CHAR_SET_AVX2
+#include <immintrin.h>
+#elif defined(__SSSE3__) || defined(__AVX__)
+#define RAYN_CHAR_SET_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace rayn {
+
+    inline size_t _char_code(char ch) {
+        return static_cast<unsigned char>(ch);
+    }
+    template <class CharT>
+    inline size_t _char_code(CharT ch) {
+        return static_cast<size_t>(ch);
+    }
+
+    /*
+    ** Nibble tables of a byte set: byte c is in the set iff bit (c >> 4) & 7 of
+    ** rows[c >> 7][c & 15] is set. pshufb looks both tables up for 16 (SSSE3)
+    ** or 32 (AVX2) bytes at once.
+    */
+    typedef unsigned char _char_set_rows[2][16];
+
+#if defined(RAYN_CHAR_SET_AVX2)
+    enum ECharSetBlock{ CHAR_SET_BLOCK = 32 };
+
+    inline unsigned _char_set_match(const char *p, const _char_set_rows& rows) {
+        const __m256i mask0f = _mm256_set1_epi8(0x0F);
+        const __m256i rows0 = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[0])));
+        const __m256i rows1 = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[1])));
+        const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                              1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i lo = _mm256_and_si256(v, mask0f);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask0f);
+        __m256i upper = _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7));
+        __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(rows0, lo), _mm256_shuffle_epi8(rows1, lo), upper);
+        __m256i bit = _mm256_shuffle_epi8(bits, hi);
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+    }
+#elif defined(RAYN_CHAR_SET_SSSE3)
+    enum ECharSetBlock{ CHAR_SET_BLOCK = 16 };
+
+    inline unsigned _char_set_match(const char *p, const _char_set_rows& rows) {
+        const __m128i mask0f = _mm_set1_epi8(0x0F);
+        const __m128i rows0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[0]));
+        const __m128i rows1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[1]));
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i lo = _mm_and_si128(v, mask0f);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask0f);
+        __m128i upper = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+        __m128i row = _mm_or_si128(_mm_and_si128(upper, _mm_shuffle_epi8(rows1, lo)),
+                                   _mm_andnot_si128(upper, _mm_shuffle_epi8(rows0, lo)));
+        __m128i bit = _mm_shuffle_epi8(bits, hi);
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)));
+    }
+#endif
+
+    /*
+    ** @brief   Skip the leading blocks of [first, last) that hold no character
+    **          whose membership is @c in.
+    ** @return  Where the scalar scan goes on, the hit itself if one was found.
+    */
+    template <class CharT>
+    inline const CharT *_char_set_skip(const CharT *first, const CharT *, const _char_set_rows&, bool) {
+        return first;
+    }
+    /*
+    ** @brief   The same as _char_set_skip, from the back.
+    ** @return  The new end of the range, one past the hit if one was found.
+    */
+    template <class CharT>
+    inline const CharT *_char_set_skip_backward(const CharT *, const CharT *last, const _char_set_rows&, bool) {
+        return last;
+    }
+#ifdef CHAR_SET_BLOCK
+    inline const char *_char_set_skip(const char *first, const char *last, const _char_set_rows& rows, bool in) {
+        const unsigned flip = in ? 0 : static_cast<unsigned>((1ULL << CHAR_SET_BLOCK) - 1);
+        for (; last - first >= CHAR_SET_BLOCK; first += CHAR_SET_BLOCK) {
+            unsigned mask = _char_set_match(first, rows) ^ flip;
+            if (mask != 0) {
+                return first + _lowest_bit(mask);
+            }
+        }
+        return first;
+    }
+    inline const char *_char_set_skip_backward(const char *first, const char *last,
+                                               const _char_set_rows& rows, bool in) {
+        const unsigned flip = in ? 0 : static_cast<unsigned>((1ULL << CHAR_SET_BLOCK) - 1);
+        for (; last - first >= CHAR_SET_BLOCK; last -= CHAR_SET_BLOCK) {
+            unsigned mask = _char_set_match(last - CHAR_SET_BLOCK, rows) ^ flip;
+            if (mask != 0) {
+                return last - CHAR_SET_BLOCK + _highest_bit(mask) + 1;
+            }
+        }
+        return last;
+    }
+#endif
+
+    /*
+    ** A set of characters for the find_first_of family. Characters below 256
+    ** are kept in a bitmap (and nibble tables for the SIMD scan of char),
+    ** wider ones are looked up in the original range, which must outlive
+    ** the set.
+    */
+    template <class CharT>
+    class char_set {
+    public:
+        char_set(const CharT *first, const CharT *last) : _first(first), _last(last), _wide(false) {
+            memset(_bits, 0, sizeof(_bits));
+            memset(_rows, 0, sizeof(_rows));
+            for (; first != last; ++first) {
+                size_t c = _char_code(*first);
+                if (c >= 256) {
+                    _wide = true;
+                    continue;
+                }
+                _bits[c >> 3] |= static_cast<unsigned char>(1 << (c & 7));
+                _rows[c >> 7][c & 15] |= static_cast<unsigned char>(1 << ((c >> 4) & 7));
+            }
+        }
+
+        bool contains(CharT ch) const {
+            size_t c = _char_code(ch);
+            if (c < 256) {
+                return ((_bits[c >> 3] >> (c & 7)) & 1) != 0;
+            }
+            return _wide && _find_char(_first, _last, ch) != _last;
+        }
+
+        /*
+        ** @brief   Find the first character in [first, last) whose membership is @c in.
+        ** @return  Pointer to it, or last if there is none.
+        */
+        const CharT *find_first(const CharT *first, const CharT *last, bool in) const {
+            for (first = _char_set_skip(first, last, _rows, in); first != last; ++first) {
+                if (contains(*first) == in) {
+                    return first;
+                }
+            }
+            return last;
+        }
+        /*
+        ** @brief   Find the last character in [first, last) whose membership is @c in.
+        ** @return  Pointer to it, or last if there is none.
+        */
+        const CharT *find_last(const CharT *first, const CharT *last, bool in) const {
+            for (const CharT *cur = _char_set_skip_backward(first, last, _rows, in); cur != first; ) {
+                if (contains(*--cur) == in) {
+                    return cur;
+                }
+            }
+            return last;
+        }
+
+    private:
+        const CharT        *_first;
+        const CharT        *_last;
+        bool                _wide;      // some characters are not below 256
+        unsigned char       _bits[32];
+        _char_set_rows      _rows;
+    };
+}
+
+#endif
\ No newline at end of file
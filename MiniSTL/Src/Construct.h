@@ -7,6 +7,7 @@
 
 #include <new>  // for placement new
 #include "TypeTraits.h"
+#include "Move.h"
 
 namespace rayn {
 
@@ -18,6 +19,10 @@ namespace rayn {
     inline void construct(T1* ptr, const T2& value) {
         new(ptr) T1(value);  //  T1::T1(value)
     }
+    template<class T, class... Args>
+    inline void construct(T* ptr, Args&&... args) {
+        new(ptr) T(rayn::forward<Args>(args)...);  //  T::T(args...), ֵʵλᱻƶ
+    }
 
     /*
     ** destroy() һ汾һָ
@@ -5,12 +5,14 @@
 #ifndef _DEQUE_H_
 #define _DEQUE_H_
 
+#include <cstring>
 #include <stdexcept>
 
 #include "Allocator.h"
 #include "Uninitialized.h"
 #include "TypeTraits.h"
 #include "Iterator.h"
+#include "Move.h"
 #include "ReverseIterator.h"
 
 namespace rayn {
@@ -131,7 +133,7 @@ namespace rayn {
                 + (cur - first) + (other.last - other.cur);
         }
 
-        reference operator[] (difference_type n) const { return *(*this + n) }
+        reference operator[] (difference_type n) const { return *(*this + n); }
         bool operator== (const self& other) const {
             return cur == other.cur;
         }
@@ -146,7 +148,7 @@ namespace rayn {
         }
     };
 
-    template <class T, size_t BufSize = 0>
+    template <class T, class Alloc = allocator<T>, size_t BufSize = 0>
     class deque {
     public:
         typedef T           value_type;
@@ -156,6 +158,7 @@ namespace rayn {
         typedef const T*    const_pointer;
         typedef const T&    const_reference;
         typedef size_t      size_type;
+        typedef Alloc       allocator_type;
         typedef __deque_iterator<T, reference, pointer, BufSize>                iterator;
         typedef __deque_iterator<T, const_reference, const_pointer, BufSize>    const_iterator;
         typedef reverse_iterator_t<iterator>                                    reverse_iterator;
@@ -164,8 +167,8 @@ namespace rayn {
     protected:
         // pointer of pointer of T
         typedef pointer*                map_pointer;
-        typedef allocator<value_type>   data_allocator;
-        typedef allocator<pointer>      map_allocator;
+        typedef typename Alloc::template rebind<value_type>::other  data_allocator;
+        typedef typename Alloc::template rebind<pointer>::other     map_allocator;
         enum { __initial_map_size = 8 };
 
     protected:
@@ -174,33 +177,47 @@ namespace rayn {
         iterator    _finish;    //β
         map_pointer map;        //ָmap, mapǿռ,ÿԪһָ,ָһ黺
         size_type   map_size;   //mapڿɶָ
+        data_allocator  data_alloc; //ķ
+        map_allocator   map_alloc;  //mapķ, data_allocͬһallocator
     
     public:
         // Default Contructor
-        deque() : _start(), _finish(), map(0), map_size(0) {}
+        deque() : _start(), _finish(), map(0), map_size(0) {
+            this->initialize_map(0);
+        }
+        // Constructs an empty container with the given allocator.
+        explicit deque(const allocator_type& a)
+            : _start(), _finish(), map(0), map_size(0), data_alloc(a), map_alloc(a) {
+            this->initialize_map(0);
+        }
         // Constructor with count copies of elements.
         explicit deque(size_type count) {
             this->fill_initialize(count, value_type());
         }
         // Constructor with count copies of elements with value value.
-        deque(size_type count, const value_type& value) {
+        deque(size_type count, const value_type& value,
+              const allocator_type& a = allocator_type()) : data_alloc(a), map_alloc(a) {
             this->fill_initialize(count, value);
         }
         // Constructor with the contents of the range [first, last).
         template <class InputIterator>
-        deque(InputIterator first, InputIterator last) {
-            this->range_initialize(first, last, iterator_category(first));
+        deque(InputIterator first, InputIterator last,
+              const allocator_type& a = allocator_type()) : data_alloc(a), map_alloc(a) {
+            typedef typename rayn::is_integral<InputIterator>::type Integer;
+            this->initialize_dispatch(first, last, Integer());
         }
-        // Copy Contructor
-        deque(const deque& other) {
+        // Copy Contructor, the copy allocates from the same allocator.
+        deque(const deque& other) : data_alloc(other.data_alloc), map_alloc(other.map_alloc) {
             this->initialize_map(other.size());
-            std::copy(other.begin(), other.end(), this->_start);
+            rayn::uninitialized_copy(other.begin(), other.end(), this->_start);
         }
         // Move Contructor
         deque(deque&& other);
         // Destructor
         ~deque() {
             rayn::destroy(this->_start, this->_finish);
+            destroy_nodes(this->_start.node, this->_finish.node + 1);
+            map_alloc.deallocate(this->map, this->map_size);
         }
 
         // Copy Assignment operator
@@ -227,13 +244,13 @@ namespace rayn {
             if (pos >= this->size()) {
                 throw std::out_of_range("out of range.");
             }
-            return _start[difference_type(n)];
+            return _start[difference_type(pos)];
         }
         const_reference at(size_type pos) const {
             if (pos >= this->size()) {
                 throw std::out_of_range("out of range.");
             }
-            return _start[difference_type(n)];
+            return _start[difference_type(pos)];
         }
 
         /*
@@ -338,6 +355,9 @@ namespace rayn {
         void resize(size_type count, const value_type& value);
         // Exchanges the contents of the container with those of other. 
         void swap(deque& other);
+
+        // Returns the allocator associated with the container.
+        allocator_type get_allocator() const { return allocator_type(data_alloc); }
     
     private:
         //private member and method
@@ -347,6 +367,14 @@ namespace rayn {
         void create_nodes(map_pointer start, map_pointer finish);
         void destroy_nodes(map_pointer start, map_pointer finish);
         void fill_initialize(size_type count, const value_type& value);
+        template <class Integer>
+        void initialize_dispatch(Integer count, Integer value, rayn::true_type) {
+            this->fill_initialize(static_cast<size_type>(count), value);
+        }
+        template <class InputIterator>
+        void initialize_dispatch(InputIterator first, InputIterator last, rayn::false_type) {
+            this->range_initialize(first, last, iterator_category(first));
+        }
         template <class InputIterator>
         void range_initialize(InputIterator first, InputIterator last, const input_iterator_tag&);
         template <class ForwardIterator>
@@ -354,6 +382,14 @@ namespace rayn {
         void initialize_map(size_type num_elements);
         void reallocate_map(size_type nodes_to_add, bool add_at_front);
         iterator insert_aux(iterator pos, const value_type& value);
+        iterator insert_aux(iterator pos, const value_type& value, true_type);
+        iterator insert_aux(iterator pos, const value_type& value, false_type);
+        iterator erase_aux(iterator first, iterator last, true_type);
+        iterator erase_aux(iterator first, iterator last, false_type);
+        // [first, last)λƵresultʼλãresultfirst֮ص
+        static iterator relocate_forward(iterator first, iterator last, iterator result);
+        // [first, last)λƵresultλãresultlast֮ǰص
+        static iterator relocate_backward(iterator first, iterator last, iterator result);
         iterator fill_insert_aux(iterator pos, size_type count, const value_type& value);
         template <class InputIterator>
         iterator range_insert_aux(iterator pos, InputIterator first, InputIterator last, size_type n);
@@ -371,8 +407,8 @@ namespace rayn {
         void assign_aux(ForwardIterator first, ForwardIterator last, const forward_iterator_tag&);
     };
 
-    template <class T, size_t BufSize>
-    deque<T, BufSize>& deque<T, BufSize>::operator= (const deque<T, BufSize>& other) {
+    template <class T, class Alloc, size_t BufSize>
+    deque<T, Alloc, BufSize>& deque<T, Alloc, BufSize>::operator= (const deque<T, Alloc, BufSize>& other) {
         const size_type len = size();
         if (&other != this) {
             if (len >= other.size()) {
@@ -386,8 +422,8 @@ namespace rayn {
         return *this;
     }
 
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::assign(size_type count, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::assign(size_type count, const value_type& value) {
         if (count > size()) {
             rayn::fill(begin(), end(), value);
             insert(end(), count - size(), value);
@@ -396,25 +432,25 @@ namespace rayn {
             rayn::fill(begin(), end(), value);
         }
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template <class InputIterator>
-    void deque<T, BufSize>::assign(InputIterator first, InputIterator last) {
+    void deque<T, Alloc, BufSize>::assign(InputIterator first, InputIterator last) {
         assign_aux(first, last, iterator_category(first));
     }
 
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::clear() {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::clear() {
         // ͷβнڵ
         for (map_pointer node = _start.node + 1; node < _finish.node; ++node) {
             rayn::destroy(*node, *node + buffer_size());
-            data_allocator::deallocate(*node, buffer_size());
+            data_alloc.deallocate(*node, buffer_size());
         }
         if (_start.node != _finish.node) {
             //ͷβڵ
             rayn::destroy(_start.cur, _start.last);
             rayn::destroy(_finish.cur, _finish.last);
             // ͷ
-            data_allocator::deallocate(_finish.first, buffer_size());
+            data_alloc.deallocate(_finish.first, buffer_size());
         } else {
             //ͷβһڵ
             rayn::destroy(_start.cur, _start.last);
@@ -422,9 +458,9 @@ namespace rayn {
         _finish = _start;
     }
 
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::insert(iterator pos, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert(iterator pos, const value_type& value) {
         if (pos.cur == _start.cur) {
             push_front(value);
             return _start;
@@ -436,9 +472,9 @@ namespace rayn {
             return insert_aux(pos, value);
         }
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::insert(iterator pos, size_type count, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert(iterator pos, size_type count, const value_type& value) {
         if (pos.cur == _start.cur) {
             iterator new_start = reserve_elements_at_front(count);
             try {
@@ -448,7 +484,7 @@ namespace rayn {
                 destroy_nodes(new_start.node, _start.node);
             }
             return _start;
-        } else if (pos.cur = _finish.cur) {
+        } else if (pos.cur == _finish.cur) {
             iterator new_finish = reserve_elements_at_back(count);
             iterator old_finish = _finish;
             try {
@@ -462,10 +498,10 @@ namespace rayn {
             return fill_insert_aux(pos, count, value);
         }
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template <class InputIterator>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::insert(iterator pos, InputIterator first, InputIterator last) {
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert(iterator pos, InputIterator first, InputIterator last) {
         size_type n = rayn::distance(first, last);
         if (pos.cur == _start.cur) {
             iterator new_start = reserve_elements_at_front(n);
@@ -491,53 +527,66 @@ namespace rayn {
         }
     }
 
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::erase(iterator pos) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::erase(iterator pos) {
         iterator next = pos;
         ++next;
-        difference_type index = pos - _start;
-        if (index < (size() >> 1)) {
-            copy_backward(_start, pos, next);
-            pop_front();
-        } else {
-            copy(next, _finish, pos);
-            pop_back();
-        }
-        return _start + index;
+        return erase(pos, next);
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::erase(iterator first, iterator last) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::erase(iterator first, iterator last) {
         if (first == _start && last == _finish) {
             clear();
             return _finish;
         } else {
-            difference_type n = last - first;
-            difference_type elems_before = first - _start;
-            if (elems_before < ((size() - n) >> 1)) {
-                copy_backward(_start, first, last);
-                iterator new_start = _start + n;
-                rayn::destroy(_start, new_start);
-                for (map_pointer node = _start.node; node < new_start.node; ++node) {
-                    data_allocator::deallocate(*node, buffer_size());
-                }
-                _start = new_start;
-            } else {
-                copy(last, _finish, first);
-                iterator new_finish = _finish - n;
-                destroy(new_finish, _finish);
-                for (map_pointer node = new_finish.node + 1; node <= _finish.node; ++node) {
-                    data_allocator::deallocate(*node, buffer_size());
-                }
-                _finish = new_finish;
-            }
-            return _start + elems_before;
+            return erase_aux(first, last, typename is_trivially_relocatable<T>::type());
+        }
+    }
+    // ɰλƵɾԪأٰѽ϶̵һΰƹ
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::erase_aux(iterator first, iterator last, true_type) {
+        difference_type n = last - first;
+        difference_type elems_before = first - _start;
+        rayn::destroy(first, last);
+        if (elems_before < difference_type((size() - n) >> 1)) {
+            relocate_backward(_start, first, last);
+            iterator new_start = _start + n;
+            destroy_nodes(_start.node, new_start.node);
+            _start = new_start;
+        } else {
+            relocate_forward(last, _finish, first);
+            iterator new_finish = _finish - n;
+            destroy_nodes(new_finish.node + 1, _finish.node + 1);
+            _finish = new_finish;
+        }
+        return _start + elems_before;
+    }
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::erase_aux(iterator first, iterator last, false_type) {
+        difference_type n = last - first;
+        difference_type elems_before = first - _start;
+        if (elems_before < difference_type((size() - n) >> 1)) {
+            copy_backward(_start, first, last);
+            iterator new_start = _start + n;
+            rayn::destroy(_start, new_start);
+            destroy_nodes(_start.node, new_start.node);
+            _start = new_start;
+        } else {
+            copy(last, _finish, first);
+            iterator new_finish = _finish - n;
+            rayn::destroy(new_finish, _finish);
+            destroy_nodes(new_finish.node + 1, _finish.node + 1);
+            _finish = new_finish;
         }
+        return _start + elems_before;
     }
 
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::push_back(const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::push_back(const value_type& value) {
         if (_finish.cur != _finish.last - 1) {
             rayn::construct(_finish.cur, value);
             ++_finish.cur;
@@ -545,8 +594,8 @@ namespace rayn {
             push_back_aux(value);
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::pop_back() {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::pop_back() {
         if (_finish.cur != _finish.first) {
             --_finish.cur;
             rayn::destroy(_finish.cur);
@@ -554,8 +603,8 @@ namespace rayn {
             pop_back_aux();
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::push_front(const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::push_front(const value_type& value) {
         if (_start.cur != _start.first) {
             rayn::construct(_start.cur - 1, value);
             --_start.cur;
@@ -563,61 +612,63 @@ namespace rayn {
             push_front_aux(value);
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::pop_front() {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::pop_front() {
         if (_start.cur != _start.last - 1) {
             rayn::destroy(_start.cur);
-            ++_finish.cur;
+            ++_start.cur;
         } else {
             pop_front_aux();
         }
     }
 
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::swap(deque& other) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::swap(deque& other) {
         rayn::swap(this->_start, other._start);
         rayn::swap(this->_finish, other._finish);
         rayn::swap(this->map_size, other.map_size);
         rayn::swap(this->map, other.map);
+        rayn::swap(this->data_alloc, other.data_alloc);
+        rayn::swap(this->map_alloc, other.map_alloc);
     }
 
     // ********************************************************************************
     // Helper functions
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::create_nodes(map_pointer start, map_pointer finish) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::create_nodes(map_pointer start, map_pointer finish) {
         map_pointer cur = start;
         try {
             for (; cur != finish; ++cur) {
-                *cur = data_allocator::allocate(buffer_size());
+                *cur = data_alloc.allocate(buffer_size());
             }
         } catch (...) {
             destroy_nodes(start, cur);
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::destroy_nodes(map_pointer start, map_pointer finish) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::destroy_nodes(map_pointer start, map_pointer finish) {
         for (map_pointer cur = start; cur != finish; ++cur) {
-            data_allocator::deallocate(*cur, buffer_size());
+            data_alloc.deallocate(*cur, buffer_size());
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::fill_initialize(size_type count, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::fill_initialize(size_type count, const value_type& value) {
         initialize_map(count);
         map_pointer cur = _start.node;
         try {
-            for (_start.node; cur != _finish.node; ++cur) {
+            for (; cur != _finish.node; ++cur) {
                 rayn::uninitialized_fill(*cur, *cur + buffer_size(), value);
             }
-            uninitialized_fill(_finish.first + _finish.cur, value);
+            rayn::uninitialized_fill(_finish.first, _finish.cur, value);
         } catch (...) {
             for (map_pointer mp = _start.node; mp != cur; ++mp) {
-                data_allocator::destroy(*mp, *mp + buffer_size());
+                rayn::destroy(*mp, *mp + buffer_size());
             }
         }
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template <class InputIterator>
-    void deque<T, BufSize>::range_initialize(InputIterator first, InputIterator last,
+    void deque<T, Alloc, BufSize>::range_initialize(InputIterator first, InputIterator last,
         const input_iterator_tag&) {
         this->initialize_map(0);
         try {
@@ -628,15 +679,15 @@ namespace rayn {
             this->clear();
         }
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template <class ForwardIterator>
-    void deque<T, BufSize>::range_initialize(ForwardIterator first, ForwardIterator last,
+    void deque<T, Alloc, BufSize>::range_initialize(ForwardIterator first, ForwardIterator last,
         const forward_iterator_tag&) {
         size_type n = distance(first, last);
         this->initialize_map(n);
         map_pointer cur_node = this->_start.node;
         try {
-            for (cur_node < this->_finish.node; ++cur_node) {
+            for (; cur_node < this->_finish.node; ++cur_node) {
                 ForwardIterator mid = first;
                 rayn::advance(mid, buffer_size());
                 rayn::uninitialized_copy(first, mid, *cur_node);
@@ -647,19 +698,19 @@ namespace rayn {
             rayn::destroy(this->_start, iterator(*cur_node, cur_node));
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::initialize_map(size_type num_elements) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::initialize_map(size_type num_elements) {
         size_type num_nodes = num_elements / buffer_size() + 1;
         // ڵ + 2 ǰԤһ
         map_size = max(size_type(__initial_map_size), num_nodes + 2);
-        map = map_allocator::allocate(map_size);
+        map = map_alloc.allocate(map_size);
 
         map_pointer nstart = map + (map_size - num_nodes) / 2;
         map_pointer nfinish = nstart + num_nodes;
         try {
             create_nodes(nstart, nfinish);
         } catch (...) {
-            map_allocator::deallocate(this->map, this->map_size);
+            map_alloc.deallocate(this->map, this->map_size);
             this->map = 0;
             this->map_size = 0;
         }
@@ -668,35 +719,57 @@ namespace rayn {
         _start.cur = _start.first;
         _finish.cur = _finish.first + num_elements % buffer_size();
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::reallocate_map(size_type nodes_to_add, bool add_at_front) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::reallocate_map(size_type nodes_to_add, bool add_at_front) {
         size_type old_nums_nodes = _finish.node - _start.node + 1;
         size_type new_nums_nodes = old_nums_nodes + nodes_to_add;
         map_pointer new_start;
         if (map_size > 2 * new_nums_nodes) {
             new_start = map + (map_size - new_nums_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
-            if (new_start < _start.node) {
-                // copy warning: if result in range [first, last) and they are in the 
-                // same one container, an error occurred.
-                copy(_start.node, _finish.node + 1, new_start);
-            } else {
-                copy_backward(_start.node, _finish.node + 1, new_start + old_nums_nodes);
-            }
+            // ڵָ԰λƣmemmoveͬʱǰƵص
+            memmove(new_start, _start.node, old_nums_nodes * sizeof(*new_start));
         } else {
             size_type new_map_size = map_size + max(map_size, nodes_to_add) + 2;
-            map_pointer new_map = map_allocator::allocate(new_map_size);
+            map_pointer new_map = map_alloc.allocate(new_map_size);
             new_start = new_map + (new_map_size - new_nums_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
-            copy(_start.node, _finish.node + 1, new_start);
-            map_allocator::deallocate(map, map_size);
+            memcpy(new_start, _start.node, old_nums_nodes * sizeof(*new_start));
+            map_alloc.deallocate(map, map_size);
             map = new_map;
             map_size = new_map_size;
         }
         _start.set_node(new_start);
         _finish.set_node(new_start + old_nums_nodes - 1);
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator 
-        deque<T, BufSize>::insert_aux(iterator pos, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert_aux(iterator pos, const value_type& value) {
+        return insert_aux(pos, value, typename is_trivially_relocatable<T>::type());
+    }
+    // ɰλƵڽ϶̵һڳһλãΰƺڿλϹԪ
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert_aux(iterator pos, const value_type& value, true_type) {
+        difference_type index = pos - _start;
+        value_type v_copy = value;
+        if (index < difference_type(size() / 2)) {
+            iterator new_start = reserve_elements_at_front(1);
+            // mapԭȵposѾʧЧ±¶λ
+            pos = _start + index;
+            relocate_forward(_start, pos, new_start);
+            _start = new_start;
+        } else {
+            iterator new_finish = reserve_elements_at_back(1);
+            pos = _start + index;
+            relocate_backward(pos, _finish, new_finish);
+            _finish = new_finish;
+        }
+        pos = _start + index;
+        rayn::construct(&*pos, rayn::move(v_copy));
+        return pos;
+    }
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::insert_aux(iterator pos, const value_type& value, false_type) {
         difference_type index = pos - _start;
         value_type v_copy = value;
         if (index < (size() / 2)) {
@@ -721,14 +794,50 @@ namespace rayn {
         *pos = v_copy;
         return pos;
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::fill_insert_aux(iterator pos, size_type count, const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::relocate_forward(iterator first, iterator last, iterator result) {
+        difference_type n = last - first;
+        while (n > 0) {
+            // ÿΰԴĿĶͬһڵһ
+            difference_type len = min(n, min(first.last - first.cur, result.last - result.cur));
+            // ɰλƵͣתvoid*ƿ-Wclass-memaccess
+            memmove(static_cast<void *>(result.cur), static_cast<const void *>(first.cur), len * sizeof(T));
+            first += len;
+            result += len;
+            n -= len;
+        }
+        return result;
+    }
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::relocate_backward(iterator first, iterator last, iterator result) {
+        const difference_type bufsize = difference_type(buffer_size());
+        difference_type n = last - first;
+        while (n > 0) {
+            // curڻͷʱһǰһ
+            T *src_end = last.cur != last.first ? last.cur : *(last.node - 1) + bufsize;
+            T *dst_end = result.cur != result.first ? result.cur : *(result.node - 1) + bufsize;
+            difference_type src_len = last.cur != last.first ? last.cur - last.first : bufsize;
+            difference_type dst_len = result.cur != result.first ? result.cur - result.first : bufsize;
+            difference_type len = min(n, min(src_len, dst_len));
+            memmove(static_cast<void *>(dst_end - len), static_cast<const void *>(src_end - len), len * sizeof(T));
+            last -= len;
+            result -= len;
+            n -= len;
+        }
+        return result;
+    }
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::fill_insert_aux(iterator pos, size_type count, const value_type& value) {
         const difference_type elems_before = pos - _start;
         size_type length = this->size();
         value_type v_copy = value;
         if (elems_before <= difference_type(length / 2)) {
             iterator new_start = reserve_elements_at_front(count);
+            // mapԭȵposѾʧЧ±¶λ
+            pos = _start + elems_before;
             iterator old_start = _start;
             try {
                 if (elems_before >= difference_type(count)) {
@@ -749,6 +858,7 @@ namespace rayn {
             }
         } else {
             iterator new_finish = reserve_elements_at_back(count);
+            pos = _start + elems_before;
             iterator old_finish = _finish;
             const difference_type elems_after = 
                 difference_type(length) - elems_before;
@@ -770,14 +880,16 @@ namespace rayn {
         }
         return pos;
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template <class InputIterator>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::range_insert_aux(iterator pos, InputIterator first, InputIterator last, size_type n) {
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::range_insert_aux(iterator pos, InputIterator first, InputIterator last, size_type n) {
         const difference_type __elems_before = pos - this->_start;
         size_type __length = this->size();
         if (__elems_before <= difference_type(__length / 2)) {
             iterator __new_start = reserve_elements_at_front(n);
+            // mapԭȵposѾʧЧ±¶λ
+            pos = this->_start + __elems_before;
             iterator __old_start = this->_start;
             try {
                 if (__elems_before >= difference_type(n)) {
@@ -792,10 +904,11 @@ namespace rayn {
                     this->_start = __new_start;
                 }
             } catch (...) {
-                destroy_nodes(__new_start, _start);
+                destroy_nodes(__new_start.node, _start.node);
             }
         } else {
             iterator __new_finish = reserve_elements_at_back(n);
+            pos = this->_start + __elems_before;
             iterator __old_finish = this->_finish;
             const difference_type __elem_after = 
                 difference_type(__length) - __elems_before;
@@ -812,16 +925,16 @@ namespace rayn {
                     rayn::copy(first, last, pos);
                 }
             } catch (...) {
-                destroy_nodes(__old_finish + 1, __new_finish + 1);
+                destroy_nodes(__old_finish.node + 1, __new_finish.node + 1);
             }
         }
         return pos;
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::push_back_aux(const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::push_back_aux(const value_type& value) {
         value_type v_copy = value;
         reserve_map_at_back();
-        *(_finish.node + 1) = data_allocator::allocate(buffer_size());
+        *(_finish.node + 1) = data_alloc.allocate(buffer_size());
         try {
             rayn::construct(_finish.cur, v_copy);
             _finish.set_node(_finish.node + 1);
@@ -829,15 +942,15 @@ namespace rayn {
         } catch (...) {
             _finish.set_node(_finish.node - 1);
             _finish.cur = _finish.last - 1;
-            data_allocator::deallocate(*(_finish.node + 1), buffer_size);
+            data_alloc.deallocate(*(_finish.node + 1), buffer_size());
             throw;
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::push_front_aux(const value_type& value) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::push_front_aux(const value_type& value) {
         value_type v_copy = value;
         reserve_map_at_front();
-        *(_start.node - 1) = data_allocator::allocate(buffer_size());
+        *(_start.node - 1) = data_alloc.allocate(buffer_size());
         try {
             _start.set_node(_start.node - 1);
             _start.cur = _start.last - 1;
@@ -845,27 +958,27 @@ namespace rayn {
         } catch (...) {
             _start.set_node(_start.node + 1);
             _start.cur = _start.first;
-            data_allocator::deallocate(*(_start.node - 1), buffer_size());
+            data_alloc.deallocate(*(_start.node - 1), buffer_size());
             throw;
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::pop_back_aux() {
-        data_allocator::deallocate(_finish.first, buffer_size());
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::pop_back_aux() {
+        data_alloc.deallocate(_finish.first, buffer_size());
         _finish.set_node(_finish.node - 1);
         _finish.cur = _finish.last - 1;
         rayn::destroy(_finish.cur);
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::pop_front_aux() {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::pop_front_aux() {
         destroy(_start.cur);
-        data_allocator(_start.first, buffer_size());
+        data_alloc.deallocate(_start.first, buffer_size());
         _start.set_node(_start.node + 1);
         _start.cur = _start.first;
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::reserve_elements_at_front(size_type n) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::reserve_elements_at_front(size_type n) {
         size_type left_count = _start.cur - _start.first;
         if (n > left_count) {
             int new_elems = n - left_count;
@@ -874,19 +987,19 @@ namespace rayn {
             size_type i = 1;
             try {
                 for (; i <= new_nodes; ++i) {
-                    *(_start.node - i) = data_allocator::allocate(buffer_size());
+                    *(_start.node - i) = data_alloc.allocate(buffer_size());
                 }
             } catch (...) {
                 for (size_type j = 1; j < i; ++j) {
-                    data_allocator::deallocate(*(_start.node - j), buffer_size());
+                    data_alloc.deallocate(*(_start.node - j), buffer_size());
                 }
             }
         }
         return _start - difference_type(n);
     }
-    template <class T, size_t BufSize>
-    typename deque<T, BufSize>::iterator
-        deque<T, BufSize>::reserve_elements_at_back(size_type n) {
+    template <class T, class Alloc, size_t BufSize>
+    typename deque<T, Alloc, BufSize>::iterator
+        deque<T, Alloc, BufSize>::reserve_elements_at_back(size_type n) {
         size_type left_count = _finish.last - _finish.cur - 1;
         if (n > left_count) {
             int new_elems = n - left_count;
@@ -895,32 +1008,32 @@ namespace rayn {
             size_type i = 1;
             try {
                 for (; i <= new_nodes; ++i) {
-                    *(_finish.node + i) = data_allocator::allocate(buffer_size());
+                    *(_finish.node + i) = data_alloc.allocate(buffer_size());
                 }
             } catch (...) {
                 for (size_type j = 1; j < i; ++j) {
-                    data_allocator::deallocate(*(_finish + j), buffer_size());
+                    data_alloc.deallocate(*(_finish.node + j), buffer_size());
                 }
             }
         }
         return _finish + difference_type(n);
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::reserve_map_at_back(size_type nodes_to_add = 1) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::reserve_map_at_back(size_type nodes_to_add) {
         if (nodes_to_add + 1 > map_size - (_finish.node - map)) {
             reallocate_map(nodes_to_add, false);
         }
     }
-    template <class T, size_t BufSize>
-    void deque<T, BufSize>::reserve_map_at_front(size_type nodes_to_add = 1) {
+    template <class T, class Alloc, size_t BufSize>
+    void deque<T, Alloc, BufSize>::reserve_map_at_front(size_type nodes_to_add) {
         if (nodes_to_add > _start.node - map) {
             reallocate_map(nodes_to_add, true);
         }
     }
 
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template<class InputIterator>
-    void deque<T, BufSize>::assign_aux(InputIterator first, InputIterator last,
+    void deque<T, Alloc, BufSize>::assign_aux(InputIterator first, InputIterator last,
         const input_iterator_tag&) {
         iterator cur = begin();
         for (; first != last && cur != end(); ++cur, ++first) {
@@ -932,9 +1045,9 @@ namespace rayn {
             insert(end(), first, last);
         }
     }
-    template <class T, size_t BufSize>
+    template <class T, class Alloc, size_t BufSize>
     template<class ForwardIterator>
-    void deque<T, BufSize>::assign_aux(ForwardIterator first, ForwardIterator last,
+    void deque<T, Alloc, BufSize>::assign_aux(ForwardIterator first, ForwardIterator last,
         const forward_iterator_tag&) {
         size_type len = rayn::distance(first, last);
         if (len > size()) {
@@ -948,34 +1061,34 @@ namespace rayn {
     }
 
     // Global functions
-    template <class T>
-    inline bool operator== (const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator== (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         return lhs.size() == rhs.size()
             && rayn::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
-    template <class T>
-    inline bool operator!= (const deque<T>& lhs, const deque<T>& rhs) {
-        return !(lsh == rhs);
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator!= (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
+        return !(lhs == rhs);
     }
-    template <class T>
-    inline bool operator< (const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator< (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         return rayn::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
-    template <class T>
-    inline bool operator<= (const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator<= (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         return !(rhs < lhs);
     }
-    template <class T>
-    inline bool operator> (const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator> (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         return rhs < lhs;
     }
-    template <class T>
-    inline bool operator>= (const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline bool operator>= (const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         return !(lhs < rhs);
     }
 
-    template <class T>
-    inline void swap(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc, size_t BufSize>
+    inline void swap(const deque<T, Alloc, BufSize>& lhs, const deque<T, Alloc, BufSize>& rhs) {
         lhs.swap(rhs);
     }
 }
@@ -0,0 +1,63 @@
+/*
+** FlatBase.h
+** Created by Rayn on 2026/10/17
+** helpers shared by flat_set and flat_map
+*/
+#ifndef _FLAT_BASE_H_
+#define _FLAT_BASE_H_
+
+#include "Algorithm.h"
+#include "Vector.h"
+
+#include <cstddef>
+
+namespace rayn {
+
+    /*
+    ** @brief   Sort the keys appended after a sorted prefix.
+    ** @param   keys    keys[0, first) is sorted and unique, keys[first, last) is new.
+    ** @param   order   Receives the indices of the new keys to keep, in key
+    **                  order: the first of each group of equal keys, unless
+    **                  the prefix already has it.
+    ** @return  true if the new keys are already sorted, unique and greater
+    **          than the prefix, so nothing has to move.
+    */
+    template <class Key, class Compare>
+    bool __flat_unique_order(const Key *keys, size_t first, size_t last, Compare comp,
+                             vector<size_t>& order)
+    {
+        size_t i = first;
+        if (i != last && (first == 0 || comp(keys[first - 1], keys[i]))) {
+            for (++i; i != last && comp(keys[i - 1], keys[i]); ++i) {}
+        }
+        if (i == last) {
+            return true;
+        }
+
+        order.clear();
+        order.reserve(last - first);
+        for (i = first; i != last; ++i) {
+            order.push_back(i);
+        }
+        // ties are broken by position so the first of equal keys comes first
+        rayn::sort(order.begin(), order.end(), [keys, comp](size_t a, size_t b) {
+            return comp(keys[a], keys[b]) || (!comp(keys[b], keys[a]) && a < b);
+        });
+        vector<size_t>::iterator end = rayn::unique(order.begin(), order.end(), [keys, comp](size_t a, size_t b) {
+            return !comp(keys[a], keys[b]);
+        });
+        // drop the keys the prefix has, both are sorted so one pass is enough
+        vector<size_t>::iterator out = order.begin();
+        const Key *old = keys;
+        for (vector<size_t>::iterator it = order.begin(); it != end; ++it) {
+            old = rayn::lower_bound(old, keys + first, keys[*it], comp);
+            if (old == keys + first || comp(keys[*it], *old)) {
+                *out++ = *it;
+            }
+        }
+        order.erase(out, order.end());
+        return false;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,543 @@
+/*
+** FlatMap.h
+** Created by Rayn on 2026/10/17
+*/
+#ifndef _FLAT_MAP_H_
+#define _FLAT_MAP_H_
+
+#include "FlatBase.h"
+#include "Functional.h"
+#include "ReverseIterator.h"
+
+#include <stdexcept>
+
+namespace rayn {
+
+    // What operator-> of a flat_map iterator returns, it holds the pair of references.
+    template <class Reference>
+    struct __flat_map_arrow {
+        Reference ref;
+
+        explicit __flat_map_arrow(const Reference& r) : ref(r) {}
+        Reference *operator-> () { return &ref; }
+    };
+
+    /*
+    ** Walks the key and the value arrays together. Dereferencing gives a
+    ** pair of references into them instead of a reference to a stored pair.
+    */
+    template <class Key, class Mapped>
+    struct __flat_map_iterator {
+        typedef pair<Key, typename remove_const<Mapped>::type>  value_type;
+        typedef pair<const Key&, Mapped&>                       reference;
+        typedef __flat_map_arrow<reference>                     pointer;
+
+        typedef random_access_iterator_tag      iterator_category;
+        typedef ptrdiff_t                       difference_type;
+
+        typedef __flat_map_iterator<Key, Mapped>    self;
+
+        const Key  *_m_key;
+        Mapped     *_m_value;
+
+        __flat_map_iterator() : _m_key(0), _m_value(0) {}
+        __flat_map_iterator(const Key *k, Mapped *v) : _m_key(k), _m_value(v) {}
+        // iterator to const_iterator
+        template <class Mapped2>
+        __flat_map_iterator(const __flat_map_iterator<Key, Mapped2>& it)
+        : _m_key(it._m_key), _m_value(it._m_value) {}
+
+        reference operator* () const { return reference(*_m_key, *_m_value); }
+        pointer operator-> () const { return pointer(**this); }
+        reference operator[] (difference_type n) const { return reference(_m_key[n], _m_value[n]); }
+
+        self& operator++ () { ++_m_key; ++_m_value; return *this; }
+        self& operator-- () { --_m_key; --_m_value; return *this; }
+        self operator++ (int) { self temp = *this; ++*this; return temp; }
+        self operator-- (int) { self temp = *this; --*this; return temp; }
+        self& operator+= (difference_type n) { _m_key += n; _m_value += n; return *this; }
+        self& operator-= (difference_type n) { _m_key -= n; _m_value -= n; return *this; }
+        self operator+ (difference_type n) const { return self(_m_key + n, _m_value + n); }
+        self operator- (difference_type n) const { return self(_m_key - n, _m_value - n); }
+
+        template <class Mapped2>
+        difference_type operator- (const __flat_map_iterator<Key, Mapped2>& x) const { return _m_key - x._m_key; }
+        template <class Mapped2>
+        bool operator== (const __flat_map_iterator<Key, Mapped2>& x) const { return _m_key == x._m_key; }
+        template <class Mapped2>
+        bool operator!= (const __flat_map_iterator<Key, Mapped2>& x) const { return _m_key != x._m_key; }
+        template <class Mapped2>
+        bool operator< (const __flat_map_iterator<Key, Mapped2>& x) const { return _m_key < x._m_key; }
+    };
+
+    /*
+    ** A map kept as two sorted vectors, one of keys and one of the mapped
+    ** values, so lookups binary search an array that holds nothing but keys.
+    ** Ranges are inserted by sorting them and merging once. Inserting or
+    ** erasing one element moves the ones after it, and iterators are
+    ** invalidated by any insertion or erasure. Iterators dereference to
+    ** pair<const Key&, T&>; reverse iterators have no operator->.
+    */
+    template <class Key, class T, class Compare = rayn::less<Key>,
+              class Alloc = allocator<pair<Key, T>> >
+    class flat_map {
+    public:
+        // public typedefs
+        typedef Key                 key_type;
+        typedef T                   mapped_type;
+        typedef pair<Key, T>        value_type;
+        typedef Compare             key_compare;
+
+        class value_compare
+        : public binary_function < value_type, value_type, bool >
+        {
+            friend class flat_map<Key, T, Compare, Alloc>;
+
+        protected:
+            Compare comp;
+
+            value_compare(Compare c) : comp(c) {}
+
+        public:
+            template <class Pair1, class Pair2>
+            bool operator()(const Pair1& x, const Pair2& y) const {
+                return comp(x.first, y.first);
+            }
+        };
+
+        typedef vector<Key, typename Alloc::template rebind<Key>::other>    key_container_type;
+        typedef vector<T, typename Alloc::template rebind<T>::other>        mapped_container_type;
+
+        typedef __flat_map_iterator<Key, T>                 iterator;
+        typedef __flat_map_iterator<Key, const T>           const_iterator;
+        typedef reverse_iterator_t<iterator>                reverse_iterator;
+        typedef reverse_iterator_t<const_iterator>          const_reverse_iterator;
+        typedef typename iterator::reference                reference;
+        typedef typename const_iterator::reference          const_reference;
+        typedef typename iterator::pointer                  pointer;
+        typedef typename const_iterator::pointer            const_pointer;
+        typedef size_t                                      size_type;
+        typedef ptrdiff_t                                   difference_type;
+        typedef Alloc                                       allocator_type;
+
+    private:
+        key_container_type      _m_keys;
+        mapped_container_type   _m_values;
+        Compare                 _m_comp;
+
+    public:
+        // constructor/destructor
+        flat_map() : _m_keys(), _m_values(), _m_comp() {}
+
+        explicit
+        flat_map(const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_keys(a), _m_values(a), _m_comp(comp) {}
+
+        explicit
+        flat_map(const allocator_type& a) : _m_keys(a), _m_values(a), _m_comp() {}
+
+        template <typename InputIterator>
+        flat_map(InputIterator first, InputIterator last) : _m_keys(), _m_values(), _m_comp()
+        {
+            insert(first, last);
+        }
+
+        template <typename InputIterator>
+        flat_map(InputIterator first, InputIterator last, const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_keys(a), _m_values(a), _m_comp(comp)
+        {
+            insert(first, last);
+        }
+
+        flat_map(const flat_map& m)
+        : _m_keys(m._m_keys), _m_values(m._m_values), _m_comp(m._m_comp) {}
+
+        flat_map(flat_map&& m)
+        : _m_keys(rayn::move(m._m_keys)), _m_values(rayn::move(m._m_values)), _m_comp(m._m_comp) {}
+
+        flat_map& operator=(const flat_map& m) {
+            _m_keys = m._m_keys;
+            _m_values = m._m_values;
+            _m_comp = m._m_comp;
+            return *this;
+        }
+
+        flat_map& operator=(flat_map&& m) {
+            _m_keys = rayn::move(m._m_keys);
+            _m_values = rayn::move(m._m_values);
+            _m_comp = m._m_comp;
+            return *this;
+        }
+
+        // Iterators
+        iterator
+        begin()
+        { return iterator(_m_keys.data(), _m_values.data()); }
+
+        const_iterator
+        begin() const
+        { return const_iterator(_m_keys.data(), _m_values.data()); }
+
+        iterator
+        end()
+        { return begin() + size(); }
+
+        const_iterator
+        end() const
+        { return begin() + size(); }
+
+        reverse_iterator
+        rbegin()
+        { return reverse_iterator(end()); }
+
+        const_reverse_iterator
+        rbegin() const
+        { return const_reverse_iterator(end()); }
+
+        reverse_iterator
+        rend()
+        { return reverse_iterator(begin()); }
+
+        const_reverse_iterator
+        rend() const
+        { return const_reverse_iterator(begin()); }
+
+        const_iterator
+        cbegin() const
+        { return begin(); }
+
+        const_iterator
+        cend() const
+        { return end(); }
+
+        const_reverse_iterator
+        crbegin() const
+        { return rbegin(); }
+
+        const_reverse_iterator
+        crend() const
+        { return rend(); }
+
+        // Capacity
+        bool        empty() const       { return _m_keys.empty(); }
+        size_type   size() const        { return _m_keys.size(); }
+        size_type   max_size() const    { return size_type(-1) / (sizeof(Key) + sizeof(T)); }
+        void        reserve(size_type n){ _m_keys.reserve(n); _m_values.reserve(n); }
+        void        shrink_to_fit()     { _m_keys.shrink_to_fit(); _m_values.shrink_to_fit(); }
+
+        // the sorted keys, and the values in the same order
+        const key_container_type&
+        keys() const
+        { return _m_keys; }
+
+        const mapped_container_type&
+        values() const
+        { return _m_values; }
+
+        // Element access
+        mapped_type&
+        operator[] (const key_type& k)
+        {
+            size_type i = _m_lower_bound(k);
+            if (i == size() || _m_comp(k, _m_keys[i])) {
+                _m_insert_at(i, k, mapped_type());
+            }
+            return _m_values[i];
+        }
+
+        mapped_type&
+        at(const key_type& k)
+        {
+            size_type i = _m_find(k);
+            if (i == size()) {
+                throw std::out_of_range("flat_map::at");
+            }
+            return _m_values[i];
+        }
+
+        const mapped_type&
+        at(const key_type& k) const
+        {
+            size_type i = _m_find(k);
+            if (i == size()) {
+                throw std::out_of_range("flat_map::at");
+            }
+            return _m_values[i];
+        }
+
+        // Modifiers
+        pair<iterator, bool>
+        insert(const value_type& val)
+        {
+            size_type i = _m_lower_bound(val.first);
+            bool inserted = i == size() || _m_comp(val.first, _m_keys[i]);
+            if (inserted) {
+                _m_insert_at(i, val.first, val.second);
+            }
+            return pair<iterator, bool>(begin() + i, inserted);
+        }
+
+        pair<iterator, bool>
+        insert(value_type&& val)
+        {
+            size_type i = _m_lower_bound(val.first);
+            bool inserted = i == size() || _m_comp(val.first, _m_keys[i]);
+            if (inserted) {
+                _m_insert_at(i, rayn::move(val.first), rayn::move(val.second));
+            }
+            return pair<iterator, bool>(begin() + i, inserted);
+        }
+
+        /*
+        ** @brief   Append the range, then sort and merge it in one pass.
+        **          The first of equal keys is kept, as in map.
+        ** @complexity  O(N + MlogM) for M new elements
+        */
+        template <class InputIterator>
+        void
+        insert(InputIterator first, InputIterator last)
+        {
+            size_type old = size();
+            try {
+                for (; first != last; ++first) {
+                    _m_keys.push_back((*first).first);
+                    _m_values.push_back((*first).second);
+                }
+                _m_merge_tail(old);
+            } catch (...) {
+                _m_keys.erase(_m_keys.begin() + old, _m_keys.end());
+                if (_m_values.size() > old) {
+                    _m_values.erase(_m_values.begin() + old, _m_values.end());
+                }
+                throw;
+            }
+        }
+
+        iterator
+        erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        size_type
+        erase(const key_type& k)
+        {
+            size_type i = _m_find(k);
+            if (i == size()) {
+                return 0;
+            }
+            _m_keys.erase(_m_keys.begin() + i);
+            _m_values.erase(_m_values.begin() + i);
+            return 1;
+        }
+
+        iterator
+        erase(const_iterator first, const_iterator last)
+        {
+            size_type i = first - begin();
+            size_type j = last - begin();
+            _m_keys.erase(_m_keys.begin() + i, _m_keys.begin() + j);
+            _m_values.erase(_m_values.begin() + i, _m_values.begin() + j);
+            return begin() + i;
+        }
+
+        void
+        swap(flat_map& x)
+        {
+            _m_keys.swap(x._m_keys);
+            _m_values.swap(x._m_values);
+            rayn::swap(_m_comp, x._m_comp);
+        }
+
+        void
+        clear()
+        {
+            _m_keys.clear();
+            _m_values.clear();
+        }
+
+        // Observers
+        key_compare
+        key_comp() const
+        { return _m_comp; }
+
+        value_compare
+        value_comp() const
+        { return value_compare(_m_comp); }
+
+        allocator_type
+        get_allocator() const
+        { return allocator_type(_m_keys.get_allocator()); }
+
+        // Operations
+        iterator
+        find(const key_type& k) { return begin() + _m_find(k); }
+
+        const_iterator
+        find(const key_type& k) const { return begin() + _m_find(k); }
+
+        size_type
+        count(const key_type& k) const
+        {
+            return _m_find(k) == size() ? 0 : 1;
+        }
+
+        iterator
+        lower_bound(const key_type& k)
+        {
+            return begin() + _m_lower_bound(k);
+        }
+
+        const_iterator
+        lower_bound(const key_type& k) const
+        {
+            return begin() + _m_lower_bound(k);
+        }
+
+        iterator
+        upper_bound(const key_type& k)
+        {
+            return begin() + _m_upper_bound(k);
+        }
+
+        const_iterator
+        upper_bound(const key_type& k) const
+        {
+            return begin() + _m_upper_bound(k);
+        }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k)
+        {
+            size_type i = _m_lower_bound(k);
+            size_type j = i == size() || _m_comp(k, _m_keys[i]) ? i : i + 1;
+            return pair<iterator, iterator>(begin() + i, begin() + j);
+        }
+
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const
+        {
+            size_type i = _m_lower_bound(k);
+            size_type j = i == size() || _m_comp(k, _m_keys[i]) ? i : i + 1;
+            return pair<const_iterator, const_iterator>(begin() + i, begin() + j);
+        }
+
+    private:
+        // Searches touch the key array only.
+        size_type
+        _m_lower_bound(const key_type& k) const
+        {
+            return rayn::lower_bound(_m_keys.begin(), _m_keys.end(), k, _m_comp) - _m_keys.begin();
+        }
+
+        size_type
+        _m_upper_bound(const key_type& k) const
+        {
+            return rayn::upper_bound(_m_keys.begin(), _m_keys.end(), k, _m_comp) - _m_keys.begin();
+        }
+
+        // index of k, or size() if missing
+        size_type
+        _m_find(const key_type& k) const
+        {
+            size_type i = _m_lower_bound(k);
+            return i == size() || _m_comp(k, _m_keys[i]) ? size() : i;
+        }
+
+        template <class KeyArg, class ValueArg>
+        void
+        _m_insert_at(size_type i, KeyArg&& k, ValueArg&& v)
+        {
+            _m_keys.insert(_m_keys.begin() + i, rayn::forward<KeyArg>(k));
+            try {
+                _m_values.insert(_m_values.begin() + i, rayn::forward<ValueArg>(v));
+            } catch (...) {
+                _m_keys.erase(_m_keys.begin() + i);
+                throw;
+            }
+        }
+
+        // Merge the elements appended after position old into the sorted ones.
+        void
+        _m_merge_tail(size_type old)
+        {
+            vector<size_t> order;
+            if (__flat_unique_order(_m_keys.data(), old, _m_keys.size(), _m_comp, order)) {
+                return;
+            }
+            key_container_type keys(_m_keys.get_allocator());
+            mapped_container_type values(_m_values.get_allocator());
+            keys.reserve(old + order.size());
+            values.reserve(old + order.size());
+            size_type i = 0;
+            for (vector<size_t>::iterator it = order.begin(); it != order.end(); ++it) {
+                for (; i != old && _m_comp(_m_keys[i], _m_keys[*it]); ++i) {
+                    keys.push_back(rayn::move(_m_keys[i]));
+                    values.push_back(rayn::move(_m_values[i]));
+                }
+                keys.push_back(rayn::move(_m_keys[*it]));
+                values.push_back(rayn::move(_m_values[*it]));
+            }
+            for (; i != old; ++i) {
+                keys.push_back(rayn::move(_m_keys[i]));
+                values.push_back(rayn::move(_m_values[i]));
+            }
+            _m_keys.swap(keys);
+            _m_values.swap(values);
+        }
+    };
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline bool
+    operator==(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        return x.keys() == y.keys() && x.values() == y.values();
+    }
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline bool
+    operator!=(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        return !(x == y);
+    }
+
+    // Lexicographical, comparing keys first and then values.
+    template <class Key, class T, class Compare, class Alloc>
+    bool
+    operator<(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        size_t n = rayn::min(x.size(), y.size());
+        for (size_t i = 0; i != n; ++i) {
+            if (x.keys()[i] < y.keys()[i]) return true;
+            if (y.keys()[i] < x.keys()[i]) return false;
+            if (x.values()[i] < y.values()[i]) return true;
+            if (y.values()[i] < x.values()[i]) return false;
+        }
+        return x.size() < y.size();
+    }
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline bool
+    operator>(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        return y < x;
+    }
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline bool
+    operator<=(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        return !(y < x);
+    }
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline bool
+    operator>=(const flat_map<Key, T, Compare, Alloc>& x, const flat_map<Key, T, Compare, Alloc>& y)
+    {
+        return !(x < y);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,333 @@
+/*
+** FlatSet.h
+** Created by Rayn on 2026/10/17
+*/
+#ifndef _FLAT_SET_H_
+#define _FLAT_SET_H_
+
+#include "FlatBase.h"
+#include "Functional.h"
+#include "ReverseIterator.h"
+
+namespace rayn {
+
+    /*
+    ** A set kept as a sorted vector. Lookups are binary searches over one
+    ** contiguous array, it takes no memory besides the keys, and ranges are
+    ** inserted by sorting them and merging once. Inserting or erasing one
+    ** key moves the keys after it, and iterators are invalidated by any
+    ** insertion or erasure.
+    */
+    template <class Key, class Compare = rayn::less<Key>,
+              class Alloc = allocator<Key> >
+    class flat_set {
+    public:
+        // public typedefs
+        typedef Key                                     key_type;
+        typedef Key                                     value_type;
+        typedef Compare                                 key_compare;
+        typedef Compare                                 value_compare;
+        typedef vector<Key, Alloc>                      container_type;
+
+        typedef const value_type*                       pointer;
+        typedef const value_type*                       const_pointer;
+        typedef const value_type&                       reference;
+        typedef const value_type&                       const_reference;
+        typedef typename container_type::const_iterator iterator;
+        typedef typename container_type::const_iterator const_iterator;
+        typedef reverse_iterator_t<const_iterator>      reverse_iterator;
+        typedef reverse_iterator_t<const_iterator>      const_reverse_iterator;
+        typedef size_t                                  size_type;
+        typedef ptrdiff_t                               difference_type;
+        typedef Alloc                                   allocator_type;
+
+    private:
+        container_type  _m_keys;
+        Compare         _m_comp;
+
+    public:
+        // constructor/destructor
+        flat_set() : _m_keys(), _m_comp() {}
+
+        explicit
+        flat_set(const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_keys(a), _m_comp(comp) {}
+
+        explicit
+        flat_set(const allocator_type& a) : _m_keys(a), _m_comp() {}
+
+        template <typename InputIterator>
+        flat_set(InputIterator first, InputIterator last) : _m_keys(), _m_comp()
+        {
+            insert(first, last);
+        }
+
+        template <typename InputIterator>
+        flat_set(InputIterator first, InputIterator last, const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_keys(a), _m_comp(comp)
+        {
+            insert(first, last);
+        }
+
+        flat_set(const flat_set& s) : _m_keys(s._m_keys), _m_comp(s._m_comp) {}
+
+        flat_set(flat_set&& s) : _m_keys(rayn::move(s._m_keys)), _m_comp(s._m_comp) {}
+
+        flat_set& operator=(const flat_set& s) {
+            _m_keys = s._m_keys;
+            _m_comp = s._m_comp;
+            return *this;
+        }
+
+        flat_set& operator=(flat_set&& s) {
+            _m_keys = rayn::move(s._m_keys);
+            _m_comp = s._m_comp;
+            return *this;
+        }
+
+        // Iterators
+        iterator
+        begin() const
+        { return _m_keys.begin(); }
+
+        iterator
+        end() const
+        { return _m_keys.end(); }
+
+        reverse_iterator
+        rbegin() const
+        { return reverse_iterator(end()); }
+
+        reverse_iterator
+        rend() const
+        { return reverse_iterator(begin()); }
+
+        const_iterator
+        cbegin() const
+        { return _m_keys.begin(); }
+
+        const_iterator
+        cend() const
+        { return _m_keys.end(); }
+
+        const_reverse_iterator
+        crbegin() const
+        { return rbegin(); }
+
+        const_reverse_iterator
+        crend() const
+        { return rend(); }
+
+        // Capacity
+        bool        empty() const       { return _m_keys.empty(); }
+        size_type   size() const        { return _m_keys.size(); }
+        size_type   max_size() const    { return size_type(-1) / sizeof(Key); }
+        void        reserve(size_type n){ _m_keys.reserve(n); }
+        void        shrink_to_fit()     { _m_keys.shrink_to_fit(); }
+
+        // the sorted keys
+        const container_type&
+        keys() const
+        { return _m_keys; }
+
+        // Modifiers
+        pair<iterator, bool>
+        insert(const value_type& val)
+        {
+            return _m_insert_unique(val);
+        }
+
+        pair<iterator, bool>
+        insert(value_type&& val)
+        {
+            return _m_insert_unique(rayn::move(val));
+        }
+
+        /*
+        ** @brief   Append the range, then sort and merge it in one pass.
+        **          The first of equal keys is kept, as in set.
+        ** @complexity  O(N + MlogM) for M new keys
+        */
+        template <class InputIterator>
+        void
+        insert(InputIterator first, InputIterator last)
+        {
+            size_type old = _m_keys.size();
+            try {
+                for (; first != last; ++first) {
+                    _m_keys.push_back(*first);
+                }
+                _m_merge_tail(old);
+            } catch (...) {
+                _m_keys.erase(_m_keys.begin() + old, _m_keys.end());
+                throw;
+            }
+        }
+
+        iterator
+        erase(const_iterator pos)
+        {
+            return _m_keys.erase(_m_mutable(pos));
+        }
+
+        size_type
+        erase(const key_type& k)
+        {
+            iterator it = find(k);
+            if (it == end()) {
+                return 0;
+            }
+            erase(it);
+            return 1;
+        }
+
+        iterator
+        erase(const_iterator first, const_iterator last)
+        {
+            return _m_keys.erase(_m_mutable(first), _m_mutable(last));
+        }
+
+        void
+        swap(flat_set& x)
+        {
+            _m_keys.swap(x._m_keys);
+            rayn::swap(_m_comp, x._m_comp);
+        }
+
+        void
+        clear() { _m_keys.clear(); }
+
+        // Observers
+        key_compare
+        key_comp() const
+        { return _m_comp; }
+
+        value_compare
+        value_comp() const
+        { return _m_comp; }
+
+        allocator_type
+        get_allocator() const
+        { return _m_keys.get_allocator(); }
+
+        // Operations
+        iterator
+        find(const key_type& k) const
+        {
+            iterator it = lower_bound(k);
+            return it == end() || _m_comp(k, *it) ? end() : it;
+        }
+
+        size_type
+        count(const key_type& k) const
+        {
+            return find(k) == end() ? 0 : 1;
+        }
+
+        iterator
+        lower_bound(const key_type& k) const
+        {
+            return rayn::lower_bound(begin(), end(), k, _m_comp);
+        }
+
+        iterator
+        upper_bound(const key_type& k) const
+        {
+            return rayn::upper_bound(begin(), end(), k, _m_comp);
+        }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k) const
+        {
+            iterator it = lower_bound(k);
+            return pair<iterator, iterator>(it, it == end() || _m_comp(k, *it) ? it : it + 1);
+        }
+
+    private:
+        typename container_type::iterator
+        _m_mutable(const_iterator it)
+        {
+            return _m_keys.begin() + (it - _m_keys.begin());
+        }
+
+        template <class Arg>
+        pair<iterator, bool>
+        _m_insert_unique(Arg&& val)
+        {
+            iterator it = lower_bound(val);
+            if (it != end() && !_m_comp(val, *it)) {
+                return pair<iterator, bool>(it, false);
+            }
+            return pair<iterator, bool>(_m_keys.insert(_m_mutable(it), rayn::forward<Arg>(val)), true);
+        }
+
+        // Merge the keys appended after position old into the sorted ones.
+        void
+        _m_merge_tail(size_type old)
+        {
+            vector<size_t> order;
+            if (__flat_unique_order(_m_keys.data(), old, _m_keys.size(), _m_comp, order)) {
+                return;
+            }
+            container_type merged(_m_keys.get_allocator());
+            merged.reserve(old + order.size());
+            size_type i = 0;
+            for (vector<size_t>::iterator it = order.begin(); it != order.end(); ++it) {
+                for (; i != old && _m_comp(_m_keys[i], _m_keys[*it]); ++i) {
+                    merged.push_back(rayn::move(_m_keys[i]));
+                }
+                merged.push_back(rayn::move(_m_keys[*it]));
+            }
+            for (; i != old; ++i) {
+                merged.push_back(rayn::move(_m_keys[i]));
+            }
+            _m_keys.swap(merged);
+        }
+    };
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator==(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return x.keys() == y.keys();
+    }
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator!=(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return !(x == y);
+    }
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator<(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return rayn::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+    }
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator>(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return y < x;
+    }
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator<=(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return !(y < x);
+    }
+
+    template <class Key, class Compare, class Alloc>
+    inline bool
+    operator>=(const flat_set<Key, Compare, Alloc>& x, const flat_set<Key, Compare, Alloc>& y)
+    {
+        return !(x < y);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -5,6 +5,8 @@
 #ifndef _FUNCTIONAL_H_
 #define _FUNCTIONAL_H_
 
+#include <cstddef>
+
 namespace rayn {
 
     // unary_function
@@ -92,21 +94,60 @@ namespace rayn {
     };
 
     // greater
-    template <class T>
+    template <class T = void>
     struct greater : public binary_function<T, T, bool> {
         bool operator()(const T& x, const T& y) const {
             return x > y;
         }
     };
 
+    // greater<>, compares any two types that support operator>
+    template <>
+    struct greater<void> {
+        typedef void    is_transparent;
+
+        template <class T, class U>
+        bool operator()(const T& x, const U& y) const {
+            return x > y;
+        }
+    };
+
     // less
-    template <class T>
+    template <class T = void>
     struct less : public binary_function<T, T, bool> {
         bool operator()(const T& x, const T& y) const {
             return x < y;
         }
     };
 
+    // less<>, compares any two types that support operator<. Ordered
+    // containers using it accept lookup keys of other types.
+    template <>
+    struct less<void> {
+        typedef void    is_transparent;
+
+        template <class T, class U>
+        bool operator()(const T& x, const U& y) const {
+            return x < y;
+        }
+    };
+
+    // __has_is_transparent<Compare>::value is true when Compare declares
+    // the nested type is_transparent
+    template <class Compare>
+    class __has_is_transparent {
+        typedef char    __one;
+        struct __two { char c[2]; };
+
+        template <class C>
+        static __one __test(typename C::is_transparent*);
+        template <class C>
+        static __two __test(...);
+
+    public:
+        static const bool value = sizeof(__test<Compare>(0)) == sizeof(__one);
+    };
+
     // greater_equal
     template <class T>
     struct greater_equal : public binary_function<T, T, bool> {
@@ -221,6 +262,73 @@ namespace rayn {
             return x.second;
         }
     };
+
+    /// Hash
+
+    /*
+    ** @brief   FNV-1a hash of n bytes.
+    */
+    inline size_t _hash_bytes(const void *p, size_t n) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(p);
+        const bool wide = sizeof(size_t) > 4;
+        size_t h = wide ? static_cast<size_t>(14695981039346656037ULL) : 2166136261U;
+        const size_t prime = wide ? static_cast<size_t>(1099511628211ULL) : 16777619U;
+        for (size_t i = 0; i != n; ++i) {
+            h ^= bytes[i];
+            h *= prime;
+        }
+        return h;
+    }
+
+    // hash, specialized for the built-in types here and for strings in their headers.
+    template <class T>
+    struct hash;
+
+    template <class T>
+    struct hash<T*> : public unary_function<T*, size_t> {
+        size_t operator()(T* p) const {
+            return reinterpret_cast<size_t>(p);
+        }
+    };
+
+    // Integers hash to themselves, hash tables mix the bits.
+#define RAYN_INTEGRAL_HASH(T)                               \
+    template <>                                             \
+    struct hash<T> : public unary_function<T, size_t> {     \
+        size_t operator()(T x) const {                      \
+            return static_cast<size_t>(x);                  \
+        }                                                   \
+    };
+
+    RAYN_INTEGRAL_HASH(bool)
+    RAYN_INTEGRAL_HASH(char)
+    RAYN_INTEGRAL_HASH(signed char)
+    RAYN_INTEGRAL_HASH(unsigned char)
+    RAYN_INTEGRAL_HASH(wchar_t)
+    RAYN_INTEGRAL_HASH(short)
+    RAYN_INTEGRAL_HASH(unsigned short)
+    RAYN_INTEGRAL_HASH(int)
+    RAYN_INTEGRAL_HASH(unsigned int)
+    RAYN_INTEGRAL_HASH(long)
+    RAYN_INTEGRAL_HASH(unsigned long)
+    RAYN_INTEGRAL_HASH(long long)
+    RAYN_INTEGRAL_HASH(unsigned long long)
+
+#undef RAYN_INTEGRAL_HASH
+
+    template <>
+    struct hash<float> : public unary_function<float, size_t> {
+        size_t operator()(float x) const {
+            // 0.0 and -0.0 are equal
+            return x == 0.0f ? 0 : _hash_bytes(&x, sizeof(x));
+        }
+    };
+    template <>
+    struct hash<double> : public unary_function<double, size_t> {
+        size_t operator()(double x) const {
+            return x == 0.0 ? 0 : _hash_bytes(&x, sizeof(x));
+        }
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,782 @@
+/*
+** Hashtable.h
+** Created by Rayn on 2026/10/17
+** open addressing hash table with Swiss table control bytes
+*/
+#ifndef _HASHTABLE_H_
+#define _HASHTABLE_H_
+
+#include "Allocator.h"
+#include "BitOps.h"
+#include "Construct.h"
+#include "Functional.h"
+#include "Iterator.h"
+#include "Move.h"
+#include "Pair.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYN_HASHTABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace rayn {
+
+    /*
+    ** Every slot has a control byte: CTRL_EMPTY, CTRL_DELETED, or the low 7
+    ** bits (H2) of the hash of the value in it. The rest of the hash (H1)
+    ** picks the first group of GROUP_WIDTH slots to probe. A group is
+    ** matched against H2 with one SSE2 compare, so the keys themselves are
+    ** only compared for about one slot per lookup, and the probe stops at
+    ** the first group that has an empty slot. The control bytes end with
+    ** CTRL_SENTINEL, where iteration stops.
+    */
+    typedef signed char __hash_ctrl;
+    enum EHashCtrl{ CTRL_EMPTY = -128, CTRL_DELETED = -2, CTRL_SENTINEL = -1 };
+    enum EHashGroup{ GROUP_WIDTH = 16 };
+
+    struct __hash_group {
+        const __hash_ctrl *ctrl;
+
+        explicit __hash_group(const __hash_ctrl *p) : ctrl(p) {}
+
+#ifdef RAYN_HASHTABLE_SSE2
+        // bit i is set if ctrl[i] == h
+        unsigned match(__hash_ctrl h) const {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), v)));
+        }
+        // bit i is set if slot i is empty or deleted
+        unsigned match_free() const {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), v)));
+        }
+#else
+        unsigned match(__hash_ctrl h) const {
+            unsigned mask = 0;
+            for (int i = 0; i != GROUP_WIDTH; ++i) {
+                mask |= static_cast<unsigned>(ctrl[i] == h) << i;
+            }
+            return mask;
+        }
+        unsigned match_free() const {
+            unsigned mask = 0;
+            for (int i = 0; i != GROUP_WIDTH; ++i) {
+                mask |= static_cast<unsigned>(ctrl[i] < CTRL_SENTINEL) << i;
+            }
+            return mask;
+        }
+#endif
+        unsigned match_empty() const { return match(CTRL_EMPTY); }
+    };
+
+    /*
+    ** @brief   Spread the bits of a weak hash, such as the identity hash of
+    **          integers, over the whole word.
+    */
+    inline size_t _hash_mix(size_t h) {
+        if (sizeof(size_t) > 4) {
+            unsigned long long x = static_cast<unsigned long long>(h) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<size_t>(x ^ (x >> 32));
+        }
+        size_t x = h * 0x9E3779B9U;
+        return x ^ (x >> 16);
+    }
+
+    // Layouts of the slots, chosen by the Layout parameter of the unordered containers.
+    struct hash_flat_layout {};     // values are stored in the slot array and move on rehash
+    struct hash_node_layout {};     // slots point to nodes, references survive rehash
+
+    template <class Value, class Alloc, class Layout>
+    struct __hash_slot_policy;
+
+    template <class Value, class Alloc>
+    struct __hash_slot_policy<Value, Alloc, hash_flat_layout> {
+        typedef Value                                               slot_type;
+        typedef typename Alloc::template rebind<Value>::other       node_allocator;
+
+        static Value& element(slot_type& s) { return s; }
+        template <class Arg>
+        static void construct(node_allocator&, slot_type *s, Arg&& arg) {
+            rayn::construct(s, rayn::forward<Arg>(arg));
+        }
+        static void destroy(node_allocator&, slot_type *s) {
+            rayn::destroy(s);
+        }
+        static void transfer(node_allocator&, slot_type *to, slot_type *from) {
+            rayn::construct(to, rayn::move(*from));
+            rayn::destroy(from);
+        }
+    };
+
+    template <class Value, class Alloc>
+    struct __hash_slot_policy<Value, Alloc, hash_node_layout> {
+        typedef Value*                                              slot_type;
+        typedef typename Alloc::template rebind<Value>::other       node_allocator;
+
+        static Value& element(slot_type s) { return *s; }
+        template <class Arg>
+        static void construct(node_allocator& a, slot_type *s, Arg&& arg) {
+            Value *p = a.allocate();
+            try {
+                rayn::construct(p, rayn::forward<Arg>(arg));
+            } catch (...) {
+                a.deallocate(p);
+                throw;
+            }
+            *s = p;
+        }
+        static void destroy(node_allocator& a, slot_type *s) {
+            rayn::destroy(*s);
+            a.deallocate(*s);
+        }
+        static void transfer(node_allocator&, slot_type *to, slot_type *from) {
+            *to = *from;
+        }
+    };
+
+    // Passes the inserted value through unchanged, insert_unique builds the element from it.
+    struct __hash_forward_value {
+        template <class Arg>
+        Arg&& operator()(Arg&& v) const {
+            return rayn::forward<Arg>(v);
+        }
+    };
+
+    // Small values are stored flat, larger ones in nodes so that rehashing only moves pointers.
+    template <class Value>
+    struct __hash_default_layout {
+        typedef typename conditional<(sizeof(Value) <= 4 * sizeof(void *)),
+                                     hash_flat_layout, hash_node_layout>::type type;
+    };
+
+    template <class Value, class Policy>
+    struct __hashtable_iterator {
+        typedef Value       value_type;
+        typedef Value&      reference;
+        typedef Value*      pointer;
+
+        typedef forward_iterator_tag            iterator_category;
+        typedef ptrdiff_t                       difference_type;
+
+        typedef __hashtable_iterator<Value, Policy>     self;
+        typedef typename Policy::slot_type              slot_type;
+
+        const __hash_ctrl  *_m_ctrl;
+        slot_type          *_m_slot;
+
+        __hashtable_iterator() : _m_ctrl(0), _m_slot(0) {}
+        __hashtable_iterator(const __hash_ctrl *ctrl, slot_type *slot) : _m_ctrl(ctrl), _m_slot(slot) {}
+
+        reference operator* () const {
+            return Policy::element(*_m_slot);
+        }
+        pointer operator-> () const {
+            return &Policy::element(*_m_slot);
+        }
+        self& operator++ () {
+            ++_m_ctrl;
+            ++_m_slot;
+            _m_skip_free();
+            return *this;
+        }
+        self operator++ (int) {
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+        bool operator== (const self& x) const {
+            return _m_ctrl == x._m_ctrl;
+        }
+        bool operator!= (const self& x) const {
+            return _m_ctrl != x._m_ctrl;
+        }
+
+        // stop at a full slot or at the sentinel
+        void _m_skip_free() {
+            while (*_m_ctrl < CTRL_SENTINEL) {
+                ++_m_ctrl;
+                ++_m_slot;
+            }
+        }
+    };
+
+    template <class Value, class Policy>
+    struct __hashtable_const_iterator {
+        typedef Value           value_type;
+        typedef const Value&    reference;
+        typedef const Value*    pointer;
+
+        typedef forward_iterator_tag            iterator_category;
+        typedef ptrdiff_t                       difference_type;
+
+        typedef __hashtable_const_iterator<Value, Policy>   self;
+        typedef __hashtable_iterator<Value, Policy>         iterator;
+        typedef typename Policy::slot_type                  slot_type;
+
+        const __hash_ctrl  *_m_ctrl;
+        slot_type          *_m_slot;
+
+        __hashtable_const_iterator() : _m_ctrl(0), _m_slot(0) {}
+        __hashtable_const_iterator(const __hash_ctrl *ctrl, slot_type *slot) : _m_ctrl(ctrl), _m_slot(slot) {}
+        __hashtable_const_iterator(const iterator& it) : _m_ctrl(it._m_ctrl), _m_slot(it._m_slot) {}
+
+        iterator _const_cast() const {
+            return iterator(_m_ctrl, _m_slot);
+        }
+
+        reference operator* () const {
+            return Policy::element(*_m_slot);
+        }
+        pointer operator-> () const {
+            return &Policy::element(*_m_slot);
+        }
+        self& operator++ () {
+            ++_m_ctrl;
+            ++_m_slot;
+            while (*_m_ctrl < CTRL_SENTINEL) {
+                ++_m_ctrl;
+                ++_m_slot;
+            }
+            return *this;
+        }
+        self operator++ (int) {
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+        bool operator== (const self& x) const {
+            return _m_ctrl == x._m_ctrl;
+        }
+        bool operator!= (const self& x) const {
+            return _m_ctrl != x._m_ctrl;
+        }
+    };
+
+    template <class Value, class Policy>
+    inline bool
+    operator==(const __hashtable_iterator<Value, Policy>& x,
+               const __hashtable_const_iterator<Value, Policy>& y)
+    { return x._m_ctrl == y._m_ctrl; }
+
+    template <class Value, class Policy>
+    inline bool
+    operator!=(const __hashtable_iterator<Value, Policy>& x,
+               const __hashtable_const_iterator<Value, Policy>& y)
+    { return x._m_ctrl != y._m_ctrl; }
+
+
+    /*
+    ** The table behind unordered_set and unordered_map. The capacity is 0 or
+    ** a power of two no less than GROUP_WIDTH, and at most 7/8 of it is
+    ** used by full and deleted slots together; an erased slot becomes empty
+    ** again when no probe can have passed its group.
+    */
+    template <class Key, class Value, class KeyOfValue, class Hash, class KeyEqual,
+              class Alloc = allocator<Value>, class Layout = hash_flat_layout>
+    class hashtable {
+    protected:
+        typedef __hash_slot_policy<Value, Alloc, Layout>                        slot_policy;
+        typedef typename slot_policy::slot_type                                 slot_type;
+        typedef typename slot_policy::node_allocator                            node_allocator;
+        typedef typename Alloc::template rebind<slot_type>::other               slot_allocator;
+        typedef typename Alloc::template rebind<__hash_ctrl>::other             ctrl_allocator;
+
+    public:
+        typedef Key                         key_type;
+        typedef Value                       value_type;
+        typedef Hash                        hasher;
+        typedef KeyEqual                    key_equal;
+        typedef value_type*                 pointer;
+        typedef const value_type*           const_pointer;
+        typedef value_type&                 reference;
+        typedef const value_type&           const_reference;
+        typedef size_t                      size_type;
+        typedef ptrdiff_t                   difference_type;
+        typedef Alloc                       allocator_type;
+
+        typedef __hashtable_iterator<value_type, slot_policy>         iterator;
+        typedef __hashtable_const_iterator<value_type, slot_policy>   const_iterator;
+
+    protected:
+        __hash_ctrl    *ctrl;
+        slot_type      *slots;
+        size_type       capacity;
+        size_type       element_count;
+        size_type       growth_left;    // empty slots that may still be filled before a rehash
+        Hash            hash_fn;
+        KeyEqual        equal_fn;
+        ctrl_allocator  ctrl_alloc;
+        slot_allocator  slot_alloc;
+        node_allocator  node_alloc;
+
+    public:
+        // constructor/destructor
+        hashtable(size_type n = 0, const Hash& hf = Hash(), const KeyEqual& eql = KeyEqual(),
+                  const allocator_type& a = allocator_type())
+        : ctrl(0), slots(0), capacity(0), element_count(0), growth_left(0),
+          hash_fn(hf), equal_fn(eql), ctrl_alloc(a), slot_alloc(a), node_alloc(a)
+        {
+            if (n != 0) {
+                _m_allocate(_s_capacity_for(n));
+            }
+        }
+
+        // the copy allocates from the same allocator
+        hashtable(const hashtable& other)
+        : ctrl(0), slots(0), capacity(0), element_count(0), growth_left(0),
+          hash_fn(other.hash_fn), equal_fn(other.equal_fn), ctrl_alloc(other.ctrl_alloc),
+          slot_alloc(other.slot_alloc), node_alloc(other.node_alloc)
+        {
+            _m_copy_from(other);
+        }
+
+        hashtable(hashtable&& other)
+        : ctrl(other.ctrl), slots(other.slots), capacity(other.capacity),
+          element_count(other.element_count), growth_left(other.growth_left),
+          hash_fn(other.hash_fn), equal_fn(other.equal_fn), ctrl_alloc(other.ctrl_alloc),
+          slot_alloc(other.slot_alloc), node_alloc(other.node_alloc)
+        {
+            other.ctrl = 0;
+            other.slots = 0;
+            other.capacity = other.element_count = other.growth_left = 0;
+        }
+
+        ~hashtable() {
+            _m_destroy_all();
+            _m_deallocate();
+        }
+
+        hashtable&
+        operator= (const hashtable& other) {
+            if (this != &other) {
+                clear();
+                hash_fn = other.hash_fn;
+                equal_fn = other.equal_fn;
+                _m_copy_from(other);
+            }
+            return *this;
+        }
+
+        hashtable&
+        operator= (hashtable&& other) {
+            swap(other);
+            return *this;
+        }
+
+        // Accessors.
+        hasher hash_function() const { return hash_fn; }
+        key_equal key_eq() const { return equal_fn; }
+        allocator_type get_allocator() const { return allocator_type(node_alloc); }
+
+        iterator begin() {
+            if (element_count == 0) {
+                return end();
+            }
+            iterator it(ctrl, slots);
+            it._m_skip_free();
+            return it;
+        }
+        const_iterator begin() const {
+            return const_cast<hashtable *>(this)->begin();
+        }
+        iterator end() {
+            return iterator(ctrl + capacity, slots + capacity);
+        }
+        const_iterator end() const {
+            return const_iterator(ctrl + capacity, slots + capacity);
+        }
+
+        bool        empty() const       { return element_count == 0; }
+        size_type   size() const        { return element_count; }
+        size_type   max_size() const    { return size_type(-1) / sizeof(slot_type); }
+
+        // Buckets, one per slot.
+        size_type   bucket_count() const    { return capacity; }
+        float       load_factor() const     { return capacity == 0 ? 0.0f : float(element_count) / capacity; }
+        float       max_load_factor() const { return 0.875f; }
+
+        /*
+        ** @brief   Make room for n elements without rehashing.
+        */
+        void reserve(size_type n) {
+            if (n > element_count + growth_left) {
+                _m_resize(_s_capacity_for(n));
+            }
+        }
+        /*
+        ** @brief   Rebuild the table with at least n slots, dropping the deleted ones.
+        */
+        void rehash(size_type n) {
+            size_type cap = _s_capacity_for(element_count);
+            while (cap < n) {
+                cap = _s_double(cap);
+            }
+            if (element_count == 0 && n == 0) {
+                clear();
+                _m_deallocate();
+            } else {
+                _m_resize(cap);
+            }
+        }
+
+        void swap(hashtable& other) {
+            rayn::swap(ctrl, other.ctrl);
+            rayn::swap(slots, other.slots);
+            rayn::swap(capacity, other.capacity);
+            rayn::swap(element_count, other.element_count);
+            rayn::swap(growth_left, other.growth_left);
+            rayn::swap(hash_fn, other.hash_fn);
+            rayn::swap(equal_fn, other.equal_fn);
+            rayn::swap(ctrl_alloc, other.ctrl_alloc);
+            rayn::swap(slot_alloc, other.slot_alloc);
+            rayn::swap(node_alloc, other.node_alloc);
+        }
+
+        // Modifiers
+        pair<iterator, bool>
+        insert_unique(const value_type& v) {
+            return _m_insert_unique(v);
+        }
+        pair<iterator, bool>
+        insert_unique(value_type&& v) {
+            return _m_insert_unique(rayn::move(v));
+        }
+        template <class InputIterator>
+        void
+        insert_unique(InputIterator first, InputIterator last) {
+            for (; first != last; ++first) {
+                _m_insert_unique(*first);
+            }
+        }
+        /*
+        ** @brief   Find k, or insert make(k) if it is missing.
+        ** The table is probed once, and make is only called on a miss.
+        */
+        template <class Make>
+        pair<iterator, bool>
+        find_or_insert(const key_type& k, const Make& make) {
+            return _m_find_or_insert(k, make, k);
+        }
+
+        iterator
+        erase(const_iterator pos) {
+            iterator it = pos._const_cast();
+            _m_erase_at(it._m_slot - slots);
+            ++it;
+            return it;
+        }
+        iterator
+        erase(const_iterator first, const_iterator last) {
+            while (first != last) {
+                first = erase(first);
+            }
+            return last._const_cast();
+        }
+        size_type
+        erase(const key_type& k) {
+            size_type i = _m_find(k);
+            if (i == capacity) {
+                return 0;
+            }
+            _m_erase_at(i);
+            return 1;
+        }
+
+        void clear() {
+            _m_destroy_all();
+            if (capacity != 0) {
+                memset(ctrl, CTRL_EMPTY, capacity);
+                growth_left = _s_growth(capacity);
+            }
+            element_count = 0;
+        }
+
+        // Lookup
+        iterator
+        find(const key_type& k) {
+            size_type i = _m_find(k);
+            return iterator(ctrl + i, slots + i);
+        }
+        const_iterator
+        find(const key_type& k) const {
+            size_type i = _m_find(k);
+            return const_iterator(ctrl + i, slots + i);
+        }
+        size_type
+        count(const key_type& k) const {
+            return _m_find(k) == capacity ? 0 : 1;
+        }
+        pair<iterator, iterator>
+        equal_range(const key_type& k) {
+            iterator first = find(k);
+            iterator last = first;
+            return pair<iterator, iterator>(first, first == end() ? last : ++last);
+        }
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const {
+            const_iterator first = find(k);
+            const_iterator last = first;
+            return pair<const_iterator, const_iterator>(first, first == end() ? last : ++last);
+        }
+
+    private:
+        static size_type _s_growth(size_type cap) {
+            return cap - cap / 8;
+        }
+        // The smallest capacity that holds n elements.
+        static size_type _s_capacity_for(size_type n) {
+            size_type cap = GROUP_WIDTH;
+            while (_s_growth(cap) < n) {
+                cap = _s_double(cap);
+            }
+            return cap;
+        }
+        // Twice cap, refusing a table larger than max_size() slots.
+        static size_type _s_double(size_type cap) {
+            if (cap > size_type(-1) / sizeof(slot_type) / 2) {
+                throw std::length_error("hashtable: too many elements");
+            }
+            return cap * 2;
+        }
+        static __hash_ctrl _s_h2(size_type h) {
+            return static_cast<__hash_ctrl>(h & 0x7F);
+        }
+        const key_type& _m_key(size_type i) const {
+            return KeyOfValue()(slot_policy::element(slots[i]));
+        }
+        size_type _m_hash(const key_type& k) const {
+            return _hash_mix(hash_fn(k));
+        }
+
+        /*
+        ** @brief   The slot holding k.
+        ** @return  Its index, or capacity if k is not in the table.
+        ** Groups are visited at offsets 1, 2, 3... from each other, which
+        ** covers all of them since their number is a power of two.
+        */
+        size_type _m_find(const key_type& k) const {
+            if (element_count == 0) {
+                return capacity;
+            }
+            size_type h = _m_hash(k);
+            size_type mask = capacity / GROUP_WIDTH - 1;
+            size_type g = (h >> 7) & mask;
+            for (size_type step = 1; ; ++step) {
+                __hash_group group(ctrl + g * GROUP_WIDTH);
+                for (unsigned m = group.match(_s_h2(h)); m != 0; m &= m - 1) {
+                    size_type i = g * GROUP_WIDTH + _lowest_bit(m);
+                    if (equal_fn(_m_key(i), k)) {
+                        return i;
+                    }
+                }
+                if (group.match_empty() != 0) {
+                    return capacity;
+                }
+                g = (g + step) & mask;
+            }
+        }
+        /*
+        ** @brief   Look k up and remember the first free slot on the way, so that
+        **          a missing key is inserted without probing again.
+        ** @return  (index of k, true), or (first free slot on the probe sequence, false).
+        */
+        pair<size_type, bool> _m_find_or_free(const key_type& k, size_type h) const {
+            size_type mask = capacity / GROUP_WIDTH - 1;
+            size_type g = (h >> 7) & mask;
+            size_type first_free = capacity;
+            for (size_type step = 1; ; ++step) {
+                __hash_group group(ctrl + g * GROUP_WIDTH);
+                for (unsigned m = group.match(_s_h2(h)); m != 0; m &= m - 1) {
+                    size_type i = g * GROUP_WIDTH + _lowest_bit(m);
+                    if (equal_fn(_m_key(i), k)) {
+                        return pair<size_type, bool>(i, true);
+                    }
+                }
+                if (first_free == capacity) {
+                    unsigned m = group.match_free();
+                    if (m != 0) {
+                        first_free = g * GROUP_WIDTH + _lowest_bit(m);
+                    }
+                }
+                if (group.match_empty() != 0) {
+                    return pair<size_type, bool>(first_free, false);
+                }
+                g = (g + step) & mask;
+            }
+        }
+        /*
+        ** @brief   The first empty or deleted slot on the probe sequence of h.
+        */
+        size_type _m_find_free(size_type h) const {
+            size_type mask = capacity / GROUP_WIDTH - 1;
+            size_type g = (h >> 7) & mask;
+            for (size_type step = 1; ; ++step) {
+                unsigned m = __hash_group(ctrl + g * GROUP_WIDTH).match_free();
+                if (m != 0) {
+                    return g * GROUP_WIDTH + _lowest_bit(m);
+                }
+                g = (g + step) & mask;
+            }
+        }
+
+        template <class Arg>
+        pair<iterator, bool>
+        _m_insert_unique(Arg&& v) {
+            return _m_find_or_insert(KeyOfValue()(v), __hash_forward_value(), rayn::forward<Arg>(v));
+        }
+        /*
+        ** @brief   Find k, or construct the element from make(arg) in the free
+        **          slot the same probe ended at.
+        */
+        template <class Make, class Arg>
+        pair<iterator, bool>
+        _m_find_or_insert(const key_type& k, const Make& make, Arg&& arg) {
+            size_type h = _m_hash(k);
+            size_type i;
+            if (capacity == 0) {
+                _m_resize(_s_capacity_for(1));
+                i = _m_find_free(h);
+            } else {
+                pair<size_type, bool> found = _m_find_or_free(k, h);
+                i = found.first;
+                if (found.second) {
+                    return pair<iterator, bool>(iterator(ctrl + i, slots + i), false);
+                }
+            }
+            if (growth_left == 0 && ctrl[i] == CTRL_EMPTY) {
+                // grow if more than 25/32 is really used, otherwise just drop the deleted slots
+                _m_resize(element_count * 32 > capacity * 25 ? _s_double(capacity) : capacity);
+                i = _m_find_free(h);
+            }
+            slot_policy::construct(node_alloc, slots + i, make(rayn::forward<Arg>(arg)));
+            if (ctrl[i] == CTRL_EMPTY) {
+                --growth_left;
+            }
+            ctrl[i] = _s_h2(h);
+            ++element_count;
+            return pair<iterator, bool>(iterator(ctrl + i, slots + i), true);
+        }
+
+        void _m_erase_at(size_type i) {
+            slot_policy::destroy(node_alloc, slots + i);
+            --element_count;
+            if (__hash_group(ctrl + i / GROUP_WIDTH * GROUP_WIDTH).match_empty() != 0) {
+                ctrl[i] = CTRL_EMPTY;
+                ++growth_left;
+            } else {
+                ctrl[i] = CTRL_DELETED;
+            }
+        }
+
+        // Allocate an empty table of cap slots, the old arrays must be released before.
+        void _m_allocate(size_type cap) {
+            if (cap > max_size()) {
+                throw std::length_error("hashtable: too many elements");
+            }
+            assert(cap >= GROUP_WIDTH);
+            ctrl = ctrl_alloc.allocate(cap + 1);
+            memset(ctrl, CTRL_EMPTY, cap);
+            ctrl[cap] = CTRL_SENTINEL;
+            slots = slot_alloc.allocate(cap);
+            capacity = cap;
+            growth_left = _s_growth(cap) - element_count;
+        }
+        void _m_deallocate() {
+            if (capacity != 0) {
+                ctrl_alloc.deallocate(ctrl, capacity + 1);
+                slot_alloc.deallocate(slots, capacity);
+            }
+            ctrl = 0;
+            slots = 0;
+            capacity = 0;
+            growth_left = 0;
+        }
+        void _m_destroy_all() {
+            for (size_type i = 0; i != capacity && element_count != 0; ++i) {
+                if (ctrl[i] >= 0) {
+                    slot_policy::destroy(node_alloc, slots + i);
+                    ctrl[i] = CTRL_EMPTY;
+                    --element_count;
+                }
+            }
+        }
+        // Move every element into a new table of cap slots.
+        void _m_resize(size_type cap) {
+            __hash_ctrl *old_ctrl = ctrl;
+            slot_type *old_slots = slots;
+            size_type old_capacity = capacity;
+            _m_allocate(cap);
+            for (size_type i = 0; i != old_capacity; ++i) {
+                if (old_ctrl[i] >= 0) {
+                    size_type h = _m_hash(KeyOfValue()(slot_policy::element(old_slots[i])));
+                    size_type j = _m_find_free(h);
+                    slot_policy::transfer(node_alloc, slots + j, old_slots + i);
+                    ctrl[j] = _s_h2(h);
+                }
+            }
+            if (old_capacity != 0) {
+                ctrl_alloc.deallocate(old_ctrl, old_capacity + 1);
+                slot_alloc.deallocate(old_slots, old_capacity);
+            }
+        }
+        // Insert the elements of other, which are known to be distinct.
+        void _m_copy_from(const hashtable& other) {
+            if (other.element_count == 0) {
+                return;
+            }
+            if (_s_growth(capacity) < other.element_count) {
+                _m_deallocate();
+                _m_allocate(_s_capacity_for(other.element_count));
+            }
+            for (size_type i = 0; i != other.capacity; ++i) {
+                if (other.ctrl[i] >= 0) {
+                    value_type& v = slot_policy::element(other.slots[i]);
+                    size_type h = _m_hash(KeyOfValue()(v));
+                    size_type j = _m_find_free(h);
+                    slot_policy::construct(node_alloc, slots + j, static_cast<const value_type&>(v));
+                    ctrl[j] = _s_h2(h);
+                    ++element_count;
+                    --growth_left;
+                }
+            }
+        }
+    };
+
+    /*
+    ** @brief   Equal if both have the same size and each element of x has an
+    **          equal element in y.
+    */
+    template <class Key, class Value, class KeyOfValue, class Hash, class KeyEqual, class Alloc, class Layout>
+    inline bool
+    operator==(const hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>& x,
+               const hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>& y)
+    {
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (typename hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>::const_iterator
+             it = x.begin(); it != x.end(); ++it) {
+            typename hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>::const_iterator
+                other = y.find(KeyOfValue()(*it));
+            if (other == y.end() || !(*other == *it)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Hash, class KeyEqual, class Alloc, class Layout>
+    inline bool
+    operator!=(const hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>& x,
+               const hashtable<Key, Value, KeyOfValue, Hash, KeyEqual, Alloc, Layout>& y)
+    {
+        return !(x == y);
+    }
+}
+
+#endif
\ No newline at end of file
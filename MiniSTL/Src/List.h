@@ -15,7 +15,7 @@
 
 namespace rayn {
 
-    template <class T> class list;
+    template <class T, class Alloc> class list;
 
     // List Node
     template <class T>
@@ -168,24 +168,24 @@ namespace rayn {
         }
     };
 
-    template <class T>
+    template <class T, class Alloc>
     inline bool operator== (const __list_iterator<T>& x,
                             const __list_const_iterator<T>& y) {
         return x.node == y.node;
     }
 
-    template <class T>
+    template <class T, class Alloc>
     inline bool operator!= (const __list_iterator<T>& x,
                             const __list_const_iterator<T>& y) {
         return x.node != y.node;
     }
 
 
-    template <class T>
+    template <class T, class Alloc = allocator<T> >
     class list {
     protected:
-        typedef __list_node<T>                      list_node;
-        typedef allocator<list_node>                node_allocator;
+        typedef __list_node<T>                                          list_node;
+        typedef typename Alloc::template rebind<list_node>::other       node_allocator;
 
     public:
         typedef T                                   value_type;
@@ -197,44 +197,53 @@ namespace rayn {
         typedef reverse_iterator_t<const_iterator>  const_reverse_iterator;
         typedef size_t                              size_type;
         typedef ptrdiff_t                           difference_type;
+        typedef Alloc                               allocator_type;
 
     protected:
-        list_node* node;
+        list_node*      node;
+        node_allocator  node_alloc;
 
     public:
         // Default Constructor
         list() {
             empty_initialize();
         }
+        // Constructs an empty container with the given allocator.
+        explicit list(const allocator_type& a) : node_alloc(a) {
+            empty_initialize();
+        }
         // Constructor with count elements.
         explicit list(size_type count) {
             empty_initialize();
             insert(end(), count, value_type());
         }
-        list(size_type count, const value_type& value) {
+        list(size_type count, const value_type& value,
+             const allocator_type& a = allocator_type()) : node_alloc(a) {
             empty_initialize();
             fill_initialize(count, value);
         }
         // Contructor with Range [first, last).
         template <class InputIterator>
-        list(InputIterator first, InputIterator last) {
+        list(InputIterator first, InputIterator last,
+             const allocator_type& a = allocator_type()) : node_alloc(a) {
             typedef typename rayn::is_integral<InputIterator>::type Integer;
             empty_initialize();
             initialize_dispatch(first, last, Integer());
         }
-        // Copy Contructor
-        list(const list& other) {
+        // Copy Contructor, the copy allocates from the same allocator.
+        list(const list& other) : node_alloc(other.node_alloc) {
             empty_initialize();
             initialize_dispatch(other.begin(), other.end(), false_type());
         }
         // Move Contructor
-        list(list&& other) {
+        list(list&& other) : node_alloc(other.node_alloc) {
             empty_initialize();
             swap(other);
         }
         // Default Destroy Function
         ~list() {
             clear();
+            put_node(node);
         }
 
         list& operator= (const list& other) {
@@ -297,6 +306,9 @@ namespace rayn {
         void resize(size_type count);
         void resize(size_type count, const T& value);
         void swap(list& other);
+
+        // Returns the allocator associated with the container.
+        allocator_type get_allocator() const { return allocator_type(node_alloc); }
         
         void merge(list& other);
         template <class Compare>
@@ -323,10 +335,10 @@ namespace rayn {
 
     protected:
         list_node* get_node() {
-            return node_allocator::allocate();
+            return node_alloc.allocate();
         }
         void put_node(list_node* p) {
-            node_allocator::deallocate(p);
+            node_alloc.deallocate(p);
         }
         list_node* create_node(const value_type& value) {
             list_node* p = get_node();
@@ -405,8 +417,8 @@ namespace rayn {
         }
     };
 
-    template <class T>
-    void list<T>::clear() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::clear() {
         list_node* cur = node->next;
         while (cur != node) {
             list_node* tmp = cur;
@@ -417,9 +429,9 @@ namespace rayn {
         node->prev = node;
     }
 
-    template <class T>
-    typename list<T>::iterator
-        list<T>::insert(const_iterator position, const T& value) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+        list<T, Alloc>::insert(const_iterator position, const T& value) {
         list_node* tmp = create_node(value);
         iterator pos = position._const_cast();
         tmp->next = pos.node;
@@ -429,11 +441,11 @@ namespace rayn {
         return iterator(tmp);
     }
 
-    template <class T>
-    typename list<T>::iterator
-        list<T>::insert(const_iterator position, size_type count, const T& value) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+        list<T, Alloc>::insert(const_iterator position, size_type count, const T& value) {
         if (count) {
-            list tmp(count, value);
+            list tmp(count, value, get_allocator());
             iterator it = tmp.begin();
             splice(position, tmp);
             return it;
@@ -441,11 +453,11 @@ namespace rayn {
         return iterator(position._const_cast());
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class InputIterator>
-    typename list<T>::iterator
-        list<T>::insert(const_iterator position, InputIterator first, InputIterator last) {
-        list tmp(first, last);
+    typename list<T, Alloc>::iterator
+        list<T, Alloc>::insert(const_iterator position, InputIterator first, InputIterator last) {
+        list tmp(first, last, get_allocator());
         if (!tmp.empty()) {
             iterator it = tmp.begin();
             splice(position, tmp);
@@ -454,9 +466,9 @@ namespace rayn {
         return position._const_cast();
     }
 
-    template <class T>
-    typename list<T>::iterator
-        list<T>::erase(const_iterator position) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+        list<T, Alloc>::erase(const_iterator position) {
         list_node* next_node = position.node->next;
         list_node* prev_node = position.node->prev;
         prev_node->next = next_node;
@@ -465,17 +477,17 @@ namespace rayn {
         return iterator(next_node);
     }
 
-    template <class T>
-    typename list<T>::iterator
-        list<T>::erase(const_iterator first, const_iterator last) {
+    template <class T, class Alloc>
+    typename list<T, Alloc>::iterator
+        list<T, Alloc>::erase(const_iterator first, const_iterator last) {
         while (first != last) {
             first = erase(first);
         }
         return last._const_cast();
     }
 
-    template <class T>
-    void list<T>::resize(size_type count) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::resize(size_type count) {
         iterator it = begin();
         size_type len = 0;
         for (; it != end() && len < count; ++it, ++len);
@@ -486,8 +498,8 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::resize(size_type count, const T& value) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::resize(size_type count, const T& value) {
         iterator it = begin();
         size_type len = 0;
         for (; it != end() && len < count; ++it, ++len);
@@ -498,13 +510,14 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::swap(list<T>& other) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::swap(list<T, Alloc>& other) {
         rayn::swap(node, other.node);
+        rayn::swap(node_alloc, other.node_alloc);
     }
 
-    template <class T>
-    void list<T>::merge(list& other) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::merge(list& other) {
         iterator first1 = begin(), last1 = end();
         iterator first2 = other.begin(), last2 = other.end();
         while (first1 != last1 && first2 != last2) {
@@ -521,9 +534,9 @@ namespace rayn {
         }
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class Compare>
-    void list<T>::merge(list& other, Compare comp) {
+    void list<T, Alloc>::merge(list& other, Compare comp) {
         iterator first1 = begin(), last1 = end();
         iterator first2 = other.begin(), last2 = other.end();
         while (first1 != last1 && first2 != last2) {
@@ -540,31 +553,31 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::splice(const_iterator position, list& other) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator position, list& other) {
         if (!other.empty()) {
             transfer(position._const_cast(), other.begin(), other.end());
         }
     }
 
-    template <class T>
-    void list<T>::splice(const_iterator position, list& other, const_iterator it) {
-        iterator next = it;
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator position, list& other, const_iterator it) {
+        iterator next = it._const_cast();
         ++next;
         if (position == it || position == next) return;
-        transfer(position._const_cast(), it, next);
+        transfer(position._const_cast(), it._const_cast(), next);
     }
 
-    template <class T>
-    void list<T>::splice(const_iterator position, list& other, const_iterator first,
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator position, list& other, const_iterator first,
                          const_iterator last) {
         if (first != last) {
-            transfer(position._const_cast(), first, last);
+            transfer(position._const_cast(), first._const_cast(), last._const_cast());
         }
     }
 
-    template <class T>
-    void list<T>::remove(const T& value) {
+    template <class T, class Alloc>
+    void list<T, Alloc>::remove(const T& value) {
         iterator first = begin();
         iterator last = end();
         while (first != last) {
@@ -576,9 +589,9 @@ namespace rayn {
         }
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class UnaryPredicate>
-    void list<T>::remove_if(UnaryPredicate p) {
+    void list<T, Alloc>::remove_if(UnaryPredicate p) {
         iterator first = begin();
         iterator last = end();
         while (first != last) {
@@ -590,8 +603,8 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::reverse() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::reverse() {
         if (node->next == node || node->next->next == node) {
             return;
         }
@@ -604,8 +617,8 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::unique() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::unique() {
         iterator first = begin();
         iterator last = end();
         if (first == last) return; // 
@@ -621,9 +634,9 @@ namespace rayn {
 
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class BinaryPredicate>
-    void list<T>::unique(BinaryPredicate p) {
+    void list<T, Alloc>::unique(BinaryPredicate p) {
         iterator first = begin();
         iterator last = end();
         if (first == last) return; // 
@@ -638,14 +651,14 @@ namespace rayn {
         }
     }
 
-    template <class T>
-    void list<T>::sort() {
+    template <class T, class Alloc>
+    void list<T, Alloc>::sort() {
         // size = 0 or size = 1, 
         if (node->next == node || node->next->next == node) {
             return;
         }
-        list<T> carry;
-        list<T> counter[64];
+        list<T, Alloc> carry;
+        list<T, Alloc> counter[64];
         int fill = 0;
         while (!empty()) {
             carry.splice(carry.begin(), *this, begin());
@@ -660,18 +673,19 @@ namespace rayn {
         for (int i = 1; i < fill; ++i) {
             counter[i].merge(counter[i - 1]);
         }
-        this->swap(counter[fill - 1]);
+        // ڵر, Եڱڵ, end()Ч
+        splice(end(), counter[fill - 1]);
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class Compare>
-    void list<T>::sort(Compare comp) {
+    void list<T, Alloc>::sort(Compare comp) {
         // size = 0 or size = 1, 
         if (node->next == node || node->next->next == node) {
             return;
         }
-        list<T> carry;
-        list<T> counter[64];
+        list<T, Alloc> carry;
+        list<T, Alloc> counter[64];
         int fill = 0;
         while (!empty()) {
             carry.splice(carry.begin(), *this, begin());
@@ -684,14 +698,15 @@ namespace rayn {
             if (i == fill) ++fill;
         }
         for (int i = 1; i < fill; ++i) {
-            counter[i].merge(counter[i - 1]);
+            counter[i].merge(counter[i - 1], comp);
         }
-        this->swap(counter[fill - 1]);
+        // ڵر, Եڱڵ, end()Ч
+        splice(end(), counter[fill - 1]);
     }
 
-    template <class T>
-    inline bool operator== (list<T>& lhs, list<T>& rhs) {
-        typedef typename list<T>::const_iterator const_iterator;
+    template <class T, class Alloc>
+    inline bool operator== (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
+        typedef typename list<T, Alloc>::const_iterator const_iterator;
         const_iterator first1 = lhs.begin(), end1 = lhs.end();
         const_iterator first2 = rhs.begin(), end2 = rhs.end();
         while (first1 != end1 && first2 != end2 && *first1 == *first2) {
@@ -700,14 +715,14 @@ namespace rayn {
         return first1 == end1 && first2 == end2;
     }
 
-    template <class T>
-    inline bool operator!= (list<T>& lhs, list<T>& rhs) {
+    template <class T, class Alloc>
+    inline bool operator!= (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
         return !(lhs == rhs);
     }
 
-    template <class T>
-    inline bool operator< (list<T>& lhs, list<T>& rhs) {
-        typedef typename list<T>::const_iterator const_iterator;
+    template <class T, class Alloc>
+    inline bool operator< (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
+        typedef typename list<T, Alloc>::const_iterator const_iterator;
         const_iterator first1 = lhs.begin(), end1 = lhs.end();
         const_iterator first2 = rhs.begin(), end2 = rhs.end();
         while (first1 != end1) {
@@ -721,23 +736,23 @@ namespace rayn {
         return first2 != end2;
     }
 
-    template <class T>
-    inline bool operator<= (list<T>& lhs, list<T>& rhs) {
+    template <class T, class Alloc>
+    inline bool operator<= (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
         return !(rhs < lhs);
     }
 
-    template <class T>
-    inline bool operator> (list<T>& lhs, list<T>& rhs) {
+    template <class T, class Alloc>
+    inline bool operator> (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
         return rhs < lhs;
     }
 
-    template <class T>
-    inline bool operator>= (list<T>& lhs, list<T>& rhs) {
+    template <class T, class Alloc>
+    inline bool operator>= (list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
         return !(lhs < rhs);
     }
 
-    template <class T>
-    inline void swap(list<T>& lhs, list<T>& rhs) {
+    template <class T, class Alloc>
+    inline void swap(list<T, Alloc>& lhs, list<T, Alloc>& rhs) {
         lhs.swap(rhs);
     }
 }
@@ -10,7 +10,9 @@
 
 namespace rayn {
 
-    template <class Key, class T, class Compare = rayn::less<Key>>
+    template <class Key, class T, class Compare = rayn::less<Key>,
+              class Alloc = allocator<pair<const Key, T>>,
+              class Augment = rb_tree_no_augment>
     class map {
     public:
         // public typedefs
@@ -22,7 +24,7 @@ namespace rayn {
         class value_compare
         : public binary_function < value_type, value_type, bool >
         {
-            friend class map<Key, T, Compare>;
+            friend class map<Key, T, Compare, Alloc, Augment>;
 
         protected:
             Compare comp;
@@ -37,7 +39,7 @@ namespace rayn {
 
     private:
         typedef rb_tree<key_type, value_type, select1st<value_type>,
-                        key_compare>    _rep_type;
+                        key_compare, Alloc, Augment>    _rep_type;
 
         _rep_type   _m_tree;
 
@@ -53,12 +55,21 @@ namespace rayn {
         typedef typename _rep_type::const_reverse_iterator  const_reverse_iterator;
         typedef typename _rep_type::size_type               size_type;
         typedef typename _rep_type::difference_type         difference_type;
+        typedef typename _rep_type::summary_type            summary_type;
+        typedef Alloc                                       allocator_type;
+        typedef __rb_tree_map_node_handle<Key, T, Alloc, Augment>  node_type;
+        typedef __rb_tree_insert_return<iterator, node_type>       insert_return_type;
 
         // constructor/destructor
         map() : _m_tree() {}
 
         explicit
-        map(const Compare& comp) : _m_tree(comp) {}
+        map(const Compare& comp,
+            const allocator_type& a = allocator_type())
+        : _m_tree(comp, a) {}
+
+        explicit
+        map(const allocator_type& a) : _m_tree(Compare(), a) {}
 
         template <typename InputIterator>
         map(InputIterator first, InputIterator last) : _m_tree()
@@ -67,8 +78,9 @@ namespace rayn {
         }
 
         template <typename InputIterator>
-        map(InputIterator first, InputIterator last, const Compare& comp)
-            : _m_tree(comp)
+        map(InputIterator first, InputIterator last, const Compare& comp,
+            const allocator_type& a = allocator_type())
+            : _m_tree(comp, a)
         {
             _m_tree.insert_unique(first, last);
         }
@@ -82,6 +94,23 @@ namespace rayn {
             return *this;
         }
 
+        /*
+        ** @brief   Bulk load a map from [first, last), which must already be
+        **          sorted by key_comp() without duplicates. Nothing is
+        **          compared, so unsorted input yields a broken map.
+        ** @complexity  O(N)
+        */
+        template <typename ForwardIterator>
+        static map
+        from_sorted_unique(ForwardIterator first, ForwardIterator last,
+                           const Compare& comp = Compare(),
+                           const allocator_type& a = allocator_type())
+        {
+            map ret(comp, a);
+            ret._m_tree.assign_sorted(first, last);
+            return ret;
+        }
+
         // Iterators
         iterator
         begin()
@@ -142,7 +171,7 @@ namespace rayn {
         {
             iterator it = lower_bound(k);
             if (it == end() || key_comp()(k, it->first)) {
-                it = insert(value_type(k, mapped_type()));
+                it = insert(it, value_type(k, mapped_type()));
             }
             return it->second;
         }
@@ -176,6 +205,29 @@ namespace rayn {
             return pair<iterator, bool>(ret.first, ret.second);
         }
 
+        // amortized O(1) when val belongs right next to hint
+        iterator
+        insert(const_iterator hint, const value_type& val)
+        {
+            return _m_tree.insert_unique(hint, val);
+        }
+
+        // relink an extracted node, nothing is allocated. When the key is
+        // already present the node stays in the returned handle.
+        insert_return_type
+        insert(node_type&& nh)
+        {
+            pair<typename _rep_type::iterator, bool> ret =
+                _m_tree.insert_unique(rayn::move(nh));
+            return insert_return_type(ret.first, ret.second, rayn::move(nh));
+        }
+
+        iterator
+        insert(const_iterator hint, node_type&& nh)
+        {
+            return _m_tree.insert_unique(hint, rayn::move(nh));
+        }
+
         template <class InputIterator>
         void
         insert(InputIterator first, InputIterator last)
@@ -201,9 +253,42 @@ namespace rayn {
             return _m_tree.erase(first, last);
         }
 
+        /*
+        ** @brief   Unlink an element and return the node that holds it, so
+        **          it can be changed and inserted again without freeing or
+        **          allocating. The handle is empty when k is not found.
+        */
+        node_type
+        extract(const_iterator pos)
+        { return node_type(_m_tree.extract(pos)); }
+
+        node_type
+        extract(const key_type& k)
+        { return node_type(_m_tree.extract(k)); }
+
         void
         swap(map& x) { _m_tree.swap(x._m_tree); }
 
+        /*
+        ** @brief   Move the elements of other whose key is not in *this,
+        **          relinking nodes instead of copying them.
+        */
+        void
+        merge(map& other) { _m_tree.merge_unique(other._m_tree); }
+
+        // Set algebra by split and join, O(M log(N/M + 1)). union_with
+        // moves the elements it needs out of other, which keeps only the
+        // keys *this already had; intersect_with and difference_with leave
+        // other as it was and destroy what they remove from *this.
+        void
+        union_with(map& other) { _m_tree.union_unique(other._m_tree); }
+
+        void
+        intersect_with(map& other) { _m_tree.intersect_unique(other._m_tree); }
+
+        void
+        difference_with(map& other) { _m_tree.difference_unique(other._m_tree); }
+
         void
         clear() { _m_tree.clear(); }
 
@@ -216,6 +301,10 @@ namespace rayn {
         value_comp() const
         { return value_compare(_m_tree.key_comp()); }
 
+        allocator_type
+        get_allocator() const
+        { return _m_tree.get_allocator(); }
+
         // Operations
         iterator
         find(const key_type& k) { return _m_tree.find(k); }
@@ -265,61 +354,153 @@ namespace rayn {
             return _m_tree.equal_range(k);
         }
 
+        // heterogeneous lookup, only when key_compare::is_transparent exists
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        find(const KT& k)
+        {
+            return _m_tree.find(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        find(const KT& k) const
+        {
+            return _m_tree.find(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, size_type>::type
+        count(const KT& k) const
+        {
+            return _m_tree.count(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        lower_bound(const KT& k)
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        lower_bound(const KT& k) const
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        upper_bound(const KT& k)
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        upper_bound(const KT& k) const
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<iterator, iterator> >::type
+        equal_range(const KT& k)
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<const_iterator, const_iterator> >::type
+        equal_range(const KT& k) const
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        // order statistics, Augment = rb_tree_order_statistics only
+        iterator
+        nth(size_type k)
+        { return _m_tree.nth(k); }
+
+        const_iterator
+        nth(size_type k) const
+        { return _m_tree.nth(k); }
+
+        size_type
+        rank(const key_type& k) const
+        { return _m_tree.rank(k); }
+
+        size_type
+        index_of(const_iterator pos) const
+        { return _m_tree.index_of(pos); }
+
+        difference_type
+        distance(const_iterator first, const_iterator last) const
+        { return _m_tree.distance(first, last); }
+
+        // Augment = rb_tree_summary<S> or rb_tree_order_statistics only
+        summary_type
+        range_aggregate(const key_type& lo, const key_type& hi) const
+        { return _m_tree.range_aggregate(lo, hi); }
+
         // friend functions
-        template <class Key2, class T2, class Compare2>
+        template <class Key2, class T2, class Compare2, class Alloc2, class Augment2>
         friend bool
-        operator==(const map<Key2, T2, Compare2>&, const map<Key2, T2, Compare2>&);
+        operator==(const map<Key2, T2, Compare2, Alloc2, Augment2>&, const map<Key2, T2, Compare2, Alloc2, Augment2>&);
 
-        template <class Key2, class T2, class Compare2>
+        template <class Key2, class T2, class Compare2, class Alloc2, class Augment2>
         friend bool
-        operator<(const map<Key2, T2, Compare2>&, const map<Key2, T2, Compare2>&);
+        operator<(const map<Key2, T2, Compare2, Alloc2, Augment2>&, const map<Key2, T2, Compare2, Alloc2, Augment2>&);
     };
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator==(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator==(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return x._m_tree == y._m_tree;
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator!=(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator!=(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return !(x == y);
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator<(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator<(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return x._m_tree < y._m_tree;
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator>(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator>(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return y < x;
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator<=(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator<=(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return !(y < x);
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator>=(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    operator>=(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         return !(x < y);
     }
 
-    template <class Key, class T, class Compare>
+    template <class Key, class T, class Compare, class Alloc, class Augment>
     inline void
-    swap(const map<Key, T, Compare>& x, const map<Key, T, Compare>& y)
+    swap(const map<Key, T, Compare, Alloc, Augment>& x, const map<Key, T, Compare, Alloc, Augment>& y)
     {
         x.swap(y);
     }
@@ -0,0 +1,270 @@
+/*
+** MemoryResource.cpp
+** Created by Rayn on 2026/10/17
+*/
+#include "MemoryResource.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace rayn {
+
+    namespace {
+        size_t align_up(size_t n, size_t alignment) {
+            return (n + alignment - 1) & ~(alignment - 1);
+        }
+
+        // memory_resource on top of rayn::alloc
+        class alloc_memory_resource : public memory_resource {
+        protected:
+            virtual void *do_allocate(size_t bytes, size_t alignment) {
+                if (alignment <= EDefaultAlign::DEFAULT_ALIGN) {
+                    return alloc::allocate(bytes);
+                }
+                // over-aligned: keep the raw pointer just before the aligned block
+                char *raw = static_cast<char *>(alloc::allocate(bytes + alignment));
+                char *p = raw + alignment - (reinterpret_cast<size_t>(raw) & (alignment - 1));
+                reinterpret_cast<char **>(p)[-1] = raw;
+                return p;
+            }
+            virtual void do_deallocate(void *p, size_t bytes, size_t alignment) {
+                if (alignment <= EDefaultAlign::DEFAULT_ALIGN) {
+                    alloc::deallocate(p, bytes);
+                } else {
+                    alloc::deallocate(reinterpret_cast<char **>(p)[-1], bytes + alignment);
+                }
+            }
+            virtual bool do_is_equal(const memory_resource& other) const {
+                return dynamic_cast<const alloc_memory_resource *>(&other) != 0;
+            }
+        };
+
+        std::atomic<memory_resource *> default_resource;
+
+        // v120 has no thread-safe function-local statics, call_once builds the resource
+        std::once_flag alloc_resource_once;
+        alloc_memory_resource *alloc_resource_instance = 0;
+
+        void create_alloc_resource() {
+            // never destroyed, containers may outlive static destruction
+            alloc_resource_instance = new alloc_memory_resource;
+        }
+    }
+
+    memory_resource *alloc_resource() {
+        std::call_once(alloc_resource_once, &create_alloc_resource);
+        return alloc_resource_instance;
+    }
+
+    memory_resource *get_default_resource() {
+        memory_resource *r = default_resource.load();
+        return r ? r : alloc_resource();
+    }
+
+    memory_resource *set_default_resource(memory_resource *r) {
+        memory_resource *old = default_resource.exchange(r);
+        return old ? old : alloc_resource();
+    }
+
+    // monotonic_buffer_resource
+    monotonic_buffer_resource::monotonic_buffer_resource(memory_resource *upstream)
+        : _upstream(upstream), _chunks(0), _current(0), _left(0), _nextSize(1024),
+          _initialBuffer(0), _initialSize(0) {}
+
+    monotonic_buffer_resource::monotonic_buffer_resource(size_t initial_size, memory_resource *upstream)
+        : _upstream(upstream), _chunks(0), _current(0), _left(0),
+          _nextSize(initial_size ? initial_size : 1), _initialBuffer(0), _initialSize(0) {}
+
+    monotonic_buffer_resource::monotonic_buffer_resource(void *buffer, size_t buffer_size,
+                                                         memory_resource *upstream)
+        : _upstream(upstream), _chunks(0), _current(static_cast<char *>(buffer)), _left(buffer_size),
+          _nextSize(buffer_size ? buffer_size * 2 : 1024), _initialBuffer(buffer), _initialSize(buffer_size) {}
+
+    monotonic_buffer_resource::~monotonic_buffer_resource() {
+        release();
+    }
+
+    void monotonic_buffer_resource::release() {
+        while (_chunks) {
+            chunk *c = _chunks;
+            _chunks = c->next;
+            _upstream->deallocate(c, c->bytes, c->alignment);
+        }
+        _current = static_cast<char *>(_initialBuffer);
+        _left = _initialSize;
+    }
+
+    void *monotonic_buffer_resource::do_allocate(size_t bytes, size_t alignment) {
+        size_t pad = (alignment - (reinterpret_cast<size_t>(_current) & (alignment - 1))) & (alignment - 1);
+        if (_current == 0 || pad + bytes > _left) {
+            // start a new buffer, large enough for this request
+            size_t header = align_up(sizeof(chunk), alignment);
+            size_t size = header + bytes;
+            if (size < _nextSize) {
+                size = _nextSize;
+            }
+            chunk *c = static_cast<chunk *>(_upstream->allocate(size, alignment));
+            c->next = _chunks;
+            c->bytes = size;
+            c->alignment = alignment;
+            _chunks = c;
+            _current = reinterpret_cast<char *>(c) + header;
+            _left = size - header;
+            _nextSize = size * 2;
+            pad = 0;
+        }
+        char *result = _current + pad;
+        _current = result + bytes;
+        _left -= pad + bytes;
+        return result;
+    }
+
+    void monotonic_buffer_resource::do_deallocate(void *, size_t, size_t) {
+        // memory is only given back by release()
+    }
+
+    bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const {
+        return this == &other;
+    }
+
+    // unsynchronized_pool_resource
+    unsynchronized_pool_resource::unsynchronized_pool_resource(memory_resource *upstream)
+        : _upstream(upstream), _chunks(0), _oversized(0) {
+        initialize(pool_options());
+    }
+
+    unsynchronized_pool_resource::unsynchronized_pool_resource(const pool_options& opts,
+                                                               memory_resource *upstream)
+        : _upstream(upstream), _chunks(0), _oversized(0) {
+        initialize(opts);
+    }
+
+    unsynchronized_pool_resource::~unsynchronized_pool_resource() {
+        release();
+    }
+
+    void unsynchronized_pool_resource::initialize(const pool_options& opts) {
+        _options = opts;
+        if (_options.max_blocks_per_chunk == 0) {
+            _options.max_blocks_per_chunk = 1024;
+        }
+        if (_options.largest_required_pool_block == 0) {
+            _options.largest_required_pool_block = 4096;
+        }
+        // round up to the nearest size class
+        size_t nclasses = 1;
+        size_t block = EMinBlock::MIN_BLOCK;
+        while (block < _options.largest_required_pool_block && nclasses < EMaxClasses::MAX_CLASSES) {
+            block <<= 1;
+            ++nclasses;
+        }
+        _options.largest_required_pool_block = block;
+        reset_pools();
+    }
+
+    void unsynchronized_pool_resource::reset_pools() {
+        size_t blocks = _options.max_blocks_per_chunk < 8 ? _options.max_blocks_per_chunk : 8;
+        for (size_t i = 0; i != EMaxClasses::MAX_CLASSES; ++i) {
+            _pools[i].free_list = 0;
+            _pools[i].next_blocks = blocks;
+        }
+    }
+
+    void unsynchronized_pool_resource::release() {
+        while (_chunks) {
+            deallocate_chunk(_chunks, _chunks + 1);
+        }
+        while (_oversized) {
+            deallocate_chunk(_oversized, _oversized + 1);
+        }
+        reset_pools();
+    }
+
+    size_t unsynchronized_pool_resource::class_index(size_t bytes) const {
+        size_t index = 0;
+        size_t block = EMinBlock::MIN_BLOCK;
+        while (block < bytes) {
+            block <<= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    size_t unsynchronized_pool_resource::header_size(size_t alignment) const {
+        return align_up(sizeof(chunk), alignment);
+    }
+
+    // the header sits right before the returned block, the padding in front
+    // of it keeps the block aligned
+    void *unsynchronized_pool_resource::allocate_chunk(chunk *&list, size_t bytes, size_t alignment) {
+        size_t header = header_size(alignment);
+        char *raw = static_cast<char *>(_upstream->allocate(header + bytes, alignment));
+        chunk *c = reinterpret_cast<chunk *>(raw + header) - 1;
+        c->prev = 0;
+        c->next = list;
+        c->bytes = header + bytes;
+        c->alignment = alignment;
+        if (list) {
+            list->prev = c;
+        }
+        list = c;
+        return c + 1;
+    }
+
+    void unsynchronized_pool_resource::deallocate_chunk(chunk *&list, void *p) {
+        chunk *c = static_cast<chunk *>(p) - 1;
+        size_t alignment = c->alignment;
+        if (c->prev) {
+            c->prev->next = c->next;
+        } else {
+            list = c->next;
+        }
+        if (c->next) {
+            c->next->prev = c->prev;
+        }
+        _upstream->deallocate(static_cast<char *>(p) - header_size(alignment), c->bytes, alignment);
+    }
+
+    void *unsynchronized_pool_resource::do_allocate(size_t bytes, size_t alignment) {
+        size_t size = bytes < alignment ? alignment : bytes;
+        if (size > _options.largest_required_pool_block || alignment > EChunkAlign::CHUNK_ALIGN) {
+            const size_t chunk_align = static_cast<size_t>(EChunkAlign::CHUNK_ALIGN);
+            return allocate_chunk(_oversized, bytes, alignment < chunk_align ? chunk_align : alignment);
+        }
+        size_t index = class_index(size);
+        pool& p = _pools[index];
+        if (!p.free_list) {
+            // carve a new chunk into blocks, chunks grow until max_blocks_per_chunk
+            size_t block = EMinBlock::MIN_BLOCK << index;
+            size_t n = p.next_blocks;
+            char *first = static_cast<char *>(allocate_chunk(_chunks, block * n, EChunkAlign::CHUNK_ALIGN));
+            for (size_t i = 0; i != n; ++i) {
+                free_block *b = reinterpret_cast<free_block *>(first + i * block);
+                b->next = p.free_list;
+                p.free_list = b;
+            }
+            if (p.next_blocks * 2 <= _options.max_blocks_per_chunk) {
+                p.next_blocks *= 2;
+            }
+        }
+        free_block *result = p.free_list;
+        p.free_list = result->next;
+        return result;
+    }
+
+    void unsynchronized_pool_resource::do_deallocate(void *p, size_t bytes, size_t alignment) {
+        size_t size = bytes < alignment ? alignment : bytes;
+        if (size > _options.largest_required_pool_block || alignment > EChunkAlign::CHUNK_ALIGN) {
+            deallocate_chunk(_oversized, p);
+            return;
+        }
+        free_block *b = static_cast<free_block *>(p);
+        pool& pl = _pools[class_index(size)];
+        b->next = pl.free_list;
+        pl.free_list = b;
+    }
+
+    bool unsynchronized_pool_resource::do_is_equal(const memory_resource& other) const {
+        return this == &other;
+    }
+}
\ No newline at end of file
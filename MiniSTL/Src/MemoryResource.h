@@ -0,0 +1,305 @@
+/*
+** MemoryResource.h
+** Created by Rayn on 2026/10/17
+** memory resources and polymorphic_allocator
+*/
+#ifndef _MEMORY_RESOURCE_H_
+#define _MEMORY_RESOURCE_H_
+
+#include "Alloc.h"
+#include "TypeTraits.h"
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <new>      // for placement new
+
+namespace rayn {
+
+    /*
+    ** Abstract interface of a source of raw memory.
+    ** Unlike alloc, a memory resource is an object, containers using
+    ** polymorphic_allocator keep a pointer to the resource they allocate from.
+    */
+    class memory_resource {
+    public:
+        enum EDefaultAlign{ DEFAULT_ALIGN = 8 };
+
+        virtual ~memory_resource() {}
+
+        void *allocate(size_t bytes, size_t alignment = DEFAULT_ALIGN) {
+            return do_allocate(bytes, alignment);
+        }
+        void deallocate(void *p, size_t bytes, size_t alignment = DEFAULT_ALIGN) {
+            do_deallocate(p, bytes, alignment);
+        }
+        bool is_equal(const memory_resource& other) const {
+            return do_is_equal(other);
+        }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+        virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+        virtual bool do_is_equal(const memory_resource& other) const = 0;
+    };
+
+    inline bool operator== (const memory_resource& lhs, const memory_resource& rhs) {
+        return &lhs == &rhs || lhs.is_equal(rhs);
+    }
+    inline bool operator!= (const memory_resource& lhs, const memory_resource& rhs) {
+        return !(lhs == rhs);
+    }
+
+    /*
+    ** @brief   The resource backed by rayn::alloc, never destroyed.
+    */
+    memory_resource *alloc_resource();
+    /*
+    ** @brief   The resource used by default constructed polymorphic_allocator.
+    ** alloc_resource() unless changed by set_default_resource.
+    */
+    memory_resource *get_default_resource();
+    /*
+    ** @brief   Replace the default resource, null restores alloc_resource().
+    ** @return  The previous default resource.
+    */
+    memory_resource *set_default_resource(memory_resource *r);
+
+    /*
+    ** A monotonic arena: allocation bumps a pointer inside the current buffer,
+    ** deallocation does nothing, and all memory is given back at once by
+    ** release() or the destructor. Buffers obtained from the upstream
+    ** resource grow geometrically.
+    */
+    class monotonic_buffer_resource : public memory_resource {
+    public:
+        explicit monotonic_buffer_resource(memory_resource *upstream = get_default_resource());
+        explicit monotonic_buffer_resource(size_t initial_size,
+                                           memory_resource *upstream = get_default_resource());
+        // Use [buffer, buffer + buffer_size) first, it is never released to upstream.
+        monotonic_buffer_resource(void *buffer, size_t buffer_size,
+                                  memory_resource *upstream = get_default_resource());
+        ~monotonic_buffer_resource();
+
+        /*
+        ** @brief   Release all memory obtained from upstream, the initial
+        **          buffer is reused by later allocations.
+        */
+        void release();
+        memory_resource *upstream_resource() const { return _upstream; }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t alignment);
+        virtual void do_deallocate(void *p, size_t bytes, size_t alignment);
+        virtual bool do_is_equal(const memory_resource& other) const;
+
+    private:
+        monotonic_buffer_resource(const monotonic_buffer_resource&);
+        monotonic_buffer_resource& operator= (const monotonic_buffer_resource&);
+
+        // header of each buffer from upstream
+        struct chunk {
+            chunk  *next;
+            size_t  bytes;
+            size_t  alignment;
+        };
+
+        memory_resource    *_upstream;
+        chunk              *_chunks;
+        char               *_current;
+        size_t              _left;
+        size_t              _nextSize;
+        void               *_initialBuffer;
+        size_t              _initialSize;
+    };
+
+    // Tuning knobs of the pool resources, 0 means the default.
+    struct pool_options {
+        size_t max_blocks_per_chunk;
+        size_t largest_required_pool_block;
+
+        pool_options() : max_blocks_per_chunk(0), largest_required_pool_block(0) {}
+    };
+
+    /*
+    ** A pool resource without locking: blocks up to largest_required_pool_block
+    ** bytes come from power-of-two size classes carved out of upstream chunks,
+    ** larger blocks go straight to upstream. release() or the destructor
+    ** gives everything back, whether deallocated or not.
+    */
+    class unsynchronized_pool_resource : public memory_resource {
+    public:
+        explicit unsynchronized_pool_resource(memory_resource *upstream = get_default_resource());
+        explicit unsynchronized_pool_resource(const pool_options& opts,
+                                              memory_resource *upstream = get_default_resource());
+        ~unsynchronized_pool_resource();
+
+        void release();
+        memory_resource *upstream_resource() const { return _upstream; }
+        pool_options options() const { return _options; }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t alignment);
+        virtual void do_deallocate(void *p, size_t bytes, size_t alignment);
+        virtual bool do_is_equal(const memory_resource& other) const;
+
+    private:
+        unsynchronized_pool_resource(const unsynchronized_pool_resource&);
+        unsynchronized_pool_resource& operator= (const unsynchronized_pool_resource&);
+
+        enum EMinBlock{ MIN_BLOCK = 8 };
+        enum EMaxClasses{ MAX_CLASSES = 24 };   // MIN_BLOCK << 23 is large enough
+        enum EChunkAlign{ CHUNK_ALIGN = 16 };   // alignment of pooled blocks
+
+        union free_block {
+            free_block *next;
+        };
+        // header in front of each chunk or oversized block from upstream
+        struct chunk {
+            chunk  *prev;
+            chunk  *next;
+            size_t  bytes;
+            size_t  alignment;
+        };
+        struct pool {
+            free_block *free_list;
+            size_t      next_blocks;    // blocks in the next chunk
+        };
+
+        void initialize(const pool_options& opts);
+        void reset_pools();
+        size_t class_index(size_t bytes) const;
+        size_t header_size(size_t alignment) const;
+        void *allocate_chunk(chunk *&list, size_t bytes, size_t alignment);
+        void deallocate_chunk(chunk *&list, void *p);
+
+        memory_resource    *_upstream;
+        pool_options        _options;
+        pool                _pools[EMaxClasses::MAX_CLASSES];
+        chunk              *_chunks;    // chunks carved into pooled blocks
+        chunk              *_oversized; // blocks bigger than the largest pool
+    };
+
+    /*
+    ** The same as unsynchronized_pool_resource, every operation holds a mutex
+    ** so that one resource can be shared between threads.
+    */
+    class synchronized_pool_resource : public memory_resource {
+    public:
+        explicit synchronized_pool_resource(memory_resource *upstream = get_default_resource())
+            : _pool(upstream) {}
+        explicit synchronized_pool_resource(const pool_options& opts,
+                                            memory_resource *upstream = get_default_resource())
+            : _pool(opts, upstream) {}
+
+        void release() {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _pool.release();
+        }
+        memory_resource *upstream_resource() const { return _pool.upstream_resource(); }
+        pool_options options() const { return _pool.options(); }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t alignment) {
+            std::lock_guard<std::mutex> guard(_mutex);
+            return _pool.allocate(bytes, alignment);
+        }
+        virtual void do_deallocate(void *p, size_t bytes, size_t alignment) {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _pool.deallocate(p, bytes, alignment);
+        }
+        virtual bool do_is_equal(const memory_resource& other) const {
+            return this == &other;
+        }
+
+    private:
+        synchronized_pool_resource(const synchronized_pool_resource&);
+        synchronized_pool_resource& operator= (const synchronized_pool_resource&);
+
+        std::mutex                      _mutex;
+        unsynchronized_pool_resource    _pool;
+    };
+
+    /*
+    ** A stateful allocator holding a memory_resource pointer, usable by every
+    ** rayn container. Copies of a container and memory moved between
+    ** containers keep allocating from the same resource.
+    */
+    template <class T>
+    class polymorphic_allocator {
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef const T*    const_pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        template <class U>
+        struct rebind {
+            typedef polymorphic_allocator<U> other;
+        };
+
+    public:
+        polymorphic_allocator() : _resource(get_default_resource()) {}
+        polymorphic_allocator(memory_resource *r) : _resource(r) {}
+        template <class U>
+        polymorphic_allocator(const polymorphic_allocator<U>& other) : _resource(other.resource()) {}
+
+        T *allocate() {
+            return allocate(1);
+        }
+        T *allocate(size_t n) {
+            if (n == 0) return 0;
+            return static_cast<T *>(_resource->allocate(sizeof(T) * n, alignment_of<T>::value));
+        }
+        void deallocate(T *ptr) {
+            deallocate(ptr, 1);
+        }
+        void deallocate(T *ptr, size_t n) {
+            if (n == 0) return;
+            _resource->deallocate(ptr, sizeof(T) * n, alignment_of<T>::value);
+        }
+        // Resources can't grow a block, allocate and copy the bytes.
+        T *reallocate(T *ptr, size_t old_n, size_t new_n) {
+            T *result = allocate(new_n);
+            if (ptr && result) {
+                memcpy(result, ptr, sizeof(T) * (old_n < new_n ? old_n : new_n));
+            }
+            deallocate(ptr, old_n);
+            return result;
+        }
+
+        static void construct(T *ptr) {
+            new(ptr) T();
+        }
+        static void construct(T *ptr, const T& value) {
+            new(ptr) T(value);
+        }
+        static void destroy(T *ptr) {
+            ptr->~T();
+        }
+        static void destroy(T *first, T *last) {
+            for (; first != last; ++first) {
+                first->~T();
+            }
+        }
+
+        memory_resource *resource() const { return _resource; }
+
+    private:
+        memory_resource *_resource;
+    };
+
+    template <class T1, class T2>
+    inline bool operator== (const polymorphic_allocator<T1>& lhs, const polymorphic_allocator<T2>& rhs) {
+        return *lhs.resource() == *rhs.resource();
+    }
+    template <class T1, class T2>
+    inline bool operator!= (const polymorphic_allocator<T1>& lhs, const polymorphic_allocator<T2>& rhs) {
+        return !(lhs == rhs);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -7,6 +7,15 @@
 
 #include "TypeTraits.h"
 
+#include <type_traits>
+
+// Visual Studio 2013 does not support noexcept yet.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define RAYN_NOEXCEPT throw()
+#else
+#define RAYN_NOEXCEPT noexcept
+#endif
+
 namespace rayn {
 
     // forward
@@ -27,6 +36,19 @@ namespace rayn {
         return static_cast<typename remove_reference<T>::type&&>(arg);
     }
 
+    // move_if_noexcept
+    // Moving is safe when it can't throw, or when T can't be copied anyway.
+    template <typename T>
+    struct __move_is_safe
+        : public std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value
+                                              || !std::is_copy_constructible<T>::value> {};
+
+    template <typename T>
+    typename conditional<__move_is_safe<T>::value, T&&, const T&>::type
+    move_if_noexcept(T& arg) {
+        return rayn::move(arg);
+    }
+
     // swap with move
     template <class T>
     inline void swap(T& a, T& b) {
@@ -10,7 +10,9 @@
 
 namespace rayn {
 
-    template <class T, class Compare = rayn::less<T>>
+    template <class T, class Compare = rayn::less<T>,
+              class Alloc = allocator<T>,
+              class Augment = rb_tree_no_augment>
     class multiset {
     public:
         // public typedefs
@@ -21,7 +23,7 @@ namespace rayn {
 
     private:
         typedef rb_tree<key_type, value_type, identity<value_type>,
-            key_compare>    _rep_type;
+            key_compare, Alloc, Augment>    _rep_type;
 
         _rep_type   _m_tree;
 
@@ -37,12 +39,20 @@ namespace rayn {
         typedef typename _rep_type::const_reverse_iterator  const_reverse_iterator;
         typedef typename _rep_type::size_type               size_type;
         typedef typename _rep_type::difference_type         difference_type;
+        typedef typename _rep_type::summary_type            summary_type;
+        typedef Alloc                                       allocator_type;
+        typedef __rb_tree_set_node_handle<T, Alloc, Augment>       node_type;
 
         // constructor/destructor
         multiset() : _m_tree() {}
 
         explicit
-        multiset(const Compare& comp) : _m_tree(comp) {}
+        multiset(const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_tree(comp, a) {}
+
+        explicit
+        multiset(const allocator_type& a) : _m_tree(Compare(), a) {}
 
         template <typename InputIterator>
         multiset(InputIterator first, InputIterator last) : _m_tree()
@@ -51,8 +61,9 @@ namespace rayn {
         }
 
         template <typename InputIterator>
-        multiset(InputIterator first, InputIterator last, const Compare& comp)
-        : _m_tree(comp)
+        multiset(InputIterator first, InputIterator last, const Compare& comp,
+                 const allocator_type& a = allocator_type())
+        : _m_tree(comp, a)
         {
             _m_tree.insert_equal(first, last);
         }
@@ -145,12 +156,30 @@ namespace rayn {
         size_type   max_size() const    { return _m_tree.max_size(); }
 
         // Modifiers
-        pair<iterator, bool>
+        iterator
         insert(const value_type& val)
         {
-            pair<typename _rep_type::iterator, bool> ret =
-                _m_tree.insert_equal(val);
-            return pair<iterator, bool>(ret.first, ret.second);
+            return _m_tree.insert_equal(val);
+        }
+
+        // amortized O(1) when val belongs right next to hint
+        iterator
+        insert(const_iterator hint, const value_type& val)
+        {
+            return _m_tree.insert_equal(hint, val);
+        }
+
+        // relink an extracted node, nothing is allocated
+        iterator
+        insert(node_type&& nh)
+        {
+            return _m_tree.insert_equal(rayn::move(nh));
+        }
+
+        iterator
+        insert(const_iterator hint, node_type&& nh)
+        {
+            return _m_tree.insert_equal(hint, rayn::move(nh));
         }
 
         template <class InputIterator>
@@ -178,15 +207,33 @@ namespace rayn {
             return _m_tree.erase(first, last);
         }
 
+        /*
+        ** @brief   Unlink an element and return the node that holds it, so
+        **          it can be changed and inserted again without freeing or
+        **          allocating. The handle is empty when k is not found.
+        */
+        node_type
+        extract(const_iterator pos)
+        { return node_type(_m_tree.extract(pos)); }
+
+        node_type
+        extract(const key_type& k)
+        { return node_type(_m_tree.extract(k)); }
+
         void
         swap(multiset& x) { _m_tree.swap(x._m_tree); }
 
+        // move all elements of other, relinking nodes instead of copying them
+        void
+        merge(multiset& other) { _m_tree.merge_equal(other._m_tree); }
+
         void
         clear() { _m_tree.clear(); }
 
         // Observers
         key_compare     key_comp() const    { return _m_tree.key_comp(); }
         value_compare   value_comp() const  { return _m_tree.key_comp(); }
+        allocator_type  get_allocator() const { return _m_tree.get_allocator(); }
 
         // Operations
         iterator
@@ -237,61 +284,153 @@ namespace rayn {
             return _m_tree.equal_range(k);
         }
 
+        // heterogeneous lookup, only when key_compare::is_transparent exists
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        find(const KT& k)
+        {
+            return _m_tree.find(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        find(const KT& k) const
+        {
+            return _m_tree.find(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, size_type>::type
+        count(const KT& k) const
+        {
+            return _m_tree.count(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        lower_bound(const KT& k)
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        lower_bound(const KT& k) const
+        {
+            return _m_tree.lower_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        upper_bound(const KT& k)
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        upper_bound(const KT& k) const
+        {
+            return _m_tree.upper_bound(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<iterator, iterator> >::type
+        equal_range(const KT& k)
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<const_iterator, const_iterator> >::type
+        equal_range(const KT& k) const
+        {
+            return _m_tree.equal_range(k);
+        }
+
+        // order statistics, Augment = rb_tree_order_statistics only
+        iterator
+        nth(size_type k)
+        { return _m_tree.nth(k); }
+
+        const_iterator
+        nth(size_type k) const
+        { return _m_tree.nth(k); }
+
+        size_type
+        rank(const key_type& k) const
+        { return _m_tree.rank(k); }
+
+        size_type
+        index_of(const_iterator pos) const
+        { return _m_tree.index_of(pos); }
+
+        difference_type
+        distance(const_iterator first, const_iterator last) const
+        { return _m_tree.distance(first, last); }
+
+        // Augment = rb_tree_summary<S> or rb_tree_order_statistics only
+        summary_type
+        range_aggregate(const key_type& lo, const key_type& hi) const
+        { return _m_tree.range_aggregate(lo, hi); }
+
         // friend functions
-        template <class T2, class Compare2>
+        template <class T2, class Compare2, class Alloc2, class Augment2>
         friend bool
-        operator==(const multiset<T2, Compare2>&, const multiset<T2, Compare2>&);
+        operator==(const multiset<T2, Compare2, Alloc2, Augment2>&, const multiset<T2, Compare2, Alloc2, Augment2>&);
 
-        template <class T2, class Compare2>
+        template <class T2, class Compare2, class Alloc2, class Augment2>
         friend bool
-        operator<(const multiset<T2, Compare2>&, const multiset<T2, Compare2>&);
+        operator<(const multiset<T2, Compare2, Alloc2, Augment2>&, const multiset<T2, Compare2, Alloc2, Augment2>&);
     };
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator==(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator==(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return x._m_tree == y._m_tree;
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator!=(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator!=(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return !(x == y);
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator<(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator<(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return x._m_tree < y._m_tree;
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator>(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator>(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return y < x;
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator<=(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator<=(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return !(y < x);
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline bool
-    operator>=(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    operator>=(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         return !(x < y);
     }
 
-    template <class T, class Compare>
+    template <class T, class Compare, class Alloc, class Augment>
     inline void
-    swap(const multiset<T, Compare>& x, const multiset<T, Compare>& y)
+    swap(const multiset<T, Compare, Alloc, Augment>& x, const multiset<T, Compare, Alloc, Augment>& y)
     {
         x.swap(y);
     }
@@ -18,7 +18,7 @@ namespace rayn {
 
     template < class T1, class T2 >
     class pair {
-    protected:
+    public:
         typedef T1      first_type;
         typedef T2      second_type;
 
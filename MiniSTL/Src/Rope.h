@@ -0,0 +1,541 @@
+/*
+** Rope.h
+** Created by Rayn on 2026/10/17
+** rope: a string made of shared immutable chunks, for building large text
+*/
+#ifndef _ROPE_H_
+#define _ROPE_H_
+
+#include "Allocator.h"
+#include "Construct.h"
+#include "Move.h"
+#include "String.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace rayn {
+
+    /*
+    ** A node of rope. Leaves (height 0) hold characters, concat nodes join
+    ** two subtrees whose heights differ by at most one. A node is never
+    ** changed once it is shared, so ropes copy in O(1) and share all nodes.
+    */
+    template <class CharT>
+    struct __rope_node {
+        std::atomic<size_t>     refs;
+        size_t                  size;
+        int                     height;
+        __rope_node            *left;
+        __rope_node            *right;
+        // leaf only: chars points into the buffer of base, or into its own
+        // buffer of capacity characters when base is null
+        CharT                  *chars;
+        size_t                  capacity;
+        __rope_node            *base;
+    };
+
+    /*
+    ** Concatenation, substr, insert and erase are O(log n) joins and splits
+    ** of an AVL balanced tree, substr never copies characters. Appending to
+    ** a rope that shares nothing fills its last leaf in place. The characters
+    ** are only gathered into one basic_string by str().
+    */
+    template <class CharT, class Alloc = allocator<CharT> >
+    class rope {
+    protected:
+        typedef __rope_node<CharT>                                  rope_node;
+        typedef typename Alloc::template rebind<rope_node>::other   node_allocator;
+
+    public:
+        typedef CharT                       value_type;
+        typedef size_t                      size_type;
+        typedef ptrdiff_t                   difference_type;
+        typedef Alloc                       allocator_type;
+        typedef basic_string<CharT, Alloc>  string_type;
+
+        static const size_type npos = static_cast<size_type>(-1);
+
+    private:
+        // characters held by a leaf built from raw data
+        enum ELeafSize{ LEAF_SIZE = 512 };
+
+    public:
+        rope() : root(0) {}
+        explicit rope(const allocator_type& a) : root(0), node_alloc(a), data_alloc(a) {}
+        rope(const CharT *cstr, const allocator_type& a = allocator_type())
+            : root(0), node_alloc(a), data_alloc(a) {
+            root = build(cstr, char_length(cstr));
+        }
+        rope(const CharT *s, size_type n, const allocator_type& a = allocator_type())
+            : root(0), node_alloc(a), data_alloc(a) {
+            root = build(s, n);
+        }
+        rope(size_type n, CharT ch, const allocator_type& a = allocator_type())
+            : root(0), node_alloc(a), data_alloc(a) {
+            string_type tmp(a);
+            tmp.append(n, ch);
+            root = build(tmp.data(), n);
+        }
+        rope(const string_type& str) : root(0), node_alloc(str.get_allocator()), data_alloc(str.get_allocator()) {
+            root = build(str.data(), str.size());
+        }
+        rope(const rope& other) : root(ref(other.root)), node_alloc(other.node_alloc), data_alloc(other.data_alloc) {}
+        rope(rope&& other) : root(other.root), node_alloc(other.node_alloc), data_alloc(other.data_alloc) {
+            other.root = 0;
+        }
+        ~rope() {
+            unref(root);
+        }
+
+        rope& operator= (const rope& other) {
+            if (this != &other) {
+                rope_node *tmp = share(other);
+                unref(root);
+                root = tmp;
+            }
+            return *this;
+        }
+        rope& operator= (rope&& other) {
+            swap(other);
+            return *this;
+        }
+        rope& operator= (const CharT *cstr) {
+            return assign(cstr, char_length(cstr));
+        }
+
+        rope& assign(const CharT *s, size_type n) {
+            rope_node *tmp = build(s, n);
+            unref(root);
+            root = tmp;
+            return *this;
+        }
+
+        allocator_type get_allocator() const { return data_alloc; }
+
+        // Capacity
+        size_type size() const { return root ? root->size : 0; }
+        size_type length() const { return size(); }
+        bool empty() const { return root == 0; }
+
+        // Element access, O(log n)
+        CharT operator[] (size_type pos) const {
+            const rope_node *t = root;
+            while (t->height != 0) {
+                if (pos < t->left->size) {
+                    t = t->left;
+                } else {
+                    pos -= t->left->size;
+                    t = t->right;
+                }
+            }
+            return t->chars[pos];
+        }
+        CharT at(size_type pos) const {
+            if (pos >= size()) {
+                throw std::out_of_range("rope::at");
+            }
+            return (*this)[pos];
+        }
+
+        // Modifiers
+        rope& append(const rope& other) {
+            root = join(root, share(other));
+            return *this;
+        }
+        rope& append(const CharT *s, size_type n) {
+            if (n != 0 && !append_in_place(s, n)) {
+                root = join(root, build(s, n));
+            }
+            return *this;
+        }
+        rope& append(const CharT *cstr) {
+            return append(cstr, char_length(cstr));
+        }
+        rope& append(const string_type& str) {
+            return append(str.data(), str.size());
+        }
+        rope& append(size_type n, CharT ch) {
+            return append(rope(n, ch, get_allocator()));
+        }
+        void push_back(CharT ch) {
+            append(&ch, 1);
+        }
+        rope& operator+= (const rope& other) { return append(other); }
+        rope& operator+= (const CharT *cstr) { return append(cstr); }
+        rope& operator+= (const string_type& str) { return append(str); }
+        rope& operator+= (CharT ch) {
+            push_back(ch);
+            return *this;
+        }
+
+        rope& insert(size_type pos, const rope& other) {
+            return replace(pos, 0, other);
+        }
+        rope& insert(size_type pos, const CharT *s, size_type n) {
+            return replace(pos, 0, rope(s, n, get_allocator()));
+        }
+        rope& insert(size_type pos, const CharT *cstr) {
+            return insert(pos, cstr, char_length(cstr));
+        }
+        rope& insert(size_type pos, const string_type& str) {
+            return insert(pos, str.data(), str.size());
+        }
+
+        rope& erase(size_type pos = 0, size_type len = npos) {
+            return replace(pos, len, rope(get_allocator()));
+        }
+
+        /*
+        ** @brief   Replace [pos, pos + len) by other, len is clamped to size().
+        ** Both ends are split off and joined back around other, O(log n).
+        */
+        rope& replace(size_type pos, size_type len, const rope& other) {
+            if (pos > size()) {
+                throw std::out_of_range("rope::replace");
+            }
+            if (len > size() - pos) {
+                len = size() - pos;
+            }
+            rope_node *mid = share(other);
+            rope_node *left, *rest, *cut, *right;
+            split(root, pos, left, rest);
+            split(rest, len, cut, right);
+            unref(rest);
+            unref(cut);
+            unref(root);
+            root = join(join(left, mid), right);
+            return *this;
+        }
+        rope& replace(size_type pos, size_type len, const CharT *cstr) {
+            return replace(pos, len, rope(cstr, get_allocator()));
+        }
+        rope& replace(size_type pos, size_type len, const string_type& str) {
+            return replace(pos, len, rope(str.data(), str.size(), get_allocator()));
+        }
+
+        void clear() {
+            unref(root);
+            root = 0;
+        }
+        void swap(rope& other) {
+            rayn::swap(root, other.root);
+            rayn::swap(node_alloc, other.node_alloc);
+            rayn::swap(data_alloc, other.data_alloc);
+        }
+
+        // Operations
+        /*
+        ** @brief   The rope of [pos, pos + len), sharing the characters of *this.
+        */
+        rope substr(size_type pos = 0, size_type len = npos) const {
+            if (pos > size()) {
+                throw std::out_of_range("rope::substr");
+            }
+            if (len > size() - pos) {
+                len = size() - pos;
+            }
+            // result allocates the new nodes, *this stays const
+            rope result(get_allocator());
+            rope_node *rest, *right;
+            result.split(root, pos, right, rest);
+            result.unref(right);
+            result.split(rest, len, result.root, right);
+            result.unref(rest);
+            result.unref(right);
+            return result;
+        }
+
+        /*
+        ** @brief   Call f(const CharT *chars, size_type n) for every chunk of
+        **          [pos, pos + len) in order, without copying any character.
+        */
+        template <class Function>
+        void for_each_chunk(Function f, size_type pos = 0, size_type len = npos) const {
+            if (pos > size()) {
+                throw std::out_of_range("rope::for_each_chunk");
+            }
+            if (len > size() - pos) {
+                len = size() - pos;
+            }
+            if (len != 0) {
+                visit(root, pos, len, f);
+            }
+        }
+
+        size_type copy(CharT *dest, size_type len, size_type pos = 0) const {
+            if (pos > size()) {
+                throw std::out_of_range("rope::copy");
+            }
+            if (len > size() - pos) {
+                len = size() - pos;
+            }
+            for_each_chunk([&dest](const CharT *chars, size_type n) {
+                memcpy(dest, chars, n * sizeof(CharT));
+                dest += n;
+            }, pos, len);
+            return len;
+        }
+
+        /*
+        ** @brief   Flatten into one basic_string.
+        */
+        string_type str() const {
+            string_type result(get_allocator());
+            result.reserve(size());
+            for_each_chunk([&result](const CharT *chars, size_type n) {
+                result.append(chars, n);
+            });
+            return result;
+        }
+
+    private:
+        static size_type char_length(const CharT *cstr) {
+            const CharT *p = cstr;
+            while (*p != CharT()) {
+                ++p;
+            }
+            return p - cstr;
+        }
+
+        static rope_node *ref(rope_node *t) {
+            if (t) {
+                ++t->refs;
+            }
+            return t;
+        }
+        void unref(rope_node *t) {
+            if (t && --t->refs == 0) {
+                if (t->height != 0) {
+                    unref(t->left);
+                    unref(t->right);
+                } else if (t->base) {
+                    unref(t->base);
+                } else {
+                    data_alloc.deallocate(t->chars, t->capacity);
+                }
+                rayn::destroy(t);
+                node_alloc.deallocate(t);
+            }
+        }
+        // Nodes can be shared only if they are freed by an equal allocator.
+        rope_node *share(const rope& other) {
+            return data_alloc == other.data_alloc ? ref(other.root) : copy_tree(other.root);
+        }
+        rope_node *copy_tree(const rope_node *t) {
+            if (!t) {
+                return 0;
+            } else if (t->height == 0) {
+                return build(t->chars, t->size);
+            }
+            return make_concat(copy_tree(t->left), copy_tree(t->right));
+        }
+
+        rope_node *get_node() {
+            rope_node *p = node_alloc.allocate();
+            rayn::construct(p);
+            p->refs = 1;
+            p->left = p->right = p->base = 0;
+            p->chars = 0;
+            p->capacity = 0;
+            return p;
+        }
+        // n <= LEAF_SIZE
+        rope_node *make_leaf(const CharT *s, size_type n) {
+            rope_node *p = get_node();
+            p->size = n;
+            p->height = 0;
+            p->chars = data_alloc.allocate(LEAF_SIZE);
+            p->capacity = LEAF_SIZE;
+            memcpy(p->chars, s, n * sizeof(CharT));
+            return p;
+        }
+        // A leaf viewing [off, off + n) of leaf t.
+        rope_node *make_sub(rope_node *t, size_type off, size_type n) {
+            rope_node *p = get_node();
+            p->size = n;
+            p->height = 0;
+            p->chars = t->chars + off;
+            p->base = ref(t->base ? t->base : t);
+            return p;
+        }
+        // Takes over the references to l and r.
+        rope_node *make_concat(rope_node *l, rope_node *r) {
+            rope_node *p = get_node();
+            p->size = l->size + r->size;
+            p->height = (l->height > r->height ? l->height : r->height) + 1;
+            p->left = l;
+            p->right = r;
+            return p;
+        }
+
+        // A balanced tree of full leaves.
+        rope_node *build(const CharT *s, size_type n) {
+            if (n == 0) {
+                return 0;
+            } else if (n <= LEAF_SIZE) {
+                return make_leaf(s, n);
+            }
+            size_type half = (n + LEAF_SIZE - 1) / LEAF_SIZE / 2 * LEAF_SIZE;
+            return make_concat(build(s, half), build(s + half, n - half));
+        }
+
+        /*
+        ** @brief   Concat a and b whose heights differ by at most two, with a
+        **          single or double rotation. Takes over both references.
+        */
+        rope_node *balance(rope_node *a, rope_node *b) {
+            if (a->height > b->height + 1) {
+                rope_node *x = ref(a->left), *y = ref(a->right);
+                unref(a);
+                if (x->height >= y->height) {
+                    return make_concat(x, make_concat(y, b));
+                }
+                rope_node *y1 = ref(y->left), *y2 = ref(y->right);
+                unref(y);
+                return make_concat(make_concat(x, y1), make_concat(y2, b));
+            } else if (b->height > a->height + 1) {
+                rope_node *x = ref(b->left), *y = ref(b->right);
+                unref(b);
+                if (y->height >= x->height) {
+                    return make_concat(make_concat(a, x), y);
+                }
+                rope_node *x1 = ref(x->left), *x2 = ref(x->right);
+                unref(x);
+                return make_concat(make_concat(a, x1), make_concat(x2, y));
+            }
+            return make_concat(a, b);
+        }
+        /*
+        ** @brief   Concat l and r of any heights, O(|height(l) - height(r)|).
+        **          Takes over both references, either may be null.
+        ** Two small leaves are merged into one so that chunks don't shrink
+        ** to single characters.
+        */
+        rope_node *join(rope_node *l, rope_node *r) {
+            if (!l) {
+                return r;
+            } else if (!r) {
+                return l;
+            }
+            if (l->height == 0 && r->height == 0 && l->size + r->size <= LEAF_SIZE) {
+                rope_node *leaf = make_leaf(l->chars, l->size);
+                memcpy(leaf->chars + l->size, r->chars, r->size * sizeof(CharT));
+                leaf->size += r->size;
+                unref(l);
+                unref(r);
+                return leaf;
+            }
+            if (l->height > r->height + 1) {
+                rope_node *ll = ref(l->left), *lr = ref(l->right);
+                unref(l);
+                return balance(ll, join(lr, r));
+            } else if (r->height > l->height + 1) {
+                rope_node *rl = ref(r->left), *rr = ref(r->right);
+                unref(r);
+                return balance(join(l, rl), rr);
+            }
+            return make_concat(l, r);
+        }
+        /*
+        ** @brief   Split t into the first k characters and the rest, t is left
+        **          untouched and l, r are new references.
+        */
+        void split(rope_node *t, size_type k, rope_node *&l, rope_node *&r) {
+            if (!t || k == 0) {
+                l = 0;
+                r = ref(t);
+            } else if (k >= t->size) {
+                l = ref(t);
+                r = 0;
+            } else if (t->height == 0) {
+                l = make_sub(t, 0, k);
+                r = make_sub(t, k, t->size - k);
+            } else if (k <= t->left->size) {
+                rope_node *rest;
+                split(t->left, k, l, rest);
+                r = join(rest, ref(t->right));
+            } else {
+                rope_node *rest;
+                split(t->right, k - t->left->size, rest, r);
+                l = join(ref(t->left), rest);
+            }
+        }
+
+        /*
+        ** @brief   Copy [s, s + n) into the spare room of the last leaf when no
+        **          node on the way to it is shared.
+        ** @return  false if nothing was appended.
+        */
+        bool append_in_place(const CharT *s, size_type n) {
+            rope_node *t = root;
+            if (!t) {
+                return false;
+            }
+            for (; t->height != 0; t = t->right) {
+                if (t->refs != 1) {
+                    return false;
+                }
+            }
+            if (t->refs != 1 || t->base || t->capacity - t->size < n) {
+                return false;
+            }
+            memcpy(t->chars + t->size, s, n * sizeof(CharT));
+            for (t = root; t->height != 0; t = t->right) {
+                t->size += n;
+            }
+            t->size += n;
+            return true;
+        }
+
+        template <class Function>
+        static void visit(const rope_node *t, size_type pos, size_type len, Function& f) {
+            if (t->height == 0) {
+                f(static_cast<const CharT *>(t->chars + pos), len);
+                return;
+            }
+            size_type lsize = t->left->size;
+            if (pos < lsize) {
+                size_type n = len < lsize - pos ? len : lsize - pos;
+                visit(t->left, pos, n, f);
+                len -= n;
+                pos = 0;
+            } else {
+                pos -= lsize;
+            }
+            if (len != 0) {
+                visit(t->right, pos, len, f);
+            }
+        }
+
+    protected:
+        rope_node          *root;
+        node_allocator      node_alloc;
+        Alloc               data_alloc;
+    };
+
+    template <class CharT, class Alloc>
+    const typename rope<CharT, Alloc>::size_type rope<CharT, Alloc>::npos;
+
+    template <class CharT, class Alloc>
+    rope<CharT, Alloc> operator+ (const rope<CharT, Alloc>& lhs, const rope<CharT, Alloc>& rhs) {
+        rope<CharT, Alloc> result(lhs);
+        result.append(rhs);
+        return result;
+    }
+    template <class CharT, class Alloc>
+    rope<CharT, Alloc> operator+ (const rope<CharT, Alloc>& lhs, const CharT *rhs) {
+        rope<CharT, Alloc> result(lhs);
+        result.append(rhs);
+        return result;
+    }
+
+    template <class CharT, class Alloc>
+    void swap(rope<CharT, Alloc>& x, rope<CharT, Alloc>& y) {
+        x.swap(y);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,287 @@
+/*
+** Searcher.h
+** Created by Rayn on 2026/10/17
+** substring search used by basic_string, and searcher for repeated needles
+*/
+#ifndef _SEARCHER_H_
+#define _SEARCHER_H_
+
+#include "BitOps.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYN_SEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace rayn {
+
+    /*
+    ** The algorithm is picked by the length m of the needle:
+    **  m == 1              memchr (or a plain loop for wide characters)
+    **  m <= SHORT_NEEDLE   filter candidates by the first and the last
+    **                      character, 16 positions at a time with SSE2
+    **  longer              Boyer-Moore-Horspool
+    ** All of them return @c last when there is no match.
+    */
+    enum ESearchNeedle{ SHORT_NEEDLE = 32 };
+    // Horspool shift table, indexed by the low byte of a character.
+    enum ESearchTable{ SHIFT_TABLE_SIZE = 256 };
+
+    inline size_t _search_key(char ch) {
+        return static_cast<unsigned char>(ch);
+    }
+    template <class CharT>
+    inline size_t _search_key(CharT ch) {
+        return static_cast<size_t>(ch) & (SHIFT_TABLE_SIZE - 1);
+    }
+
+    template <class CharT>
+    inline bool _chars_equal(const CharT *a, const CharT *b, size_t n) {
+        for (; n != 0; --n, ++a, ++b) {
+            if (*a != *b) {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline bool _chars_equal(const char *a, const char *b, size_t n) {
+        // an empty view may hold a null pointer, which memcmp must not get
+        if (n == 0) {
+            return true;
+        }
+        return memcmp(a, b, n) == 0;
+    }
+
+    template <class CharT>
+    inline const CharT *_find_char(const CharT *first, const CharT *last, CharT ch) {
+        for (; first != last; ++first) {
+            if (*first == ch) {
+                return first;
+            }
+        }
+        return last;
+    }
+    inline const char *_find_char(const char *first, const char *last, char ch) {
+        if (first == last) {
+            return last;
+        }
+        const void *p = memchr(first, ch, last - first);
+        return p ? static_cast<const char *>(p) : last;
+    }
+
+    template <class CharT>
+    inline const CharT *_rfind_char(const CharT *first, const CharT *last, CharT ch) {
+        for (const CharT *cur = last; cur != first; ) {
+            if (*--cur == ch) {
+                return cur;
+            }
+        }
+        return last;
+    }
+
+    /*
+    ** @brief   Short needle (m >= 2): a position is only compared when its first
+    **          and last characters match the needle.
+    */
+    template <class CharT>
+    const CharT *_search_short(const CharT *first, const CharT *last, const CharT *needle, size_t m) {
+        const CharT *stop = last - m + 1;
+        for (; first != stop; ++first) {
+            first = _find_char(first, stop, needle[0]);
+            if (first == stop) {
+                break;
+            }
+            if (first[m - 1] == needle[m - 1] && _chars_equal(first + 1, needle + 1, m - 2)) {
+                return first;
+            }
+        }
+        return last;
+    }
+    inline const char *_search_short(const char *first, const char *last, const char *needle, size_t m) {
+        const char *stop = last - m + 1;
+#ifdef RAYN_SEARCH_SSE2
+        const __m128i head = _mm_set1_epi8(needle[0]);
+        const __m128i tail = _mm_set1_epi8(needle[m - 1]);
+        // 16 starting positions at a time, the loads never go past last
+        for (; stop - first >= 16; first += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + m - 1));
+            unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, head), _mm_cmpeq_epi8(b, tail)));
+            while (mask != 0) {
+                unsigned i = _lowest_bit(mask);
+                if (memcmp(first + i + 1, needle + 1, m - 2) == 0) {
+                    return first + i;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; first != stop; ++first) {
+            first = _find_char(first, stop, needle[0]);
+            if (first == stop) {
+                break;
+            }
+            if (first[m - 1] == needle[m - 1] && memcmp(first + 1, needle + 1, m - 2) == 0) {
+                return first;
+            }
+        }
+        return last;
+    }
+
+    /*
+    ** @brief   Fill the Horspool shift table of the needle.
+    ** Characters sharing a low byte keep the smaller shift, so no match is skipped.
+    */
+    template <class CharT>
+    void _horspool_table(const CharT *needle, size_t m, size_t *shift) {
+        for (size_t i = 0; i != SHIFT_TABLE_SIZE; ++i) {
+            shift[i] = m;
+        }
+        for (size_t i = 0; i + 1 < m; ++i) {
+            shift[_search_key(needle[i])] = m - 1 - i;
+        }
+    }
+    template <class CharT>
+    const CharT *_search_horspool(const CharT *first, const CharT *last,
+                                  const CharT *needle, size_t m, const size_t *shift) {
+        const CharT tail = needle[m - 1];
+        size_t left = last - first;
+        for (const CharT *cur = first; left >= m; ) {
+            CharT ch = cur[m - 1];
+            if (ch == tail && _chars_equal(cur, needle, m - 1)) {
+                return cur;
+            }
+            size_t step = shift[_search_key(ch)];
+            cur += step;
+            left -= step;
+        }
+        return last;
+    }
+
+    /*
+    ** @brief   Find the first occurrence of [needle, needle + m) in [first, last).
+    ** @return  Pointer to the match, or last if there is none.
+    */
+    template <class CharT>
+    const CharT *_search(const CharT *first, const CharT *last, const CharT *needle, size_t m) {
+        size_t n = last - first;
+        if (m == 0) {
+            return first;
+        } else if (m > n) {
+            return last;
+        } else if (m == 1) {
+            return _find_char(first, last, needle[0]);
+        } else if (m <= SHORT_NEEDLE) {
+            return _search_short(first, last, needle, m);
+        }
+        size_t shift[SHIFT_TABLE_SIZE];
+        _horspool_table(needle, m, shift);
+        return _search_horspool(first, last, needle, m, shift);
+    }
+
+    /*
+    ** @brief   Find the last occurrence of [needle, needle + m) in [first, last).
+    ** @return  Pointer to the match, or last if there is none.
+    ** Long needles use Horspool backwards, shifting on the character under
+    ** the first position of the needle.
+    */
+    template <class CharT>
+    const CharT *_search_backward(const CharT *first, const CharT *last, const CharT *needle, size_t m) {
+        size_t n = last - first;
+        if (m == 0) {
+            return last;
+        } else if (m > n) {
+            return last;
+        } else if (m == 1) {
+            return _rfind_char(first, last, needle[0]);
+        }
+        const CharT head = needle[0];
+        if (m <= SHORT_NEEDLE) {
+            for (size_t i = n - m + 1; i != 0; ) {
+                --i;
+                if (first[i] == head && first[i + m - 1] == needle[m - 1] &&
+                    _chars_equal(first + i + 1, needle + 1, m - 2)) {
+                    return first + i;
+                }
+            }
+            return last;
+        }
+        size_t shift[SHIFT_TABLE_SIZE];
+        for (size_t i = 0; i != SHIFT_TABLE_SIZE; ++i) {
+            shift[i] = m;
+        }
+        for (size_t i = m - 1; i != 0; --i) {
+            shift[_search_key(needle[i])] = i;
+        }
+        // i is the candidate start, jumping from the last one towards first
+        for (size_t i = n - m; ; ) {
+            CharT ch = first[i];
+            if (ch == head && _chars_equal(first + i + 1, needle + 1, m - 1)) {
+                return first + i;
+            }
+            size_t step = shift[_search_key(ch)];
+            if (step > i) {
+                break;
+            }
+            i -= step;
+        }
+        return last;
+    }
+
+    /*
+    ** A needle prepared once and searched for many times. The Horspool table
+    ** of a long needle is computed in the constructor instead of on every
+    ** search.
+    */
+    template <class CharT>
+    class searcher {
+    public:
+        typedef CharT   value_type;
+        typedef size_t  size_type;
+
+    public:
+        searcher(const CharT *needle, size_type n) : _needle(needle, needle + n) {
+            init_table();
+        }
+        template <class InputIterator>
+        searcher(InputIterator first, InputIterator last) : _needle(first, last) {
+            init_table();
+        }
+
+        /*
+        ** @brief   Find the needle in [first, last).
+        ** @return  Pointer to the first match, or last if there is none.
+        */
+        const CharT *operator() (const CharT *first, const CharT *last) const {
+            size_type m = _needle.size();
+            if (m <= SHORT_NEEDLE) {
+                return _search(first, last, needle(), m);
+            }
+            return _search_horspool(first, last, needle(), m, _shift);
+        }
+
+        /*
+        ** @return  Length of the needle.
+        */
+        size_type size() const { return _needle.size(); }
+
+    private:
+        const CharT *needle() const {
+            return _needle.empty() ? 0 : &_needle[0];
+        }
+        void init_table() {
+            if (_needle.size() > SHORT_NEEDLE) {
+                _horspool_table(needle(), _needle.size(), _shift);
+            }
+        }
+
+        vector<CharT>   _needle;
+        size_t          _shift[SHIFT_TABLE_SIZE];
+    };
+}
+
+#endif
\ No newline at end of file
@@ -9,6 +9,9 @@
 #include "Allocator.h"
 #include "Uninitialized.h"
 #include "ReverseIterator.h"
+#include "Searcher.h"
+#include "StringView.h"
+#include "TypeTraits.h"
 
 #include <cstring>
 #include <iostream>
@@ -16,7 +19,7 @@
 #include <type_traits>
 
 namespace rayn {
-    template <class CharT>
+    template <class CharT, class Alloc = allocator<CharT>>
     class basic_string {
     public:
         typedef CharT                               value_type;
@@ -28,34 +31,59 @@ namespace rayn {
         typedef const CharT&                        const_reference;
         typedef size_t                              size_type;
         typedef ptrdiff_t                           difference_type;
+        typedef Alloc                               allocator_type;
+        typedef basic_string_view<CharT>            view_type;
 
         // Value returned by various member functions when they Fail.
         static const size_type npos = static_cast<size_type>(-1);
 
     private:
-        CharT *_start;
-        CharT *_finish;
-        CharT *_endOfStorage;
-
-        typedef allocator<CharT>    data_allocator;
+        // 堆上的空间，capacity不含结尾的空字符
+        struct heap_data {
+            CharT      *start;
+            size_type   capacity;
+        };
+        // 短字符串直接存放在对象内，不向配置器申请空间
+        enum ELocalCapacity{ LOCAL_CAPACITY = sizeof(heap_data) / sizeof(CharT) > 1 ?
+                                              sizeof(heap_data) / sizeof(CharT) - 1 : 1 };
+        // 两种存储共用空间，其中不保存指向对象自身的指针，对象可以按位搬移
+        union storage {
+            heap_data   heap;
+            CharT       local[LOCAL_CAPACITY + 1];
+        };
+
+        storage     _data;
+        size_type   _size;
+        bool        _isLocal;
+
+        typedef Alloc               data_allocator;
+
+        // 有状态的配置器(如polymorphic_allocator)跟随内存一起移动与交换
+        data_allocator _alloc;
 
     public:
         // The Default Constructor
-        explicit basic_string() : _start(0), _finish(0), _endOfStorage(0) {}
+        explicit basic_string() {
+            init_local();
+        }
+        // Construct an empty string using allocator a.
+        explicit basic_string(const allocator_type& a) : _alloc(a) {
+            init_local();
+        }
 
         // The Copy Constructor
-        basic_string(const basic_string& str) {
-            allocate_and_copy(str._start, str._finish);
+        basic_string(const basic_string& str) : _alloc(str._alloc) {
+            allocate_and_copy(str.begin(), str.end());
         }
 
         // The Move Constructor
-        basic_string(basic_string&& str) {
+        basic_string(basic_string&& str) RAYN_NOEXCEPT {
             moveData(str);
         }
         // Construct string as copy of a substring.
         basic_string(const basic_string& str, size_type pos, size_type len = npos) {
             len = fix_npos(len, str.length(), pos);
-            allocate_and_copy(str._start + pos, str._start + pos + len);
+            allocate_and_copy(str.begin() + pos, str.begin() + pos + len);
         }
         // Construct string as copy of a C-Style string.
         basic_string(const CharT* cstr) {
@@ -74,6 +102,10 @@ namespace rayn {
         basic_string(InputIterator first, InputIterator last) {
             allocate_and_copy(first, last);
         }
+        // Construct string as copy of the characters of a view.
+        explicit basic_string(view_type sv) {
+            allocate_and_copy(sv.begin(), sv.end());
+        }
 
         // Destroy the string instance.
         ~basic_string() {
@@ -89,40 +121,43 @@ namespace rayn {
         // Set value to string of length 1.
         basic_string& operator= (CharT ch);
 
+        // View all characters of this string, nothing is copied.
+        operator view_type() const { return view_type(data_ptr(), _size); }
+
         // The Iterator Functions
-        iterator begin() { return _start; }
-        const_iterator begin() const { return _start; }
-        const_iterator cbegin() const { return _start; }
-        iterator end() { return _finish; }
-        const_iterator end() const { return _finish; }
-        const_iterator cend() const { return _finish; }
-        reverse_iterator rbegin() { return reverse_iterator(_finish); }
-        const_reverse_iterator rbegin() const { return const_reverse_iterator(_finish); }
-        const_reverse_iterator crbegin() const { return const_reverse_iterator(_finish); }
-        reverse_iterator rend() { return reverse_iterator(_start); }
-        const_reverse_iterator rend() const { return const_reverse_iterator(_start); }
-        const_reverse_iterator crend() const { return const_reverse_iterator(_start); }
+        iterator begin() { return data_ptr(); }
+        const_iterator begin() const { return data_ptr(); }
+        const_iterator cbegin() const { return data_ptr(); }
+        iterator end() { return data_ptr() + _size; }
+        const_iterator end() const { return data_ptr() + _size; }
+        const_iterator cend() const { return data_ptr() + _size; }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
 
         // Capacity
         /*
         ** @return  Returns the number of characters in the string
         */
-        size_type size() const { return _finish - _start; }
+        size_type size() const { return _size; }
         /*
         ** @return  Returns the length of this string.
         */
-        size_type length() const { return _finish - _start; }
+        size_type length() const { return _size; }
         /*
         ** @return  Returns the total number of characters that the cur string can hold
+        ** 短字符串为对象内可存放的字符数。
         */
-        size_type capacity() const { return _endOfStorage - _start; }
+        size_type capacity() const { return _isLocal ? size_type(LOCAL_CAPACITY) : _data.heap.capacity; }
 
         /*
         ** @brief   Erases the string, Make this string empty.
         */
         void clear() {
-            destroy(_start, _finish);
-            _start = _finish;
+            set_size(0);
         }
         /*
         ** @return  Returns true if this string is empty.
@@ -144,9 +179,12 @@ namespace rayn {
         ** @brief   Shrink memory to fit cur string length.
         */
         void shrink_to_fit() {
-            data_allocator::deallocate(_finish, _endOfStorage - _finish);
-            _endOfStorage = _finish;
+            reallocate_storage(size());
         }
+        /*
+        ** @brief   Return the allocator of string.
+        */
+        allocator_type get_allocator() const { return _alloc; }
 
         // Element access
         /*
@@ -154,42 +192,42 @@ namespace rayn {
         ** @param   pos The index of char to access.
         ** @return  Read/Write reference to the character.
         */
-        reference operator[] (size_type pos) { return *(_start + pos); }
+        reference operator[] (size_type pos) { return data_ptr()[pos]; }
         /*
         ** @brief   Access to the data in the string by index.
         ** @param   pos The index of char to access.
         ** @return  Read-only reference to the character.
         */
-        const_reference operator[] (size_type pos) const { return *(_start + pos); }
+        const_reference operator[] (size_type pos) const { return data_ptr()[pos]; }
         /*
         ** @brief   Access to the data in the string by index.
         ** @param   pos The index of char to access.
         ** @return  Read/Write reference to the character.
         */
-        reference at(size_type pos) { return *(_start + pos); }
+        reference at(size_type pos) { return data_ptr()[pos]; }
         /*
         ** @brief   Access to the data in the string by index.
         ** @param   pos The index of char to access.
         ** @return  Read-only reference to the character.
         */
-        const_reference at(size_type pos) const { return *(_start + pos); }
+        const_reference at(size_type pos) const { return data_ptr()[pos]; }
 
         /*
         ** @return  Read/Write reference to the data at the first.
         */
-        reference front() { return *(_start); }
+        reference front() { return *data_ptr(); }
         /*
         ** @return  Read-only reference to the data at the first.
         */
-        const_reference front() const { return *(_start); }
+        const_reference front() const { return *data_ptr(); }
         /*
         ** @return  Read/Write reference to the data at the last.
         */
-        reference back() { return *(_finish - 1); }
+        reference back() { return data_ptr()[_size - 1]; }
         /*
         ** @return  Read-only reference to the data at the last.
         */
-        const_reference back() const { return *(_finish - 1); }
+        const_reference back() const { return data_ptr()[_size - 1]; }
 
         // Modifiers
         /*
@@ -203,6 +241,11 @@ namespace rayn {
         */
         basic_string& operator+=(const CharT* cstr);
         /*
+        ** @brief   Append the characters of a view.
+        ** @return  Reference to this string.
+        */
+        basic_string& operator+=(view_type sv);
+        /*
         ** @brief   Append a Character.
         ** @return  Reference to this string.
         */
@@ -232,6 +275,11 @@ namespace rayn {
         */
         basic_string& append(const CharT* cstr, size_type n);
         /*
+        ** @brief   Append the characters of a view.
+        ** @return  Reference to this string.
+        */
+        basic_string& append(view_type sv);
+        /*
         ** @brief   Append n Characters to this string.
         ** @return  Reference to this string.
         */
@@ -245,7 +293,15 @@ namespace rayn {
         /*
         ** @brief   Append a single character.
         */
-        void push_back(CharT ch) { insert(end(), ch); }
+        void push_back(CharT ch) {
+            if (_size != capacity()) {
+                CharT *start = data_ptr();
+                start[_size] = ch;
+                start[++_size] = CharT();
+            } else {
+                insert(end(), ch);
+            }
+        }
 
         /*
         ** @brief   Set (Copy) this string as another string.
@@ -313,6 +369,13 @@ namespace rayn {
         */
         basic_string& insert(size_type pos, const CharT* cstr, size_type n);
         /*
+        ** @brief   Insert the characters of a view.
+        ** @param   pos     Index in this string to insert.
+        ** @param   sv      The characters to insert.
+        ** @return  Reference to this string.
+        */
+        basic_string& insert(size_type pos, view_type sv);
+        /*
         ** @brief   Insert multiple characters.
         ** @param   pos     Index in this string to insert.
         ** @param   n       Number of characters to insert.
@@ -381,6 +444,14 @@ namespace rayn {
         */
         basic_string& replace(size_type pos, size_type len, const CharT* cstr);
         /*
+        ** @brief   Replace characters with the characters of a view.
+        ** @param   pos     Index of first char to replace.
+        ** @param   len     Number of char to be replaced.
+        ** @param   sv      The characters to insert.
+        ** @return  Reference to this string.
+        */
+        basic_string& replace(size_type pos, size_type len, view_type sv);
+        /*
         ** @brief   Replace characters from multiple characters.
         ** @param   pos     Index of first char to replace.
         ** @param   len     Number of char to be replaced.
@@ -448,16 +519,11 @@ namespace rayn {
         /*
         ** @brief   Return const pointer to null-terminated contents.
         */
-        const CharT* c_str() const { 
-            CharT* ret = new CharT[size() + 1];
-            rayn::uninitialized_copy(begin(), end(), ret);
-            ret[size()] = '\0';
-            return ret;
-        }
+        const CharT* c_str() const { return data_ptr(); }
         /*
         ** @brief   Return const pointer to contents.
         */
-        const CharT* data() const { return _start; }
+        const CharT* data() const { return data_ptr(); }
 
         /*
         ** @brief   Find position of a String.
@@ -467,6 +533,13 @@ namespace rayn {
         */
         size_type find(const basic_string& str, size_type pos = 0) const;
         /*
+        ** @brief   Find position of the characters of a view.
+        ** @param   sv      The characters to locate.
+        ** @param   pos     Index of character to search from. (Default = 0)
+        ** @return  Index of start of first occurrence.
+        */
+        size_type find(view_type sv, size_type pos = 0) const;
+        /*
         ** @brief   Find position of a C substring.
         ** @param   cstr    C-String to locate.
         ** @param   pos     Index of character to search from.
@@ -488,6 +561,13 @@ namespace rayn {
         ** @return  Index of start of first occurrence.
         */
         size_type find(CharT ch, size_type pos = 0) const;
+        /*
+        ** @brief   Find position of a prepared needle.
+        ** @param   s       The searcher holding the needle.
+        ** @param   pos     Index of character to search from. (Default = 0)
+        ** @return  Index of start of first occurrence.
+        */
+        size_type find(const searcher<CharT>& s, size_type pos = 0) const;
 
         /*
         ** @brief   Find last position of a String.
@@ -497,6 +577,13 @@ namespace rayn {
         */
         size_type rfind(const basic_string& str, size_type pos = npos) const;
         /*
+        ** @brief   Find last position of the characters of a view.
+        ** @param   sv      The characters to locate.
+        ** @param   pos     Index of character to search back from. (Default = npos)
+        ** @return  Index of start of last occurrence.
+        */
+        size_type rfind(view_type sv, size_type pos = npos) const;
+        /*
         ** @brief   Find last position of a C substring.
         ** @param   cstr    C-String to locate.
         ** @param   pos     Index of character to search back from.
@@ -530,6 +617,13 @@ namespace rayn {
         */
         size_type find_first_of(const basic_string& str, size_type pos = 0) const;
         /*
+        ** @brief   Find position of a char of a view.
+        ** @param   sv      The characters to locate.
+        ** @param   pos     Index of character to search from.(Default = 0)
+        ** @return  Index of first occurrence.
+        */
+        size_type find_first_of(view_type sv, size_type pos = 0) const;
+        /*
         ** @brief   Find position of a char of C substring.
         ** @param   str     The C-String containing characters to locate.
         ** @param   pos     Index of character to search from
@@ -572,6 +666,13 @@ namespace rayn {
         */
         size_type find_last_of(const basic_string& str, size_type pos = npos) const;
         /*
+        ** @brief   Find last position of a char of a view.
+        ** @param   sv      The characters to locate.
+        ** @param   pos     Index of character to search back from.(Default = npos)
+        ** @return  Index of last occurrence.
+        */
+        size_type find_last_of(view_type sv, size_type pos = npos) const;
+        /*
         ** @brief   Find last position of a char of C substring.
         ** @param   str     The C-String containing characters to locate.
         ** @param   pos     Index of character to search back from.(Default = npos)
@@ -614,6 +715,13 @@ namespace rayn {
         */
         size_type find_first_not_of(const basic_string& str, size_type pos = 0) const;
         /*
+        ** @brief   Find position of a character not in a view.
+        ** @param   sv      The characters to avoid.
+        ** @param   pos     Index of character to search from (Default = 0).
+        ** @return  Index of first occurrence.
+        */
+        size_type find_first_not_of(view_type sv, size_type pos = 0) const;
+        /*
         ** @brief   Find position of a character not in C subtring.
         ** @param   str     C-String containing characters to avoid.
         ** @param   pos     Index of character to search from.
@@ -660,6 +768,13 @@ namespace rayn {
         */
         size_type find_last_not_of(const basic_string& str, size_type pos = npos) const;
         /*
+        ** @brief   Find last position of a character not in a view.
+        ** @param   sv      The characters to avoid.
+        ** @param   pos     Index of character to search back from (Default = npos).
+        ** @return  Index of last occurrence.
+        */
+        size_type find_last_not_of(view_type sv, size_type pos = npos) const;
+        /*
         ** @brief   Find last position of a character not in C subtring.
         ** @param   str     C-String containing characters to avoid.
         ** @param   pos     Index of character to search back from.
@@ -723,6 +838,20 @@ namespace rayn {
         */
         int compare(size_type pos1, size_type n1, const basic_string& str) const;
         /*
+        ** @brief   Compare to the characters of a view.
+        ** @param   sv  The view to compare against.
+        ** @return  Integer < 0, 0, or > 0.
+        */
+        int compare(view_type sv) const;
+        /*
+        ** @brief   Compare substring to the characters of a view.
+        ** @param   pos1    Index of first char of substring.
+        ** @param   n1      Number of chars in substring.
+        ** @param   sv      The view to compare against.
+        ** @return  Integer < 0, 0, or > 0.
+        */
+        int compare(size_type pos1, size_type n1, view_type sv) const;
+        /*
         ** @brief   Compare substring to a substring.
         ** @param   pos1    Index of first char of substring.
         ** @param   n1      Number of chars in substring.
@@ -770,117 +899,153 @@ namespace rayn {
 
     public:
         // operator+
-        template <class CharT>
-        friend basic_string<CharT> operator+ (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
-        template <class CharT>
-        friend basic_string<CharT> operator+ (const CharT* lhs, const basic_string<CharT>& rhs);
-        template <class CharT>
-        friend basic_string<CharT> operator+ (const basic_string<CharT>& lhs, const CharT* rhs);
-        template <class CharT>
-        friend basic_string<CharT> operator+ (const basic_string<CharT>& lhs, CharT rhs);
-        template <class CharT>
-        friend basic_string<CharT> operator+ (CharT lhs, const basic_string<CharT>& rhs);
+        template <class CharT, class Alloc>
+        friend basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
+        template <class CharT, class Alloc>
+        friend basic_string<CharT, Alloc> operator+ (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
+        template <class CharT, class Alloc>
+        friend basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
+        template <class CharT, class Alloc>
+        friend basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, CharT rhs);
+        template <class CharT, class Alloc>
+        friend basic_string<CharT, Alloc> operator+ (CharT lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator==
-        template <class CharT>
-        friend bool operator== (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
-        template <class CharT>
-        friend bool operator== (const basic_string<CharT>& lhs, const CharT* rhs);
-        template <class CharT>
-        friend bool operator== (const CharT* lhs, const basic_string<CharT>& rhs);
+        template <class CharT, class Alloc>
+        friend bool operator== (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
+        template <class CharT, class Alloc>
+        friend bool operator== (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
+        template <class CharT, class Alloc>
+        friend bool operator== (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator!=
-        template <class CharT>
-        friend bool operator!= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
-        template <class CharT>
-        friend bool operator!= (const basic_string<CharT>& lhs, const CharT* rhs);
-        template <class CharT>
-        friend bool operator!= (const CharT* lhs, const basic_string<CharT>& rhs);
+        template <class CharT, class Alloc>
+        friend bool operator!= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
+        template <class CharT, class Alloc>
+        friend bool operator!= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
+        template <class CharT, class Alloc>
+        friend bool operator!= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator<
         template <CharT>
-        friend bool operator< (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
+        friend bool operator< (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
         template <CharT>
-        friend bool operator< (const basic_string<CharT>& lhs, const CharT* rhs);
+        friend bool operator< (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
         template <CharT>
-        friend bool operator< (const CharT* lhs, const basic_string<CharT>& rhs);
+        friend bool operator< (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator<=
         template <CharT>
-        friend bool operator<= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
+        friend bool operator<= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
         template <CharT>
-        friend bool operator<= (const basic_string<CharT>& lhs, const CharT* rhs);
+        friend bool operator<= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
         template <CharT>
-        friend bool operator<= (const CharT* lhs, const basic_string<CharT>& rhs);
+        friend bool operator<= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator>
         template <CharT>
-        friend bool operator> (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
+        friend bool operator> (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
         template <CharT>
-        friend bool operator> (const basic_string<CharT>& lhs, const CharT* rhs);
+        friend bool operator> (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
         template <CharT>
-        friend bool operator> (const CharT* lhs, const basic_string<CharT>& rhs);
+        friend bool operator> (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
 
         // operator>=
         template <CharT>
-        friend bool operator>= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs);
+        friend bool operator>= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs);
         template <CharT>
-        friend bool operator>= (const basic_string<CharT>& lhs, const CharT* rhs);
+        friend bool operator>= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs);
         template <CharT>
-        friend bool operator>= (const CharT* lhs, const basic_string<CharT>& rhs);
+        friend bool operator>= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs);
         
-        friend void swap(basic_string<CharT>& lhs, basic_string<CharT>& rhs);
+        friend void swap(basic_string<CharT, Alloc>& lhs, basic_string<CharT, Alloc>& rhs);
      
         template <CharT>
-        friend std::ostream& operator<< (std::ostream& os, const basic_string<CharT>& str);
+        friend std::ostream& operator<< (std::ostream& os, const basic_string<CharT, Alloc>& str);
         template <CharT>
-        friend std::istream& operator>> (std::istream& is, basic_string<CharT>& str);
+        friend std::istream& operator>> (std::istream& is, basic_string<CharT, Alloc>& str);
         template <CharT>
-        friend std::istream& getline(std::istream& is, basic_string<CharT>& str, char delim);
+        friend std::istream& getline(std::istream& is, basic_string<CharT, Alloc>& str, char delim);
         template <CharT>
-        friend std::istream& getline(std::istream& is, basic_string<CharT>& str);
+        friend std::istream& getline(std::istream& is, basic_string<CharT, Alloc>& str);
 
     private:
         //Aux function
         /*
+        ** @brief   Pointer to the characters, inside the object for short string.
+        */
+        CharT *data_ptr() { return _isLocal ? _data.local : _data.heap.start; }
+        const CharT *data_ptr() const { return _isLocal ? _data.local : _data.heap.start; }
+        /*
+        ** @brief   Make this string empty, using the local buffer.
+        */
+        void init_local() {
+            _isLocal = true;
+            _size = 0;
+            _data.local[0] = CharT();
+        }
+        /*
+        ** @brief   Set the length to n and write the terminating null character.
+        */
+        void set_size(size_type n) {
+            _size = n;
+            data_ptr()[n] = CharT();
+        }
+        /*
         ** @brief   Move the data to this string.
         */
         void moveData(basic_string& str) {
-            _start = str._start;
-            _finish = str._finish;
-            _endOfStorage = str._endOfStorage;
-            str._start = str._finish = str._endOfStorage = 0;
+            _data = str._data;
+            _size = str._size;
+            _isLocal = str._isLocal;
+            _alloc = str._alloc;
+            str.init_local();
+        }
+        /*
+        ** @brief   Get storage for n characters, nothing is held before.
+        ** 不超过LOCAL_CAPACITY时使用对象内的空间，否则多申请一个位置存放结尾的空字符。
+        */
+        CharT *allocate_storage(size_type n) {
+            if (n <= LOCAL_CAPACITY) {
+                _isLocal = true;
+                return _data.local;
+            }
+            _data.heap.start = _alloc.allocate(n + 1);
+            _data.heap.capacity = n;
+            _isLocal = false;
+            return _data.heap.start;
         }
         /*
         ** @brief   Allocate memory for n elem and fill with same character.
         */
         void allocate_and_fill(size_type n, CharT ch) {
-            _start = data_allocator::allocate(n);
-            _finish = rayn::uninitialized_fill_n(_start, n, ch);
-            _endOfStorage = _finish;
+            rayn::uninitialized_fill_n(allocate_storage(n), n, ch);
+            set_size(n);
         }
         /*
         ** @brief   Allocate memory and copy data from range [first, last) into.
         */
         template <class InputIterator>
         void allocate_and_copy(InputIterator first, InputIterator last) {
-            _start = data_allocator::allocate(last - first);
-            _finish = rayn::uninitialized_copy(first, last, _start);
-            _endOfStorage = _finish;
+            size_type n = last - first;
+            rayn::uninitialized_copy(first, last, allocate_storage(n));
+            set_size(n);
         }
         /*
         ** @brief   Destroy data and deallocate memory.
+        ** 短字符串没有向配置器申请空间。
         */
         void destroy_and_deallocate() {
-            rayn::destroy(_start, _finish);
-            data_allocator::deallocate(_start, _endOfStorage - _start);
+            if (!_isLocal) {
+                _alloc.deallocate(_data.heap.start, _data.heap.capacity + 1);
+            }
         }
         /*
         ** @brief   如果原大小为0，则配置为len, 否则配置为 旧大小 * 2 or 旧大小 + 增加长度
         ** @param   len
         */
         size_type getNewCapacity(size_type len) {
-            size_type oldCapacity = _endOfStorage - _start;
+            size_type oldCapacity = capacity();
             size_type newCapacity = oldCapacity + rayn::max(oldCapacity, len);
             return newCapacity;
         }
@@ -891,640 +1056,598 @@ namespace rayn {
             return var == npos ? (length - off) : var;
         }
         /*
-        ** @brief   Insert aux, allocate memory and fill with char.
-        */
-        iterator insert_and_fill(iterator p, size_type n, value_type ch) {
-            size_type newCapacity = getNewCapacity(n);
-            iterator newStart = data_allocator::allocate(newCapacity);
-            iterator newFinish = rayn::uninitialized_copy(_start, p, newStart);
-            newFinish = rayn::uninitialized_fill_n(newFinish, n, ch);
-            iterator ret = newFinish;
-            newFinish = rayn::uninitialized_copy(p, _finish, newFinish);
-
-            destroy_and_deallocate();
-            _start = newStart;
-            _finish = newFinish;
-            _endOfStorage = _start + newCapacity;
-            return ret;
-        }
-        /*
-        ** @brief   Insert aux, allocate memory and copy range into.
-        */
-        template <class InputIterator>
-        iterator insert_and_copy(iterator p, InputIterator first, InputIterator last) {
-            size_type lengthOfAdd = last - first;
-            size_type newCapacity = getNewCapacity(lengthOfAdd);
-            iterator newStart = data_allocator::allocate(newCapacity);
-            iterator newFinish = rayn::uninitialized_copy(_start, p, newStart);
-            newFinish = rayn::uninitialized_copy(first, last, newFinish);
-            iterator ret = newFinish;
-            newFinish = rayn::uninitialized_copy(p, _finish, newFinish);
-
-            destroy_and_deallocate();
-            _start = newStart;
-            _finish = newFinish;
-            _endOfStorage = _start + newCapacity;
-            return ret;
-        }
-        /*
-        ** @brief   Find aux, from range [st, ed) to find substring equal to [it, it + length).
-        */
-        size_type find_aux(size_type st, size_type ed, const_iterator it, size_type length) const {
-            size_type i, j;
-            for (i = st; i != ed; ++i) {
-                for (j = 0; j != length; ++j) {
-                    if (*(begin() + i + j) != *(it + j)) {
-                        break;
-                    }
+        ** @brief   Change the capacity to newCapacity, characters are kept.
+        ** 足够短时搬回对象内；堆上的空间交给配置器的reallocate，可能原地扩充。
+        ** 字符类型都可以按位复制，直接使用memcpy。
+        */
+        void reallocate_storage(size_type newCapacity) {
+            if (newCapacity <= LOCAL_CAPACITY) {
+                if (!_isLocal) {
+                    // local与heap共用空间，先取出堆上的地址
+                    heap_data old = _data.heap;
+                    memcpy(_data.local, old.start, (_size + 1) * sizeof(CharT));
+                    _isLocal = true;
+                    _alloc.deallocate(old.start, old.capacity + 1);
                 }
-                if (j == length) return i;
+            } else if (_isLocal) {
+                CharT *start = _alloc.allocate(newCapacity + 1);
+                memcpy(start, _data.local, (_size + 1) * sizeof(CharT));
+                _data.heap.start = start;
+                _data.heap.capacity = newCapacity;
+                _isLocal = false;
+            } else {
+                _data.heap.start = _alloc.reallocate(_data.heap.start, _data.heap.capacity + 1, newCapacity + 1);
+                _data.heap.capacity = newCapacity;
             }
-            return npos;
         }
         /*
-        ** @brief   rFind aux, from range [st, ed) to find substring equal to [it, it + length).
+        ** @brief   Test whether [first, last) may lie in the storage of string.
+        ** 无法判断的迭代器保守地返回true。
         */
-        size_type rfind_aux(size_type st, size_type ed, const_iterator it, size_type length) const {
-            size_type i, j;
-            for (i = st; i >= ed; --i) {
-                for (j = 0; j != length; ++j) {
-                    if (*(begin() + i + j) != *(it + j)) {
-                        break;
-                    }
-                }
-                if (j == length) return i;
-            }
-            return npos;
+        template <class InputIterator>
+        bool may_alias(InputIterator, InputIterator) const {
+            return true;
         }
-        /*
-        ** @brief Test whether the char is in range [first, last) or not.
-        */
-        bool isContained(CharT ch, const_iterator first, const_iterator last) const {
-            for (const_iterator it = first; it != last; ++it) {
-                if (*it == ch) {
-                    return true;
-                }
-            }
-            return false;
+        bool may_alias(const CharT *first, const CharT *last) const {
+            const CharT *start = data_ptr();
+            return first < start + capacity() && start < last;
+        }
+        bool may_alias(CharT *first, CharT *last) const {
+            return may_alias(static_cast<const CharT *>(first), static_cast<const CharT *>(last));
         }
 
         /*
-        ** @brief Compare aux.
+        ** @brief Compare aux. Characters are ordered as in basic_string_view,
+        **        char as unsigned char, so lookups mixing both agree.
         */
         int compare_aux(size_type pos1, size_type n1, const_iterator it, size_type pos2, size_type n2) const {
-            size_type i, j;
-            for (i = 0, j = 0; i != n1 && j != n2; ++i, ++j) {
-                if (*(begin() + pos1 + i) < *(it + pos2 + j)) {
-                    return -1;
-                } else if (*(begin() + pos1 + i) > *(it + pos2 + j)) {
-                    return 1;
-                }
-            }
-            if (i == n1 && j == n2) {
-                return 0;
-            } else if (i == n1) {
-                return -1;
-            } else {
-                return 1;
+            int ret = _char_compare(begin() + pos1, it + pos2, n1 < n2 ? n1 : n2);
+            if (ret != 0) {
+                return ret;
             }
+            return n1 == n2 ? 0 : (n1 < n2 ? -1 : 1);
         }
     };
 
     typedef basic_string<char>      string;
     typedef basic_string<wchar_t>   wstring;
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator= (const basic_string& str) {
+    template <class CharT, class Alloc>
+    const typename basic_string<CharT, Alloc>::size_type basic_string<CharT, Alloc>::npos;
+
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator= (const basic_string& str) {
         if (this != &str) {
             destroy_and_deallocate();
-            allocate_and_copy(str._start, str._finish);
+            allocate_and_copy(str.begin(), str.end());
         }
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator= (basic_string&& str) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator= (basic_string&& str) {
         if (this != &str) {
+            destroy_and_deallocate();
             moveData(str);
         }
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator= (const CharT* cstr) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator= (const CharT* cstr) {
         destroy_and_deallocate();
         allocate_and_copy(cstr, cstr + strlen(cstr));
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator= (CharT ch) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator= (CharT ch) {
         destroy_and_deallocate();
         allocate_and_fill(1, ch);
         return *this;
     }
 
-    template <class CharT>
-    void basic_string<CharT>::resize(size_type n) {
+    template <class CharT, class Alloc>
+    void basic_string<CharT, Alloc>::resize(size_type n) {
         resize(n, CharT());
     }
-    template <class CharT>
-    void basic_string<CharT>::resize(size_type n, CharT ch) {
-        if (n < size()) {
-            rayn::destroy(_start + n, _finish);
-            _finish = _start + n;
-        } else if (n > size() && n <= capacity()) {
-            size_type lengthOfAdd = n - size();
-            _finish = rayn::uninitialized_fill_n(_finish, lengthOfAdd, ch);
-        } else if (n > capacity()) {
-            size_type lengthOfAdd = n - size();
-            iterator newStart = data_allocator::allocate(getNewCapacity(lengthOfAdd));
-            iterator newFinish = rayn::uninitialized_copy(begin(), end(), newStart);
-            newFinish = rayn::uninitialized_fill_n(newFinish, lengthOfAdd, ch);
-
-            destroy_and_deallocate();
-            _start = newStart;
-            _finish = newFinish;
-            _endOfStorage = _start + n;
+    template <class CharT, class Alloc>
+    void basic_string<CharT, Alloc>::resize(size_type n, CharT ch) {
+        if (n > capacity()) {
+            reallocate_storage(getNewCapacity(n - size()));
+        }
+        if (n > size()) {
+            rayn::uninitialized_fill_n(end(), n - size(), ch);
         }
+        set_size(n);
     }
 
-    template <class CharT>
-    void basic_string<CharT>::reserve(size_type n = 0) {
+    template <class CharT, class Alloc>
+    void basic_string<CharT, Alloc>::reserve(size_type n = 0) {
         if (n <= capacity()) return;
-        iterator newStart = data_allocator::allocate(n);
-        iterator newFinish = rayn::uninitialized_copy(begin(), end(), newStart);
-        destroy_and_deallocate();
-        _start = newStart;
-        _finish = newFinish;
-        _endOfStorage = _start + n;
+        reallocate_storage(n);
     }
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator+= (const basic_string& str) {
-        insert(size(), str);
-        return *this;
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator+= (const basic_string& str) {
+        return append(str.data(), str.size());
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator+= (const CharT* cstr) {
-        insert(size(), cstr);
-        return *this;
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator+= (const CharT* cstr) {
+        return append(cstr, strlen(cstr));
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::operator+= (CharT ch) {
-        insert(end(), ch);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator+= (view_type sv) {
+        return append(sv.data(), sv.size());
+    }
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::operator+= (CharT ch) {
+        push_back(ch);
         return *this;
     }
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::append(const basic_string& str) {
-        insert(size(), str);
-        return *this;
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(const basic_string& str) {
+        return append(str.data(), str.size());
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::append(const basic_string& str, size_type subpos,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(const basic_string& str, size_type subpos,
         size_type sublen = npos) {
         sublen = fix_npos(sublen, str.length(), subpos);
         insert(size(), str, subpos, sublen);
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::append(const CharT* cstr) {
-        insert(size(), cstr);
-        return *this;
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(const CharT* cstr) {
+        return append(cstr, strlen(cstr));
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::append(const CharT* cstr, size_type n) {
-        insert(size(), cstr, n);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(const CharT* cstr, size_type n) {
+        if (n == 0) {
+            // 空视图的data()为空指针，不能交给memmove
+            return *this;
+        }
+        if (n <= capacity() - size()) {
+            // 空间足够时直接复制到尾部，cstr可能指向自身的字符
+            memmove(end(), cstr, n * sizeof(CharT));
+            set_size(size() + n);
+        } else {
+            insert(end(), cstr, cstr + n);
+        }
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::append(size_type n, CharT ch) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(view_type sv) {
+        return append(sv.data(), sv.size());
+    }
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(size_type n, CharT ch) {
         insert(end(), n, ch);
         return *this;
     }
-    template <class CharT>
+    template <class CharT, class Alloc>
     template <class InputIterator>
-    basic_string<CharT>& basic_string<CharT>::append(InputIterator first, InputIterator last) {
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::append(InputIterator first, InputIterator last) {
         insert(end(), first, last);
         return *this;
     }
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::assign(const basic_string& str) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::assign(const basic_string& str) {
         if (this != &str) {
             destroy_and_deallocate();
             allocate_and_copy(str.begin(), str.end());
         }
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::assign(basic_string&& str) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::assign(basic_string&& str) {
         if (this != &str) {
+            destroy_and_deallocate();
             moveData(str);
         }
         return *this;
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::iterator
-        basic_string<CharT>::insert(iterator p, size_type n, CharT ch) {
-        size_type lengthOfLeft = capacity() - size();
-        if (n <= lengthOfLeft) {
-            for (iterator it = _finish - 1; it >= p; --it) {
-                *(it + n) = *it;
-            }
-            rayn::uninitialized_fill_n(p, n, ch);
-            _finish += n;
-            return p + n;
-        } else {
-            return insert_and_fill(p, n, ch);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::iterator
+        basic_string<CharT, Alloc>::insert(iterator p, size_type n, CharT ch) {
+        size_type index = p - begin();
+        if (n > capacity() - size()) {
+            reallocate_storage(getNewCapacity(n));
+            p = begin() + index;
         }
-    }
-    template <class CharT>
-    typename basic_string<CharT>::iterator
-        basic_string<CharT>::insert(iterator p, CharT ch) {
+        memmove(p + n, p, (size() - index) * sizeof(CharT));
+        rayn::uninitialized_fill_n(p, n, ch);
+        set_size(size() + n);
+        return p + n;
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::iterator
+        basic_string<CharT, Alloc>::insert(iterator p, CharT ch) {
         return insert(p, 1, ch);
     }
-    template <class CharT>
+    template <class CharT, class Alloc>
     template <class InputIterator>
-    typename basic_string<CharT>::iterator
-        basic_string<CharT>::insert(iterator p, InputIterator first, InputIterator last) {
-        size_type lengthOfLeft = capacity() - size();
+    typename basic_string<CharT, Alloc>::iterator
+        basic_string<CharT, Alloc>::insert(iterator p, InputIterator first, InputIterator last) {
+        size_type index = p - begin();
+        if (may_alias(first, last)) {
+            // 腾出位置或扩充会改变[first, last)，先复制一份
+            basic_string tmp(first, last);
+            return insert(begin() + index, tmp.begin(), tmp.end());
+        }
         size_type range = last - first;
-        if (range <= lengthOfLeft) {
-            for (iterator it = _finish - 1; it >= p; --it) {
-                *(it + range) = *it;
-            }
-            rayn::uninitialized_copy(first, last, p);
-            _finish += range;
-            return p + range;
-        } else {
-            return insert_and_copy(p, first, last);
+        if (range > capacity() - size()) {
+            reallocate_storage(getNewCapacity(range));
+            p = begin() + index;
         }
+        memmove(p + range, p, (size() - index) * sizeof(CharT));
+        rayn::uninitialized_copy(first, last, p);
+        set_size(size() + range);
+        return p + range;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::insert(size_type pos, const basic_string& str) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, const basic_string& str) {
         insert(begin() + pos, str.begin(), str.end());
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::insert(size_type pos, const basic_string& str,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, const basic_string& str,
         size_type subpos, size_type sublen = npos) {
         sublen = fix_npos(sublen, str.length(), subpos);
-        insert(_start + pos, str.begin() + subpos, str.begin() + subpos + sublen);
+        insert(begin() + pos, str.begin() + subpos, str.begin() + subpos + sublen);
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::insert(size_type pos, const CharT* cstr) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, const CharT* cstr) {
         insert(begin() + pos, cstr, cstr + strlen(cstr));
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::insert(size_type pos, const CharT* cstr, size_type n) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, const CharT* cstr, size_type n) {
         insert(begin() + pos, cstr, cstr + n);
         return *this;
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::insert(size_type pos, size_type n, CharT ch) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, view_type sv) {
+        insert(begin() + pos, sv.begin(), sv.end());
+        return *this;
+    }
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::insert(size_type pos, size_type n, CharT ch) {
         insert(begin() + pos, n, ch);
         return *this;
     }
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::erase(size_type pos = 0, size_type n = npos) {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::erase(size_type pos = 0, size_type n = npos) {
         n = fix_npos(n, size(), pos);
         erase(begin() + pos, begin() + pos + n);
         return *this;
     }
-    template <class CharT>
-    typename basic_string<CharT>::iterator
-        basic_string<CharT>::erase(iterator pos) {
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::iterator
+        basic_string<CharT, Alloc>::erase(iterator pos) {
         return erase(pos, pos + 1);
     }
-    template <class CharT>
-    typename basic_string<CharT>::iterator
-        basic_string<CharT>::erase(iterator first, iterator last) {
-        size_type lengthOfTail = _finish - last;
-        for (size_type off = 0; off != lengthOfTail; ++off) {
-            *(first + off) = *(last + off);
-        }
-        rayn::destroy(first + lengthOfTail, _finish);
-        _finish = first + lengthOfTail;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::iterator
+        basic_string<CharT, Alloc>::erase(iterator first, iterator last) {
+        memmove(first, last, (end() - last) * sizeof(CharT));
+        set_size(size() - (last - first));
         return first;
     }
 
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(size_type pos, size_type len,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
         const basic_string& str) {
         return replace(begin() + pos, begin() + pos + len, str.begin(), str.end());
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(size_type pos, size_type len,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
         const basic_string& str, size_type subpos, size_type sublen = npos) {
         sublen = fix_npos(sublen, str.length(), subpos);
         return replace(begin() + pos, begin() + pos + len, str.begin() + subpos,
             str.begin() + subpos + sublen);
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(size_type pos, size_type len,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
         const CharT* cstr, size_type len2) {
         return replace(begin() + pos, begin() + pos + len, cstr, cstr + len2);
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(size_type pos, size_type len,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
         const CharT* cstr) {
         return replace(begin() + pos, begin() + pos + len, cstr, cstr + strlen(cstr));
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(size_type pos, size_type len,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
+        view_type sv) {
+        return replace(begin() + pos, begin() + pos + len, sv.begin(), sv.end());
+    }
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(size_type pos, size_type len,
         size_type n, CharT ch) {
         return replace(begin() + pos, begin() + pos + len, n, ch);
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(iterator i1, iterator i2,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(iterator i1, iterator i2,
         const basic_string& str) {
         return replace(i1, i2, str.begin(), str.end());
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(iterator i1, iterator i2,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(iterator i1, iterator i2,
         const CharT* cstr, size_type n) {
         return replace(i1, i2, cstr, cstr + n);
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(iterator i1, iterator i2,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(iterator i1, iterator i2,
         const CharT* cstr) {
         return replace(i1, i2, cstr, cstr + strlen(cstr));
     }
-    template <class CharT>
-    basic_string<CharT>& basic_string<CharT>::replace(iterator i1, iterator i2,
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(iterator i1, iterator i2,
         size_type n, CharT ch) {
         iterator cur = erase(i1, i2);
         insert(cur, n, c);
         return *this;
     }
-    template <class CharT>
+    template <class CharT, class Alloc>
     template <class InputIterator>
-    basic_string<CharT>& basic_string<CharT>::replace(iterator i1, iterator i2,
+    basic_string<CharT, Alloc>& basic_string<CharT, Alloc>::replace(iterator i1, iterator i2,
         InputIterator first, InputIterator last) {
         iterator cur = erase(i1, i2);
         insert(cur, first, last);
         return *this;
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::copy(const CharT* cstr, size_type len, size_type pos = 0) const {
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::copy(const CharT* cstr, size_type len, size_type pos = 0) const {
         iterator tail = rayn::uninitialized_copy(begin() + pos, begin() + pos + len, cstr);
         return static_cast<size_type>(tail - cstr);
     }
-    template <class CharT>
-    void basic_string<CharT>::swap(basic_string& str) {
-        rayn::swap(_start, str._start);
-        rayn::swap(_finish, str._finish);
-        rayn::swap(_endOfStorage, str._endOfStorage);
+    template <class CharT, class Alloc>
+    void basic_string<CharT, Alloc>::swap(basic_string& str) {
+        rayn::swap(_data, str._data);
+        rayn::swap(_size, str._size);
+        rayn::swap(_isLocal, str._isLocal);
+        rayn::swap(_alloc, str._alloc);
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find(const basic_string& str, size_type pos = 0) const {
-        size_type length = str.length();
-        if (size() - pos < length) return npos;
-        return find_aux(pos, size(), str.cbegin(), length);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(const basic_string& str, size_type pos = 0) const {
+        return find(str.data(), pos, str.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find(const CharT* cstr, size_type pos, size_type n) const {
-        return find_aux(pos, size(), cstr, n);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(view_type sv, size_type pos) const {
+        return find(sv.data(), pos, sv.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find(const CharT* cstr, size_type pos = 0) const {
-        return find(cstr, pos, strlen(cstr));
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).find(cstr, pos, n);
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find(CharT ch, size_type pos = 0) const {
-        for (const_iterator it = cbegin() + pos; it != cend(); ++it) {
-            if (*it == ch) {
-                return it - cbegin();
-            }
-        }
-        return npos;
-    }
-
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::rfind(const basic_string& str, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
-        return rfind_aux(pos, 0, str.cbegin(), str.length());
-    }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::rfind(const CharT* cstr, size_type pos, size_type n) const {
-        return rfind_aux(pos, 0, cstr, n);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(const CharT* cstr, size_type pos = 0) const {
+        return find(cstr, pos, strlen(cstr));
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::rfind(const CharT* cstr, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(CharT ch, size_type pos = 0) const {
+        return view_type(*this).find(ch, pos);
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find(const searcher<CharT>& s, size_type pos = 0) const {
+        if (pos > size()) return npos;
+        const CharT *result = s(begin() + pos, end());
+        return result == end() && s.size() != 0 ? npos : result - begin();
+    }
+
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::rfind(const basic_string& str, size_type pos = npos) const {
+        return rfind(str.data(), pos, str.size());
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::rfind(view_type sv, size_type pos) const {
+        return rfind(sv.data(), pos, sv.size());
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::rfind(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).rfind(cstr, pos, n);
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::rfind(const CharT* cstr, size_type pos = npos) const {
         return rfind(cstr, pos, strlen(cstr));
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::rfind(CharT ch, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
-        for (const_iterator it = cbegin() + pos; it >= cbegin(); --it) {
-            if (*it == ch) {
-                return it - cbegin();
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::rfind(CharT ch, size_type pos = npos) const {
+        return view_type(*this).rfind(ch, pos);
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_of(const basic_string& str, size_type pos = 0) const {
-        return find_first_of(str.begin(), pos, str.size());
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_of(const basic_string& str, size_type pos = 0) const {
+        return find_first_of(str.data(), pos, str.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_of(const CharT* cstr, size_type pos, size_type n) const {
-        for (size_type i = pos; i != size(); ++i) {
-            if (isContained(*(begin() + i), cstr, cstr + n)) {
-                return i;
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_of(view_type sv, size_type pos) const {
+        return find_first_of(sv.data(), pos, sv.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_of(const CharT* cstr, size_type pos = 0) const {
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_of(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).find_first_of(cstr, pos, n);
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_of(const CharT* cstr, size_type pos = 0) const {
         return find_first_of(cstr, pos, strlen(cstr));
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_of(CharT ch, size_type pos = 0) const {
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_of(CharT ch, size_type pos = 0) const {
         return find(ch, pos);
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_of(const basic_string& str, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
-        return find_last_of(str.begin(), pos, str.size());
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_of(const basic_string& str, size_type pos = npos) const {
+        return find_last_of(str.data(), pos, str.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_of(const CharT* cstr, size_type pos, size_type n) const {
-        pos = fix_npos(pos, size(), 1);
-        for (size_type i = pos; i >= 0; --i) {
-            if (isContained(*(begin() + i), cstr, cstr + n)) {
-                return i;
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_of(view_type sv, size_type pos) const {
+        return find_last_of(sv.data(), pos, sv.size());
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_of(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).find_last_of(cstr, pos, n);
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_of(const CharT* cstr, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_of(const CharT* cstr, size_type pos = npos) const {
         return find_last_of(cstr, pos, strlen(cstr));
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_of(CharT ch, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_of(CharT ch, size_type pos = npos) const {
         return rfind(ch, pos);
     }
 
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_not_of(const basic_string& str, size_type pos = 0) const {
-        return find_first_not_of(str.begin(), pos, str.size());
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_not_of(const basic_string& str, size_type pos = 0) const {
+        return find_first_not_of(str.data(), pos, str.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_not_of(const CharT* cstr, size_type pos, size_type n) const {
-        for (size_type i = pos; i != size(); ++i) {
-            if (!isContained(*(begin() + i), cstr, cstr + n)) {
-                return i;
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_not_of(view_type sv, size_type pos) const {
+        return find_first_not_of(sv.data(), pos, sv.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_not_of(const CharT* cstr, size_type pos = 0) const {
-        return find_last_not_of(cstr, pos, strlen(cstr));
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_not_of(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).find_first_not_of(cstr, pos, n);
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_first_not_of(CharT ch, size_type pos = 0) const {
-        for (size_type i = pos; i != size(); ++i) {
-            if (*(begin() + i) != ch) {
-                return i;
-            }
-        }
-        return npos;
-    }
-
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_not_of(const basic_string& str, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
-        return find_last_not_of(str.begin(), pos, str.size());
-    }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_not_of(const CharT* cstr, size_type pos, size_type n) const {
-        pos = fix_npos(pos, size(), 1);
-        for (size_type i = pos; i >= 0; --i) {
-            if (!isContained(*(begin() + i), cstr, cstr + n)) {
-                return i;
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_not_of(const CharT* cstr, size_type pos = 0) const {
+        return find_first_not_of(cstr, pos, strlen(cstr));
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_first_not_of(CharT ch, size_type pos = 0) const {
+        return view_type(*this).find_first_not_of(ch, pos);
+    }
+
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_not_of(const basic_string& str, size_type pos = npos) const {
+        return find_last_not_of(str.data(), pos, str.size());
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_not_of(const CharT* cstr, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_not_of(view_type sv, size_type pos) const {
+        return find_last_not_of(sv.data(), pos, sv.size());
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_not_of(const CharT* cstr, size_type pos, size_type n) const {
+        return view_type(*this).find_last_not_of(cstr, pos, n);
+    }
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_not_of(const CharT* cstr, size_type pos = npos) const {
         return find_last_not_of(cstr, pos, strlen(cstr));
     }
-    template <class CharT>
-    typename basic_string<CharT>::size_type
-        basic_string<CharT>::find_last_not_of(CharT ch, size_type pos = npos) const {
-        pos = fix_npos(pos, size(), 1);
-        for (size_type i = pos; i >= 0; --i) {
-            if (*(begin() + i) != ch) {
-                return i;
-            }
-        }
-        return npos;
+    template <class CharT, class Alloc>
+    typename basic_string<CharT, Alloc>::size_type
+        basic_string<CharT, Alloc>::find_last_not_of(CharT ch, size_type pos = npos) const {
+        return view_type(*this).find_last_not_of(ch, pos);
     }
 
-    template <class CharT>
-    basic_string<CharT>
-        basic_string<CharT>::substr(size_type pos = 0, size_type len = npos) const {
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc>
+        basic_string<CharT, Alloc>::substr(size_type pos = 0, size_type len = npos) const {
         len = fix_npos(len, size(), pos);
-        return basic_string<CharT>(begin() + pos, begin() + pos + len);
+        return basic_string<CharT, Alloc>(begin() + pos, begin() + pos + len);
     }
 
-    template <class CharT>
-    int basic_string<CharT>::compare(const basic_string& str) const {
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(const basic_string& str) const {
         return compare(0, size(), str, 0, str.size());
     }
-    template <class CharT>
-    int basic_string<CharT>::compare(size_type pos1, size_type n1, const basic_string& str) const {
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(size_type pos1, size_type n1, const basic_string& str) const {
         return compare(pos1, n1, str, 0, str.size());
     }
-    template <class CharT>
-    int basic_string<CharT>::compare(size_type pos1, size_type n1,
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(view_type sv) const {
+        return compare(0, size(), sv.data(), sv.size());
+    }
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(size_type pos1, size_type n1, view_type sv) const {
+        return compare(pos1, n1, sv.data(), sv.size());
+    }
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(size_type pos1, size_type n1,
         const basic_string& str, size_type pos2, size_type n2) const {
         return compare_aux(pos1, n1, str.begin(), pos2, n2);
     }
-    template <class CharT>
-    int basic_string<CharT>::compare(const CharT* cstr) const {
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(const CharT* cstr) const {
         return compare(0, size(), cstr, strlen(cstr));
     }
-    template <class CharT>
-    int basic_string<CharT>::compare(size_type pos1, size_type n1, const CharT* cstr) const {
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(size_type pos1, size_type n1, const CharT* cstr) const {
         return compare(pos1, n1, cstr, strlen(cstr));
     }
-    template <class CharT>
-    int basic_string<CharT>::compare(size_type pos1, size_type n1, const CharT* cstr, size_type n2) const {
+    template <class CharT, class Alloc>
+    int basic_string<CharT, Alloc>::compare(size_type pos1, size_type n1, const CharT* cstr, size_type n2) const {
         return compare_aux(pos1, n1, cstr, 0, n2);
     }
 
     // Friend Functions
     // operator +
-    template <class CharT>
-    basic_string<CharT> operator+ (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
-        basic_string<CharT> res(lhs);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
+        basic_string<CharT, Alloc> res(lhs);
         return res += rhs;
     }
-    template <class CharT>
-    basic_string<CharT> operator+ (const CharT* lhs, const basic_string<CharT>& rhs) {
-        basic_string<CharT> res(lhs);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc> operator+ (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
+        basic_string<CharT, Alloc> res(lhs);
         return res += rhs;
     }
-    template <class CharT>
-    basic_string<CharT> operator+ (const basic_string<CharT>& lhs, const CharT* rhs) {
-        basic_string<CharT> res(lhs);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
+        basic_string<CharT, Alloc> res(lhs);
         return res += rhs;
     }
-    template <class CharT>
-    basic_string<CharT> operator+ (const basic_string<CharT>& lhs, CharT rhs) {
-        basic_string<CharT> res(lhs);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc> operator+ (const basic_string<CharT, Alloc>& lhs, CharT rhs) {
+        basic_string<CharT, Alloc> res(lhs);
         return res += rhs;
     }
-    template <class CharT>
-    basic_string<CharT> operator+ (CharT lhs, const basic_string<CharT>& rhs) {
-        basic_string<CharT> res(lhs);
+    template <class CharT, class Alloc>
+    basic_string<CharT, Alloc> operator+ (CharT lhs, const basic_string<CharT, Alloc>& rhs) {
+        basic_string<CharT, Alloc> res(lhs);
         return res += rhs;
     }
 
     //operator==
-    template <class CharT>
-    bool operator== (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator== (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         if (lhs.size() == rhs.size()) {
             for (auto cit1 = lhs.cbegin(), cit2 = rhs.cbegin();
                 cit1 != lhs.cend() && cit2 != rhs.cend();
@@ -1537,8 +1660,8 @@ namespace rayn {
         }
         return false;
     }
-    template <class CharT>
-    bool operator== (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator== (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         size_t len1 = lhs.size(), len2 = strlen(rhs);
         if (len1 == len2) {
             auto cit1 = lhs.cbegin();
@@ -1553,95 +1676,145 @@ namespace rayn {
         }
         return false;
     }
-    template <class CharT>
-    bool operator== (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator== (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return rhs == lhs;
     }
 
     //operator!=
-    template <class CharT>
-    bool operator!= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator!= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         return !(lhs == rhs);
     }
-    template <class CharT>
-    bool operator!= (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator!= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         return !(lhs == rhs);
     }
-    template <class CharT>
-    bool operator!= (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator!= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return !(lhs == rhs);
     }
 
     //operator<
-    template <class CharT>
-    bool operator< (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator< (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         return lhs.compare(rhs) < 0;
     }
-    template <class CharT>
-    bool operator< (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator< (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         return lhs.compare(rhs) < 0;
     }
-    template <class CharT>
-    bool operator< (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator< (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return rhs.compare(lhs) > 0;
     }
 
     //operator<=
-    template <class CharT>
-    bool operator<= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator<= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         return lhs.compare(rhs) <= 0;
     }
-    template <class CharT>
-    bool operator<= (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator<= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         return lhs.compare(rhs) <= 0;
     }
-    template <class CharT>
-    bool operator<= (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator<= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return rhs.compare(lhs) >= 0;
     }
 
     //operator>
-    template <class CharT>
-    bool operator> (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator> (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         return lhs.compare(rhs) > 0;
     }
-    template <class CharT>
-    bool operator> (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator> (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         return lhs.compare(rhs) > 0;
     }
-    template <class CharT>
-    bool operator> (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator> (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return rhs.compare(lhs) < 0;
     }
 
     //operator>=
-    template <class CharT>
-    bool operator>= (const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator>= (const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         return lhs.compare(rhs) >= 0;
     }
-    template <class CharT>
-    bool operator>= (const basic_string<CharT>& lhs, const CharT* rhs) {
+    template <class CharT, class Alloc>
+    bool operator>= (const basic_string<CharT, Alloc>& lhs, const CharT* rhs) {
         return lhs.compare(rhs) >= 0;
     }
-    template <class CharT>
-    bool operator>= (const CharT* lhs, const basic_string<CharT>& rhs) {
+    template <class CharT, class Alloc>
+    bool operator>= (const CharT* lhs, const basic_string<CharT, Alloc>& rhs) {
         return rhs.compare(lhs) <= 0;
     }
 
-    template <class CharT>
-    void swap(const basic_string<CharT>& lhs, const basic_string<CharT>& rhs) {
+    // Comparisons with a view, neither side is copied.
+    template <class CharT, class Alloc>
+    bool operator== (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return basic_string_view<CharT>(lhs) == rhs;
+    }
+    template <class CharT, class Alloc>
+    bool operator== (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return lhs == basic_string_view<CharT>(rhs);
+    }
+    template <class CharT, class Alloc>
+    bool operator!= (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return !(lhs == rhs);
+    }
+    template <class CharT, class Alloc>
+    bool operator!= (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return !(lhs == rhs);
+    }
+    template <class CharT, class Alloc>
+    bool operator< (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) < 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator< (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return rhs.compare(lhs) > 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator<= (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) <= 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator<= (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return rhs.compare(lhs) >= 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator> (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) > 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator> (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return rhs.compare(lhs) < 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator>= (const basic_string<CharT, Alloc>& lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) >= 0;
+    }
+    template <class CharT, class Alloc>
+    bool operator>= (basic_string_view<CharT> lhs, const basic_string<CharT, Alloc>& rhs) {
+        return rhs.compare(lhs) <= 0;
+    }
+
+    template <class CharT, class Alloc>
+    void swap(const basic_string<CharT, Alloc>& lhs, const basic_string<CharT, Alloc>& rhs) {
         lhs.swap(rhs);
     }
 
-    template <class CharT>
-    std::ostream& operator<< (std::ostream& os, const basic_string<CharT>& str) {
+    template <class CharT, class Alloc>
+    std::ostream& operator<< (std::ostream& os, const basic_string<CharT, Alloc>& str) {
         for (auto it = str.begin(); it != str.end(); ++it) {
             os << *it;
         }
         return os;
     }
-    template <class CharT>
-    std::istream& operator>> (std::istream& is, const basic_string<CharT>& str) {
+    template <class CharT, class Alloc>
+    std::istream& operator>> (std::istream& is, const basic_string<CharT, Alloc>& str) {
         CharT ch;
         bool hasPrevBlank = false;
         while (is.get(ch)) {
@@ -1662,8 +1835,8 @@ namespace rayn {
         }
         return is;
     }
-    template <class CharT>
-    std::istream& getline(std::istream& is, basic_string<CharT>& str, CharT delim) {
+    template <class CharT, class Alloc>
+    std::istream& getline(std::istream& is, basic_string<CharT, Alloc>& str, CharT delim) {
         CharT ch;
         str.clear();
         while (is.get(ch)) {
@@ -1675,11 +1848,23 @@ namespace rayn {
         }
         return is;
     }
-    template <class CharT>
-    std::istream& getline(std::istream& is, basic_string<CharT>& str) {
+    template <class CharT, class Alloc>
+    std::istream& getline(std::istream& is, basic_string<CharT, Alloc>& str) {
         return getline(is, str, '\n');
     }
 
+    // 与string_view的哈希值相同
+    template <class CharT, class Alloc>
+    struct hash<basic_string<CharT, Alloc> > : public unary_function<basic_string<CharT, Alloc>, size_t> {
+        size_t operator()(const basic_string<CharT, Alloc>& str) const {
+            return _hash_bytes(str.data(), str.size() * sizeof(CharT));
+        }
+    };
+
+    // basic_string不保存指向自身的指针，短字符串也可以按位搬移
+    template <class CharT, class Alloc>
+    struct is_trivially_relocatable<basic_string<CharT, Alloc> > : public is_trivially_relocatable<Alloc> {};
+
     // Numeric Conversions [string.conversions].
 }
 
@@ -0,0 +1,414 @@
+/*
+** StringView.h
+** Created by Rayn on 2026/10/17
+** basic_string_view: a non-owning view of a character sequence
+*/
+#ifndef _STRING_VIEW_H_
+#define _STRING_VIEW_H_
+
+#include "CharSet.h"
+#include "Functional.h"
+#include "Move.h"
+#include "ReverseIterator.h"
+#include "Searcher.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace rayn {
+
+    template <class CharT>
+    inline size_t _char_length(const CharT *cstr) {
+        const CharT *p = cstr;
+        while (*p != CharT()) {
+            ++p;
+        }
+        return p - cstr;
+    }
+    inline size_t _char_length(const char *cstr) {
+        return strlen(cstr);
+    }
+
+    // Compare n characters; char is compared as unsigned char, like memcmp.
+    template <class CharT>
+    inline int _char_compare(const CharT *s1, const CharT *s2, size_t n) {
+        for (size_t i = 0; i != n; ++i) {
+            if (s1[i] < s2[i]) {
+                return -1;
+            } else if (s2[i] < s1[i]) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    inline int _char_compare(const char *s1, const char *s2, size_t n) {
+        return n == 0 ? 0 : memcmp(s1, s2, n);
+    }
+
+    /*
+    ** A pointer and a length into characters owned by someone else, so a
+    ** slice of a larger buffer is searched and compared without allocating.
+    ** The characters must outlive the view and need not be null-terminated.
+    ** The search functions share their algorithms with basic_string.
+    */
+    template <class CharT>
+    class basic_string_view {
+    public:
+        typedef CharT                               value_type;
+        typedef const CharT*                        pointer;
+        typedef const CharT*                        const_pointer;
+        typedef const CharT&                        reference;
+        typedef const CharT&                        const_reference;
+        typedef const CharT*                        iterator;
+        typedef const CharT*                        const_iterator;
+        typedef reverse_iterator_t<const CharT*>    reverse_iterator;
+        typedef reverse_iterator_t<const CharT*>    const_reverse_iterator;
+        typedef size_t                              size_type;
+        typedef ptrdiff_t                           difference_type;
+
+        // Value returned by various member functions when they Fail.
+        static const size_type npos = static_cast<size_type>(-1);
+
+    public:
+        basic_string_view() : _start(0), _size(0) {}
+        basic_string_view(const CharT *cstr) : _start(cstr), _size(_char_length(cstr)) {}
+        basic_string_view(const CharT *s, size_type n) : _start(s), _size(n) {}
+
+        // The Iterator Functions
+        const_iterator begin() const { return _start; }
+        const_iterator cbegin() const { return _start; }
+        const_iterator end() const { return _start + _size; }
+        const_iterator cend() const { return _start + _size; }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        size_type size() const { return _size; }
+        size_type length() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        // Element access
+        const_reference operator[] (size_type pos) const { return _start[pos]; }
+        const_reference at(size_type pos) const {
+            if (pos >= _size) {
+                throw std::out_of_range("basic_string_view::at");
+            }
+            return _start[pos];
+        }
+        const_reference front() const { return _start[0]; }
+        const_reference back() const { return _start[_size - 1]; }
+        const_pointer data() const { return _start; }
+
+        // Modifiers
+        /*
+        ** @brief   Drop the first n characters from the view.
+        */
+        void remove_prefix(size_type n) {
+            _start += n;
+            _size -= n;
+        }
+        /*
+        ** @brief   Drop the last n characters from the view.
+        */
+        void remove_suffix(size_type n) {
+            _size -= n;
+        }
+        void swap(basic_string_view& other) {
+            rayn::swap(_start, other._start);
+            rayn::swap(_size, other._size);
+        }
+
+        // Operations
+        /*
+        ** @brief   Copy at most len characters from pos into dest.
+        ** @return  Number of characters actually copied.
+        */
+        size_type copy(CharT *dest, size_type len, size_type pos = 0) const {
+            len = clamp(pos, len, "basic_string_view::copy");
+            for (size_type i = 0; i != len; ++i) {
+                dest[i] = _start[pos + i];
+            }
+            return len;
+        }
+        /*
+        ** @brief   The view of [pos, pos + len), len is clamped to size().
+        */
+        basic_string_view substr(size_type pos = 0, size_type len = npos) const {
+            len = clamp(pos, len, "basic_string_view::substr");
+            return basic_string_view(_start + pos, len);
+        }
+
+        /*
+        ** @return  Integer < 0, 0, or > 0 as this view is ordered before,
+        **          equal to or after other.
+        */
+        int compare(basic_string_view other) const {
+            size_type n = _size < other._size ? _size : other._size;
+            int ret = _char_compare(_start, other._start, n);
+            if (ret != 0) {
+                return ret;
+            }
+            return _size == other._size ? 0 : (_size < other._size ? -1 : 1);
+        }
+        int compare(size_type pos1, size_type n1, basic_string_view other) const {
+            return substr(pos1, n1).compare(other);
+        }
+        int compare(size_type pos1, size_type n1, basic_string_view other, size_type pos2, size_type n2) const {
+            return substr(pos1, n1).compare(other.substr(pos2, n2));
+        }
+        int compare(const CharT *cstr) const {
+            return compare(basic_string_view(cstr));
+        }
+        int compare(size_type pos1, size_type n1, const CharT *cstr) const {
+            return substr(pos1, n1).compare(basic_string_view(cstr));
+        }
+        int compare(size_type pos1, size_type n1, const CharT *s, size_type n2) const {
+            return substr(pos1, n1).compare(basic_string_view(s, n2));
+        }
+
+        bool starts_with(basic_string_view prefix) const {
+            return _size >= prefix._size && _chars_equal(_start, prefix._start, prefix._size);
+        }
+        bool starts_with(CharT ch) const {
+            return _size != 0 && _start[0] == ch;
+        }
+        bool ends_with(basic_string_view suffix) const {
+            return _size >= suffix._size && _chars_equal(end() - suffix._size, suffix._start, suffix._size);
+        }
+        bool ends_with(CharT ch) const {
+            return _size != 0 && _start[_size - 1] == ch;
+        }
+
+        /*
+        ** @brief   Find the first occurrence of [s, s + n) starting from pos.
+        ** @return  Index of the match, or npos.
+        */
+        size_type find(const CharT *s, size_type pos, size_type n) const {
+            if (pos > _size) return npos;
+            const CharT *result = _search(begin() + pos, end(), s, n);
+            return result == end() && n != 0 ? npos : result - begin();
+        }
+        size_type find(basic_string_view v, size_type pos = 0) const { return find(v._start, pos, v._size); }
+        size_type find(const CharT *cstr, size_type pos = 0) const { return find(cstr, pos, _char_length(cstr)); }
+        size_type find(CharT ch, size_type pos = 0) const {
+            if (pos >= _size) return npos;
+            const CharT *result = _find_char(begin() + pos, end(), ch);
+            return result == end() ? npos : result - begin();
+        }
+
+        /*
+        ** @brief   Find the last occurrence of [s, s + n) starting at or before pos.
+        ** @return  Index of the match, or npos.
+        */
+        size_type rfind(const CharT *s, size_type pos, size_type n) const {
+            if (n > _size) return npos;
+            // the match starts at or before pos
+            size_type last = (pos < _size - n ? pos : _size - n) + n;
+            if (n == 0) return last;
+            const CharT *result = _search_backward(begin(), begin() + last, s, n);
+            return result == begin() + last ? npos : result - begin();
+        }
+        size_type rfind(basic_string_view v, size_type pos = npos) const { return rfind(v._start, pos, v._size); }
+        size_type rfind(const CharT *cstr, size_type pos = npos) const { return rfind(cstr, pos, _char_length(cstr)); }
+        size_type rfind(CharT ch, size_type pos = npos) const {
+            if (empty()) return npos;
+            size_type last = (pos < _size - 1 ? pos : _size - 1) + 1;
+            const CharT *result = _rfind_char(begin(), begin() + last, ch);
+            return result == begin() + last ? npos : result - begin();
+        }
+
+        // The find_first_of family, the set of characters is [s, s + n).
+        size_type find_first_of(const CharT *s, size_type pos, size_type n) const {
+            return find_first_in_set(s, pos, n, true);
+        }
+        size_type find_first_of(basic_string_view v, size_type pos = 0) const {
+            return find_first_of(v._start, pos, v._size);
+        }
+        size_type find_first_of(const CharT *cstr, size_type pos = 0) const {
+            return find_first_of(cstr, pos, _char_length(cstr));
+        }
+        size_type find_first_of(CharT ch, size_type pos = 0) const { return find(ch, pos); }
+
+        size_type find_last_of(const CharT *s, size_type pos, size_type n) const {
+            return find_last_in_set(s, pos, n, true);
+        }
+        size_type find_last_of(basic_string_view v, size_type pos = npos) const {
+            return find_last_of(v._start, pos, v._size);
+        }
+        size_type find_last_of(const CharT *cstr, size_type pos = npos) const {
+            return find_last_of(cstr, pos, _char_length(cstr));
+        }
+        size_type find_last_of(CharT ch, size_type pos = npos) const { return rfind(ch, pos); }
+
+        size_type find_first_not_of(const CharT *s, size_type pos, size_type n) const {
+            return find_first_in_set(s, pos, n, false);
+        }
+        size_type find_first_not_of(basic_string_view v, size_type pos = 0) const {
+            return find_first_not_of(v._start, pos, v._size);
+        }
+        size_type find_first_not_of(const CharT *cstr, size_type pos = 0) const {
+            return find_first_not_of(cstr, pos, _char_length(cstr));
+        }
+        size_type find_first_not_of(CharT ch, size_type pos = 0) const {
+            return find_first_in_set(&ch, pos, 1, false);
+        }
+
+        size_type find_last_not_of(const CharT *s, size_type pos, size_type n) const {
+            return find_last_in_set(s, pos, n, false);
+        }
+        size_type find_last_not_of(basic_string_view v, size_type pos = npos) const {
+            return find_last_not_of(v._start, pos, v._size);
+        }
+        size_type find_last_not_of(const CharT *cstr, size_type pos = npos) const {
+            return find_last_not_of(cstr, pos, _char_length(cstr));
+        }
+        size_type find_last_not_of(CharT ch, size_type pos = npos) const {
+            return find_last_in_set(&ch, pos, 1, false);
+        }
+
+    private:
+        /*
+        ** @brief   Check pos and clamp len to the characters left after it.
+        */
+        size_type clamp(size_type pos, size_type len, const char *what) const {
+            if (pos > _size) {
+                throw std::out_of_range(what);
+            }
+            return len < _size - pos ? len : _size - pos;
+        }
+        /*
+        ** @brief   Find the first char from pos that is (in == true) or is not
+        **          (in == false) one of [s, s + n).
+        */
+        size_type find_first_in_set(const CharT *s, size_type pos, size_type n, bool in) const {
+            if (pos >= _size) return npos;
+            char_set<CharT> set(s, s + n);
+            const CharT *result = set.find_first(begin() + pos, end(), in);
+            return result == end() ? npos : result - begin();
+        }
+        /*
+        ** @brief   The same as find_first_in_set, searching back from pos.
+        */
+        size_type find_last_in_set(const CharT *s, size_type pos, size_type n, bool in) const {
+            if (empty()) return npos;
+            const CharT *last = begin() + (pos < _size - 1 ? pos : _size - 1) + 1;
+            char_set<CharT> set(s, s + n);
+            const CharT *result = set.find_last(begin(), last, in);
+            return result == last ? npos : result - begin();
+        }
+
+        const CharT    *_start;
+        size_type       _size;
+    };
+
+    typedef basic_string_view<char>     string_view;
+    typedef basic_string_view<wchar_t>  wstring_view;
+
+    template <class CharT>
+    const typename basic_string_view<CharT>::size_type basic_string_view<CharT>::npos;
+
+    // Comparisons, a C-String on either side is viewed without copying.
+    template <class CharT>
+    inline bool operator== (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return lhs.size() == rhs.size() && _chars_equal(lhs.data(), rhs.data(), lhs.size());
+    }
+    template <class CharT>
+    inline bool operator== (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return lhs == basic_string_view<CharT>(rhs);
+    }
+    template <class CharT>
+    inline bool operator== (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return basic_string_view<CharT>(lhs) == rhs;
+    }
+
+    template <class CharT>
+    inline bool operator!= (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return !(lhs == rhs);
+    }
+    template <class CharT>
+    inline bool operator!= (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return !(lhs == rhs);
+    }
+    template <class CharT>
+    inline bool operator!= (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class CharT>
+    inline bool operator< (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) < 0;
+    }
+    template <class CharT>
+    inline bool operator< (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return lhs.compare(rhs) < 0;
+    }
+    template <class CharT>
+    inline bool operator< (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return rhs.compare(lhs) > 0;
+    }
+
+    template <class CharT>
+    inline bool operator<= (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) <= 0;
+    }
+    template <class CharT>
+    inline bool operator<= (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return lhs.compare(rhs) <= 0;
+    }
+    template <class CharT>
+    inline bool operator<= (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return rhs.compare(lhs) >= 0;
+    }
+
+    template <class CharT>
+    inline bool operator> (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) > 0;
+    }
+    template <class CharT>
+    inline bool operator> (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return lhs.compare(rhs) > 0;
+    }
+    template <class CharT>
+    inline bool operator> (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return rhs.compare(lhs) < 0;
+    }
+
+    template <class CharT>
+    inline bool operator>= (basic_string_view<CharT> lhs, basic_string_view<CharT> rhs) {
+        return lhs.compare(rhs) >= 0;
+    }
+    template <class CharT>
+    inline bool operator>= (basic_string_view<CharT> lhs, const CharT *rhs) {
+        return lhs.compare(rhs) >= 0;
+    }
+    template <class CharT>
+    inline bool operator>= (const CharT *lhs, basic_string_view<CharT> rhs) {
+        return rhs.compare(lhs) <= 0;
+    }
+
+    template <class CharT>
+    struct hash<basic_string_view<CharT> > : public unary_function<basic_string_view<CharT>, size_t> {
+        size_t operator()(basic_string_view<CharT> v) const {
+            return _hash_bytes(v.data(), v.size() * sizeof(CharT));
+        }
+    };
+
+    template <class CharT>
+    inline void swap(basic_string_view<CharT>& lhs, basic_string_view<CharT>& rhs) {
+        lhs.swap(rhs);
+    }
+
+    template <class CharT>
+    std::ostream& operator<< (std::ostream& os, basic_string_view<CharT> v) {
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            os << *it;
+        }
+        return os;
+    }
+}
+
+#endif
\ No newline at end of file
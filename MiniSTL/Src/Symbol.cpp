@@ -0,0 +1,92 @@
+/*
+** Symbol.cpp
+** Created by Rayn on 2026/10/17
+*/
+#include "Symbol.h"
+
+#include <cstring>
+
+namespace rayn {
+
+    namespace {
+        // v120 has no thread-safe function-local statics, call_once builds the table
+        std::once_flag global_table_once;
+        symbol_table *global_table = 0;
+
+        void create_global_table() {
+            // never destroyed, symbols may be used during static destruction
+            global_table = new symbol_table;
+        }
+    }
+
+    symbol_table::symbol_table() : _nextId(1) {
+        for (size_t i = 0; i != SHARD_COUNT; ++i) {
+            _shards[i].slots.resize(MIN_SLOTS, 0);
+        }
+    }
+
+    symbol_table& symbol_table::global() {
+        std::call_once(global_table_once, &create_global_table);
+        return *global_table;
+    }
+
+    size_t symbol_table::probe(const shard& sh, string_view s, size_t hash) {
+        size_t mask = sh.slots.size() - 1;
+        size_t i = hash & mask;
+        for (; sh.slots[i] != 0; i = (i + 1) & mask) {
+            const symbol_entry *e = sh.slots[i];
+            if (e->hash == hash && e->size == s.size() && memcmp(e->chars, s.data(), s.size()) == 0) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    void symbol_table::grow(shard& sh) {
+        vector<const symbol_entry *> slots(sh.slots.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (size_t i = 0; i != sh.slots.size(); ++i) {
+            const symbol_entry *e = sh.slots[i];
+            if (e) {
+                size_t j = e->hash & mask;
+                while (slots[j] != 0) {
+                    j = (j + 1) & mask;
+                }
+                slots[j] = e;
+            }
+        }
+        sh.slots.swap(slots);
+    }
+
+    const symbol_entry *symbol_table::intern(string_view s) {
+        size_t hash = _hash_bytes(s.data(), s.size());
+        shard& sh = shard_of(hash);
+        std::lock_guard<std::mutex> guard(sh.mutex);
+        size_t i = probe(sh, s, hash);
+        if (sh.slots[i]) {
+            return sh.slots[i];
+        }
+        // at most half of the slots are used
+        if ((sh.count + 1) * 2 > sh.slots.size()) {
+            grow(sh);
+            i = probe(sh, s, hash);
+        }
+        symbol_entry *e = static_cast<symbol_entry *>(
+            sh.arena.allocate(offsetof(symbol_entry, chars) + s.size() + 1, alignment_of<symbol_entry>::value));
+        e->id = _nextId++;
+        e->hash = hash;
+        e->size = s.size();
+        memcpy(e->chars, s.data(), s.size());
+        e->chars[s.size()] = '\0';
+        sh.slots[i] = e;
+        ++sh.count;
+        return e;
+    }
+
+    const symbol_entry *symbol_table::find(string_view s) const {
+        size_t hash = _hash_bytes(s.data(), s.size());
+        const shard& sh = shard_of(hash);
+        std::lock_guard<std::mutex> guard(sh.mutex);
+        return sh.slots[probe(sh, s, hash)];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+/*
+** Symbol.h
+** Created by Rayn on 2026/10/17
+** symbol: interned strings compared by identity
+*/
+#ifndef _SYMBOL_H_
+#define _SYMBOL_H_
+
+#include "Functional.h"
+#include "MemoryResource.h"
+#include "StringView.h"
+#include "Vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace rayn {
+
+    // The interned characters of a symbol, never moved or freed while its table lives.
+    struct symbol_entry {
+        size_t  id;         // 1, 2, 3... in the order of interning
+        size_t  hash;
+        size_t  size;
+        char    chars[1];   // size characters and a null terminator
+    };
+
+    /*
+    ** A set of unique strings. Interning the same characters twice gives the
+    ** same entry, so interned strings are equal iff their entries are.
+    ** The table is split into shards picked by hash, each with its own lock,
+    ** open addressing index and arena holding the entries, so threads
+    ** interning different strings rarely wait on each other.
+    */
+    class symbol_table {
+    public:
+        symbol_table();
+
+        /*
+        ** @brief   The entry of the characters of s, added if missing.
+        */
+        const symbol_entry *intern(string_view s);
+        /*
+        ** @brief   The entry of the characters of s.
+        ** @return  null if s was never interned.
+        */
+        const symbol_entry *find(string_view s) const;
+        /*
+        ** @return  Number of strings interned.
+        */
+        size_t size() const { return _nextId.load() - 1; }
+
+        /*
+        ** @brief   The table used by symbol, never destroyed.
+        */
+        static symbol_table& global();
+
+    private:
+        symbol_table(const symbol_table&);
+        symbol_table& operator= (const symbol_table&);
+
+        enum EShardCount{ SHARD_COUNT = 16 };
+        enum EMinSlots{ MIN_SLOTS = 16 };
+
+        struct shard {
+            mutable std::mutex              mutex;
+            vector<const symbol_entry *>    slots;  // power of two, null is empty
+            size_t                          count;
+            monotonic_buffer_resource       arena;
+
+            shard() : count(0), arena(alloc_resource()) {}
+        };
+
+        shard& shard_of(size_t hash) { return _shards[(hash >> 28) & (SHARD_COUNT - 1)]; }
+        const shard& shard_of(size_t hash) const { return _shards[(hash >> 28) & (SHARD_COUNT - 1)]; }
+        /*
+        ** @brief   Slot of s in sh, or the empty slot where it goes.
+        */
+        static size_t probe(const shard& sh, string_view s, size_t hash);
+        static void grow(shard& sh);
+
+        shard               _shards[SHARD_COUNT];
+        std::atomic<size_t> _nextId;
+    };
+
+    /*
+    ** A handle to a string interned in symbol_table::global(). It is one
+    ** pointer: copying is free, == compares addresses, and < orders by the
+    ** interning id, so a map keyed on symbols compares integers instead of
+    ** characters. Use symbol_name_less for the alphabetical order. The
+    ** empty string is the null symbol, with id 0.
+    */
+    class symbol {
+    public:
+        symbol() : _entry(0) {}
+        explicit symbol(string_view s) : _entry(s.empty() ? 0 : symbol_table::global().intern(s)) {}
+        explicit symbol(const char *cstr) : _entry(0) {
+            string_view s(cstr);
+            if (!s.empty()) {
+                _entry = symbol_table::global().intern(s);
+            }
+        }
+
+        /*
+        ** @brief   The symbol of s if it was interned, the null symbol otherwise.
+        **          Nothing is added to the table.
+        */
+        static symbol find(string_view s) {
+            symbol result;
+            if (!s.empty()) {
+                result._entry = symbol_table::global().find(s);
+            }
+            return result;
+        }
+
+        size_t id() const { return _entry ? _entry->id : 0; }
+        size_t hash() const { return _entry ? _entry->hash : 0; }
+        size_t size() const { return _entry ? _entry->size : 0; }
+        bool empty() const { return _entry == 0; }
+        // Null-terminated, valid for the whole program.
+        const char *c_str() const { return _entry ? _entry->chars : ""; }
+        string_view str() const { return _entry ? string_view(_entry->chars, _entry->size) : string_view(); }
+
+    private:
+        friend bool operator== (symbol lhs, symbol rhs);
+        friend bool operator!= (symbol lhs, symbol rhs);
+
+        const symbol_entry *_entry;
+    };
+
+    inline bool operator== (symbol lhs, symbol rhs) { return lhs._entry == rhs._entry; }
+    inline bool operator!= (symbol lhs, symbol rhs) { return lhs._entry != rhs._entry; }
+    inline bool operator< (symbol lhs, symbol rhs) { return lhs.id() < rhs.id(); }
+    inline bool operator<= (symbol lhs, symbol rhs) { return lhs.id() <= rhs.id(); }
+    inline bool operator> (symbol lhs, symbol rhs) { return lhs.id() > rhs.id(); }
+    inline bool operator>= (symbol lhs, symbol rhs) { return lhs.id() >= rhs.id(); }
+
+    // Orders symbols by their characters instead of their ids.
+    struct symbol_name_less {
+        bool operator()(symbol lhs, symbol rhs) const {
+            return lhs != rhs && lhs.str() < rhs.str();
+        }
+    };
+
+    template <>
+    struct hash<symbol> : public unary_function<symbol, size_t> {
+        size_t operator()(symbol sym) const {
+            return sym.hash();
+        }
+    };
+
+    inline std::ostream& operator<< (std::ostream& os, symbol sym) {
+        return os << sym.c_str();
+    }
+}
+
+#endif
\ No newline at end of file
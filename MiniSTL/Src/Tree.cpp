@@ -72,9 +72,21 @@ namespace rayn {
         return local_rb_tree_decrement(const_cast<__rb_tree_node_base*>(node));
     }
 
+    // walk from x up to the root, recomputing each summary
+    static void
+    local_rb_tree_update_path(__rb_tree_node_base* x,
+                              __rb_tree_node_base* header,
+                              __rb_tree_update_fn update)
+    {
+        for (; x != header; x = x->parent) {
+            update(x);
+        }
+    }
+
     static void
     local_rb_tree_rotate_left(__rb_tree_node_base* const x,
-                              __rb_tree_node_base*& root)
+                              __rb_tree_node_base*& root,
+                              __rb_tree_update_fn update)
     {
         __rb_tree_node_base* const y = x->right;
         x->right = y->left;
@@ -92,11 +104,18 @@ namespace rayn {
         }
         y->left = x;
         x->parent = y;
+
+        // x is now below y; the subtree as a whole is unchanged
+        if (update) {
+            update(x);
+            update(y);
+        }
     }
 
     static void
     local_rb_tree_rotate_right(__rb_tree_node_base* const x,
-                               __rb_tree_node_base*& root)
+                               __rb_tree_node_base*& root,
+                               __rb_tree_update_fn update)
     {
         __rb_tree_node_base* const y = x->left;
         x->left = y->right;
@@ -114,13 +133,64 @@ namespace rayn {
         }
         y->right = x;
         x->parent = y;
+
+        if (update) {
+            update(x);
+            update(y);
+        }
+    }
+
+    // Restore the red-black properties after x was linked in red. The root
+    // may be left red; callers paint it black.
+    static void
+    local_rb_tree_insert_fixup(__rb_tree_node_base* x,
+                               __rb_tree_node_base*& root,
+                               __rb_tree_update_fn update)
+    {
+        while (x != root && x->parent->color == _s_red) {
+            __rb_tree_node_base* const xpp = x->parent->parent;
+            if (x->parent == xpp->left) {
+                __rb_tree_node_base* const uncle = xpp->right;
+                if (uncle && uncle->color == _s_red) {
+                    x->parent->color = _s_black;
+                    uncle->color = _s_black;
+                    xpp->color = _s_red;
+                    x = xpp;
+                } else {
+                    if (x == x->parent->right) {
+                        x = x->parent;
+                        local_rb_tree_rotate_left(x, root, update);
+                    }
+                    x->parent->color = _s_black;
+                    xpp->color = _s_red;
+                    local_rb_tree_rotate_right(xpp, root, update);
+                }
+            } else {
+                __rb_tree_node_base* const uncle = xpp->left;
+                if (uncle && uncle->color == _s_red) {
+                    x->parent->color = _s_black;
+                    uncle->color = _s_black;
+                    xpp->color = _s_red;
+                    x = xpp;
+                } else {
+                    if (x == x->parent->left) {
+                        x = x->parent;
+                        local_rb_tree_rotate_right(x, root, update);
+                    }
+                    x->parent->color = _s_black;
+                    xpp->color = _s_red;
+                    local_rb_tree_rotate_left(xpp, root, update);
+                }
+            }
+        }
     }
 
     void
     _rb_tree_insert_and_rebalance(const bool insert_left,
                                   __rb_tree_node_base* x,
                                   __rb_tree_node_base* pa,
-                                  __rb_tree_node_base& header)
+                                  __rb_tree_node_base& header,
+                                  __rb_tree_update_fn update)
     {
         __rb_tree_node_base*& root = header.parent;
 
@@ -152,50 +222,22 @@ namespace rayn {
             }
         }
 
-        // Rebalance
-        while (x != root && x->parent->color == _s_red) {
-            __rb_tree_node_base* const xpp = x->parent->parent;
-            if (x->parent == xpp->left) {
-                __rb_tree_node_base* const uncle = xpp->right;
-                if (uncle && uncle->color == _s_red) {
-                    x->parent->color = _s_black;
-                    uncle->color = _s_black;
-                    xpp->color = _s_red;
-                    x = xpp;
-                } else {
-                    if (x == x->parent->right) {
-                        x = x->parent;
-                        local_rb_tree_rotate_left(x, root);
-                    }
-                    x->parent->color = _s_black;
-                    xpp->color = _s_red;
-                    local_rb_tree_rotate_right(xpp, root);
-                }
-            } else {
-                __rb_tree_node_base* const uncle = xpp->left;
-                if (uncle && uncle->color == _s_red) {
-                    x->parent->color = _s_black;
-                    uncle->color = _s_black;
-                    xpp->color = _s_red;
-                    x = xpp;
-                } else {
-                    if (x == x->parent->left) {
-                        x = x->parent;
-                        local_rb_tree_rotate_right(x, root);
-                    }
-                    x->parent->color = _s_black;
-                    xpp->color = _s_red;
-                    local_rb_tree_rotate_left(xpp, root);
-                }
-            }
+        // Every ancestor gained one node. Rotations below only reshape
+        // subtrees whose summaries are already right.
+        if (update) {
+            local_rb_tree_update_path(x, &header, update);
         }
+
+        // Rebalance
+        local_rb_tree_insert_fixup(x, root, update);
         root->color = _s_black;
     }
 
 
     __rb_tree_node_base*
     _rb_tree_rebalance_for_erase(__rb_tree_node_base* const z,
-                                 __rb_tree_node_base& header)
+                                 __rb_tree_node_base& header,
+                                 __rb_tree_update_fn update)
     {
         __rb_tree_node_base*& root = header.parent;
         __rb_tree_node_base*& leftmost = header.left;
@@ -279,6 +321,11 @@ namespace rayn {
                 }
             }
         }
+        // x_parent is the lowest node whose subtree lost a node; with y
+        // relinked in z's place, its path to the root covers every change.
+        if (update) {
+            local_rb_tree_update_path(x_parent, &header, update);
+        }
         if (y->color != _s_red) {
             while (x != root && (x == 0 || x->color == _s_black)) {
                 if (x == x_parent->left) {
@@ -286,7 +333,7 @@ namespace rayn {
                     if (w->color == _s_red) {
                         w->color = _s_black;
                         x_parent->color = _s_red;
-                        local_rb_tree_rotate_left(x_parent, root);
+                        local_rb_tree_rotate_left(x_parent, root, update);
                         w = x_parent->right;
                     }
                     if ((w->left == 0 || w->left->color == _s_black)
@@ -298,7 +345,7 @@ namespace rayn {
                         if (w->right == 0 || w->right->color == _s_black) {
                             w->left->color = _s_black;
                             w->color = _s_red;
-                            local_rb_tree_rotate_right(w, root);
+                            local_rb_tree_rotate_right(w, root, update);
                             w = x_parent->right;
                         }
                         w->color = x_parent->color;
@@ -306,7 +353,7 @@ namespace rayn {
                         if (w->right) {
                             w->right->color = _s_black;
                         }
-                        local_rb_tree_rotate_left(x_parent, root);
+                        local_rb_tree_rotate_left(x_parent, root, update);
                         break;
                     }
                 } else {
@@ -314,7 +361,7 @@ namespace rayn {
                     if (w->color == _s_red) {
                         w->color = _s_black;
                         x_parent->color = _s_red;
-                        local_rb_tree_rotate_right(x_parent, root);
+                        local_rb_tree_rotate_right(x_parent, root, update);
                         w = x_parent->left;
                     }
                     if ((w->right == 0 || w->right->color == _s_black)
@@ -326,7 +373,7 @@ namespace rayn {
                         if (w->left == 0 || w->left->color == _s_black) {
                             w->right->color = _s_black;
                             w->color = _s_red;
-                            local_rb_tree_rotate_left(w, root);
+                            local_rb_tree_rotate_left(w, root, update);
                             w = x_parent->left;
                         }
                         w->color = x_parent->color;
@@ -334,7 +381,7 @@ namespace rayn {
                         if (w->left) {
                             w->left->color = _s_black;
                         }
-                        local_rb_tree_rotate_right(x_parent, root);
+                        local_rb_tree_rotate_right(x_parent, root, update);
                         break;
                     }
                 }
@@ -345,4 +392,117 @@ namespace rayn {
         }
         return y;
     }
+
+    size_t
+    _rb_tree_black_height(const __rb_tree_node_base* x) throw ()
+    {
+        size_t h = 0;
+        for (; x != 0; x = x->left) {
+            if (x->color == _s_black) {
+                ++h;
+            }
+        }
+        return h;
+    }
+
+    __rb_tree_subtree
+    _rb_tree_join(__rb_tree_subtree l, __rb_tree_node_base* k,
+                  __rb_tree_subtree r, __rb_tree_update_fn update)
+    {
+        __rb_tree_subtree ret;
+        if (l.black_height == r.black_height) {
+            k->color = _s_black;
+            k->parent = 0;
+            k->left = l.root;
+            k->right = r.root;
+            if (l.root != 0) {
+                l.root->parent = k;
+            }
+            if (r.root != 0) {
+                r.root->parent = k;
+            }
+            if (update) {
+                update(k);
+            }
+            ret.root = k;
+            ret.black_height = l.black_height + 1;
+            return ret;
+        }
+
+        // Walk down the facing spine of the taller tree to the first black
+        // node (or null) as tall as the shorter tree, and put k there in
+        // red with that node and the shorter tree as children.
+        const bool right_spine = l.black_height > r.black_height;
+        const __rb_tree_subtree& big = right_spine ? l : r;
+        const __rb_tree_subtree& small = right_spine ? r : l;
+        __rb_tree_node_base* pa = 0;
+        __rb_tree_node_base* c = big.root;
+        size_t h = big.black_height;
+        while (c != 0 && !(c->color == _s_black && h == small.black_height)) {
+            if (c->color == _s_black) {
+                --h;
+            }
+            pa = c;
+            c = right_spine ? c->right : c->left;
+        }
+
+        k->color = _s_red;
+        k->parent = pa;
+        if (right_spine) {
+            k->left = c;
+            k->right = small.root;
+            pa->right = k;
+        } else {
+            k->left = small.root;
+            k->right = c;
+            pa->left = k;
+        }
+        if (c != 0) {
+            c->parent = k;
+        }
+        if (small.root != 0) {
+            small.root->parent = k;
+        }
+        if (update) {
+            local_rb_tree_update_path(k, 0, update);
+        }
+
+        __rb_tree_node_base* root = big.root;
+        local_rb_tree_insert_fixup(k, root, update);
+        ret.root = root;
+        ret.black_height = big.black_height;
+        if (root->color == _s_red) {
+            root->color = _s_black;
+            ++ret.black_height;
+        }
+        return ret;
+    }
+
+    __rb_tree_subtree
+    _rb_tree_join2(__rb_tree_subtree l, __rb_tree_subtree r,
+                   __rb_tree_update_fn update)
+    {
+        if (r.root == 0) {
+            return l;
+        }
+        if (l.root == 0) {
+            return r;
+        }
+        // take the smallest node out of r to serve as the middle key,
+        // erasing under a scratch header
+        __rb_tree_node_base header;
+        header.color = _s_red;
+        header.parent = r.root;
+        header.left = __rb_tree_node_base::minimum(r.root);
+        header.right = __rb_tree_node_base::maximum(r.root);
+        r.root->parent = &header;
+
+        __rb_tree_node_base* k = _rb_tree_rebalance_for_erase(header.left, header, update);
+        r.root = header.parent;
+        if (r.root != 0) {
+            r.root->parent = 0;
+        }
+        r.black_height = _rb_tree_black_height(r.root);
+        return _rb_tree_join(l, k, r, update);
+    }
 }
\ No newline at end of file
@@ -11,6 +11,10 @@
 #include "ReverseIterator.h"
 #include "Pair.h"
 #include "AlgoBase.h"
+#include "TypeTraits.h"
+#include "Functional.h"
+
+#include <cassert>
 
 namespace rayn {
 
@@ -64,6 +68,129 @@ namespace rayn {
         }
     };
 
+    /*
+    ** Augmentation.
+    ** An rb_tree can keep extra per-subtree data in its nodes. The policy
+    ** picks the node type, which must derive from __rb_tree_node<Value> so
+    ** iterators stay the same, and an update function that recomputes a
+    ** node's data from its children. The rebalancing code in Tree.cpp calls
+    ** it after every structural change; a null function costs one branch.
+    **
+    ** node_traits<Value> also describes the subtree summary folded by
+    ** rb_tree::range_aggregate(): summary_type, lift() for one value,
+    ** combine() for two adjacent runs and summary() of a whole subtree,
+    ** plus construct()/destroy() for data that is not plain old data.
+    */
+    typedef void (*__rb_tree_update_fn)(__rb_tree_node_base* x);
+
+    // plain nodes, nothing to maintain
+    struct rb_tree_no_augment {
+        template <class Value>
+        struct node_traits {
+            typedef __rb_tree_node<Value>   node_type;
+            typedef void                    summary_type;
+
+            static __rb_tree_update_fn update() { return 0; }
+            static void construct(node_type*) {}
+            static void destroy(node_type*) {}
+        };
+    };
+
+    template <class Value>
+    struct __rb_tree_size_node : public __rb_tree_node<Value> {
+        size_t  subtree_size;
+    };
+
+    template <class Value>
+    inline size_t
+    _rb_tree_subtree_size(const __rb_tree_node_base* x) {
+        return x == 0 ? 0 : static_cast<const __rb_tree_size_node<Value>*>(x)->subtree_size;
+    }
+
+    template <class Value>
+    void
+    _rb_tree_update_size(__rb_tree_node_base* x) {
+        static_cast<__rb_tree_size_node<Value>*>(x)->subtree_size =
+            1 + _rb_tree_subtree_size<Value>(x->left)
+              + _rb_tree_subtree_size<Value>(x->right);
+    }
+
+    // subtree sizes, for O(log N) nth(), rank() and index_of();
+    // range_aggregate() counts the elements in the range.
+    struct rb_tree_order_statistics {
+        template <class Value>
+        struct node_traits {
+            typedef __rb_tree_size_node<Value>  node_type;
+            typedef size_t                      summary_type;
+
+            static __rb_tree_update_fn update() { return &_rb_tree_update_size<Value>; }
+            static void construct(node_type*) {}
+            static void destroy(node_type*) {}
+
+            static summary_type lift(const Value&) { return 1; }
+            static summary_type combine(summary_type a, summary_type b) { return a + b; }
+            static summary_type summary(const __rb_tree_node_base* x) {
+                return _rb_tree_subtree_size<Value>(x);
+            }
+        };
+    };
+
+    template <class Value, class Summary>
+    struct __rb_tree_summary_node : public __rb_tree_size_node<Value> {
+        typename Summary::result_type   summary;
+    };
+
+    template <class Value, class Summary>
+    void
+    _rb_tree_update_summary(__rb_tree_node_base* x) {
+        typedef __rb_tree_summary_node<Value, Summary> node_type;
+        _rb_tree_update_size<Value>(x);
+
+        Summary f;
+        node_type* node = static_cast<node_type*>(x);
+        typename Summary::result_type sum = f(node->value_field);
+        if (x->left != 0) {
+            sum = f(static_cast<node_type*>(x->left)->summary, sum);
+        }
+        if (x->right != 0) {
+            sum = f(sum, static_cast<node_type*>(x->right)->summary);
+        }
+        node->summary = sum;
+    }
+
+    /*
+    ** User-defined subtree summaries, on top of order statistics.
+    ** Summary is a stateless functor with
+    **      typedef ... result_type;
+    **      result_type operator()(const value_type& v) const;
+    **      result_type operator()(const result_type& left,
+    **                             const result_type& right) const;
+    ** where the two-argument form is associative, e.g. a sum, a maximum or
+    ** the highest interval end point.
+    */
+    template <class Summary>
+    struct rb_tree_summary {
+        template <class Value>
+        struct node_traits {
+            typedef __rb_tree_summary_node<Value, Summary>  node_type;
+            typedef typename Summary::result_type           summary_type;
+
+            static __rb_tree_update_fn update() {
+                return &_rb_tree_update_summary<Value, Summary>;
+            }
+            static void construct(node_type* p) { rayn::construct(&p->summary); }
+            static void destroy(node_type* p) { rayn::destroy(&p->summary); }
+
+            static summary_type lift(const Value& v) { return Summary()(v); }
+            static summary_type combine(const summary_type& a, const summary_type& b) {
+                return Summary()(a, b);
+            }
+            static const summary_type& summary(const __rb_tree_node_base* x) {
+                return static_cast<const node_type*>(x)->summary;
+            }
+        };
+    };
+
     __rb_tree_node_base*
     _rb_tree_increment(__rb_tree_node_base* node) throw ();
 
@@ -207,14 +334,210 @@ namespace rayn {
     _rb_tree_insert_and_rebalance(const bool insert_left,
                                   __rb_tree_node_base* x,
                                   __rb_tree_node_base* pa,
-                                  __rb_tree_node_base& header);
+                                  __rb_tree_node_base& header,
+                                  __rb_tree_update_fn update = 0);
 
     __rb_tree_node_base*
     _rb_tree_rebalance_for_erase(__rb_tree_node_base* const z,
-                                 __rb_tree_node_base& header);
+                                 __rb_tree_node_base& header,
+                                 __rb_tree_update_fn update = 0);
+
+    // A detached red-black tree: root->parent is null, the root is black
+    // (or null), and black_height counts the black nodes on any path from
+    // the root down to null.
+    struct __rb_tree_subtree {
+        __rb_tree_node_base*    root;
+        size_t                  black_height;
+    };
+
+    size_t
+    _rb_tree_black_height(const __rb_tree_node_base* x) throw ();
+
+    // Join l, k and r, where every key in l < k < every key in r.
+    // O(|black height of l - black height of r| + 1)
+    __rb_tree_subtree
+    _rb_tree_join(__rb_tree_subtree l, __rb_tree_node_base* k,
+                  __rb_tree_subtree r, __rb_tree_update_fn update = 0);
+
+    // Join l and r without a middle node. O(logN)
+    __rb_tree_subtree
+    _rb_tree_join2(__rb_tree_subtree l, __rb_tree_subtree r,
+                   __rb_tree_update_fn update = 0);
+
+    // R for the heterogeneous lookup overloads, which exist only when
+    // Compare is transparent. KT keeps the test dependent so that it is
+    // not evaluated before overload resolution.
+    template <class Compare, class KT, class R>
+    struct __rb_tree_if_transparent
+    : public enable_if<__has_is_transparent<Compare>::value, R> {};
+
+    /*
+    ** Owning handle to a node extracted from an rb_tree. The node keeps its
+    ** value and its memory, so inserting the handle into a tree with an
+    ** equal allocator relinks it without allocating. A handle that is never
+    ** inserted destroys and frees its node.
+    */
+    template <class Value, class Alloc, class Augment>
+    class __rb_tree_node_handle {
+        template <class, class, class, class, class, class>
+        friend class rb_tree;
+
+    protected:
+        typedef typename Augment::template node_traits<Value>   node_traits;
+        typedef typename node_traits::node_type                 node_type;
+        typedef typename Alloc::template rebind<node_type>::other node_allocator;
+        typedef __rb_tree_node<Value>*                          link_type;
+
+    public:
+        typedef Alloc   allocator_type;
+
+        __rb_tree_node_handle() : _m_ptr(0), _m_alloc() {}
+
+        __rb_tree_node_handle(__rb_tree_node_handle&& nh)
+        : _m_ptr(nh._m_ptr), _m_alloc(nh._m_alloc)
+        {
+            nh._m_ptr = 0;
+        }
+
+        __rb_tree_node_handle&
+        operator=(__rb_tree_node_handle&& nh) {
+            if (this != &nh) {
+                _m_drop();
+                _m_ptr = nh._m_ptr;
+                _m_alloc = nh._m_alloc;
+                nh._m_ptr = 0;
+            }
+            return *this;
+        }
+
+        ~__rb_tree_node_handle() { _m_drop(); }
+
+        bool
+        empty() const { return _m_ptr == 0; }
+
+        allocator_type
+        get_allocator() const { return allocator_type(_m_alloc); }
+
+        void
+        swap(__rb_tree_node_handle& nh) {
+            rayn::swap(_m_ptr, nh._m_ptr);
+            rayn::swap(_m_alloc, nh._m_alloc);
+        }
+
+    protected:
+        link_type       _m_ptr;
+        node_allocator  _m_alloc;
 
+        __rb_tree_node_handle(link_type p, const node_allocator& a)
+        : _m_ptr(p), _m_alloc(a) {}
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+        link_type _m_release() {
+            link_type p = _m_ptr;
+            _m_ptr = 0;
+            return p;
+        }
+
+        void _m_drop() {
+            if (_m_ptr != 0) {
+                node_traits::destroy(static_cast<node_type*>(_m_ptr));
+                rayn::destroy(&_m_ptr->value_field);
+                _m_alloc.deallocate(static_cast<node_type*>(_m_ptr));
+                _m_ptr = 0;
+            }
+        }
+
+    private:
+        // move only
+        __rb_tree_node_handle(const __rb_tree_node_handle&);
+        __rb_tree_node_handle& operator=(const __rb_tree_node_handle&);
+    };
+
+    // node handle of set and multiset
+    template <class Value, class Alloc, class Augment>
+    class __rb_tree_set_node_handle
+    : public __rb_tree_node_handle<Value, Alloc, Augment>
+    {
+        typedef __rb_tree_node_handle<Value, Alloc, Augment>    base;
+
+    public:
+        typedef Value   value_type;
+
+        __rb_tree_set_node_handle() {}
+
+        __rb_tree_set_node_handle(base&& nh) : base(rayn::move(nh)) {}
+
+        __rb_tree_set_node_handle(__rb_tree_set_node_handle&& nh)
+        : base(rayn::move(nh)) {}
+
+        __rb_tree_set_node_handle&
+        operator=(__rb_tree_set_node_handle&& nh) {
+            base::operator=(rayn::move(nh));
+            return *this;
+        }
+
+        // the value may be changed before the node is inserted again
+        value_type&
+        value() const { return this->_m_ptr->value_field; }
+    };
+
+    // node handle of map and multimap, key() is writable
+    template <class Key, class T, class Alloc, class Augment>
+    class __rb_tree_map_node_handle
+    : public __rb_tree_node_handle<pair<const Key, T>, Alloc, Augment>
+    {
+        typedef __rb_tree_node_handle<pair<const Key, T>, Alloc, Augment> base;
+
+    public:
+        typedef Key     key_type;
+        typedef T       mapped_type;
+
+        __rb_tree_map_node_handle() {}
+
+        __rb_tree_map_node_handle(base&& nh) : base(rayn::move(nh)) {}
+
+        __rb_tree_map_node_handle(__rb_tree_map_node_handle&& nh)
+        : base(rayn::move(nh)) {}
+
+        __rb_tree_map_node_handle&
+        operator=(__rb_tree_map_node_handle&& nh) {
+            base::operator=(rayn::move(nh));
+            return *this;
+        }
+
+        key_type&
+        key() const { return const_cast<key_type&>(this->_m_ptr->value_field.first); }
+
+        mapped_type&
+        mapped() const { return this->_m_ptr->value_field.second; }
+    };
+
+    // result of inserting a node handle into a unique container; node
+    // still owns the element when it was not inserted
+    template <class Iterator, class NodeHandle>
+    struct __rb_tree_insert_return {
+        Iterator    position;
+        bool        inserted;
+        NodeHandle  node;
+
+        __rb_tree_insert_return(Iterator pos, bool ins, NodeHandle&& nh)
+        : position(pos), inserted(ins), node(rayn::move(nh)) {}
+
+        __rb_tree_insert_return(__rb_tree_insert_return&& r)
+        : position(r.position), inserted(r.inserted), node(rayn::move(r.node)) {}
+
+        __rb_tree_insert_return&
+        operator=(__rb_tree_insert_return&& r) {
+            position = r.position;
+            inserted = r.inserted;
+            node = rayn::move(r.node);
+            return *this;
+        }
+    };
+
+
+    template <class Key, class Value, class KeyOfValue, class Compare,
+              class Alloc = allocator<Value>,
+              class Augment = rb_tree_no_augment>
     class rb_tree {
     protected:
         typedef void*                           void_pointer;
@@ -224,7 +547,9 @@ namespace rayn {
         typedef __rb_tree_node<Value>*          link_type;
         typedef const __rb_tree_node<Value>*    const_link_type;
         typedef __rb_tree_node<Value>           rb_tree_node;
-        typedef allocator<rb_tree_node>         node_allocator;
+        typedef typename Augment::template node_traits<Value>   node_traits;
+        typedef typename node_traits::node_type node_type;
+        typedef typename Alloc::template rebind<node_type>::other node_allocator;
         typedef __rb_tree_color                 color_type;
         
 
@@ -237,6 +562,7 @@ namespace rayn {
         typedef const value_type&           const_reference;
         typedef size_t                      size_type;
         typedef ptrdiff_t                   difference_type;
+        typedef Alloc                       allocator_type;
 
         // iterators typedefs
         typedef __rb_tree_iterator<value_type>          iterator;
@@ -244,10 +570,14 @@ namespace rayn {
         typedef reverse_iterator_t<iterator>            reverse_iterator;
         typedef reverse_iterator_t<const_iterator>      const_reverse_iterator;
 
+        typedef typename node_traits::summary_type      summary_type;
+        typedef __rb_tree_node_handle<Value, Alloc, Augment>    node_handle;
+
     protected:
         size_type   node_count;
         base_node   header;
         Compare     key_compare;
+        node_allocator  node_alloc;
 
         base_ptr&       _m_root()               { return header.parent; }
         const_base_ptr  _m_root() const         { return header.parent; }
@@ -304,6 +634,21 @@ namespace rayn {
         _s_right(const_base_ptr x)
         { return static_cast<const_link_type>(x->right); }
 
+        // only compiles for nodes that carry subtree_size
+        static size_type
+        _s_subtree_size(const_base_ptr x)
+        { return x == 0 ? 0 : static_cast<const node_type*>(x)->subtree_size; }
+
+        // recompute the augmented data of a whole subtree, children first
+        static void
+        _s_update_subtree(base_ptr x) {
+            if (x != 0 && node_traits::update()) {
+                _s_update_subtree(x->left);
+                _s_update_subtree(x->right);
+                node_traits::update()(x);
+            }
+        }
+
         static base_ptr _s_minimum(base_ptr x) {
             return __rb_tree_node_base::minimum(x);
         }
@@ -320,10 +665,10 @@ namespace rayn {
     private:
         // helper functions
         link_type get_node() {
-            return node_allocator::allocate();
+            return node_alloc.allocate();
         }
         void put_node(link_type p) {
-            node_allocator::deallocate(p);
+            node_alloc.deallocate(static_cast<node_type*>(p));
         }
         link_type create_node(const value_type& x) {
             link_type tmp = get_node();
@@ -332,6 +677,7 @@ namespace rayn {
             } catch (...) {
                 put_node(tmp);
             }
+            node_traits::construct(static_cast<node_type*>(tmp));
             return tmp;
         }
         link_type clone_node(const_link_type x) {
@@ -342,6 +688,7 @@ namespace rayn {
             return tmp;
         }
         void destroy_node(link_type p) {
+            node_traits::destroy(static_cast<node_type*>(p));
             rayn::destroy(&p->value_field);
         }
         void drop_node(link_type p) {
@@ -370,9 +717,19 @@ namespace rayn {
         pair<base_ptr, base_ptr>
         _m_get_insert_equal_pos(const key_type& k);
 
+        pair<base_ptr, base_ptr>
+        _m_get_insert_hint_unique_pos(const_iterator pos, const key_type& k);
+
+        pair<base_ptr, base_ptr>
+        _m_get_insert_hint_equal_pos(const_iterator pos, const key_type& k);
+
         iterator
         _m_insert(base_ptr x, base_ptr pa, const value_type& v);
 
+        // link an existing node z at a position found by _m_get_insert_*_pos
+        iterator
+        _m_insert_node(base_ptr x, base_ptr pa, link_type z);
+
         iterator
         _m_insert_lower(base_ptr pa, const value_type& v);
 
@@ -382,6 +739,73 @@ namespace rayn {
         link_type
         _m_copy(const_link_type x, base_ptr p);
 
+        template <typename ForwardIterator>
+        link_type
+        _m_build_sorted(ForwardIterator& first, size_type n, base_ptr pa,
+                        size_type depth, size_type red_depth);
+
+        template <typename ForwardIterator>
+        void
+        _m_assign_sorted(ForwardIterator first, size_type n);
+
+        template <typename ForwardIterator>
+        bool
+        _m_is_sorted(ForwardIterator first, ForwardIterator last,
+                     bool strict, true_type) const;
+
+        template <typename ForwardIterator>
+        bool
+        _m_is_sorted(ForwardIterator, ForwardIterator, bool, false_type) const
+        { return false; }
+
+        // join/split based set algebra
+        typedef __rb_tree_subtree   subtree;
+
+        static subtree
+        _s_subtree(base_ptr x, size_t black_height);
+
+        subtree
+        _m_take_subtree();
+
+        void
+        _m_install_subtree(subtree t, size_type count);
+
+        void
+        _m_drop_subtree(base_ptr x);
+
+        void
+        _m_split(subtree t, const key_type& k,
+                 subtree& l, base_ptr& mid, subtree& r);
+
+        subtree
+        _m_union(subtree t1, subtree t2, subtree& rest, size_type& matched);
+
+        subtree
+        _m_intersect(subtree t1, subtree t2, subtree& rest, size_type& matched);
+
+        subtree
+        _m_difference(subtree t1, subtree t2, subtree& rest, size_type& matched);
+
+        template <typename InputIterator>
+        void
+        _m_insert_unique_range(InputIterator first, InputIterator last,
+                               input_iterator_tag);
+
+        template <typename ForwardIterator>
+        void
+        _m_insert_unique_range(ForwardIterator first, ForwardIterator last,
+                               forward_iterator_tag);
+
+        template <typename InputIterator>
+        void
+        _m_insert_equal_range(InputIterator first, InputIterator last,
+                              input_iterator_tag);
+
+        template <typename ForwardIterator>
+        void
+        _m_insert_equal_range(ForwardIterator first, ForwardIterator last,
+                              forward_iterator_tag);
+
         void
         _m_erase(link_type x);
 
@@ -391,29 +815,54 @@ namespace rayn {
         void
         _m_erase_aux(const_iterator first, const_iterator last);
 
+        // KT is key_type, or any type Compare accepts when transparent
+        template <class KT>
+        iterator
+        _m_lower_bound(link_type x, base_ptr pos, const KT& k);
+
+        template <class KT>
+        const_iterator
+        _m_lower_bound(const_link_type x, const_base_ptr pos, const KT& k) const;
+
+        template <class KT>
         iterator
-        _m_lower_bound(link_type x, base_ptr pos, const Key& k);
+        _m_upper_bound(link_type x, base_ptr pos, const KT& k);
 
+        template <class KT>
         const_iterator
-        _m_lower_bound(const_link_type x, const_base_ptr pos, const Key& k) const;
+        _m_upper_bound(const_link_type x, const_base_ptr pos, const KT& k) const;
 
+        template <class KT>
         iterator
-        _m_upper_bound(link_type x, base_ptr pos, const Key& k);
+        _m_find(const KT& k);
 
+        template <class KT>
         const_iterator
-        _m_upper_bound(const_link_type x, const_base_ptr pos, const Key& k) const;
+        _m_find(const KT& k) const;
+
+        template <class KT>
+        pair<iterator, iterator>
+        _m_equal_range(const KT& k);
+
+        template <class KT>
+        pair<const_iterator, const_iterator>
+        _m_equal_range(const KT& k) const;
 
     public:
         // constructor/destructor
-        rb_tree(const Compare& comp = Compare())
-        : header(), node_count(0), key_compare(comp) 
+        rb_tree(const Compare& comp = Compare(),
+                const allocator_type& a = allocator_type())
+        : header(), node_count(0), key_compare(comp), node_alloc(a)
         { _m_initialize(); }
 
+        // the copy allocates from the same allocator
         rb_tree(const rb_tree& other)
-        : header(), node_count(0), key_compare(other.key_compare)
+        : header(), node_count(0), key_compare(other.key_compare),
+          node_alloc(other.node_alloc)
         {
             if (other._m_root() != 0) {
                 _m_root() = _m_copy(other._m_begin(), _m_end());
+                _s_update_subtree(_m_root());
                 _m_leftmost() = _s_minimum(_m_root());
                 _m_rightmost() = _s_maximum(_m_root());
                 node_count = other.node_count;
@@ -421,7 +870,8 @@ namespace rayn {
         }
 
         rb_tree(rb_tree&& other)
-        : header(), node_count(0), key_compare(other.key_compare)
+        : header(), node_count(0), key_compare(other.key_compare),
+          node_alloc(other.node_alloc)
         {
             if (other._m_root() != 0) {
                 _m_move_data(other);
@@ -440,6 +890,10 @@ namespace rayn {
         key_comp() const
         { return key_compare; }
 
+        allocator_type
+        get_allocator() const
+        { return allocator_type(node_alloc); }
+
         iterator
         begin()
         { return iterator(header.left); }
@@ -493,6 +947,19 @@ namespace rayn {
         iterator
         insert_equal(const value_type& v);
 
+        /*
+        ** @brief   Insert v using pos as a hint. When v belongs right
+        **          before or right after pos, no search from the root is
+        **          done and the insert is amortized O(1).
+        ** @return  The inserted element, or the equivalent one already
+        **          in the tree for insert_unique.
+        */
+        iterator
+        insert_unique(const_iterator pos, const value_type& v);
+
+        iterator
+        insert_equal(const_iterator pos, const value_type& v);
+
         template <typename InputIterator>
         void
         insert_unique(InputIterator first, InputIterator last);
@@ -501,6 +968,18 @@ namespace rayn {
         void
         insert_equal(InputIterator first, InputIterator last);
 
+        /*
+        ** @brief   Replace the contents with [first, last), which must be
+        **          sorted by key (and free of duplicates for unique trees).
+        ** @complexity  O(N), no comparisons and no rebalancing.
+        */
+        template <typename ForwardIterator>
+        void
+        assign_sorted(ForwardIterator first, ForwardIterator last) {
+            clear();
+            _m_assign_sorted(first, size_type(rayn::distance(first, last)));
+        }
+
         iterator
         erase(const_iterator pos) {
             const_iterator ret = pos;
@@ -526,6 +1005,74 @@ namespace rayn {
         size_type
         erase(const key_type& x);
 
+        /*
+        ** @brief   Move the nodes of other into *this without copying or
+        **          allocating. merge_unique leaves the elements whose key
+        **          is already in *this behind in other.
+        **          The allocators must compare equal.
+        ** @complexity  O(M log(N + M)) for M = other.size()
+        */
+        void
+        merge_unique(rb_tree& other);
+
+        void
+        merge_equal(rb_tree& other);
+
+        /*
+        ** @brief   Unlink the element at pos (or the first element equal to
+        **          k) and hand over its node; the handle is empty when k is
+        **          not found. Nothing is freed or allocated.
+        ** @complexity  O(log N)
+        */
+        node_handle
+        extract(const_iterator pos);
+
+        node_handle
+        extract(const key_type& k);
+
+        /*
+        ** @brief   Relink the node owned by nh. On success nh becomes
+        **          empty; a unique tree that already holds the key leaves
+        **          the node in nh. An empty nh inserts nothing and returns
+        **          end(). The allocators must compare equal.
+        ** @complexity  O(log N), amortized O(1) with a good hint
+        */
+        pair<iterator, bool>
+        insert_unique(node_handle&& nh);
+
+        iterator
+        insert_equal(node_handle&& nh);
+
+        iterator
+        insert_unique(const_iterator pos, node_handle&& nh);
+
+        iterator
+        insert_equal(const_iterator pos, node_handle&& nh);
+
+        /*
+        ** @brief   Set algebra on unique trees by split and join. *this
+        **          becomes the union, intersection or difference; nodes
+        **          are relinked, never copied or allocated. On equal keys
+        **          the element of *this is kept. Afterwards other holds:
+        **          union:        only its elements whose key was also in
+        **                        *this, the rest moved into *this
+        **          intersection: all of its elements, untouched
+        **          difference:   all of its elements, untouched
+        **          The elements removed from *this by intersection and
+        **          difference are destroyed.
+        **          The allocators must compare equal.
+        ** @complexity  O(M log(N/M + 1)) for M <= N the two sizes, plus
+        **              destroying the removed elements
+        */
+        void
+        union_unique(rb_tree& other);
+
+        void
+        intersect_unique(rb_tree& other);
+
+        void
+        difference_unique(rb_tree& other);
+
         void
         erase(const key_type* first, const key_type* last);
 
@@ -537,10 +1084,10 @@ namespace rayn {
 
         // find operations.
         iterator
-        find(const key_type& k);
+        find(const key_type& k) { return _m_find(k); }
 
         const_iterator
-        find(const key_type& k) const;
+        find(const key_type& k) const { return _m_find(k); }
 
         size_type
         count(const key_type& k) const;
@@ -566,72 +1113,189 @@ namespace rayn {
         }
 
         pair<iterator, iterator>
-        equal_range(const key_type& k);
+        equal_range(const key_type& k) { return _m_equal_range(k); }
 
         pair<const_iterator, const_iterator>
-        equal_range(const key_type& k) const;
+        equal_range(const key_type& k) const { return _m_equal_range(k); }
+
+        /*
+        ** @brief   Heterogeneous lookup. These overloads take part only
+        **          when Compare::is_transparent exists, and then compare k
+        **          with the stored keys directly, so no key_type temporary
+        **          is built.
+        */
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        find(const KT& k) { return _m_find(k); }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        find(const KT& k) const { return _m_find(k); }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, size_type>::type
+        count(const KT& k) const {
+            pair<const_iterator, const_iterator> p = _m_equal_range(k);
+            return size_type(rayn::distance(p.first, p.second));
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        lower_bound(const KT& k) {
+            return _m_lower_bound(_m_begin(), _m_end(), k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        lower_bound(const KT& k) const {
+            return _m_lower_bound(_m_begin(), _m_end(), k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, iterator>::type
+        upper_bound(const KT& k) {
+            return _m_upper_bound(_m_begin(), _m_end(), k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT, const_iterator>::type
+        upper_bound(const KT& k) const {
+            return _m_upper_bound(_m_begin(), _m_end(), k);
+        }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<iterator, iterator> >::type
+        equal_range(const KT& k) { return _m_equal_range(k); }
+
+        template <class KT>
+        typename __rb_tree_if_transparent<Compare, KT,
+                                          pair<const_iterator, const_iterator> >::type
+        equal_range(const KT& k) const { return _m_equal_range(k); }
+
+        // order statistics, rb_tree_order_statistics trees only
+        /*
+        ** @brief   The k-th element in order, counting from 0.
+        ** @return  end() when k >= size().
+        ** @complexity  O(logN)
+        */
+        iterator
+        nth(size_type k);
+
+        const_iterator
+        nth(size_type k) const
+        { return const_cast<rb_tree*>(this)->nth(k); }
+
+        /*
+        ** @brief   Number of elements whose key is less than k, i.e. the
+        **          position of lower_bound(k).
+        ** @complexity  O(logN)
+        */
+        size_type
+        rank(const key_type& k) const;
+
+        /*
+        ** @brief   Position of pos in order; size() for end().
+        ** @complexity  O(logN)
+        */
+        size_type
+        index_of(const_iterator pos) const;
+
+        difference_type
+        distance(const_iterator first, const_iterator last) const
+        { return difference_type(index_of(last)) - difference_type(index_of(first)); }
+
+        /*
+        ** @brief   Fold the summaries of all elements with lo <= key < hi,
+        **          in order. Augmented trees only.
+        ** @return  summary_type() for an empty range.
+        ** @complexity  O(logN)
+        */
+        summary_type
+        range_aggregate(const key_type& lo, const key_type& hi) const;
+
+        // Debugging.
+        bool
+        __rb_verify() const;
     };
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    // number of black nodes from node up to root
+    inline size_t
+    _rb_tree_black_count(const __rb_tree_node_base* node,
+                         const __rb_tree_node_base* root)
+    {
+        size_t sum = 0;
+        for (; node != 0; node = node->parent) {
+            if (node->color == _s_black) {
+                ++sum;
+            }
+            if (node == root) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator==(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-               const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator==(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+               const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return x.size() == y.size() && rayn::equal(x.begin(), x.end(), y.begin());
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator<(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-              const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator<(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+              const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return rayn::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator!=(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-               const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator!=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+               const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return !(x == y);
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator>(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-              const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator>(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+              const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return y < x;
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator<=(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-               const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator<=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+               const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return !(y < x);
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline bool
-    operator>=(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-               const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    operator>=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+               const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return !(x < y);
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     inline void
-    swap(const rb_tree<Key, Value, KeyOfValue, Compare>& x,
-         const rb_tree<Key, Value, KeyOfValue, Compare>& y)
+    swap(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& x,
+         const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>& y)
     {
         return x.swap(y);
     }
 
     // _m_move_data
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_move_data(rb_tree& other) {
         _m_root() = other._m_root();
         _m_leftmost() = other._m_leftmost();
@@ -646,10 +1310,10 @@ namespace rayn {
     }
 
     // _m_get_insert_unique_pos
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::base_ptr,
-         typename rb_tree<Key, Value, KeyOfValue, Compare>::base_ptr>
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_get_insert_unique_pos(const key_type& k)
     {
         typedef pair<base_ptr, base_ptr> Result;
@@ -676,10 +1340,10 @@ namespace rayn {
     }
 
     // _m_get_insert_equal_pos
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::base_ptr,
-         typename rb_tree<Key, Value, KeyOfValue, Compare>::base_ptr>
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_get_insert_equal_pos(const key_type& k)
     {
         typedef pair<base_ptr, base_ptr> Result;
@@ -692,41 +1356,140 @@ namespace rayn {
         return Result(x, y);
     }
 
+    // _m_get_insert_hint_unique_pos
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_get_insert_hint_unique_pos(const_iterator position, const key_type& k)
+    {
+        // Same result convention as _m_get_insert_unique_pos. When k falls
+        // between pos and its neighbour, one of the two has a free child
+        // slot on the facing side, so k is linked there directly.
+        typedef pair<base_ptr, base_ptr> Result;
+        iterator pos = position._const_cast();
+
+        if (pos._m_node == _m_end()) {
+            if (size() > 0 && key_compare(_s_key(_m_rightmost()), k)) {
+                return Result(0, _m_rightmost());
+            }
+            return _m_get_insert_unique_pos(k);
+        } else if (key_compare(k, _s_key(pos._m_node))) {
+            // k goes before pos
+            iterator before = pos;
+            if (pos._m_node == _m_leftmost()) {
+                return Result(_m_leftmost(), _m_leftmost());
+            } else if (key_compare(_s_key((--before)._m_node), k)) {
+                if (_s_right(before._m_node) == 0) {
+                    return Result(0, before._m_node);
+                }
+                return Result(pos._m_node, pos._m_node);
+            }
+            return _m_get_insert_unique_pos(k);
+        } else if (key_compare(_s_key(pos._m_node), k)) {
+            // k goes after pos
+            iterator after = pos;
+            if (pos._m_node == _m_rightmost()) {
+                return Result(0, _m_rightmost());
+            } else if (key_compare(k, _s_key((++after)._m_node))) {
+                if (_s_right(pos._m_node) == 0) {
+                    return Result(0, pos._m_node);
+                }
+                return Result(after._m_node, after._m_node);
+            }
+            return _m_get_insert_unique_pos(k);
+        }
+        // equivalent key already at pos
+        return Result(pos._m_node, 0);
+    }
+
+    // _m_get_insert_hint_equal_pos
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::base_ptr>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_get_insert_hint_equal_pos(const_iterator position, const key_type& k)
+    {
+        typedef pair<base_ptr, base_ptr> Result;
+        iterator pos = position._const_cast();
+
+        if (pos._m_node == _m_end()) {
+            if (size() > 0 && !key_compare(k, _s_key(_m_rightmost()))) {
+                return Result(0, _m_rightmost());
+            }
+            return _m_get_insert_equal_pos(k);
+        } else if (!key_compare(_s_key(pos._m_node), k)) {
+            // k goes before pos
+            iterator before = pos;
+            if (pos._m_node == _m_leftmost()) {
+                return Result(_m_leftmost(), _m_leftmost());
+            } else if (!key_compare(k, _s_key((--before)._m_node))) {
+                if (_s_right(before._m_node) == 0) {
+                    return Result(0, before._m_node);
+                }
+                return Result(pos._m_node, pos._m_node);
+            }
+            return _m_get_insert_equal_pos(k);
+        } else {
+            // k goes after pos
+            iterator after = pos;
+            if (pos._m_node == _m_rightmost()) {
+                return Result(0, _m_rightmost());
+            } else if (!key_compare(_s_key((++after)._m_node), k)) {
+                if (_s_right(pos._m_node) == 0) {
+                    return Result(0, pos._m_node);
+                }
+                return Result(after._m_node, after._m_node);
+            }
+            return _m_get_insert_equal_pos(k);
+        }
+    }
+
 
     // _m_insert
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_insert(base_ptr x, base_ptr pa, const value_type& v)
+    {
+        return _m_insert_node(x, pa, create_node(v));
+    }
+
+    // _m_insert_node
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_insert_node(base_ptr x, base_ptr pa, link_type z)
     {
         bool insert_left = (x != 0 || pa == _m_end()
-                            || key_compare(KeyOfValue()(v), _s_key(pa)));
+                            || key_compare(_s_key(z), _s_key(pa)));
 
-        link_type z = create_node(v);
-        _rb_tree_insert_and_rebalance(insert_left, z, pa, header);
+        _rb_tree_insert_and_rebalance(insert_left, z, pa, header,
+                                      node_traits::update());
         ++node_count;
         return iterator(z);
     }
 
     // _m_insert_lower
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_insert_lower(base_ptr pa, const value_type& v)
     {
         bool insert_left = (pa == _m_end()
                             || !key_compare(_s_key(pa), KeyOfValue()(v)));
 
         link_type z = create_node(v);
-        _rb_tree_insert_and_rebalance(insert_left, z, pa, header);
+        _rb_tree_insert_and_rebalance(insert_left, z, pa, header,
+                                      node_traits::update());
         ++node_count;
         return iterator(z);
     }
 
     // _m_insert_equal_lower
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_insert_equal_lower(base_ptr pa, const value_type& v)
     {
         link_type cur = _m_begin();
@@ -741,9 +1504,9 @@ namespace rayn {
     }
 
     // _m_copy
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::link_type
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::link_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_copy(const_link_type x, base_ptr p) {
         // Structural copy
         link_type top = clone_node(x);
@@ -771,10 +1534,98 @@ namespace rayn {
         return top;
     }
 
+    // _m_build_sorted
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename ForwardIterator>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::link_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_build_sorted(ForwardIterator& first, size_type n, base_ptr pa,
+                    size_type depth, size_type red_depth)
+    {
+        // Consume n values in order: left half, middle, right half.
+        // Halves differ by at most one, so all leaves sit on the last two
+        // levels; painting only the incomplete last level red keeps every
+        // path at the same black height.
+        if (n == 0) {
+            return 0;
+        }
+        const size_type left_n = (n - 1) / 2;
+        link_type left = _m_build_sorted(first, left_n, 0, depth + 1, red_depth);
+        link_type x = 0;
+        try {
+            x = create_node(*first);
+        } catch (...) {
+            _m_erase(left);
+            throw;
+        }
+        ++first;
+        x->color = (depth == red_depth) ? _s_red : _s_black;
+        x->parent = pa;
+        x->left = left;
+        x->right = 0;
+        if (left != 0) {
+            left->parent = x;
+        }
+        try {
+            x->right = _m_build_sorted(first, n - 1 - left_n, x,
+                                       depth + 1, red_depth);
+        } catch (...) {
+            _m_erase(x);
+            throw;
+        }
+        if (node_traits::update()) {
+            node_traits::update()(x);
+        }
+        return x;
+    }
+
+    // _m_assign_sorted
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename ForwardIterator>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_assign_sorted(ForwardIterator first, size_type n)
+    {
+        // the tree must be empty. red_depth is the number of complete
+        // levels: the largest k with 2^k - 1 <= n.
+        if (n == 0) {
+            return;
+        }
+        size_type red_depth = 0;
+        while ((size_type(2) << red_depth) - 1 <= n) {
+            ++red_depth;
+        }
+        _m_root() = _m_build_sorted(first, n, _m_end(), 0, red_depth);
+        _m_leftmost() = _s_minimum(_m_root());
+        _m_rightmost() = _s_maximum(_m_root());
+        node_count = n;
+    }
+
+    // _m_is_sorted
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename ForwardIterator>
+    bool
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_is_sorted(ForwardIterator first, ForwardIterator last,
+                 bool strict, true_type) const
+    {
+        if (first == last) {
+            return true;
+        }
+        ForwardIterator next = first;
+        for (++next; next != last; ++first, ++next) {
+            if (strict ? !key_compare(KeyOfValue()(*first), KeyOfValue()(*next))
+                       : key_compare(KeyOfValue()(*next), KeyOfValue()(*first))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // _m_erase
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_erase(link_type x)
     {
         // Erase without rebalancing.
@@ -787,21 +1638,22 @@ namespace rayn {
     }
 
     // _m_erase_aux
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_erase_aux(const_iterator pos)
     {
         base_ptr ret = _rb_tree_rebalance_for_erase
-                        (const_cast<base_ptr>(pos._m_node), header);
+                        (const_cast<base_ptr>(pos._m_node), header,
+                         node_traits::update());
         drop_node(static_cast<link_type>(ret));
         --node_count;
     }
 
     // _m_erase_aux
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     _m_erase_aux(const_iterator first, const_iterator last)
     {
         if (first == begin() && last == end()) {
@@ -814,10 +1666,11 @@ namespace rayn {
     }
 
     // _m_lower_bound
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    _m_lower_bound(link_type x, base_ptr pos, const Key& k)
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_lower_bound(link_type x, base_ptr pos, const KT& k)
     {
         while (x != 0) {
             if (!key_compare(_s_key(x), k)) {
@@ -829,10 +1682,11 @@ namespace rayn {
         return iterator(pos);
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    _m_lower_bound(const_link_type x, const_base_ptr pos, const Key& k) const
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::const_iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_lower_bound(const_link_type x, const_base_ptr pos, const KT& k) const
     {
         while (x != 0) {
             if (!key_compare(_s_key(x), k)) {
@@ -845,10 +1699,11 @@ namespace rayn {
     }
 
     // _m_upper_bound
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    _m_upper_bound(link_type x, base_ptr pos, const Key& k)
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_upper_bound(link_type x, base_ptr pos, const KT& k)
     {
         while (x != 0) {
             if (key_compare(k, _s_key(x))) {
@@ -860,10 +1715,11 @@ namespace rayn {
         return iterator(pos);
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    _m_upper_bound(const_link_type x, const_base_ptr pos, const Key& k) const
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::const_iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_upper_bound(const_link_type x, const_base_ptr pos, const KT& k) const
     {
         while (x != 0) {
             if (key_compare(k, _s_key(x))) {
@@ -876,9 +1732,9 @@ namespace rayn {
     }
 
     // operator=
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    rb_tree<Key, Value, KeyOfValue, Compare>&
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>&
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     operator= (const rb_tree& other)
     {
         if (this != &other) {
@@ -886,6 +1742,7 @@ namespace rayn {
             key_compare = other.key_compare;
             if (other._m_root() != 0) {
                 _m_root() = _m_copy(other._m_begin(), _m_end());
+                _s_update_subtree(_m_root());
                 _m_leftmost() = _s_minimum(_m_root());
                 _m_rightmost() = _s_maximum(_m_root());
                 node_count = other.node_count;
@@ -895,9 +1752,9 @@ namespace rayn {
     }
 
     // swap
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     swap(rb_tree& t)
     {
         if (_m_root() == 0) {
@@ -925,38 +1782,35 @@ namespace rayn {
             t._m_root()->parent = t._m_end();
         }
         rayn::swap(key_compare, t.key_compare);
+        rayn::swap(node_alloc, t.node_alloc);
     }
 
     // assign_unique
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     template <typename InputIterator>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     assign_unique(InputIterator first, InputIterator last)
     {
         clear();
-        for (; first != last; ++first) {
-            insert_unique(*first);
-        }
+        insert_unique(first, last);
     }
 
     // assign_equal
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     template <typename InputIterator>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     assign_equal(InputIterator first, InputIterator last)
     {
         clear();
-        for (; first != last; ++first) {
-            insert_equal(*first);
-        }
+        insert_equal(first, last);
     }
 
     // insert_unique
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator, bool>
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator, bool>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     insert_unique(const value_type& v)
     {
         typedef pair<iterator, bool> Result;
@@ -970,9 +1824,9 @@ namespace rayn {
     }
 
     // insert_equal
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     insert_equal(const value_type& v)
     {
         typedef pair<iterator, bool> Result;
@@ -981,34 +1835,113 @@ namespace rayn {
         return _m_insert(insert_pos.first, insert_pos.second, v);
     }
 
+    // insert_unique with hint
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_unique(const_iterator pos, const value_type& v)
+    {
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_hint_unique_pos(pos, KeyOfValue()(v));
+        if (insert_pos.second) {
+            return _m_insert(insert_pos.first, insert_pos.second, v);
+        }
+        return iterator(insert_pos.first);
+    }
+
+    // insert_equal with hint
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_equal(const_iterator pos, const value_type& v)
+    {
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_hint_equal_pos(pos, KeyOfValue()(v));
+        return _m_insert(insert_pos.first, insert_pos.second, v);
+    }
+
     // insert_unique with range
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     template <typename InputIterator>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     insert_unique(InputIterator first, InputIterator last)
     {
+        _m_insert_unique_range(first, last, iterator_category(first));
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename InputIterator>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_insert_unique_range(InputIterator first, InputIterator last,
+                           input_iterator_tag)
+    {
+        // hinting at end() links ascending runs straight to the right of
+        // the rightmost node, skipping the search from the root.
         for (; first != last; ++first) {
-            insert_unique(*first);
+            insert_unique(end(), *first);
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename ForwardIterator>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_insert_unique_range(ForwardIterator first, ForwardIterator last,
+                           forward_iterator_tag)
+    {
+        typedef typename iterator_traits<ForwardIterator>::value_type ValueType;
+        if (empty() && _m_is_sorted(first, last, true,
+                                    is_same<ValueType, value_type>())) {
+            _m_assign_sorted(first, size_type(rayn::distance(first, last)));
+        } else {
+            _m_insert_unique_range(first, last, input_iterator_tag());
         }
     }
 
     // insert_equal with range
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     template <typename InputIterator>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     insert_equal(InputIterator first, InputIterator last)
+    {
+        _m_insert_equal_range(first, last, iterator_category(first));
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename InputIterator>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_insert_equal_range(InputIterator first, InputIterator last,
+                          input_iterator_tag)
     {
         for (; first != last; ++first) {
-            insert_equal(*first);
+            insert_equal(end(), *first);
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <typename ForwardIterator>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_insert_equal_range(ForwardIterator first, ForwardIterator last,
+                          forward_iterator_tag)
+    {
+        typedef typename iterator_traits<ForwardIterator>::value_type ValueType;
+        if (empty() && _m_is_sorted(first, last, false,
+                                    is_same<ValueType, value_type>())) {
+            _m_assign_sorted(first, size_type(rayn::distance(first, last)));
+        } else {
+            _m_insert_equal_range(first, last, input_iterator_tag());
         }
     }
 
     // erase
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::size_type
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     erase(const key_type& x)
     {
         pair<iterator, iterator> p = equal_range(x);
@@ -1017,9 +1950,9 @@ namespace rayn {
         return old_size - size();
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
     void
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     erase(const key_type* first, const key_type* last)
     {
         while (first != last) {
@@ -1027,28 +1960,30 @@ namespace rayn {
         }
     }
 
-    // find
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    find(const key_type& k) {
+    // _m_find
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_find(const KT& k) {
         iterator ret = _m_lower_bound(_m_begin(), _m_end(), k);
         return (ret == end() || key_compare(k, _s_key(ret._m_node))) ? end() : ret;
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    find(const key_type& k) const
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::const_iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_find(const KT& k) const
     {
         const_iterator ret = _m_lower_bound(_m_begin(), _m_end(), k);
         return (ret == end() || key_compare(k, _s_key(ret._m_node))) ? end() : ret;
     }
 
     // count
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    typename rb_tree<Key, Value, KeyOfValue, Compare>::size_type
-    rb_tree<Key, Value, KeyOfValue, Compare>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
     count(const key_type& k) const
     {
         pair<const_iterator, const_iterator> p = equal_range(k);
@@ -1056,12 +1991,13 @@ namespace rayn {
         return n;
     }
 
-    // equal_range
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator,
-         typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator>
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    equal_range(const key_type& k)
+    // _m_equal_range
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_equal_range(const KT& k)
     {
         link_type cur = _m_begin();
         base_ptr pos = _m_end();
@@ -1083,11 +2019,12 @@ namespace rayn {
         return pair<iterator, iterator>(iterator(pos), iterator(pos));
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare>
-    pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator,
-         typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator>
-    rb_tree<Key, Value, KeyOfValue, Compare>::
-    equal_range(const key_type& k) const
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    template <class KT>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::const_iterator,
+         typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::const_iterator>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_equal_range(const KT& k) const
     {
         const_link_type cur = _m_begin();
         const_base_ptr pos = _m_end();
@@ -1111,6 +2048,554 @@ namespace rayn {
                     const_iterator>(const_iterator(pos),
                                     const_iterator(pos));
     }
+
+    // merge_unique
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    merge_unique(rb_tree& other)
+    {
+        if (&other == this) {
+            return;
+        }
+        assert(node_alloc == other.node_alloc);
+        // other is in order, so the last insert is usually a good hint
+        const_iterator hint = end();
+        for (iterator it = other.begin(); it != other.end(); ) {
+            iterator next = it;
+            ++next;
+            pair<base_ptr, base_ptr> pos =
+                _m_get_insert_hint_unique_pos(hint, _s_key(it._m_node));
+            if (pos.second) {
+                base_ptr z = _rb_tree_rebalance_for_erase(it._m_node, other.header,
+                                                          node_traits::update());
+                --other.node_count;
+                hint = _m_insert_node(pos.first, pos.second,
+                                      static_cast<link_type>(z));
+                ++hint;
+            }
+            it = next;
+        }
+    }
+
+    // merge_equal
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    merge_equal(rb_tree& other)
+    {
+        if (&other == this) {
+            return;
+        }
+        assert(node_alloc == other.node_alloc);
+        const_iterator hint = end();
+        for (iterator it = other.begin(); it != other.end(); ) {
+            iterator next = it;
+            ++next;
+            pair<base_ptr, base_ptr> pos =
+                _m_get_insert_hint_equal_pos(hint, _s_key(it._m_node));
+            base_ptr z = _rb_tree_rebalance_for_erase(it._m_node, other.header,
+                                                      node_traits::update());
+            --other.node_count;
+            hint = _m_insert_node(pos.first, pos.second,
+                                  static_cast<link_type>(z));
+            ++hint;
+            it = next;
+        }
+    }
+
+    // extract
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::node_handle
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    extract(const_iterator pos)
+    {
+        base_ptr z = _rb_tree_rebalance_for_erase
+                        (const_cast<base_ptr>(pos._m_node), header,
+                         node_traits::update());
+        --node_count;
+        return node_handle(static_cast<link_type>(z), node_alloc);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::node_handle
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    extract(const key_type& k)
+    {
+        iterator pos = find(k);
+        return pos == end() ? node_handle() : extract(pos);
+    }
+
+    // insert_unique
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator, bool>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_unique(node_handle&& nh)
+    {
+        typedef pair<iterator, bool> Result;
+        if (nh.empty()) {
+            return Result(end(), false);
+        }
+        assert(nh._m_alloc == node_alloc);
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_unique_pos(_s_key(nh._m_ptr));
+        if (insert_pos.second) {
+            return Result(_m_insert_node(insert_pos.first, insert_pos.second,
+                                         nh._m_release()),
+                          true);
+        }
+        return Result(iterator(insert_pos.first), false);
+    }
+
+    // insert_equal
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_equal(node_handle&& nh)
+    {
+        if (nh.empty()) {
+            return end();
+        }
+        assert(nh._m_alloc == node_alloc);
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_equal_pos(_s_key(nh._m_ptr));
+        return _m_insert_node(insert_pos.first, insert_pos.second,
+                              nh._m_release());
+    }
+
+    // insert_unique with hint
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_unique(const_iterator pos, node_handle&& nh)
+    {
+        if (nh.empty()) {
+            return end();
+        }
+        assert(nh._m_alloc == node_alloc);
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_hint_unique_pos(pos, _s_key(nh._m_ptr));
+        if (insert_pos.second) {
+            return _m_insert_node(insert_pos.first, insert_pos.second,
+                                  nh._m_release());
+        }
+        return iterator(insert_pos.first);
+    }
+
+    // insert_equal with hint
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    insert_equal(const_iterator pos, node_handle&& nh)
+    {
+        if (nh.empty()) {
+            return end();
+        }
+        assert(nh._m_alloc == node_alloc);
+        pair<base_ptr, base_ptr> insert_pos
+            = _m_get_insert_hint_equal_pos(pos, _s_key(nh._m_ptr));
+        return _m_insert_node(insert_pos.first, insert_pos.second,
+                              nh._m_release());
+    }
+
+    // _s_subtree
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::subtree
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _s_subtree(base_ptr x, size_t black_height)
+    {
+        // cut x loose from its parent; a red root may simply turn black
+        subtree ret;
+        ret.root = x;
+        ret.black_height = black_height;
+        if (x != 0) {
+            x->parent = 0;
+            if (x->color == _s_red) {
+                x->color = _s_black;
+                ++ret.black_height;
+            }
+        }
+        return ret;
+    }
+
+    // _m_take_subtree
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::subtree
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_take_subtree()
+    {
+        subtree ret;
+        ret.root = _m_root();
+        ret.black_height = _rb_tree_black_height(ret.root);
+        if (ret.root != 0) {
+            ret.root->parent = 0;
+        }
+        _m_reset();
+        return ret;
+    }
+
+    // _m_install_subtree
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_install_subtree(subtree t, size_type count)
+    {
+        _m_reset();
+        if (t.root != 0) {
+            _m_root() = t.root;
+            t.root->parent = _m_end();
+            _m_leftmost() = _s_minimum(t.root);
+            _m_rightmost() = _s_maximum(t.root);
+            node_count = count;
+        }
+    }
+
+    // _m_drop_subtree
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_drop_subtree(base_ptr x)
+    {
+        while (x != 0) {
+            _m_drop_subtree(x->right);
+            base_ptr y = x->left;
+            drop_node(static_cast<link_type>(x));
+            x = y;
+        }
+    }
+
+    // _m_split
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_split(subtree t, const key_type& k, subtree& l, base_ptr& mid, subtree& r)
+    {
+        // l gets the keys < k, r the keys > k, mid the node equal to k
+        if (t.root == 0) {
+            l = r = t;
+            mid = 0;
+            return;
+        }
+        base_ptr x = t.root;
+        subtree a = _s_subtree(x->left, t.black_height - 1);
+        subtree b = _s_subtree(x->right, t.black_height - 1);
+        if (key_compare(k, _s_key(x))) {
+            subtree rest;
+            _m_split(a, k, l, mid, rest);
+            r = _rb_tree_join(rest, x, b, node_traits::update());
+        } else if (key_compare(_s_key(x), k)) {
+            subtree rest;
+            _m_split(b, k, rest, mid, r);
+            l = _rb_tree_join(a, x, rest, node_traits::update());
+        } else {
+            l = a;
+            mid = x;
+            r = b;
+        }
+    }
+
+    // _m_union
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::subtree
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_union(subtree t1, subtree t2, subtree& rest, size_type& matched)
+    {
+        // rest gets the nodes of t2 whose key is also in t1
+        if (t1.root == 0 || t2.root == 0) {
+            subtree empty = { 0, 0 };
+            rest = empty;
+            return t1.root == 0 ? t2 : t1;
+        }
+        base_ptr x = t1.root;
+        subtree a = _s_subtree(x->left, t1.black_height - 1);
+        subtree b = _s_subtree(x->right, t1.black_height - 1);
+        subtree l2, r2;
+        base_ptr mid;
+        _m_split(t2, _s_key(x), l2, mid, r2);
+        subtree rest_l, rest_r;
+        subtree l = _m_union(a, l2, rest_l, matched);
+        subtree r = _m_union(b, r2, rest_r, matched);
+        if (mid != 0) {
+            ++matched;
+            rest = _rb_tree_join(rest_l, mid, rest_r, node_traits::update());
+        } else {
+            rest = _rb_tree_join2(rest_l, rest_r, node_traits::update());
+        }
+        return _rb_tree_join(l, x, r, node_traits::update());
+    }
+
+    // _m_intersect
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::subtree
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_intersect(subtree t1, subtree t2, subtree& rest, size_type& matched)
+    {
+        // rest keeps all of t2; the nodes of t1 missing from t2 are destroyed
+        if (t1.root == 0 || t2.root == 0) {
+            _m_drop_subtree(t1.root);
+            subtree empty = { 0, 0 };
+            rest = t2;
+            return empty;
+        }
+        base_ptr x = t1.root;
+        subtree a = _s_subtree(x->left, t1.black_height - 1);
+        subtree b = _s_subtree(x->right, t1.black_height - 1);
+        subtree l2, r2;
+        base_ptr mid;
+        _m_split(t2, _s_key(x), l2, mid, r2);
+        subtree rest_l, rest_r;
+        subtree l = _m_intersect(a, l2, rest_l, matched);
+        subtree r = _m_intersect(b, r2, rest_r, matched);
+        if (mid != 0) {
+            ++matched;
+            rest = _rb_tree_join(rest_l, mid, rest_r, node_traits::update());
+            return _rb_tree_join(l, x, r, node_traits::update());
+        }
+        rest = _rb_tree_join2(rest_l, rest_r, node_traits::update());
+        drop_node(static_cast<link_type>(x));
+        return _rb_tree_join2(l, r, node_traits::update());
+    }
+
+    // _m_difference
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::subtree
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    _m_difference(subtree t1, subtree t2, subtree& rest, size_type& matched)
+    {
+        // rest keeps all of t2; the nodes of t1 found in t2 are destroyed,
+        // at most min(|t1|, |t2|) of them
+        if (t1.root == 0 || t2.root == 0) {
+            rest = t2;
+            return t1;
+        }
+        base_ptr x = t1.root;
+        subtree a = _s_subtree(x->left, t1.black_height - 1);
+        subtree b = _s_subtree(x->right, t1.black_height - 1);
+        subtree l2, r2;
+        base_ptr mid;
+        _m_split(t2, _s_key(x), l2, mid, r2);
+        subtree rest_l, rest_r;
+        subtree l = _m_difference(a, l2, rest_l, matched);
+        subtree r = _m_difference(b, r2, rest_r, matched);
+        if (mid != 0) {
+            ++matched;
+            rest = _rb_tree_join(rest_l, mid, rest_r, node_traits::update());
+            drop_node(static_cast<link_type>(x));
+            return _rb_tree_join2(l, r, node_traits::update());
+        }
+        rest = _rb_tree_join2(rest_l, rest_r, node_traits::update());
+        return _rb_tree_join(l, x, r, node_traits::update());
+    }
+
+    // union_unique
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    union_unique(rb_tree& other)
+    {
+        if (&other == this) {
+            return;
+        }
+        assert(node_alloc == other.node_alloc);
+        const size_type total = size() + other.size();
+        size_type matched = 0;
+        subtree t1 = _m_take_subtree();
+        subtree t2 = other._m_take_subtree();
+        subtree rest;
+        subtree t = _m_union(t1, t2, rest, matched);
+        _m_install_subtree(t, total - matched);
+        other._m_install_subtree(rest, matched);
+    }
+
+    // intersect_unique
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    intersect_unique(rb_tree& other)
+    {
+        if (&other == this) {
+            return;
+        }
+        assert(node_alloc == other.node_alloc);
+        const size_type m = other.size();
+        size_type matched = 0;
+        subtree t1 = _m_take_subtree();
+        subtree t2 = other._m_take_subtree();
+        subtree rest;
+        subtree t = _m_intersect(t1, t2, rest, matched);
+        _m_install_subtree(t, matched);
+        other._m_install_subtree(rest, m);
+    }
+
+    // difference_unique
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    void
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    difference_unique(rb_tree& other)
+    {
+        if (&other == this) {
+            clear();
+            return;
+        }
+        assert(node_alloc == other.node_alloc);
+        const size_type n = size();
+        const size_type m = other.size();
+        size_type matched = 0;
+        subtree t1 = _m_take_subtree();
+        subtree t2 = other._m_take_subtree();
+        subtree rest;
+        subtree t = _m_difference(t1, t2, rest, matched);
+        _m_install_subtree(t, n - matched);
+        other._m_install_subtree(rest, m);
+    }
+
+    // nth
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    nth(size_type k)
+    {
+        base_ptr x = _m_root();
+        while (x != 0) {
+            const size_type left = _s_subtree_size(x->left);
+            if (k < left) {
+                x = x->left;
+            } else if (k == left) {
+                return iterator(x);
+            } else {
+                k -= left + 1;
+                x = x->right;
+            }
+        }
+        return end();
+    }
+
+    // rank
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    rank(const key_type& k) const
+    {
+        size_type ret = 0;
+        const_base_ptr x = _m_root();
+        while (x != 0) {
+            if (key_compare(_s_key(x), k)) {
+                ret += _s_subtree_size(x->left) + 1;
+                x = x->right;
+            } else {
+                x = x->left;
+            }
+        }
+        return ret;
+    }
+
+    // index_of
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::size_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    index_of(const_iterator pos) const
+    {
+        const_base_ptr x = pos._m_node;
+        if (x == _m_end()) {
+            return size();
+        }
+        // everything left of x, plus each ancestor reached from the right
+        size_type ret = _s_subtree_size(x->left);
+        for (; x != _m_root(); x = x->parent) {
+            if (x == x->parent->right) {
+                ret += _s_subtree_size(x->parent->left) + 1;
+            }
+        }
+        return ret;
+    }
+
+    // range_aggregate
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::summary_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    range_aggregate(const key_type& lo, const key_type& hi) const
+    {
+        // descend to the highest node inside [lo, hi)
+        const_base_ptr split = _m_root();
+        while (split != 0) {
+            if (key_compare(_s_key(split), lo)) {
+                split = split->right;
+            } else if (!key_compare(_s_key(split), hi)) {
+                split = split->left;
+            } else {
+                break;
+            }
+        }
+        if (split == 0) {
+            return summary_type();
+        }
+
+        summary_type ret = node_traits::lift(_s_value(split));
+        // left of split: the keys >= lo, gathered right to left
+        for (const_base_ptr x = split->left; x != 0; ) {
+            if (key_compare(_s_key(x), lo)) {
+                x = x->right;
+            } else {
+                if (x->right != 0) {
+                    ret = node_traits::combine(node_traits::summary(x->right), ret);
+                }
+                ret = node_traits::combine(node_traits::lift(_s_value(x)), ret);
+                x = x->left;
+            }
+        }
+        // right of split: the keys < hi, gathered left to right
+        for (const_base_ptr x = split->right; x != 0; ) {
+            if (!key_compare(_s_key(x), hi)) {
+                x = x->left;
+            } else {
+                if (x->left != 0) {
+                    ret = node_traits::combine(ret, node_traits::summary(x->left));
+                }
+                ret = node_traits::combine(ret, node_traits::lift(_s_value(x)));
+                x = x->right;
+            }
+        }
+        return ret;
+    }
+
+    // __rb_verify
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+    bool
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::
+    __rb_verify() const
+    {
+        if (node_count == 0 || begin() == end()) {
+            return node_count == 0 && begin() == end()
+                && header.left == &header && header.right == &header;
+        }
+        if (_m_root()->color != _s_black) {
+            return false;
+        }
+        const size_t len = _rb_tree_black_count(_m_leftmost(), _m_root());
+        size_type n = 0;
+        for (const_iterator it = begin(); it != end(); ++it, ++n) {
+            const_base_ptr x = it._m_node;
+            const_base_ptr L = x->left;
+            const_base_ptr R = x->right;
+            if (x->color == _s_red) {
+                if ((L != 0 && L->color == _s_red) || (R != 0 && R->color == _s_red)) {
+                    return false;
+                }
+            }
+            if (L != 0 && (L->parent != x || key_compare(_s_key(x), _s_key(L)))) {
+                return false;
+            }
+            if (R != 0 && (R->parent != x || key_compare(_s_key(R), _s_key(x)))) {
+                return false;
+            }
+            if ((L == 0 || R == 0) && _rb_tree_black_count(x, _m_root()) != len) {
+                return false;
+            }
+        }
+        return n == node_count
+            && _m_leftmost() == _s_minimum(_m_root())
+            && _m_rightmost() == _s_maximum(_m_root());
+    }
 }
 
 #endif
@@ -44,10 +44,67 @@ namespace rayn {
         return _uninitialized_copy(first, last, result, value_type(result));
     }
 
+    /********** uninitialized_move **********/
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator _uninitialized_move_aux(InputIterator first, InputIterator last,
+                                            ForwardIterator result, _true_type) {
+        return copy(first, last, result);
+    }
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator _uninitialized_move_aux(InputIterator first, InputIterator last,
+                                            ForwardIterator result, _false_type) {
+        ForwardIterator cur = result;
+        for (; first != last; ++first, ++cur) {
+            construct(&*cur, rayn::move(*first));
+        }
+        return cur;
+    }
+    template<class InputIterator, class ForwardIterator, class T>
+    ForwardIterator _uninitialized_move(InputIterator first, InputIterator last,
+                                        ForwardIterator result, T*) {
+        typedef typename _type_traits<T>::is_POD_type is_POD;
+        return _uninitialized_move_aux(first, last, result, is_POD());
+    }
+    /*
+    ** @brief Move the range [first, last) into result, the source elements are left moved-from.
+    ** @return result + (last - first)
+    */
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator uninitialized_move(InputIterator first, InputIterator last, ForwardIterator result) {
+        return _uninitialized_move(first, last, result, value_type(result));
+    }
+
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator _uninitialized_move_if_noexcept_aux(InputIterator first, InputIterator last,
+                                                        ForwardIterator result, std::true_type) {
+        return rayn::uninitialized_move(first, last, result);
+    }
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator _uninitialized_move_if_noexcept_aux(InputIterator first, InputIterator last,
+                                                        ForwardIterator result, std::false_type) {
+        return rayn::uninitialized_copy(first, last, result);
+    }
+    template<class InputIterator, class ForwardIterator, class T>
+    ForwardIterator _uninitialized_move_if_noexcept(InputIterator first, InputIterator last,
+                                                    ForwardIterator result, T*) {
+        typedef typename __move_is_safe<T>::type move_is_safe;
+        return _uninitialized_move_if_noexcept_aux(first, last, result, move_is_safe());
+    }
+    /*
+    ** @brief Move the range [first, last) into result if the move constructor can't throw,
+    **        otherwise copy it, so the source is still intact if an exception occurs.
+    ** @return result + (last - first)
+    */
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator uninitialized_move_if_noexcept(InputIterator first, InputIterator last,
+                                                   ForwardIterator result) {
+        return _uninitialized_move_if_noexcept(first, last, result, value_type(first));
+    }
+
     /********** uninitialized_fill **********/
     template<class ForwardIterator, class T>
     void _uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T& value, _true_type) {
-        //TODO
+        rayn::fill(first, last, value);
     }
     template<class ForwardIterator, class T>
     void _uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T& value, _false_type) {
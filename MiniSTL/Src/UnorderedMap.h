@@ -0,0 +1,285 @@
+/*
+** UnorderedMap.h
+** Created by Rayn on 2026/10/17
+*/
+#ifndef _UNORDERED_MAP_H_
+#define _UNORDERED_MAP_H_
+
+#include "Hashtable.h"
+#include "Functional.h"
+
+#include <stdexcept>
+
+namespace rayn {
+
+    // The element operator[] inserts for a missing key.
+    template <class Value>
+    struct __hash_map_default_value {
+        Value operator()(const typename Value::first_type& k) const {
+            return Value(k, typename Value::second_type());
+        }
+    };
+
+    /*
+    ** Layout is hash_flat_layout or hash_node_layout; the default stores
+    ** small pairs flat. Only the node layout keeps references to elements
+    ** valid across a rehash.
+    */
+    template <class Key, class T, class Hash = rayn::hash<Key>,
+              class KeyEqual = rayn::equal_to<Key>,
+              class Alloc = allocator<pair<const Key, T>>,
+              class Layout = typename __hash_default_layout<pair<const Key, T>>::type>
+    class unordered_map {
+    public:
+        // public typedefs
+        typedef Key                 key_type;
+        typedef T                   mapped_type;
+        typedef pair<const Key, T>  value_type;
+        typedef Hash                hasher;
+        typedef KeyEqual            key_equal;
+
+    private:
+        typedef hashtable<key_type, value_type, select1st<value_type>,
+                          hasher, key_equal, Alloc, Layout>    _rep_type;
+
+        _rep_type   _m_ht;
+
+    public:
+        // public typedefs of iterator.
+        typedef typename _rep_type::pointer                 pointer;
+        typedef typename _rep_type::const_pointer           const_pointer;
+        typedef typename _rep_type::reference               reference;
+        typedef typename _rep_type::const_reference         const_reference;
+        typedef typename _rep_type::iterator                iterator;
+        typedef typename _rep_type::const_iterator          const_iterator;
+        typedef typename _rep_type::size_type               size_type;
+        typedef typename _rep_type::difference_type         difference_type;
+        typedef Alloc                                       allocator_type;
+
+        // constructor/destructor
+        unordered_map() : _m_ht() {}
+
+        explicit
+        unordered_map(size_type n, const hasher& hf = hasher(),
+                      const key_equal& eql = key_equal(),
+                      const allocator_type& a = allocator_type())
+        : _m_ht(n, hf, eql, a) {}
+
+        explicit
+        unordered_map(const allocator_type& a) : _m_ht(0, hasher(), key_equal(), a) {}
+
+        template <typename InputIterator>
+        unordered_map(InputIterator first, InputIterator last) : _m_ht()
+        {
+            _m_ht.insert_unique(first, last);
+        }
+
+        template <typename InputIterator>
+        unordered_map(InputIterator first, InputIterator last, size_type n,
+                      const hasher& hf = hasher(), const key_equal& eql = key_equal(),
+                      const allocator_type& a = allocator_type())
+        : _m_ht(n, hf, eql, a)
+        {
+            _m_ht.insert_unique(first, last);
+        }
+
+        unordered_map(const unordered_map& m) : _m_ht(m._m_ht) {}
+
+        unordered_map(unordered_map&& m) : _m_ht(rayn::move(m._m_ht)) {}
+
+        unordered_map& operator=(const unordered_map& m) {
+            _m_ht = m._m_ht;
+            return *this;
+        }
+
+        unordered_map& operator=(unordered_map&& m) {
+            _m_ht = rayn::move(m._m_ht);
+            return *this;
+        }
+
+        // Iterators
+        iterator
+        begin()
+        { return _m_ht.begin(); }
+
+        const_iterator
+        begin() const
+        { return _m_ht.begin(); }
+
+        iterator
+        end()
+        { return _m_ht.end(); }
+
+        const_iterator
+        end() const
+        { return _m_ht.end(); }
+
+        const_iterator
+        cbegin() const
+        { return _m_ht.begin(); }
+
+        const_iterator
+        cend() const
+        { return _m_ht.end(); }
+
+        // Capacity
+        bool        empty() const       { return _m_ht.empty(); }
+        size_type   size() const        { return _m_ht.size(); }
+        size_type   max_size() const    { return _m_ht.max_size(); }
+
+        // Element access
+        mapped_type&
+        operator[] (const key_type& k)
+        {
+            return _m_ht.find_or_insert(k, __hash_map_default_value<value_type>()).first->second;
+        }
+
+        mapped_type&
+        at(const key_type& k)
+        {
+            iterator it = find(k);
+            if (it == end()) {
+                throw std::out_of_range("unordered_map::at");
+            }
+            return it->second;
+        }
+
+        const mapped_type&
+        at(const key_type& k) const
+        {
+            const_iterator it = find(k);
+            if (it == end()) {
+                throw std::out_of_range("unordered_map::at");
+            }
+            return it->second;
+        }
+
+        // Modifiers
+        pair<iterator, bool>
+        insert(const value_type& val)
+        {
+            return _m_ht.insert_unique(val);
+        }
+
+        pair<iterator, bool>
+        insert(value_type&& val)
+        {
+            return _m_ht.insert_unique(rayn::move(val));
+        }
+
+        // the hint is ignored, a hash table has no position to start from
+        iterator
+        insert(const_iterator, const value_type& val)
+        {
+            return _m_ht.insert_unique(val).first;
+        }
+
+        template <class InputIterator>
+        void
+        insert(InputIterator first, InputIterator last)
+        {
+            _m_ht.insert_unique(first, last);
+        }
+
+        iterator
+        erase(const_iterator pos)
+        {
+            return _m_ht.erase(pos);
+        }
+
+        size_type
+        erase(const key_type& k)
+        {
+            return _m_ht.erase(k);
+        }
+
+        iterator
+        erase(const_iterator first, const_iterator last)
+        {
+            return _m_ht.erase(first, last);
+        }
+
+        void
+        swap(unordered_map& x) { _m_ht.swap(x._m_ht); }
+
+        void
+        clear() { _m_ht.clear(); }
+
+        // Observers
+        hasher
+        hash_function() const
+        { return _m_ht.hash_function(); }
+
+        key_equal
+        key_eq() const
+        { return _m_ht.key_eq(); }
+
+        allocator_type
+        get_allocator() const
+        { return _m_ht.get_allocator(); }
+
+        // Lookup
+        iterator
+        find(const key_type& k) { return _m_ht.find(k); }
+
+        const_iterator
+        find(const key_type& k) const { return _m_ht.find(k); }
+
+        size_type
+        count(const key_type& k) const
+        {
+            return _m_ht.count(k);
+        }
+
+        pair<iterator, iterator>
+        equal_range(const key_type& k)
+        {
+            return _m_ht.equal_range(k);
+        }
+
+        pair<const_iterator, const_iterator>
+        equal_range(const key_type& k) const
+        {
+            return _m_ht.equal_range(k);
+        }
+
+        // Hash policy
+        size_type   bucket_count() const    { return _m_ht.bucket_count(); }
+        float       load_factor() const     { return _m_ht.load_factor(); }
+        float       max_load_factor() const { return _m_ht.max_load_factor(); }
+        void        rehash(size_type n)     { _m_ht.rehash(n); }
+        void        reserve(size_type n)    { _m_ht.reserve(n); }
+
+        // friend functions
+        template <class Key2, class T2, class Hash2, class KeyEqual2, class Alloc2, class Layout2>
+        friend bool
+        operator==(const unordered_map<Key2, T2, Hash2, KeyEqual2, Alloc2, Layout2>&,
+                   const unordered_map<Key2, T2, Hash2, KeyEqual2, Alloc2, Layout2>&);
+    };
+
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Layout>
+    inline bool
+    operator==(const unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& x,
+               const unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& y)
+    {
+        return x._m_ht == y._m_ht;
+    }
+
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Layout>
+    inline bool
+    operator!=(const unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& x,
+               const unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& y)
+    {
+        return !(x == y);
+    }
+
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class Layout>
+    inline void
+    swap(unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& x,
+         unordered_map<Key, T, Hash, KeyEqual, Alloc, Layout>& y)
+    {
+        x.swap(y);
+    }
+}
+
+#endif
\ No newline at end of file
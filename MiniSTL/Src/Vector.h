@@ -13,6 +13,9 @@
 #include "TypeTraits.h"
 #include "Algorithm.h"
 
+#include <cstring>
+#include <type_traits>
+
 namespace rayn {
     template <class T, class Alloc = allocator<T>>
     class vector {
@@ -28,6 +31,7 @@ namespace rayn {
         typedef const T&                        const_reference;
         typedef size_t                          size_type;
         typedef ptrdiff_t                       difference_type;
+        typedef Alloc                           allocator_type;
 
     private:
         typedef Alloc data_allocator;
@@ -35,30 +39,34 @@ namespace rayn {
         T *_start;
         T *_finish;
         T *_endOfStorage;
+        // ״̬(polymorphic_allocator)ڴһƶ뽻
+        data_allocator _alloc;
 
     public:
         // The Default Constructor
         vector() : _start(0), _finish(0), _endOfStorage(0) {}
+        // Construct an empty vector using allocator @c a.
+        explicit vector(const allocator_type& a) : _start(0), _finish(0), _endOfStorage(0), _alloc(a) {}
         // explicit Construct vector as Size n.
-        explicit vector(const size_type n) {
+        explicit vector(const size_type n, const allocator_type& a = allocator_type()) : _alloc(a) {
             allocateAndFillN(n, value_type());
         }
         // Construct vector as multiple elements.
-        vector(const size_type n, const value_type& value) {
+        vector(const size_type n, const value_type& value, const allocator_type& a = allocator_type()) : _alloc(a) {
             allocateAndFillN(n, value);
         }
         // Construct vector from range [first, last)
         template <class InputIterator>
-        vector(InputIterator first, InputIterator last) {
+        vector(InputIterator first, InputIterator last, const allocator_type& a = allocator_type()) : _alloc(a) {
             //жǵ, vector_aux
             vector_aux(first, last, typename std::is_integral<InputIterator>::type());
         }
         //The Copy Constructor
-        vector(const vector& v) {
+        vector(const vector& v) : _alloc(v._alloc) {
             allocateAndCopy(v.begin(), v.end());
         }
         //The Move Constructor
-        vector(vector&& v) {
+        vector(vector&& v) RAYN_NOEXCEPT : _alloc(v._alloc) {
             _start = v._start;
             _finish = v._finish;
             _endOfStorage = v._endOfStorage;
@@ -67,6 +75,7 @@ namespace rayn {
         //Vector Assignment operator
         vector& operator = (const vector& v) {
             if (this != &v) {
+                destroyAndDeallocateAll();
                 allocateAndCopy(v.begin(), v.end());
             }
             return *this;
@@ -79,6 +88,7 @@ namespace rayn {
                 _start = v._start;
                 _finish = v._finish;
                 _endOfStorage = v._endOfStorage;
+                _alloc = v._alloc;
                 v._start = v._finish = v._endOfStorage = 0;
             }
             return *this;
@@ -133,21 +143,15 @@ namespace rayn {
         */
         void resize(size_type n, value_type val = value_type()) {
             if (n < size()) {
-                data_allocator::destroy(_start + n, _finish);
+                _alloc.destroy(_start + n, _finish);
                 _finish = _start + n;
             } else if (size() < n && n <= capacity()) {
                 auto lengthOfAdd = n - size();
-                _finish = rayn::uninitialized_fill_n(_start, lengthOfAdd, val);
+                _finish = rayn::uninitialized_fill_n(_finish, lengthOfAdd, val);
             } else if (capacity() < n) {
                 auto lengthOfAdd = n - size();
-                T *newStart = data_allocator::allocate(getNewCapacity(lengthOfAdd));
-                T* newFinish = rayn::uninitialized_copy(begin(), end(), newStart);
-                newFinish = rayn::uninitialized_fill_n(newFinish, lengthOfAdd, val);
-                //first to destroy cur vector
-                destroyAndDeallocateAll();
-                _start = newStart;
-                _finish = newFinish;
-                _endOfStorage = _start + n;
+                reallocateStorage(getNewCapacity(lengthOfAdd));
+                _finish = rayn::uninitialized_fill_n(_finish, lengthOfAdd, val);
             }
         }
 
@@ -157,17 +161,10 @@ namespace rayn {
         */
         void reserve(size_type n) {
             if (n <= capacity()) return;
-            T *newStart = data_allocator::allocate(n);
-            T *newFinish = rayn::uninitialized_copy(begin(), end(), newStart);
-            //first to destroy cur vector
-            destroyAndDeallocateAll();
-            _start = newStart;
-            _finish = newFinish;
-            _endOfStorage = _start + n;
+            reallocateStorage(n);
         }
         void shrink_to_fit() {
-            data_allocator::deallocate(_finish, _endOfStorage - _finish);
-            _endOfStorage = _finish;
+            reallocateStorage(size());
         }
 
         // Elements Access function
@@ -209,6 +206,7 @@ namespace rayn {
                 rayn::swap(_start, v._start);
                 rayn::swap(_finish, v._finish);
                 rayn::swap(_endOfStorage, v._endOfStorage);
+                rayn::swap(_alloc, v._alloc);
             }
         }
         /*
@@ -219,10 +217,45 @@ namespace rayn {
                 construct(_finish, value);
                 ++_finish;
             } else {
-                insert(end(), value);
+                reallocateAndEmplace(end(), value);
+            }
+        }
+        void push_back(value_type&& value) {
+            emplace_back(rayn::move(value));
+        }
+        /*
+        ** @brief Construct an element in place at the end of vector.
+        */
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            if (_finish != _endOfStorage) {
+                construct(_finish, rayn::forward<Args>(args)...);
+                ++_finish;
+            } else {
+                reallocateAndEmplace(end(), rayn::forward<Args>(args)...);
             }
         }
         /*
+        ** @brief Construct an element in place before @c position.
+        ** @return The iterator of the new element.
+        */
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args) {
+            difference_type index = position - begin();
+            if (position == end()) {
+                emplace_back(rayn::forward<Args>(args)...);
+            } else if (_finish != _endOfStorage) {
+                // argsvectorеԪأȹԪڳλ
+                value_type tmp(rayn::forward<Args>(args)...);
+                openGap(position, 1);
+                construct(position, rayn::move(tmp));
+                ++_finish;
+            } else {
+                reallocateAndEmplace(position, rayn::forward<Args>(args)...);
+            }
+            return begin() + index;
+        }
+        /*
         ** @brief Erase the last data of vector
         */
         void pop_back() {
@@ -235,9 +268,10 @@ namespace rayn {
         ** @return The iterator of inserted element.
         */
         iterator insert(iterator position, const value_type& val) {
-            difference_type index = position - begin();
-            insert(position, 1, val);
-            return begin() + index;
+            return emplace(position, val);
+        }
+        iterator insert(iterator position, value_type&& val) {
+            return emplace(position, rayn::move(val));
         }
         /*
         ** @brief Insert @c val at the range [position, position + n).
@@ -265,21 +299,15 @@ namespace rayn {
         ** @return  An iterator pointing to the element pointed to by @a last prior to erasing (or end()).
         */
         iterator erase(iterator first, iterator last) {
-            // βԪ
-            difference_type lengthOfTail = end() - last;
-            difference_type lenthOfRemove = last - first;
-            _finish = _finish - lenthOfRemove;
-            for (; lengthOfTail != 0; --lengthOfTail) {
-                iterator temp = last - lenthOfRemove;
-                *temp = *last;
-                ++last;
+            if (first != last) {
+                erase_aux(first, last, typename is_trivially_relocatable<T>::type());
             }
             return first;
         }
 
         //Allocator Function of Container
         Alloc get_allocator() const {
-            return data_allocator;
+            return _alloc;
         }
     private:
         /*
@@ -288,7 +316,7 @@ namespace rayn {
         void destroyAndDeallocateAll() {
             if (capacity() != 0) {
                 destroy(_start, _finish);
-                data_allocator::deallocate(_start, capacity());
+                _alloc.deallocate(_start, capacity());
             }
         }
         /*
@@ -297,7 +325,7 @@ namespace rayn {
         ** @param value The value will be fill into vector.
         */
         void allocateAndFillN(const size_type n, const value_type& value) {
-            _start = data_allocator::allocate(n);
+            _start = _alloc.allocate(n);
             rayn::uninitialized_fill_n(_start, n, value);
             _finish = _endOfStorage = _start + n;
         }
@@ -306,7 +334,7 @@ namespace rayn {
         */
         template <class InputIterator>
         void allocateAndCopy(InputIterator first, InputIterator last) {
-            _start = data_allocator::allocate(last - first);
+            _start = _alloc.allocate(last - first);
             _finish = rayn::uninitialized_copy(first, last, _start);
             _endOfStorage = _finish;
         }
@@ -316,12 +344,27 @@ namespace rayn {
         */
         template <class InputIterator>
         void reallocateAndCopy(iterator position, InputIterator first, InputIterator last) {
+            reallocateAndCopy_aux(position, first, last, typename is_trivially_relocatable<T>::type());
+        }
+        template <class InputIterator>
+        void reallocateAndCopy_aux(iterator position, InputIterator first, InputIterator last, true_type) {
+            if (mayAlias(first, last)) {
+                // [first, last)ھɿռУʧЧ
+                reallocateAndCopy_aux(position, first, last, false_type());
+                return;
+            }
+            difference_type index = position - begin();
+            reallocateStorage(getNewCapacity(last - first));
+            insert_aux(begin() + index, first, last, std::false_type());
+        }
+        template <class InputIterator>
+        void reallocateAndCopy_aux(iterator position, InputIterator first, InputIterator last, false_type) {
             difference_type newCapacity = getNewCapacity(last - first);
-            T* newStart = data_allocator::allocate(newCapacity);
+            T* newStart = _alloc.allocate(newCapacity);
             T* newEndOfStorage = newStart + newCapacity;
-            T* newFinish = rayn::uninitialized_copy(begin(), position, newStart);
+            T* newFinish = rayn::uninitialized_move_if_noexcept(begin(), position, newStart);
             newFinish = rayn::uninitialized_copy(first, last, newFinish);
-            newFinish = rayn::uninitialized_copy(position, end(), newFinish);
+            newFinish = rayn::uninitialized_move_if_noexcept(position, end(), newFinish);
             // First to destroy cur Vector.
             destroyAndDeallocateAll();
             _start = newStart;
@@ -332,12 +375,22 @@ namespace rayn {
         ** @brief Reallocate memory and Insert(Copy) n val into [position, position + n).
         */
         void reallocateAndFillN(iterator position, const size_type& n, const value_type& value) {
+            reallocateAndFillN_aux(position, n, value, typename is_trivially_relocatable<T>::type());
+        }
+        void reallocateAndFillN_aux(iterator position, const size_type& n, const value_type& value, true_type) {
+            // valuevectorеԪأǰȸһ
+            value_type copy = value;
+            difference_type index = position - begin();
+            reallocateStorage(getNewCapacity(n));
+            insert_aux(begin() + index, n, copy, std::true_type());
+        }
+        void reallocateAndFillN_aux(iterator position, const size_type& n, const value_type& value, false_type) {
             difference_type newCapacity = getNewCapacity(n);
-            T* newStart = data_allocator::allocate(newCapacity);
+            T* newStart = _alloc.allocate(newCapacity);
             T* newEndOfStorage = newStart + newCapacity;
-            T* newFinish = rayn::uninitialized_copy(begin(), position, newStart);
+            T* newFinish = rayn::uninitialized_move_if_noexcept(begin(), position, newStart);
             newFinish = rayn::uninitialized_fill_n(newFinish, n, value);
-            newFinish = rayn::uninitialized_copy(position, end(), newFinish);
+            newFinish = rayn::uninitialized_move_if_noexcept(position, end(), newFinish);
             // First to destroy cur Vector.
             destroyAndDeallocateAll();
             _start = newStart;
@@ -345,6 +398,134 @@ namespace rayn {
             _endOfStorage = newEndOfStorage;
         }
 
+        /*
+        ** @brief Reallocate memory and construct an element from @c args at @c position.
+        */
+        template <class... Args>
+        void reallocateAndEmplace(iterator position, Args&&... args) {
+            reallocateAndEmplace_aux(position, typename is_trivially_relocatable<T>::type(), rayn::forward<Args>(args)...);
+        }
+        template <class... Args>
+        void reallocateAndEmplace_aux(iterator position, true_type, Args&&... args) {
+            // argsvectorеԪأǰʱռ乹Ԫأ֮λ
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type buffer;
+            T *tmp = reinterpret_cast<T *>(&buffer);
+            construct(tmp, rayn::forward<Args>(args)...);
+            difference_type index = position - begin();
+            try {
+                reallocateStorage(getNewCapacity());
+            } catch (...) {
+                destroy(tmp);
+                throw;
+            }
+            openGap(begin() + index, 1);
+            // ɰλƵͣתvoid*ƿ-Wclass-memaccess
+            memcpy(static_cast<void *>(begin() + index), static_cast<const void *>(tmp), sizeof(T));
+            ++_finish;
+        }
+        template <class... Args>
+        void reallocateAndEmplace_aux(iterator position, false_type, Args&&... args) {
+            size_type newCapacity = getNewCapacity();
+            T *newStart = _alloc.allocate(newCapacity);
+            T *newPosition = newStart + (position - begin());
+            // ԪھԪصİƹ죬argsþԪ
+            try {
+                construct(newPosition, rayn::forward<Args>(args)...);
+            } catch (...) {
+                _alloc.deallocate(newStart, newCapacity);
+                throw;
+            }
+            rayn::uninitialized_move_if_noexcept(begin(), position, newStart);
+            T *newFinish = rayn::uninitialized_move_if_noexcept(position, end(), newPosition + 1);
+            destroyAndDeallocateAll();
+            _start = newStart;
+            _finish = newFinish;
+            _endOfStorage = _start + newCapacity;
+        }
+
+        /*
+        ** @brief Change the capacity to @c newCapacity, elements are kept.
+        ** Ԫؿ԰λʱreallocateԭ䣬ƣ
+        ** ƶ첻׳쳣ʱƶơ
+        */
+        void reallocateStorage(size_type newCapacity) {
+            reallocateStorage_aux(newCapacity, typename is_trivially_relocatable<T>::type());
+        }
+        void reallocateStorage_aux(size_type newCapacity, true_type) {
+            size_type oldSize = size();
+            _start = _alloc.reallocate(_start, capacity(), newCapacity);
+            _finish = _start + oldSize;
+            _endOfStorage = _start + newCapacity;
+        }
+        void reallocateStorage_aux(size_type newCapacity, false_type) {
+            T *newStart = _alloc.allocate(newCapacity);
+            T *newFinish = rayn::uninitialized_move_if_noexcept(begin(), end(), newStart);
+            //first to destroy cur vector
+            destroyAndDeallocateAll();
+            _start = newStart;
+            _finish = newFinish;
+            _endOfStorage = _start + newCapacity;
+        }
+        /*
+        ** @brief Move [position, end()) back by @c n elements, capacity must be enough.
+        ** [position, position + n)ΪδʼĿռ䣬ɵ߹Ԫز_finish
+        */
+        void openGap(iterator position, size_type n) {
+            openGap_aux(position, n, typename is_trivially_relocatable<T>::type());
+        }
+        void openGap_aux(iterator position, size_type n, true_type) {
+            // ɰλƵͣתvoid*ƿ-Wclass-memaccess
+            memmove(static_cast<void *>(position + n), static_cast<const void *>(position),
+                    (_finish - position) * sizeof(T));
+        }
+        void openGap_aux(iterator position, size_type n, false_type) {
+            iterator src = _finish;
+            iterator dst = _finish + n;
+            // _finish֮Ĳƶ죬ƶֵ
+            while (src != position) {
+                --src, --dst;
+                if (dst >= _finish) {
+                    construct(dst, rayn::move(*src));
+                } else {
+                    *dst = rayn::move(*src);
+                }
+            }
+            destroy(position, position + n < _finish ? position + n : _finish);
+        }
+        /*
+        ** @brief Remove [first, last) and move the tail to @c first.
+        ** Ԫؿ԰λʱɾԪأβƶֵ
+        */
+        void erase_aux(iterator first, iterator last, true_type) {
+            destroy(first, last);
+            // ɰλƵͣתvoid*ƿ-Wclass-memaccess
+            memmove(static_cast<void *>(first), static_cast<const void *>(last), (_finish - last) * sizeof(T));
+            _finish -= last - first;
+        }
+        void erase_aux(iterator first, iterator last, false_type) {
+            // βԪƶǰ棬Ԫ
+            iterator newFinish = first;
+            for (; last != _finish; ++last, ++newFinish) {
+                *newFinish = rayn::move(*last);
+            }
+            destroy(newFinish, _finish);
+            _finish = newFinish;
+        }
+        /*
+        ** @brief Test whether [first, last) may lie in the storage of vector.
+        ** ޷жϵĵصطtrue
+        */
+        template <class InputIterator>
+        bool mayAlias(InputIterator, InputIterator) const {
+            return true;
+        }
+        bool mayAlias(const T *first, const T *last) const {
+            return first < _endOfStorage && _start < last;
+        }
+        bool mayAlias(T *first, T *last) const {
+            return mayAlias(static_cast<const T *>(first), static_cast<const T *>(last));
+        }
+
         //Public Functionĸ
         template <class InputIterator>
         void vector_aux(InputIterator first, InputIterator last, std::false_type) {
@@ -359,12 +540,18 @@ namespace rayn {
             // the size of left storage
             difference_type storageLeft = _endOfStorage - _finish;
             difference_type rangeNeed = last - first;
+            if (rangeNeed == 0) {
+                return;
+            }
             if (storageLeft >= rangeNeed) {
-                iterator lastPtr = end() - 1;
-                // Move the range [position, _finish) back
-                for (; lastPtr - position >= 0; --lastPtr) {
-                    *(lastPtr + rangeNeed) = *lastPtr;
+                if (mayAlias(first, last)) {
+                    // ڳλûı[first, last)ȸһ
+                    vector tmp(first, last, _alloc);
+                    insert_aux(position, tmp.begin(), tmp.end(), std::false_type());
+                    return;
                 }
+                // Move the range [position, _finish) back
+                openGap(position, rangeNeed);
                 rayn::uninitialized_copy(first, last, position);
                 _finish += rangeNeed;
             } else {
@@ -378,12 +565,11 @@ namespace rayn {
             difference_type storageLeft = _endOfStorage - _finish;
             difference_type rangeNeed = n;
             if (storageLeft >= rangeNeed) {
-                iterator lastPtr = end() - 1;
+                // valuevectorеԪأڳλǰȸһ
+                value_type copy = value;
                 // Move the range [position, _finish) back
-                for (; lastPtr - position >= 0; --lastPtr) {
-                    *(lastPtr + rangeNeed) = *lastPtr;
-                }
-                rayn::uninitialized_fill_n(position, n, value);
+                openGap(position, n);
+                rayn::uninitialized_fill_n(position, n, copy);
                 _finish += rangeNeed;
             } else {
                 reallocateAndFillN(position, n, value);
@@ -422,6 +608,10 @@ namespace rayn {
     inline void swap(vector<T, Alloc>& lhs, vector<T, Alloc>& rhs) {
         lhs.swap(rhs);
     }
+
+    // vectorָֻѿռָ룬԰λ
+    template <class T, class Alloc>
+    struct is_trivially_relocatable<vector<T, Alloc> > : public is_trivially_relocatable<Alloc> {};
 }
 
 #endif
\ No newline at end of file
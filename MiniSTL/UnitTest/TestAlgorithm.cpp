@@ -0,0 +1,54 @@
+/*
+** unit test for algorithm
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Algorithm.h"
+#include "../Src/Vector.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+TEST_CASE("sort and unique agree with std", "[algorithm]") {
+    srand(17);
+    bool ok = true;
+    for (int n = 0; n < 300; n += 7) {
+        std::vector<int> expected;
+        rayn::vector<int> v;
+        for (int i = 0; i != n; ++i) {
+            // few distinct values, so there are many equal ones and sorted runs
+            int x = i % 5 == 0 ? i : rand() % 20;
+            expected.push_back(x);
+            v.push_back(x);
+        }
+        std::sort(expected.begin(), expected.end());
+        rayn::sort(v.begin(), v.end());
+        ok = ok && std::equal(expected.begin(), expected.end(), v.begin());
+
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        v.erase(rayn::unique(v.begin(), v.end()), v.end());
+        ok = ok && v.size() == expected.size() && std::equal(expected.begin(), expected.end(), v.begin());
+    }
+    REQUIRE(ok);
+
+    int desc[40];
+    for (int i = 0; i != 40; ++i) {
+        desc[i] = 40 - i;
+    }
+    rayn::sort(desc, desc + 40, rayn::greater<int>());
+    REQUIRE(desc[0] == 40);
+    REQUIRE(desc[39] == 1);
+}
+
+TEST_CASE("lower_bound and upper_bound agree with std", "[algorithm]") {
+    int a[] = { 1, 2, 2, 2, 5, 7, 7, 9 };
+    bool ok = true;
+    for (int n = 0; n <= 8; ++n) {
+        for (int x = 0; x != 11; ++x) {
+            ok = ok && rayn::lower_bound(a, a + n, x) == std::lower_bound(a, a + n, x);
+            ok = ok && rayn::upper_bound(a, a + n, x) == std::upper_bound(a, a + n, x);
+        }
+    }
+    REQUIRE(ok);
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+/*
+** unit test for alloc
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Alloc.h"
+#include "../Src/List.h"
+#include "../Src/Vector.h"
+
+#include <chrono>
+#include <thread>
+#include <typeinfo>
+
+TEST_CASE("alloc small blocks", "[alloc]") {
+    void *p1 = rayn::alloc::allocate(24);
+    void *p2 = rayn::alloc::allocate(24);
+    REQUIRE(p1 != 0);
+    REQUIRE(p2 != 0);
+    REQUIRE(p1 != p2);
+
+    rayn::alloc::deallocate(p1, 24);
+    // free-list is LIFO, the last freed block comes back first.
+    void *p3 = rayn::alloc::allocate(24);
+    REQUIRE(p3 == p1);
+
+    rayn::alloc::deallocate(p2, 24);
+    rayn::alloc::deallocate(p3, 24);
+}
+
+TEST_CASE("alloc large blocks", "[alloc]") {
+    void *p = rayn::alloc::allocate(1024);
+    REQUIRE(p != 0);
+    rayn::alloc::deallocate(p, 1024);
+}
+
+TEST_CASE("alloc thread cache", "[alloc]") {
+    const int nthreads = 4;
+    const int count = 10000;
+    bool ok[nthreads] = { false, false, false, false };
+
+    std::thread workers[nthreads];
+    for (int t = 0; t < nthreads; ++t) {
+        workers[t] = std::thread([t, count, &ok]() {
+            rayn::list<int> l;
+            for (int i = 0; i < count; ++i) {
+                l.push_back(i * t);
+            }
+            int expect = 0;
+            bool same = true;
+            for (auto it = l.begin(); it != l.end(); ++it, ++expect) {
+                same = same && (*it == expect * t);
+            }
+            ok[t] = same && expect == count;
+        });
+    }
+    for (int t = 0; t < nthreads; ++t) {
+        workers[t].join();
+    }
+    for (int t = 0; t < nthreads; ++t) {
+        REQUIRE(ok[t]);
+    }
+}
+
+TEST_CASE("alloc blocks cross threads", "[alloc]") {
+    // blocks allocated on one thread and released on another
+    // go back through the releasing thread's cache.
+    const int count = 1000;
+    void *blocks[count];
+    std::thread producer([&blocks, count]() {
+        for (int i = 0; i < count; ++i) {
+            blocks[i] = rayn::alloc::allocate(16);
+        }
+    });
+    producer.join();
+
+    std::thread consumer([&blocks, count]() {
+        for (int i = 0; i < count; ++i) {
+            rayn::alloc::deallocate(blocks[i], 16);
+        }
+    });
+    consumer.join();
+
+    void *p = rayn::alloc::allocate(16);
+    REQUIRE(p != 0);
+    rayn::alloc::deallocate(p, 16);
+}
+
+TEST_CASE("alloc trim", "[alloc]") {
+    // blocks of a worker thread go back to the central pool when it exits,
+    // after that every chunk they lived in is idle and can be released.
+    const int count = 5000;
+    std::thread worker([count]() {
+        rayn::list<double> l;
+        for (int i = 0; i < count; ++i) {
+            l.push_back(i);
+        }
+    });
+    worker.join();
+
+    size_t before = rayn::alloc::released_bytes();
+    size_t released = rayn::alloc::trim();
+    REQUIRE(released > 0);
+    REQUIRE(rayn::alloc::released_bytes() == before + released);
+    // nothing left to release
+    REQUIRE(rayn::alloc::trim() == 0);
+
+    // the pool is still usable after trimming
+    rayn::list<int> l;
+    for (int i = 0; i < count; ++i) {
+        l.push_back(i);
+    }
+    REQUIRE(l.size() == count);
+}
+
+TEST_CASE("alloc background trim", "[alloc]") {
+    size_t before = rayn::alloc::released_bytes();
+    std::thread worker([]() {
+        rayn::list<double> l;
+        for (int i = 0; i < 5000; ++i) {
+            l.push_back(i);
+        }
+    });
+    worker.join();
+
+    rayn::alloc::start_background_trim(1);
+    for (int i = 0; i < 1000 && rayn::alloc::released_bytes() == before; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    rayn::alloc::stop_background_trim();
+    REQUIRE(rayn::alloc::released_bytes() > before);
+}
+
+TEST_CASE("alloc geometric size classes", "[alloc]") {
+    typedef rayn::geometric_alloc_policy policy;
+    REQUIRE(policy::class_size(policy::class_index(1)) == 8);
+    REQUIRE(policy::class_size(policy::class_index(128)) == 128);
+    REQUIRE(policy::class_size(policy::class_index(129)) == 160);
+    REQUIRE(policy::class_size(policy::class_index(1000)) == 1024);
+    REQUIRE(policy::class_size(policy::class_index(4096)) == 4096);
+    // every request maps to the smallest class that can hold it
+    bool tight = true;
+    for (size_t bytes = 1; bytes <= policy::MAXBYTES; ++bytes) {
+        size_t index = policy::class_index(bytes);
+        tight = tight && policy::class_size(index) >= bytes;
+        tight = tight && (index == 0 || policy::class_size(index - 1) < bytes);
+    }
+    REQUIRE(tight);
+}
+
+TEST_CASE("alloc geometric pool", "[alloc]") {
+    typedef rayn::pool_alloc<rayn::geometric_alloc_policy> pool;
+    // blocks up to 4KiB come from the pool and are reused
+    void *p1 = pool::allocate(3000);
+    REQUIRE(p1 != 0);
+    pool::deallocate(p1, 3000);
+    void *p2 = pool::allocate(2600);
+    REQUIRE(p2 == p1);
+    pool::deallocate(p2, 2600);
+
+    rayn::vector<int, rayn::allocator<int, pool>> v;
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    bool same = true;
+    for (int i = 0; i < 1000; ++i) {
+        same = same && v[i] == i;
+    }
+    REQUIRE(same);
+}
+
+TEST_CASE("alloc stats", "[alloc]") {
+    typedef rayn::pool_alloc<rayn::geometric_alloc_policy> pool;
+    pool::stats before, after;
+    pool::snapshot(before);
+
+    void *small[3];
+    for (int i = 0; i < 3; ++i) {
+        small[i] = pool::allocate(48);
+    }
+    void *large = pool::allocate(10000);
+    for (int i = 0; i < 3; ++i) {
+        pool::deallocate(small[i], 48);
+    }
+    pool::deallocate(large, 10000);
+
+    pool::snapshot(after);
+    size_t index = rayn::geometric_alloc_policy::class_index(48);
+    const pool::class_stats& b = before.classes[index];
+    const pool::class_stats& a = after.classes[index];
+    REQUIRE(a.block_size == 48);
+    REQUIRE(a.hits + a.misses == b.hits + b.misses + 3);
+    REQUIRE(a.frees == b.frees + 3);
+    REQUIRE(after.large_allocs == before.large_allocs + 1);
+    REQUIRE(after.large_frees == before.large_frees + 1);
+    REQUIRE(after.large_bytes == before.large_bytes + 10000);
+    REQUIRE(after.heap_bytes >= after.idle_bytes);
+
+    // realloc of a large block counts it at its new size
+    pool::snapshot(before);
+    large = pool::allocate(10000);
+    large = pool::reallocate(large, 10000, 30000);
+    large = pool::reallocate(large, 30000, 20000);
+    pool::deallocate(large, 20000);
+    pool::snapshot(after);
+    REQUIRE(after.large_allocs == before.large_allocs + 1);
+    REQUIRE(after.large_frees == before.large_frees + 1);
+    REQUIRE(after.large_bytes == before.large_bytes + 20000);
+}
+
+TEST_CASE("alloc sampled trace", "[alloc]") {
+    typedef rayn::pool_alloc<rayn::geometric_alloc_policy> pool;
+    typedef rayn::allocator<double, pool> double_allocator;
+    pool::start_trace(4);
+    double *blocks[8];
+    for (int i = 0; i < 8; ++i) {
+        blocks[i] = double_allocator::allocate(2);
+    }
+    pool::stop_trace();
+    for (int i = 0; i < 8; ++i) {
+        double_allocator::deallocate(blocks[i], 2);
+    }
+
+    pool::trace_record records[8];
+    size_t n = pool::trace(records, 8);
+    REQUIRE(n == 2);
+    for (size_t i = 0; i != n; ++i) {
+        REQUIRE(records[i].bytes == 2 * sizeof(double));
+        REQUIRE(*records[i].site == typeid(double));
+        REQUIRE(records[i].thread == std::this_thread::get_id());
+    }
+}
+
+TEST_CASE("alloc reallocate", "[alloc]") {
+    char *p = static_cast<char *>(rayn::alloc::allocate(16));
+    for (int i = 0; i < 16; ++i) {
+        p[i] = static_cast<char>(i);
+    }
+
+    SECTION("same size class stays in place") {
+        char *q = static_cast<char *>(rayn::alloc::reallocate(p, 16, 13));
+        REQUIRE(q == p);
+        rayn::alloc::deallocate(q, 13);
+    }
+
+    SECTION("small to large to small keeps contents") {
+        char *q = static_cast<char *>(rayn::alloc::reallocate(p, 16, 100));
+        bool same = true;
+        for (int i = 0; i < 16; ++i) {
+            same = same && q[i] == i;
+        }
+        q = static_cast<char *>(rayn::alloc::reallocate(q, 100, 4000));
+        q = static_cast<char *>(rayn::alloc::reallocate(q, 4000, 100000));
+        for (int i = 0; i < 16; ++i) {
+            same = same && q[i] == i;
+        }
+        q = static_cast<char *>(rayn::alloc::reallocate(q, 100000, 8));
+        for (int i = 0; i < 8; ++i) {
+            same = same && q[i] == i;
+        }
+        REQUIRE(same);
+        rayn::alloc::deallocate(q, 8);
+    }
+}
+
+TEST_CASE("alloc huge page backing", "[alloc]") {
+    typedef rayn::pool_alloc<rayn::default_alloc_policy, rayn::huge_page_backing> pool;
+    const size_t huge = rayn::huge_page_backing::HUGE_PAGE_SIZE;
+    // the whole huge page goes into the pool, no other chunk is needed
+    void *blocks[10000];
+    for (int i = 0; i < 10000; ++i) {
+        blocks[i] = pool::allocate(64);
+    }
+    pool::stats s;
+    pool::snapshot(s);
+    REQUIRE(s.chunk_allocs == 1);
+    REQUIRE(s.heap_bytes > huge - 64);
+    REQUIRE(s.heap_bytes < huge);
+    REQUIRE(reinterpret_cast<size_t>(blocks[0]) / huge == reinterpret_cast<size_t>(blocks[9999]) / huge);
+
+    for (int i = 0; i < 10000; ++i) {
+        pool::deallocate(blocks[i], 64);
+    }
+    REQUIRE(pool::trim() == huge);
+}
+
+TEST_CASE("alloc numa backing", "[alloc]") {
+    typedef rayn::pool_alloc<rayn::default_alloc_policy, rayn::numa_huge_page_backing> pool;
+    REQUIRE(rayn::numa_huge_page_backing::current_node() >= -1);
+    rayn::list<int, rayn::allocator<int, pool>> l;
+    for (int i = 0; i < 1000; ++i) {
+        l.push_back(i);
+    }
+    REQUIRE(l.size() == 1000);
+    l.clear();
+    REQUIRE(pool::trim() % rayn::huge_page_backing::HUGE_PAGE_SIZE == 0);
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+/*
+** unit test for btree_map, btree_set and their multi versions
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "TestHelper.h"
+#include "../Src/BTreeMap.h"
+#include "../Src/BTreeSet.h"
+#include "../Src/Map.h"
+#include "../Src/Set.h"
+#include "../Src/String.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// *************************************
+// btree_map
+
+TEST_CASE("btree_map agrees with map", "[btree]") {
+    rayn::btree_map<int, int> b;
+    rayn::map<int, int> m;
+    REQUIRE(test_helper::agrees_with_map(b, m, 19, 40000, 5000));
+
+    // same order both ways, and the bounds find the same keys
+    bool ok = true;
+    rayn::map<int, int>::iterator mit = m.begin();
+    for (rayn::btree_map<int, int>::iterator it = b.begin(); it != b.end(); ++it, ++mit) {
+        ok = ok && it->first == mit->first;
+    }
+    rayn::map<int, int>::reverse_iterator rmit = m.rbegin();
+    for (rayn::btree_map<int, int>::reverse_iterator it = b.rbegin(); it != b.rend(); ++it, ++rmit) {
+        ok = ok && (*it).first == (*rmit).first;
+    }
+    for (int k = -1; k != 5001; ++k) {
+        rayn::btree_map<int, int>::iterator lb = b.lower_bound(k);
+        rayn::btree_map<int, int>::iterator ub = b.upper_bound(k);
+        ok = ok && (lb == b.end() ? m.lower_bound(k) == m.end() : lb->first == m.lower_bound(k)->first);
+        ok = ok && (ub == b.end() ? m.upper_bound(k) == m.end() : ub->first == m.upper_bound(k)->first);
+    }
+    REQUIRE(ok);
+    REQUIRE_THROWS_AS(b.at(-1), const std::out_of_range&);
+}
+
+namespace {
+    // b holds exactly the keys first, first + step, ... below last, both ways
+    bool holds_keys(const rayn::btree_set<int>& b, int first, int last, int step) {
+        int k = first;
+        for (rayn::btree_set<int>::const_iterator it = b.begin(); it != b.end(); ++it, k += step) {
+            if (k >= last || *it != k) {
+                return false;
+            }
+        }
+        if (k < last) {
+            return false;
+        }
+        for (rayn::btree_set<int>::const_reverse_iterator it = b.rbegin(); it != b.rend(); ++it) {
+            k -= step;
+            if (*it != k) {
+                return false;
+            }
+        }
+        return k == first;
+    }
+}
+
+TEST_CASE("btree splits and merges at the node limits", "[btree]") {
+    const int max = rayn::__btree_node<int>::MAX_VALUES;
+    const int min = rayn::__btree_node<int>::MIN_VALUES;
+    // one full leaf, the first split, a full root over full leaves and
+    // the first split of an internal node
+    const int sizes[] = { max, max + 1, 2 * max + 1, (max + 1) * (max + 1) - 1,
+                          (max + 1) * (max + 1), (max + 1) * (max + 1) + min };
+    bool ok = true;
+    for (int n = 0; n != 6; ++n) {
+        const int size = sizes[n];
+        rayn::btree_set<int> up, down;
+        for (int i = 0; i != size; ++i) {
+            up.insert(i);
+            down.insert(size - 1 - i);
+        }
+        ok = ok && up.size() == size_t(size) && holds_keys(up, 0, size, 1)
+                && holds_keys(down, 0, size, 1);
+
+        // every other key first, so that each leaf underflows in turn,
+        // then the rest from the back through merges up to the root
+        for (int i = 0; i < size; i += 2) {
+            ok = ok && up.erase(i) == 1;
+        }
+        ok = ok && holds_keys(up, 1, size, 2);
+        for (int i = size % 2 == 0 ? size - 1 : size - 2; i > 0; i -= 2) {
+            ok = ok && up.erase(i) == 1;
+        }
+        ok = ok && up.empty() && up.begin() == up.end();
+
+        // from the front, always taking the leftmost leaf below its minimum
+        for (int i = 0; i != size; ++i) {
+            ok = ok && *down.begin() == i;
+            down.erase(down.begin());
+        }
+        ok = ok && down.empty();
+    }
+    REQUIRE(ok);
+}
+
+TEST_CASE("btree_map erase returns the next element", "[btree]") {
+    rayn::btree_map<int, rayn::string> b;
+    char buf[32];
+    for (int i = 0; i != 3000; ++i) {
+        sprintf(buf, "value%d", i);
+        b.insert(rayn::pair<const int, rayn::string>(i, rayn::string(buf)));
+    }
+    // erasing every other element walks through merges and rotations
+    bool ok = true;
+    rayn::btree_map<int, rayn::string>::iterator it = b.begin();
+    while (it != b.end()) {
+        int k = it->first;
+        it = b.erase(it);
+        ok = ok && (it == b.end() || it->first == k + 1);
+        if (it != b.end()) {
+            ++it;
+        }
+    }
+    REQUIRE(ok);
+    REQUIRE(b.size() == 1500);
+    REQUIRE(b.begin()->first == 1);
+    REQUIRE(b.find(2999)->second == "value2999");
+
+    // from the back, hitting values in internal nodes
+    for (int k = 2999; k > 1000; k -= 2) {
+        it = b.erase(b.find(k));
+        ok = ok && it == b.end();
+    }
+    REQUIRE(ok);
+    REQUIRE(b.size() == 500);
+
+    rayn::btree_map<int, rayn::string> copy(b);
+    REQUIRE(copy == b);
+    it = copy.erase(copy.find(101), copy.find(501));
+    REQUIRE(it->first == 501);
+    REQUIRE(copy.size() == 300);
+    copy.erase(copy.begin(), copy.end());
+    REQUIRE(copy.empty());
+    REQUIRE(copy.begin() == copy.end());
+}
+
+TEST_CASE("btree_multimap keeps equal keys in insertion order", "[btree]") {
+    rayn::btree_multimap<int, int> b;
+    size_t counts[50] = { 0 };
+    srand(20);
+    for (int i = 0; i != 5000; ++i) {
+        int k = rand() % 50;
+        b.insert(rayn::pair<const int, int>(k, i));
+        ++counts[k];
+    }
+    bool ok = true;
+    rayn::btree_multimap<int, int>::iterator prev = b.begin();
+    for (rayn::btree_multimap<int, int>::iterator it = ++b.begin(); it != b.end(); ++it, ++prev) {
+        ok = ok && (prev->first < it->first || (prev->first == it->first && prev->second < it->second));
+    }
+    REQUIRE(ok);
+    size_t total = b.size();
+    for (int k = 0; k < 50; k += 3) {
+        ok = ok && b.count(k) == counts[k] && b.erase(k) == counts[k] && b.count(k) == 0;
+        total -= counts[k];
+    }
+    REQUIRE(ok);
+    REQUIRE(b.size() == total);
+}
+
+// *************************************
+// btree_set
+
+TEST_CASE("btree_set and btree_multiset", "[btree]") {
+    rayn::btree_set<int> s;
+    for (int i = 10000; i != 0; --i) {
+        s.insert(i);
+    }
+    REQUIRE(s.size() == 10000);
+    REQUIRE(*s.begin() == 1);
+    REQUIRE(*s.rbegin() == 10000);
+    REQUIRE(s.insert(500).second == false);
+    REQUIRE(*s.insert(0).first == 0);
+    REQUIRE(s.erase(500) == 1);
+    REQUIRE(*s.lower_bound(500) == 501);
+    REQUIRE(rayn::distance(s.begin(), s.end()) == 10000);
+
+    rayn::btree_set<int> other;
+    other.swap(s);
+    REQUIRE(s.empty());
+    REQUIRE(other.count(9999) == 1);
+
+    int values[] = { 3, 1, 3, 2, 3 };
+    rayn::btree_multiset<int> ms(values, values + 5);
+    REQUIRE(ms.size() == 5);
+    REQUIRE(ms.count(3) == 3);
+    rayn::pair<rayn::btree_multiset<int>::iterator, rayn::btree_multiset<int>::iterator> r = ms.equal_range(3);
+    REQUIRE(rayn::distance(r.first, r.second) == 3);
+    REQUIRE(ms.erase(3) == 3);
+    REQUIRE(ms.size() == 2);
+}
\ No newline at end of file
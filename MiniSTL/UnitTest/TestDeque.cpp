@@ -0,0 +1,195 @@
+/*
+** unit test for deque
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Deque.h"
+
+#include <deque>
+
+namespace {
+    // owns a heap object but never points into itself, opts in below
+    struct relocatable_item {
+        static int copies;
+        static int moves;
+        static int alive;
+        static void reset() { copies = moves = 0; }
+
+        int *value;
+        relocatable_item(int v = 0) : value(new int(v)) { ++alive; }
+        relocatable_item(const relocatable_item& other) : value(new int(*other.value)) { ++copies; ++alive; }
+        relocatable_item(relocatable_item&& other) : value(other.value) { other.value = 0; ++moves; ++alive; }
+        ~relocatable_item() { delete value; --alive; }
+        relocatable_item& operator= (const relocatable_item& other) { *value = *other.value; ++copies; return *this; }
+    };
+    int relocatable_item::copies = 0;
+    int relocatable_item::moves = 0;
+    int relocatable_item::alive = 0;
+
+    // four elements per buffer, the map has to grow quickly
+    typedef rayn::deque<int, rayn::allocator<int>, 4> small_deque;
+
+    bool holds_range(const small_deque& d, int first, int last) {
+        if (d.size() != size_t(last - first)) {
+            return false;
+        }
+        for (size_t i = 0; i != d.size(); ++i) {
+            if (d[i] != first + int(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace rayn {
+    template <>
+    struct is_trivially_relocatable<relocatable_item> : public true_type {};
+}
+
+TEST_CASE("deque grows the map at both ends", "[deque]") {
+    small_deque d;
+    for (int i = 0; i != 200; ++i) {
+        d.push_back(i);
+    }
+    REQUIRE(holds_range(d, 0, 200));
+    for (int i = -1; i != -200; --i) {
+        d.push_front(i);
+    }
+    REQUIRE(holds_range(d, -199, 200));
+
+    // the map has room again after shrinking at the back,
+    // growing at the front recenters the nodes inside the same map
+    for (int i = 0; i != 390; ++i) {
+        d.pop_back();
+    }
+    REQUIRE(holds_range(d, -199, -190));
+    for (int i = -200; i != -400; --i) {
+        d.push_front(i);
+    }
+    REQUIRE(holds_range(d, -399, -190));
+    for (int i = 0; i != 400; ++i) {
+        d.pop_front();
+        d.push_back(-190 + i);
+    }
+    REQUIRE(holds_range(d, 1, 210));
+}
+
+TEST_CASE("deque insert and erase in the middle", "[deque]") {
+    small_deque d;
+    for (int i = 0; i != 40; ++i) {
+        d.push_back(i);
+    }
+    // near the front and near the back shift different sides
+    d.insert(d.begin() + 5, -1);
+    d.insert(d.begin() + 35, -2);
+    REQUIRE(d.size() == 42);
+    REQUIRE(d[4] == 4);
+    REQUIRE(d[5] == -1);
+    REQUIRE(d[6] == 5);
+    REQUIRE(d[35] == -2);
+    REQUIRE(d[36] == 34);
+    d.erase(d.begin() + 35);
+    d.erase(d.begin() + 5);
+    REQUIRE(holds_range(d, 0, 40));
+
+    d.erase(d.begin() + 2, d.begin() + 12);
+    d.erase(d.begin() + 20, d.begin() + 29);
+    REQUIRE(d.size() == 21);
+    REQUIRE(d[1] == 1);
+    REQUIRE(d[2] == 12);
+    REQUIRE(d[19] == 29);
+    REQUIRE(d[20] == 39);
+}
+
+namespace {
+    template <class Deque>
+    bool same_as(const Deque& d, const std::deque<int>& model) {
+        if (d.size() != model.size()) {
+            return false;
+        }
+        for (size_t i = 0; i != d.size(); ++i) {
+            if (d[i] != model[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("deque inserts in the middle while the map grows", "[deque]") {
+    // every insert next to an end reserves one more element there, so the
+    // map is recentered or reallocated in the middle of an insert
+    small_deque d;
+    std::deque<int> model;
+    for (int i = 0; i != 8; ++i) {
+        d.push_back(i);
+        model.push_back(i);
+    }
+    bool ok = true;
+    for (int i = 0; i != 300; ++i) {
+        d.insert(d.begin() + 1, 1000 + i);
+        model.insert(model.begin() + 1, 1000 + i);
+        ok = ok && same_as(d, model);
+    }
+    for (int i = 0; i != 300; ++i) {
+        d.insert(d.end() - 1, 2000 + i);
+        model.insert(model.end() - 1, 2000 + i);
+        ok = ok && same_as(d, model);
+    }
+    REQUIRE(ok);
+
+    // the same through the fill and range inserts
+    int values[] = { -1, -2, -3 };
+    for (int i = 0; i != 100; ++i) {
+        d.insert(d.begin() + 2, small_deque::size_type(3), -i);
+        model.insert(model.begin() + 2, 3, -i);
+        d.insert(d.end() - 2, values, values + 3);
+        model.insert(model.end() - 2, values, values + 3);
+        ok = ok && same_as(d, model);
+    }
+    REQUIRE(ok);
+
+    // a full-sized buffer grows its map only after many more elements
+    rayn::deque<int> big;
+    std::deque<int> big_model;
+    for (int i = 0; i != 2000; ++i) {
+        big.push_front(i);
+        big_model.push_front(i);
+    }
+    for (int i = 0; i != 3000; ++i) {
+        big.insert(big.begin() + 1, -i);
+        big_model.insert(big_model.begin() + 1, -i);
+    }
+    REQUIRE(same_as(big, big_model));
+}
+
+TEST_CASE("deque relocates trivially relocatable elements", "[deque]") {
+    typedef relocatable_item item;
+    {
+        rayn::deque<item, rayn::allocator<item>, 4> d;
+        for (int i = 0; i != 40; ++i) {
+            d.push_back(item(i));
+        }
+        item::reset();
+        // the shifted elements are moved bitwise, only the new element is built
+        d.insert(d.begin() + 3, item(-1));
+        d.insert(d.begin() + 30, item(-2));
+        d.erase(d.begin() + 10, d.begin() + 20);
+        d.erase(d.begin() + 25);
+        REQUIRE(item::copies == 2);
+        REQUIRE(item::moves == 2);
+        REQUIRE(item::alive == 31);
+        REQUIRE(d.size() == 31);
+        REQUIRE(*d[2].value == 2);
+        REQUIRE(*d[3].value == -1);
+        REQUIRE(*d[4].value == 3);
+        REQUIRE(*d[10].value == 19);
+        REQUIRE(*d[19].value == 28);
+        REQUIRE(*d[20].value == -2);
+        REQUIRE(*d[24].value == 32);
+        REQUIRE(*d[25].value == 34);
+        REQUIRE(*d.back().value == 39);
+    }
+    REQUIRE(relocatable_item::alive == 0);
+}
@@ -0,0 +1,151 @@
+/*
+** unit test for flat_map and flat_set
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "TestHelper.h"
+#include "../Src/FlatMap.h"
+#include "../Src/FlatSet.h"
+#include "../Src/Map.h"
+#include "../Src/String.h"
+
+// *************************************
+// flat_map
+
+TEST_CASE("flat_map agrees with map", "[flat_map]") {
+    rayn::flat_map<int, int> f;
+    rayn::map<int, int> m;
+    REQUIRE(test_helper::agrees_with_map(f, m, 18, 5000, 700));
+
+    // same order, and the bounds are the same positions
+    bool ok = true;
+    rayn::map<int, int>::iterator mit = m.begin();
+    for (rayn::flat_map<int, int>::iterator it = f.begin(); it != f.end(); ++it, ++mit) {
+        ok = ok && it->first == mit->first;
+    }
+    for (int k = -1; k != 701; ++k) {
+        ok = ok && f.lower_bound(k) - f.begin() == rayn::distance(m.begin(), m.lower_bound(k));
+        ok = ok && f.upper_bound(k) - f.begin() == rayn::distance(m.begin(), m.upper_bound(k));
+    }
+    REQUIRE(ok);
+    REQUIRE_THROWS_AS(f.at(-1), const std::out_of_range&);
+}
+
+TEST_CASE("flat_map builds from unsorted input", "[flat_map]") {
+    rayn::pair<int, rayn::string> input[] = {
+        rayn::pair<int, rayn::string>(5, "five"),
+        rayn::pair<int, rayn::string>(1, "one"),
+        rayn::pair<int, rayn::string>(5, "FIVE"),
+        rayn::pair<int, rayn::string>(3, "three"),
+        rayn::pair<int, rayn::string>(1, "ONE"),
+    };
+    rayn::flat_map<int, rayn::string> f(input, input + 5);
+    REQUIRE(f.size() == 3);
+    REQUIRE(f.keys()[0] == 1);
+    REQUIRE(f.keys()[2] == 5);
+    // the first of equal keys wins, as in map
+    REQUIRE(f.at(1) == "one");
+    REQUIRE(f.at(5) == "five");
+
+    // a second range merges with what is there
+    rayn::pair<int, rayn::string> more[] = {
+        rayn::pair<int, rayn::string>(4, "four"),
+        rayn::pair<int, rayn::string>(3, "THREE"),
+        rayn::pair<int, rayn::string>(0, "zero"),
+    };
+    f.insert(more, more + 3);
+    REQUIRE(f.size() == 5);
+    REQUIRE(f.at(3) == "three");
+    REQUIRE(f.begin()->second == "zero");
+    REQUIRE(f.values()[3] == "four");
+
+    rayn::flat_map<int, rayn::string>::iterator it = f.find(4);
+    it->second = "4";
+    REQUIRE(f[4] == "4");
+    REQUIRE(f.insert(rayn::pair<int, rayn::string>(4, "x")).second == false);
+    REQUIRE(f.erase(f.find(0)) == f.begin());
+    REQUIRE(f.begin()->first == 1);
+    REQUIRE((*f.rbegin()).first == 5);
+}
+
+TEST_CASE("flat_map appends sorted input in place", "[flat_map]") {
+    rayn::vector<rayn::pair<int, int> > sorted;
+    for (int i = 0; i != 1000; ++i) {
+        sorted.push_back(rayn::pair<int, int>(i * 2, i));
+    }
+    rayn::flat_map<int, int> f(sorted.begin(), sorted.end());
+    REQUIRE(f.size() == 1000);
+    rayn::vector<rayn::pair<int, int> > tail;
+    for (int i = 1000; i != 2000; ++i) {
+        tail.push_back(rayn::pair<int, int>(i * 2, i));
+    }
+    f.reserve(2000);
+    const int *keys = f.keys().data();
+    // strictly greater keys are appended without a merge
+    f.insert(tail.begin(), tail.end());
+    REQUIRE(f.keys().data() == keys);
+    REQUIRE(f.size() == 2000);
+    REQUIRE(f.at(3998) == 1999);
+
+    // sorted input with runs of equal keys keeps the first of each run,
+    // also across the boundary with what is already there
+    rayn::vector<rayn::pair<int, int> > runs;
+    for (int i = 0; i != 300; ++i) {
+        runs.push_back(rayn::pair<int, int>(3998 + i / 3 * 2, i));
+    }
+    f.insert(runs.begin(), runs.end());
+    REQUIRE(f.size() == 2099);
+    REQUIRE(f.at(3998) == 1999);
+    REQUIRE(f.at(4000) == 3);
+    REQUIRE(f.at(4196) == 297);
+    bool ok = true;
+    for (size_t i = 1; i < f.size(); ++i) {
+        ok = ok && f.keys()[i - 1] < f.keys()[i];
+    }
+    REQUIRE(ok);
+    rayn::flat_map<int, int> dedup(runs.begin(), runs.end());
+    REQUIRE(dedup.size() == 100);
+    REQUIRE(dedup.begin()->second == 0);
+    REQUIRE(dedup.at(4000) == 3);
+
+    rayn::flat_map<int, int> copy(f);
+    REQUIRE(copy == f);
+    copy[1] = 1;
+    REQUIRE(copy != f);
+    REQUIRE(copy < f);
+    copy.erase(copy.begin(), copy.end());
+    REQUIRE(copy.empty());
+}
+
+// *************************************
+// flat_set
+
+TEST_CASE("flat_set", "[flat_set]") {
+    int values[] = { 9, 3, 5, 3, 1, 9, 7 };
+    rayn::flat_set<int> s(values, values + 7);
+    REQUIRE(s.size() == 5);
+    REQUIRE(*s.begin() == 1);
+    REQUIRE(*s.rbegin() == 9);
+    REQUIRE(s.insert(4).second);
+    REQUIRE(s.insert(4).second == false);
+    REQUIRE(*s.lower_bound(6) == 7);
+    REQUIRE(*s.upper_bound(7) == 9);
+    REQUIRE(s.count(5) == 1);
+    REQUIRE(s.erase(5) == 1);
+    REQUIRE(s.find(5) == s.end());
+
+    rayn::pair<rayn::flat_set<int>::iterator, rayn::flat_set<int>::iterator> r = s.equal_range(3);
+    REQUIRE(r.second - r.first == 1);
+    r = s.equal_range(2);
+    REQUIRE(r.first == r.second);
+
+    int more[] = { 8, 0, 4 };
+    s.insert(more, more + 3);
+    int expected[] = { 0, 1, 3, 4, 7, 8, 9 };
+    REQUIRE(s.size() == 7);
+    REQUIRE(rayn::equal(s.begin(), s.end(), expected));
+
+    rayn::flat_set<int, rayn::greater<int> > desc(values, values + 7);
+    REQUIRE(*desc.begin() == 9);
+    REQUIRE(*desc.lower_bound(6) == 5);
+}
\ No newline at end of file
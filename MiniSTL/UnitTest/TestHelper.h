@@ -0,0 +1,64 @@
+/*
+** helpers shared by the unit tests
+** Created by Rayn on 2026/10/17
+*/
+#ifndef _TEST_HELPER_H_
+#define _TEST_HELPER_H_
+
+#include "../Src/Alloc.h"
+#include "../Src/Map.h"
+
+#include <cstdlib>
+
+namespace test_helper {
+
+    // true when every size class of rayn::alloc has as many blocks out as
+    // it had at the earlier snapshot
+    inline bool
+    same_live_blocks(const rayn::alloc::stats& a, const rayn::alloc::stats& b)
+    {
+        for (size_t i = 0; i != sizeof(a.classes) / sizeof(a.classes[0]); ++i) {
+            if (a.classes[i].hits + a.classes[i].misses - a.classes[i].frees !=
+                b.classes[i].hits + b.classes[i].misses - b.classes[i].frees) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+    ** @brief   Run ops random steps on c and on the map model, each either
+    **          erase(k) or c[k] += i for a key k in [0, keys), then check
+    **          that both hold the same elements.
+    **          The ordering, if any, is left to the caller.
+    */
+    template <class IntMap>
+    bool
+    agrees_with_map(IntMap& c, rayn::map<int, int>& model,
+                    unsigned seed, int ops, int keys)
+    {
+        srand(seed);
+        bool ok = true;
+        for (int i = 0; i != ops; ++i) {
+            int k = rand() % keys;
+            if (rand() % 3 == 0) {
+                ok = ok && c.erase(k) == model.erase(k);
+            } else {
+                c[k] += i;
+                model[k] += i;
+            }
+            ok = ok && c.size() == model.size();
+        }
+        size_t n = 0;
+        for (typename IntMap::iterator it = c.begin(); it != c.end(); ++it, ++n) {
+            ok = ok && model.count(it->first) == 1 && model[it->first] == it->second;
+        }
+        ok = ok && n == model.size();
+        for (int k = -1; k != keys + 1; ++k) {
+            ok = ok && c.count(k) == model.count(k);
+        }
+        return ok;
+    }
+}
+
+#endif
@@ -3,7 +3,11 @@
 ** Created by Rayn on 2016/02/14
 */
 #include "catch.hpp"
+#include "TestHelper.h"
 #include "../Src/List.h"
+#include "../Src/Alloc.h"
+#include "../Src/AlgoBase.h"
+#include "../Src/Functional.h"
 
 TEST_CASE("list constructor", "[list]") {
     rayn::list<int> first;
@@ -162,4 +166,52 @@ TEST_CASE("list modifiers", "[list]") {
     first.pop_front();
     REQUIRE(first.size() == 2);
     REQUIRE(first.front() == 78);
+}
+
+TEST_CASE("list frees its sentinel", "[list]") {
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::list<int> empty;
+        rayn::list<int> lst(5, 1);
+        rayn::list<int> moved(rayn::move(lst));
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+}
+
+TEST_CASE("list splice const_iterator", "[list]") {
+    int a[] = { 1, 2, 3 };
+    int b[] = { 10, 20, 30, 40 };
+    rayn::list<int> x(a, a + 3), y(b, b + 4);
+    rayn::list<int>::const_iterator pos = x.begin();
+    ++pos;
+    rayn::list<int>::const_iterator it = y.begin();
+    x.splice(pos, y, it);
+    REQUIRE(x.size() == 4);
+    REQUIRE(y.size() == 3);
+
+    rayn::list<int>::const_iterator first = y.begin(), last = y.end();
+    ++first;
+    x.splice(x.end(), y, first, last);
+    REQUIRE(y.size() == 1);
+    REQUIRE(y.front() == 20);
+    int expect[] = { 1, 10, 2, 3, 30, 40 };
+    REQUIRE(rayn::equal(x.begin(), x.end(), expect));
+}
+
+TEST_CASE("list sort", "[list]") {
+    int a[] = { 5, 3, 9, 1, 7, 3 };
+    rayn::list<int> lst(a, a + 6);
+    // sort relinks the nodes, so iterators including end() stay valid
+    rayn::list<int>::iterator end = lst.end();
+    lst.sort();
+    REQUIRE(lst.end() == end);
+    int sorted[] = { 1, 3, 3, 5, 7, 9 };
+    REQUIRE(rayn::equal(lst.begin(), lst.end(), sorted));
+
+    lst.sort(rayn::greater<int>());
+    REQUIRE(lst.end() == end);
+    REQUIRE(lst.front() == 9);
+    REQUIRE(lst.back() == 1);
 }
\ No newline at end of file
@@ -5,10 +5,73 @@
 #include "catch.hpp"
 #include "../Src/Map.h"
 #include "../Src/MultiMap.h"
+#include "../Src/String.h"
 
 // *************************************
 // map
 
+TEST_CASE("map operator[]", "[map]") {
+    rayn::map<int, int> m;
+    m[3] = 30;
+    m[1] = 10;
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[3] == 30);
+    REQUIRE(m[1] == 10);
+    // a missing key is inserted with a value-initialized mapped_type
+    REQUIRE(m[2] == 0);
+    REQUIRE(m.size() == 3);
+    m[3] += 1;
+    REQUIRE(m.find(3)->second == 31);
+}
+
+TEST_CASE("map heterogeneous lookup", "[map]") {
+    rayn::map<rayn::string, int, rayn::less<> > m;
+    m["apple"] = 1;
+    m["banana-bread-with-walnuts"] = 2;
+    m["cherry"] = 3;
+    const char buf[] = "xx banana-bread-with-walnuts yy";
+    rayn::string_view slice(buf + 3, 25);
+    REQUIRE(m.find(slice) != m.end());
+    REQUIRE(m.find(slice)->second == 2);
+    REQUIRE(m.find("cherry")->second == 3);
+    REQUIRE(m.count(rayn::string_view(buf, 2)) == 0);
+    REQUIRE(m.lower_bound("b")->second == 2);
+    REQUIRE(m.upper_bound(slice)->second == 3);
+
+    // a plain comparator still takes only key_type
+    rayn::map<rayn::string, int> plain;
+    plain["apple"] = 1;
+    REQUIRE(plain.find("apple")->second == 1);
+}
 
 // *************************************
-// multimap
\ No newline at end of file
+// multimap
+
+TEST_CASE("multimap heterogeneous lookup", "[multimap]") {
+    typedef rayn::multimap<rayn::string, int, rayn::less<> > tag_map;
+    tag_map mm;
+    mm.insert(rayn::make_pair(rayn::string("red"), 1));
+    mm.insert(rayn::make_pair(rayn::string("green"), 2));
+    mm.insert(rayn::make_pair(rayn::string("red"), 3));
+    mm.insert(rayn::make_pair(rayn::string("blue"), 4));
+    mm.insert(rayn::make_pair(rayn::string("red"), 5));
+
+    const char buf[] = "tags: red, green";
+    rayn::string_view red(buf + 6, 3);
+    REQUIRE(mm.count(red) == 3);
+    REQUIRE(mm.count("green") == 1);
+    REQUIRE(mm.count(rayn::string_view(buf, 4)) == 0);
+
+    // equal keys stay in insertion order
+    rayn::pair<tag_map::iterator, tag_map::iterator> range = mm.equal_range(red);
+    int expect[] = { 1, 3, 5 };
+    int n = 0;
+    for (tag_map::iterator it = range.first; it != range.second; ++it, ++n) {
+        REQUIRE(it->second == expect[n]);
+    }
+    REQUIRE(n == 3);
+    REQUIRE(mm.find(red)->second == 1);
+    REQUIRE(mm.lower_bound("h")->first == "red");
+    REQUIRE(mm.upper_bound(red) == mm.end());
+    REQUIRE(mm.find("yellow") == mm.end());
+}
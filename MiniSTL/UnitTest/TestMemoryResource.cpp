@@ -0,0 +1,217 @@
+/*
+** unit test for memory_resource
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/MemoryResource.h"
+#include "../Src/Deque.h"
+#include "../Src/List.h"
+#include "../Src/Map.h"
+#include "../Src/Set.h"
+#include "../Src/String.h"
+#include "../Src/Vector.h"
+
+#include <thread>
+
+namespace {
+    // forwards to alloc_resource() and counts what is still outstanding
+    class counting_resource : public rayn::memory_resource {
+    public:
+        counting_resource() : bytes(0), blocks(0) {}
+
+        size_t bytes;
+        size_t blocks;
+
+    protected:
+        virtual void *do_allocate(size_t n, size_t alignment) {
+            bytes += n;
+            ++blocks;
+            return rayn::alloc_resource()->allocate(n, alignment);
+        }
+        virtual void do_deallocate(void *p, size_t n, size_t alignment) {
+            bytes -= n;
+            --blocks;
+            rayn::alloc_resource()->deallocate(p, n, alignment);
+        }
+        virtual bool do_is_equal(const rayn::memory_resource& other) const {
+            return this == &other;
+        }
+    };
+}
+
+TEST_CASE("monotonic buffer resource", "[memory_resource]") {
+    char buffer[256];
+    counting_resource upstream;
+    {
+        rayn::monotonic_buffer_resource mr(buffer, sizeof(buffer), &upstream);
+        char *p1 = static_cast<char *>(mr.allocate(16));
+        char *p2 = static_cast<char *>(mr.allocate(16));
+        REQUIRE(p1 == buffer);
+        REQUIRE(p2 == p1 + 16);
+        // deallocate is a no-op, the space is not reused
+        mr.deallocate(p2, 16);
+        REQUIRE(mr.allocate(16) == p2 + 16);
+        REQUIRE(upstream.blocks == 0);
+
+        void *p3 = mr.allocate(1000, 64);
+        REQUIRE(reinterpret_cast<size_t>(p3) % 64 == 0);
+        REQUIRE(upstream.blocks == 1);
+
+        mr.release();
+        REQUIRE(upstream.blocks == 0);
+        REQUIRE(mr.allocate(16) == buffer);
+        mr.allocate(1000);
+    }
+    REQUIRE(upstream.bytes == 0);
+}
+
+TEST_CASE("unsynchronized pool resource", "[memory_resource]") {
+    counting_resource upstream;
+    {
+        rayn::pool_options opts;
+        opts.largest_required_pool_block = 100;
+        rayn::unsynchronized_pool_resource mr(opts, &upstream);
+        REQUIRE(mr.options().largest_required_pool_block == 128);
+
+        void *p1 = mr.allocate(24);
+        void *p2 = mr.allocate(24);
+        REQUIRE(p1 != p2);
+        REQUIRE(upstream.blocks == 1);
+        mr.deallocate(p1, 24);
+        REQUIRE(mr.allocate(24) == p1);
+
+        // oversized blocks go to upstream one by one
+        void *big = mr.allocate(1000, 32);
+        REQUIRE(reinterpret_cast<size_t>(big) % 32 == 0);
+        REQUIRE(upstream.blocks == 2);
+        mr.deallocate(big, 1000, 32);
+        REQUIRE(upstream.blocks == 1);
+
+        mr.allocate(200);
+        mr.release();
+        REQUIRE(upstream.blocks == 0);
+        mr.allocate(24);
+    }
+    REQUIRE(upstream.bytes == 0);
+}
+
+TEST_CASE("synchronized pool resource", "[memory_resource]") {
+    rayn::synchronized_pool_resource mr;
+    bool ok[4] = { false, false, false, false };
+    std::thread threads[4];
+    for (int i = 0; i != 4; ++i) {
+        threads[i] = std::thread([&mr, &ok, i]() {
+            rayn::polymorphic_allocator<int> a(&mr);
+            rayn::vector<int, rayn::polymorphic_allocator<int> > v(a);
+            for (int j = 0; j != 1000; ++j) {
+                v.push_back(i * 1000 + j);
+            }
+            bool good = v.size() == 1000;
+            for (int j = 0; j != 1000; ++j) {
+                good = good && v[j] == i * 1000 + j;
+            }
+            ok[i] = good;
+        });
+    }
+    for (int i = 0; i != 4; ++i) {
+        threads[i].join();
+        REQUIRE(ok[i]);
+    }
+}
+
+TEST_CASE("containers allocate from the resource", "[memory_resource]") {
+    counting_resource mr;
+    rayn::polymorphic_allocator<int> a(&mr);
+    {
+        rayn::vector<int, rayn::polymorphic_allocator<int> > v(a);
+        rayn::list<int, rayn::polymorphic_allocator<int> > l(a);
+        rayn::set<int, rayn::less<int>, rayn::polymorphic_allocator<int> > s(a);
+        rayn::map<int, int, rayn::less<int>,
+                  rayn::polymorphic_allocator<rayn::pair<const int, int> > > m(a);
+        rayn::basic_string<char, rayn::polymorphic_allocator<char> > str(a);
+        for (int i = 0; i != 100; ++i) {
+            v.push_back(i);
+            l.push_back(i);
+            s.insert(i);
+            m[i] = i;
+            str.push_back('a' + i % 26);
+        }
+        REQUIRE(mr.blocks > 300);
+        REQUIRE(v.get_allocator() == a);
+        REQUIRE(l.get_allocator() == a);
+        REQUIRE(s.get_allocator() == a);
+        REQUIRE(m.get_allocator() == a);
+        REQUIRE(str.get_allocator() == a);
+
+        // copies keep allocating from the same resource
+        size_t before = mr.blocks;
+        rayn::list<int, rayn::polymorphic_allocator<int> > l2(l);
+        rayn::set<int, rayn::less<int>, rayn::polymorphic_allocator<int> > s2(s);
+        REQUIRE(mr.blocks == before + 201);
+        l2.sort();
+        REQUIRE(l2 == l);
+        REQUIRE(s2 == s);
+    }
+    REQUIRE(mr.bytes == 0);
+    REQUIRE(mr.blocks == 0);
+}
+
+TEST_CASE("deque allocates from the resource", "[memory_resource]") {
+    counting_resource mr;
+    rayn::polymorphic_allocator<int> a(&mr);
+    {
+        rayn::deque<int, rayn::polymorphic_allocator<int> > d(a);
+        REQUIRE(d.get_allocator() == a);
+        REQUIRE(mr.blocks == 2);
+        for (int i = 0; i != 1000; ++i) {
+            d.push_back(i);
+            d.push_front(-i - 1);
+        }
+        REQUIRE(d.size() == 2000);
+        REQUIRE(d.front() == -1000);
+        REQUIRE(d.back() == 999);
+        REQUIRE(d[1000] == 0);
+        REQUIRE(d.at(1999) == 999);
+        REQUIRE_THROWS(d.at(2000));
+
+        // the copy allocates from the same resource
+        rayn::deque<int, rayn::polymorphic_allocator<int> > d2(d);
+        REQUIRE(d2.get_allocator() == a);
+        REQUIRE(d2 == d);
+        d2.pop_front();
+        d2.pop_back();
+        REQUIRE(d2 != d);
+        REQUIRE(d2.front() == -999);
+        REQUIRE(d2.back() == 998);
+
+        d.clear();
+        REQUIRE(d.size() == 0);
+        d.push_back(7);
+        REQUIRE(d.front() == 7);
+
+        rayn::deque<int, rayn::polymorphic_allocator<int> > d3(300, 3, a);
+        REQUIRE(d3.get_allocator() == a);
+        REQUIRE(d3.size() == 300);
+        REQUIRE(d3[0] == 3);
+        REQUIRE(d3[299] == 3);
+    }
+    REQUIRE(mr.bytes == 0);
+    REQUIRE(mr.blocks == 0);
+}
+
+TEST_CASE("swap exchanges allocators", "[memory_resource]") {
+    rayn::monotonic_buffer_resource mr1, mr2;
+    rayn::polymorphic_allocator<int> a1(&mr1), a2(&mr2);
+    rayn::vector<int, rayn::polymorphic_allocator<int> > v1(3, 1, a1), v2(5, 2, a2);
+    v1.swap(v2);
+    REQUIRE(v1.get_allocator() == a2);
+    REQUIRE(v2.get_allocator() == a1);
+    REQUIRE(v1.size() == 5);
+
+    rayn::set<int, rayn::less<int>, rayn::polymorphic_allocator<int> > s1(a1), s2(a2);
+    s1.insert(1);
+    s1.swap(s2);
+    REQUIRE(s2.get_allocator() == a1);
+    REQUIRE(s2.size() == 1);
+    REQUIRE(s1.empty());
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+** unit test for rope
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Rope.h"
+
+#include <string>
+
+namespace {
+    std::string to_std(const rayn::rope<char>& r) {
+        std::string result;
+        r.for_each_chunk([&result](const char *chars, size_t n) {
+            result.append(chars, n);
+        });
+        return result;
+    }
+}
+
+TEST_CASE("rope append", "[rope]") {
+    rayn::rope<char> r;
+    std::string expect;
+    REQUIRE(r.empty());
+    for (int i = 0; i != 5000; ++i) {
+        char ch = 'a' + i % 26;
+        r.push_back(ch);
+        expect.push_back(ch);
+        if (i % 7 == 0) {
+            r.append("xyz");
+            expect.append("xyz");
+        }
+    }
+    REQUIRE(r.size() == expect.size());
+    REQUIRE(to_std(r) == expect);
+    REQUIRE(r[1234] == expect[1234]);
+    REQUIRE(r.at(r.size() - 1) == expect[expect.size() - 1]);
+    REQUIRE_THROWS_AS(r.at(r.size()), const std::out_of_range&);
+
+    rayn::string flat = r.str();
+    REQUIRE(flat.size() == expect.size());
+    REQUIRE(std::string(flat.c_str()) == expect);
+
+    rayn::rope<char> twice = r + r;
+    REQUIRE(to_std(twice) == expect + expect);
+}
+
+TEST_CASE("rope insert, erase and replace", "[rope]") {
+    std::string expect(3000, '.');
+    for (size_t i = 0; i != expect.size(); ++i) {
+        expect[i] = 'A' + i % 26;
+    }
+    rayn::rope<char> r(expect.c_str());
+    for (int i = 0; i != 200; ++i) {
+        size_t pos = (i * 7919) % (expect.size() + 1);
+        switch (i % 3) {
+        case 0:
+            r.insert(pos, "inserted");
+            expect.insert(pos, "inserted");
+            break;
+        case 1:
+            r.erase(pos, 13);
+            expect.erase(pos, 13);
+            break;
+        default:
+            r.replace(pos, 5, "<>");
+            expect.replace(pos, 5, "<>");
+            break;
+        }
+    }
+    REQUIRE(to_std(r) == expect);
+
+    r.insert(0, r);
+    expect.insert(0, expect);
+    REQUIRE(to_std(r) == expect);
+    r.erase(10);
+    REQUIRE(to_std(r) == expect.substr(0, 10));
+    REQUIRE_THROWS_AS(r.insert(11, "x"), const std::out_of_range&);
+}
+
+TEST_CASE("rope substr shares the characters", "[rope]") {
+    std::string text(10000, ' ');
+    for (size_t i = 0; i != text.size(); ++i) {
+        text[i] = '0' + i % 10;
+    }
+    rayn::rope<char> r(text.c_str(), text.size());
+    rayn::rope<char> sub = r.substr(1000, 5000);
+    REQUIRE(sub.size() == 5000);
+    REQUIRE(to_std(sub) == text.substr(1000, 5000));
+
+    // every chunk of sub lies inside the chunks of r
+    const char *lowest = 0;
+    r.for_each_chunk([&lowest](const char *chars, size_t) {
+        if (!lowest || chars < lowest) lowest = chars;
+    });
+    bool inside = true;
+    sub.for_each_chunk([&inside, &r](const char *chars, size_t n) {
+        bool found = false;
+        r.for_each_chunk([&found, chars, n](const char *c, size_t m) {
+            found = found || (chars >= c && chars + n <= c + m);
+        });
+        inside = inside && found;
+    });
+    REQUIRE(inside);
+
+    // the original is untouched by changes to the substring
+    sub.append("tail");
+    sub.erase(0, 10);
+    REQUIRE(to_std(r) == text);
+    REQUIRE(to_std(sub) == text.substr(1010, 4990) + "tail");
+
+    char buf[16];
+    REQUIRE(r.copy(buf, 5, 9998) == 2);
+    REQUIRE(buf[0] == '8');
+    REQUIRE(buf[1] == '9');
+}
+
+TEST_CASE("rope copies are independent", "[rope]") {
+    rayn::rope<char> a("Hello");
+    rayn::rope<char> b(a);
+    b += " World";
+    b += '!';
+    REQUIRE(to_std(a) == "Hello");
+    REQUIRE(to_std(b) == "Hello World!");
+    a = b;
+    a.erase(5);
+    REQUIRE(to_std(a) == "Hello");
+    REQUIRE(to_std(b) == "Hello World!");
+    a.swap(b);
+    REQUIRE(to_std(a) == "Hello World!");
+    a.clear();
+    REQUIRE(a.empty());
+    REQUIRE(a.str().empty());
+}
\ No newline at end of file
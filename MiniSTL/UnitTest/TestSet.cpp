@@ -3,8 +3,16 @@
 ** Created by Rayn on 2016/02/19
 */
 #include "catch.hpp"
+#include "TestHelper.h"
 #include "../Src/Set.h"
 #include "../Src/MultiSet.h"
+#include "../Src/Map.h"
+#include "../Src/MultiMap.h"
+#include "../Src/Vector.h"
+#include "../Src/Algo.h"
+#include "../Src/String.h"
+
+#include <cstdlib>
 
 // *************************************
 // set
@@ -31,5 +39,568 @@ TEST_CASE("set insert") {
 
 }
 
+TEST_CASE("rb_tree builds sorted input in linear time", "[set]") {
+    typedef rayn::rb_tree<int, int, rayn::identity<int>, rayn::less<int> > tree_type;
+    bool ok = true;
+    rayn::vector<int> v;
+    for (int n = 0; n != 300; ++n) {
+        tree_type t;
+        t.insert_unique(v.begin(), v.end());
+        ok = ok && t.__rb_verify() && t.size() == v.size()
+                && rayn::equal(t.begin(), t.end(), v.begin());
+        v.push_back(n * 2);
+    }
+    REQUIRE(ok);
+
+    // duplicates in sorted input are kept by insert_equal
+    int dups[] = { 1, 1, 2, 3, 3, 3, 4, 5, 5 };
+    tree_type multi;
+    multi.insert_equal(dups, dups + 9);
+    REQUIRE(multi.__rb_verify());
+    REQUIRE(multi.size() == 9);
+    REQUIRE(multi.count(3) == 3);
+
+    // and dropped by insert_unique, which falls back to per-element insert
+    tree_type uniq;
+    uniq.insert_unique(dups, dups + 9);
+    REQUIRE(uniq.__rb_verify());
+    REQUIRE(uniq.size() == 5);
+
+    // appending an ascending run to a non-empty tree
+    uniq.insert_unique(v.begin(), v.end());
+    REQUIRE(uniq.__rb_verify());
+    REQUIRE(uniq.size() == 5 + v.size() - 2);
+    REQUIRE(*uniq.rbegin() == v.back());
+
+    // unsorted input
+    int mixed[] = { 5, 3, 9, 1, 7, 3 };
+    tree_type t;
+    t.insert_unique(mixed, mixed + 6);
+    REQUIRE(t.__rb_verify());
+    REQUIRE(t.size() == 5);
+    REQUIRE(*t.begin() == 1);
+
+    t.assign_sorted(v.begin(), v.begin() + 100);
+    REQUIRE(t.__rb_verify());
+    REQUIRE(t.size() == 100);
+    t.assign_equal(dups, dups + 9);
+    REQUIRE(t.__rb_verify());
+    REQUIRE(t.size() == 9);
+}
+
+namespace {
+    struct counting_less {
+        static size_t calls;
+        bool operator()(int a, int b) const {
+            ++calls;
+            return a < b;
+        }
+    };
+    size_t counting_less::calls = 0;
+}
+
+TEST_CASE("hinted insert", "[set]") {
+    typedef rayn::rb_tree<int, int, rayn::identity<int>, counting_less> tree_type;
+    tree_type t;
+    for (int i = 0; i != 10000; ++i) {
+        t.insert_unique(t.end(), i);
+    }
+    // the hint check and the link side, instead of a walk from the root
+    REQUIRE(counting_less::calls <= 2 * 10000);
+    REQUIRE(t.__rb_verify());
+    REQUIRE(t.size() == 10000);
+
+    // hints in front of, behind, and far away from the right spot
+    tree_type u;
+    for (int i = 0; i != 1000; ++i) {
+        u.insert_unique(u.begin(), 1000 - i);
+        u.insert_unique(u.find(1000), 2000 + i);
+        u.insert_unique(u.end(), 500);
+    }
+    REQUIRE(u.__rb_verify());
+    REQUIRE(u.size() == 2000);
+    tree_type::iterator it = u.insert_unique(u.begin(), 500);
+    REQUIRE(*it == 500);
+    REQUIRE(u.size() == 2000);
+
+    tree_type e;
+    for (int i = 0; i != 1000; ++i) {
+        e.insert_equal(e.begin(), i % 10);
+        e.insert_equal(e.end(), i % 7);
+    }
+    REQUIRE(e.__rb_verify());
+    REQUIRE(e.size() == 2000);
+    REQUIRE(e.count(3) == 100 + 143);
+
+    rayn::set<int> s;
+    rayn::set<int>::iterator hint = s.end();
+    for (int i = 0; i != 100; ++i) {
+        hint = s.insert(hint, i * 2);
+    }
+    REQUIRE(*s.insert(s.begin(), 50) == 50);
+    REQUIRE(s.size() == 100);
+
+    rayn::multiset<int> ms;
+    ms.insert(ms.end(), 3);
+    ms.insert(ms.begin(), 3);
+    REQUIRE(*ms.insert(1) == 1);
+    REQUIRE(ms.count(3) == 2);
+
+    rayn::map<int, int> m;
+    for (int i = 0; i != 100; ++i) {
+        m.insert(m.end(), rayn::pair<const int, int>(i, i));
+    }
+    m[200] = 1;
+    REQUIRE(m.size() == 101);
+    REQUIRE(m.rbegin()->second == 1);
+}
+
+TEST_CASE("from_sorted_unique", "[set]") {
+    rayn::vector<int> keys;
+    for (int i = 0; i != 1000; ++i) {
+        keys.push_back(i * 3);
+    }
+    rayn::set<int> s = rayn::set<int>::from_sorted_unique(keys.begin(), keys.end());
+    REQUIRE(s.size() == 1000);
+    REQUIRE(s.count(999) == 1);
+    REQUIRE(s.count(1000) == 0);
+    REQUIRE(rayn::equal(s.begin(), s.end(), keys.begin()));
+    s.insert(1000);
+    s.erase(0);
+    REQUIRE(*s.begin() == 3);
+    REQUIRE(s.size() == 1000);
+
+    rayn::map<int, int> original;
+    for (int i = 0; i != 1000; ++i) {
+        original[i] = i * i;
+    }
+    rayn::map<int, int> m = rayn::map<int, int>::from_sorted_unique(original.begin(), original.end());
+    REQUIRE(m.size() == 1000);
+    REQUIRE(m[999] == 999 * 999);
+    REQUIRE(m.find(1000) == m.end());
+}
+
 // *************************************
-// multiset
\ No newline at end of file
+// multiset
+
+TEST_CASE("order statistics", "[set]") {
+    typedef rayn::multiset<int, rayn::less<int>, rayn::allocator<int>,
+                           rayn::rb_tree_order_statistics> ranked_set;
+    ranked_set s;
+    rayn::vector<int> model;
+    srand(21);
+    bool ok = true;
+    for (int i = 0; i != 4000; ++i) {
+        int k = rand() % 500;
+        rayn::vector<int>::iterator pos = rayn::lower_bound(model.begin(), model.end(), k);
+        if (rand() % 3 == 0) {
+            ranked_set::iterator it = s.find(k);
+            if (it != s.end()) {
+                s.erase(it);
+                model.erase(pos);
+            }
+        } else if (rand() % 2 == 0) {
+            s.insert(k);
+            model.insert(rayn::upper_bound(model.begin(), model.end(), k), k);
+        } else {
+            s.insert(s.lower_bound(k), k);
+            model.insert(pos, k);
+        }
+    }
+    REQUIRE(s.size() == model.size());
+    for (size_t i = 0; i != model.size(); ++i) {
+        ok = ok && *s.nth(i) == model[i] && s.index_of(s.nth(i)) == i;
+    }
+    REQUIRE(ok);
+    REQUIRE(s.nth(model.size()) == s.end());
+    REQUIRE(s.index_of(s.end()) == model.size());
+    for (int k = -1; k != 501; ++k) {
+        size_t expect = rayn::lower_bound(model.begin(), model.end(), k) - model.begin();
+        ok = ok && s.rank(k) == expect;
+    }
+    REQUIRE(ok);
+    REQUIRE(s.distance(s.lower_bound(100), s.upper_bound(300))
+            == rayn::distance(s.lower_bound(100), s.upper_bound(300)));
+
+    // copies and bulk builds carry the sizes too
+    ranked_set copy(s);
+    REQUIRE(*copy.nth(model.size() / 2) == model[model.size() / 2]);
+    ranked_set built(model.begin(), model.end());
+    for (size_t i = 0; i < model.size(); i += 7) {
+        ok = ok && *built.nth(i) == model[i];
+    }
+    REQUIRE(ok);
+
+    rayn::map<int, int, rayn::less<int>, rayn::allocator<rayn::pair<const int, int> >,
+              rayn::rb_tree_order_statistics> m;
+    for (int i = 0; i != 100; ++i) {
+        m[i * 10] = i;
+    }
+    REQUIRE(m.nth(42)->second == 42);
+    REQUIRE(m.rank(425) == 43);
+}
+
+namespace {
+    struct sum_summary {
+        typedef long long result_type;
+        result_type operator()(int v) const { return v; }
+        result_type operator()(result_type a, result_type b) const { return a + b; }
+    };
+
+    // order sensitive, and not plain old data
+    struct concat_summary {
+        typedef rayn::string result_type;
+        result_type operator()(int v) const { return rayn::string(1, char('a' + v % 26)); }
+        result_type operator()(const result_type& a, const result_type& b) const { return a + b; }
+    };
+
+    // intervals keyed by start, summarized by the furthest end
+    struct max_end_summary {
+        typedef int result_type;
+        result_type operator()(const rayn::pair<const int, int>& v) const { return v.second; }
+        result_type operator()(result_type a, result_type b) const { return a < b ? b : a; }
+    };
+}
+
+TEST_CASE("range_aggregate", "[set]") {
+    typedef rayn::multiset<int, rayn::less<int>, rayn::allocator<int>,
+                           rayn::rb_tree_summary<sum_summary> > sum_set;
+    sum_set s;
+    rayn::vector<int> model;
+    srand(22);
+    for (int i = 0; i != 3000; ++i) {
+        int k = rand() % 1000;
+        if (rand() % 4 == 0 && s.find(k) != s.end()) {
+            s.erase(s.find(k));
+            model.erase(rayn::lower_bound(model.begin(), model.end(), k));
+        } else {
+            s.insert(k);
+            model.insert(rayn::upper_bound(model.begin(), model.end(), k), k);
+        }
+    }
+    bool ok = true;
+    for (int i = 0; i != 200; ++i) {
+        int lo = rand() % 1100 - 50;
+        int hi = lo + rand() % 400;
+        long long expect = 0;
+        for (size_t j = 0; j != model.size(); ++j) {
+            if (lo <= model[j] && model[j] < hi) {
+                expect += model[j];
+            }
+        }
+        ok = ok && s.range_aggregate(lo, hi) == expect;
+    }
+    REQUIRE(ok);
+    REQUIRE(s.range_aggregate(500, 500) == 0);
+    REQUIRE(s.nth(10) != s.end());
+
+    rayn::set<int, rayn::less<int>, rayn::allocator<int>,
+              rayn::rb_tree_summary<concat_summary> > letters;
+    for (int i = 25; i >= 0; --i) {
+        letters.insert(i);
+    }
+    REQUIRE(letters.range_aggregate(0, 26) == "abcdefghijklmnopqrstuvwxyz");
+    REQUIRE(letters.range_aggregate(3, 9) == "defghi");
+    letters.erase(5);
+    REQUIRE(letters.range_aggregate(3, 9) == "deghi");
+
+    rayn::multiset<int, rayn::less<int>, rayn::allocator<int>,
+                   rayn::rb_tree_order_statistics> ranked(model.begin(), model.end());
+    REQUIRE(ranked.range_aggregate(100, 200)
+            == size_t(rayn::lower_bound(model.begin(), model.end(), 200)
+                      - rayn::lower_bound(model.begin(), model.end(), 100)));
+
+    // does any interval starting before 50 reach past it?
+    rayn::map<int, int, rayn::less<int>, rayn::allocator<rayn::pair<const int, int> >,
+              rayn::rb_tree_summary<max_end_summary> > intervals;
+    intervals[10] = 20;
+    intervals[30] = 45;
+    intervals[40] = 60;
+    intervals[70] = 90;
+    REQUIRE(intervals.range_aggregate(0, 50) == 60);
+    intervals.erase(40);
+    REQUIRE(intervals.range_aggregate(0, 50) == 45);
+    REQUIRE(intervals.range_aggregate(0, 100) == 90);
+}
+
+TEST_CASE("merge and set algebra", "[set]") {
+    typedef rayn::rb_tree<int, int, rayn::identity<int>, rayn::less<int>,
+                          rayn::allocator<int>, rayn::rb_tree_order_statistics> tree_type;
+    srand(23);
+    bool ok = true;
+    const int sizes[][2] = { { 0, 0 }, { 0, 50 }, { 50, 0 }, { 1, 1000 }, { 1000, 1 },
+                             { 30, 3000 }, { 3000, 30 }, { 700, 900 } };
+    for (int round = 0; round != 8; ++round) {
+        tree_type a[3], b[3];
+        for (int i = 0; i != sizes[round][0]; ++i) {
+            int k = rand() % 5000;
+            for (int j = 0; j != 3; ++j) a[j].insert_unique(k);
+        }
+        for (int i = 0; i != sizes[round][1]; ++i) {
+            int k = rand() % 5000;
+            for (int j = 0; j != 3; ++j) b[j].insert_unique(k);
+        }
+
+        rayn::vector<int> u, in, d, bk;
+        for (int k = 0; k != 5000; ++k) {
+            bool x = a[0].find(k) != a[0].end();
+            bool y = b[0].find(k) != b[0].end();
+            if (x || y) u.push_back(k);
+            if (x && y) in.push_back(k);
+            if (x && !y) d.push_back(k);
+            if (y) bk.push_back(k);
+        }
+
+        a[0].union_unique(b[0]);
+        a[1].intersect_unique(b[1]);
+        a[2].difference_unique(b[2]);
+        // union leaves other with the shared keys, the others leave it alone
+        const rayn::vector<int>* expect[] = { &u, &in, &d };
+        const rayn::vector<int>* rest[] = { &in, &bk, &bk };
+        for (int j = 0; j != 3; ++j) {
+            ok = ok && b[j].__rb_verify() && a[j].__rb_verify()
+                    && a[j].size() == expect[j]->size()
+                    && rayn::equal(a[j].begin(), a[j].end(), expect[j]->begin())
+                    && b[j].size() == rest[j]->size()
+                    && rayn::equal(b[j].begin(), b[j].end(), rest[j]->begin());
+            for (size_t i = 0; i < expect[j]->size(); i += 17) {
+                ok = ok && *a[j].nth(i) == (*expect[j])[i];
+            }
+            for (size_t i = 0; i < rest[j]->size(); i += 17) {
+                ok = ok && *b[j].nth(i) == (*rest[j])[i];
+            }
+        }
+    }
+    REQUIRE(ok);
+
+    // nodes are reused, not copied
+    rayn::set<int> s1, s2;
+    for (int i = 0; i != 100; ++i) {
+        s1.insert(i * 2);
+        s2.insert(i * 3);
+    }
+    const int* addr = &*s2.find(3);
+    const int* dup = &*s2.find(6);
+    s1.union_with(s2);
+    REQUIRE(&*s1.find(3) == addr);
+    REQUIRE(s1.size() == 100 + 100 - 34);
+    // the duplicates stay behind in other
+    REQUIRE(s2.size() == 34);
+    REQUIRE(*s2.begin() == 0);
+    REQUIRE(&*s2.find(6) == dup);
+
+    // intersect_with keeps the nodes of *this and leaves other alone
+    rayn::set<int> i1, i2;
+    for (int i = 0; i != 10; ++i) {
+        i1.insert(i);
+        i2.insert(i + 5);
+    }
+    addr = &*i1.find(6);
+    dup = &*i2.find(6);
+    i1.intersect_with(i2);
+    int shared[] = { 5, 6, 7, 8, 9 };
+    int own[] = { 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+    REQUIRE(i1.size() == 5);
+    REQUIRE(rayn::equal(i1.begin(), i1.end(), shared));
+    REQUIRE(i2.size() == 10);
+    REQUIRE(rayn::equal(i2.begin(), i2.end(), own));
+    REQUIRE(&*i1.find(6) == addr);
+    REQUIRE(&*i2.find(6) == dup);
+
+    // difference_with leaves other alone too
+    rayn::set<int> d1, d2;
+    for (int i = 0; i != 100; ++i) {
+        d1.insert(i * 2);
+        d2.insert(i * 3);
+    }
+    dup = &*d2.find(3);
+    d1.difference_with(d2);
+    REQUIRE(d1.size() == 100 - 34);
+    REQUIRE(d2.size() == 100);
+    REQUIRE(&*d2.find(3) == dup);
+    REQUIRE(d1.find(6) == d1.end());
+    ok = true;
+    int k = 0;
+    for (rayn::set<int>::iterator it = d2.begin(); it != d2.end(); ++it, k += 3) {
+        ok = ok && *it == k;
+    }
+    REQUIRE(ok);
+
+    // the elements removed from *this are destroyed, nothing leaks
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::set<int> x[3], y[3];
+        for (int i = 0; i != 200; ++i) {
+            for (int j = 0; j != 3; ++j) {
+                x[j].insert(i * 2);
+                y[j].insert(i * 3);
+            }
+        }
+        x[0].union_with(y[0]);
+        x[1].intersect_with(y[1]);
+        x[2].difference_with(y[2]);
+        REQUIRE(y[1].size() == 200);
+        REQUIRE(y[2].size() == 200);
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+
+    // merge leaves duplicates behind in a unique container
+    rayn::set<int> m1, m2;
+    for (int i = 0; i != 50; ++i) {
+        m1.insert(i * 2);
+        m2.insert(i);
+    }
+    addr = &*m2.find(49);
+    m1.merge(m2);
+    REQUIRE(m1.size() == 75);
+    REQUIRE(m2.size() == 25);
+    REQUIRE(*m2.begin() == 0);
+    REQUIRE(&*m1.find(49) == addr);
+
+    rayn::multiset<int> ms1, ms2;
+    for (int i = 0; i != 50; ++i) {
+        ms1.insert(i % 10);
+        ms2.insert(i % 5);
+    }
+    ms1.merge(ms2);
+    REQUIRE(ms1.size() == 100);
+    REQUIRE(ms2.empty());
+    REQUIRE(ms1.count(3) == 15);
+
+    rayn::map<int, int> mp1, mp2;
+    mp1[1] = 10;
+    mp1[2] = 20;
+    mp2[2] = 200;
+    mp2[3] = 300;
+    mp1.intersect_with(mp2);
+    REQUIRE(mp1.size() == 1);
+    REQUIRE(mp1[2] == 20);
+    REQUIRE(mp2.size() == 2);
+    REQUIRE(mp2.find(1) == mp2.end());
+    REQUIRE(mp2.find(2)->second == 200);
+    REQUIRE(mp2.find(3)->second == 300);
+}
+
+TEST_CASE("node handles", "[set]") {
+    // re-keying a map entry keeps its node
+    rayn::map<rayn::string, int> m;
+    m["alpha"] = 1;
+    m["beta"] = 2;
+    const int* addr = &m["alpha"];
+    rayn::map<rayn::string, int>::node_type nh = m.extract("alpha");
+    REQUIRE(!nh.empty());
+    REQUIRE(m.size() == 1);
+    nh.key() = "gamma";
+    nh.mapped() = 3;
+    rayn::map<rayn::string, int>::insert_return_type r = m.insert(rayn::move(nh));
+    REQUIRE(r.inserted);
+    REQUIRE(r.node.empty());
+    REQUIRE(&r.position->second == addr);
+    REQUIRE(m.size() == 2);
+    REQUIRE(m["gamma"] == 3);
+    REQUIRE(m.find("alpha") == m.end());
+
+    // a duplicate key leaves the node in the handle, which frees it
+    nh = m.extract(m.find("beta"));
+    nh.key() = "gamma";
+    r = m.insert(rayn::move(nh));
+    REQUIRE(!r.inserted);
+    REQUIRE(!r.node.empty());
+    REQUIRE(r.position->second == 3);
+    REQUIRE(m.size() == 1);
+    REQUIRE(m.extract("none").empty());
+
+    // moving between containers
+    rayn::set<int> s1, s2;
+    for (int i = 0; i != 10; ++i) s1.insert(i);
+    const int* p = &*s1.find(7);
+    s2.insert(s2.end(), s1.extract(7));
+    REQUIRE(s1.size() == 9);
+    REQUIRE(s2.size() == 1);
+    REQUIRE(&*s2.begin() == p);
+    rayn::set<int>::node_type sn = s2.extract(s2.begin());
+    sn.value() = 70;
+    REQUIRE(*s1.insert(rayn::move(sn)).position == 70);
+    REQUIRE(s1.size() == 10);
+
+    rayn::multiset<int> ms;
+    for (int i = 0; i != 20; ++i) ms.insert(i % 4);
+    rayn::multiset<int>::node_type mn = ms.extract(2);
+    REQUIRE(mn.value() == 2);
+    REQUIRE(ms.count(2) == 4);
+    mn.value() = 3;
+    ms.insert(rayn::move(mn));
+    REQUIRE(ms.count(3) == 6);
+    REQUIRE(ms.size() == 20);
+
+    rayn::multimap<int, int> mm;
+    rayn::map<int, int> src;
+    for (int i = 0; i != 6; ++i) src[i] = i * 10;
+    for (int i = 0; i != 6; ++i) {
+        rayn::map<int, int>::node_type n = src.extract(i);
+        rayn::multimap<int, int>::node_type mnode(rayn::move(n));
+        mnode.key() = i % 2;
+        mm.insert(rayn::move(mnode));
+    }
+    REQUIRE(src.empty());
+    REQUIRE(mm.size() == 6);
+    REQUIRE(mm.count(1) == 3);
+
+    // subtree sizes stay right across extract and re-insert
+    typedef rayn::set<int, rayn::less<int>, rayn::allocator<int>,
+                      rayn::rb_tree_order_statistics> os_set;
+    os_set os;
+    for (int i = 0; i != 200; ++i) os.insert(i);
+    bool ok = true;
+    for (int i = 0; i < 200; i += 3) {
+        os_set::node_type n = os.extract(i);
+        n.value() = i + 1000;
+        os.insert(os.end(), rayn::move(n));
+    }
+    int k = 0;
+    for (os_set::iterator it = os.begin(); it != os.end(); ++it, ++k) {
+        ok = ok && *os.nth(k) == *it && os.rank(*it) == size_t(k);
+    }
+    REQUIRE(ok);
+    REQUIRE(os.size() == 200);
+}
+
+namespace {
+    // counts how many keys get built, lookups by int must build none
+    struct counted_key {
+        static size_t built;
+        int v;
+        counted_key(int x) : v(x) { ++built; }
+        counted_key(const counted_key& k) : v(k.v) { ++built; }
+    };
+    size_t counted_key::built = 0;
+
+    struct counted_less {
+        typedef void is_transparent;
+        bool operator()(const counted_key& a, const counted_key& b) const { return a.v < b.v; }
+        bool operator()(const counted_key& a, int b) const { return a.v < b; }
+        bool operator()(int a, const counted_key& b) const { return a < b.v; }
+    };
+}
+
+TEST_CASE("heterogeneous lookup", "[set]") {
+    rayn::set<counted_key, counted_less> s;
+    rayn::multimap<counted_key, int, counted_less> mm;
+    for (int i = 0; i != 100; ++i) {
+        s.insert(counted_key(i * 2));
+        mm.insert(rayn::make_pair(counted_key(i % 10), i));
+    }
+    counted_key::built = 0;
+    REQUIRE(s.find(40)->v == 40);
+    REQUIRE(s.find(41) == s.end());
+    REQUIRE(s.count(42) == 1);
+    REQUIRE(s.lower_bound(41)->v == 42);
+    REQUIRE(s.upper_bound(42)->v == 44);
+    REQUIRE(s.equal_range(50).first->v == 50);
+    REQUIRE(mm.count(3) == 10);
+    REQUIRE(mm.equal_range(3).first->second == 3);
+    REQUIRE(mm.find(10) == mm.end());
+    REQUIRE(counted_key::built == 0);
+}
\ No newline at end of file
@@ -3,7 +3,11 @@
 ** Created by Rayn on 2015/12/23
 */
 #include "catch.hpp"
+#include "TestHelper.h"
 #include "../Src/String.h"
+#include "../Src/Alloc.h"
+
+#include <string>
 
 TEST_CASE("string constructor", "[string]") {
     rayn::string s1("Hello World!");
@@ -100,7 +104,9 @@ TEST_CASE("string capacity function", "[string]") {
 
         str.shrink_to_fit();
         REQUIRE(str.length() == 11);
-        REQUIRE(str.capacity() == 11);
+        // short strings go back into the object, which may hold a few more chars
+        REQUIRE(str.capacity() >= 11);
+        REQUIRE(str.capacity() < 32);
     }
 
     SECTION("string clear") {
@@ -210,3 +216,208 @@ TEST_CASE("string assign", "[string]") {
     }
 }
 
+
+
+TEST_CASE("string growth keeps characters", "[string]") {
+    rayn::string str;
+    for (int i = 0; i < 500; ++i) {
+        str.push_back('a' + i % 26);
+    }
+    REQUIRE(str.size() == 500);
+    REQUIRE(str[0] == 'a');
+    REQUIRE(str[499] == 'a' + 499 % 26);
+
+    rayn::string head(str, 0, 26);
+    REQUIRE(head == "abcdefghijklmnopqrstuvwxyz");
+    head.append(head);
+    REQUIRE(head == "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+    head.insert(head.begin(), 3, '*');
+    REQUIRE(head.size() == 55);
+    REQUIRE(head[2] == '*');
+    REQUIRE(head[3] == 'a');
+    REQUIRE(head.back() == 'z');
+}
+
+TEST_CASE("string move assignment frees the old storage", "[string]") {
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::string a("a string that is long enough to live on the heap");
+        rayn::string b("another string that is long enough for the heap");
+        rayn::string c("and a third one, again too long to be stored inline");
+        a = rayn::move(b);
+        REQUIRE(a == "another string that is long enough for the heap");
+        a.assign(rayn::move(c));
+        REQUIRE(a == "and a third one, again too long to be stored inline");
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+}
+
+TEST_CASE("string resize", "[string]") {
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::string s("0123456789");
+        s.resize(11, 'x');
+        REQUIRE(s == "0123456789x");
+        s.resize(100, 'y');
+        REQUIRE(s.size() == 100);
+        REQUIRE(s.capacity() >= 100);
+        REQUIRE(s[99] == 'y');
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+}
+
+namespace {
+    bool inside(const void *p, const rayn::string& str) {
+        const char *obj = reinterpret_cast<const char *>(&str);
+        return obj <= p && p < obj + sizeof(str);
+    }
+}
+
+TEST_CASE("short string is stored inside the object", "[string]") {
+    rayn::string str("key");
+    REQUIRE(inside(str.c_str(), str));
+    REQUIRE(str.c_str()[3] == '\0');
+    REQUIRE(strcmp(str.c_str(), "key") == 0);
+
+    str.append("_suffix");
+    REQUIRE(str == "key_suffix");
+    REQUIRE(inside(str.data(), str));
+    REQUIRE(str.c_str()[10] == '\0');
+
+    // moving a short string copies the characters, the source is left empty
+    rayn::string moved(rayn::move(str));
+    REQUIRE(moved == "key_suffix");
+    REQUIRE(inside(moved.c_str(), moved));
+    REQUIRE(str.empty());
+    REQUIRE(str.c_str()[0] == '\0');
+
+    // growing past the local buffer moves the characters to the heap
+    moved.append(moved);
+    moved.append(moved);
+    REQUIRE(moved == "key_suffixkey_suffixkey_suffixkey_suffix");
+    REQUIRE_FALSE(inside(moved.c_str(), moved));
+    REQUIRE(moved.c_str()[40] == '\0');
+
+    moved.erase(3, 37);
+    REQUIRE(moved == "key");
+    moved.shrink_to_fit();
+    REQUIRE(inside(moved.c_str(), moved));
+    REQUIRE(moved == "key");
+
+    rayn::string other(50, 'x');
+    moved.swap(other);
+    REQUIRE(moved.size() == 50);
+    REQUIRE(other == "key");
+    REQUIRE(inside(other.c_str(), other));
+}
+
+TEST_CASE("string find and rfind", "[string]") {
+    rayn::string str("This is a string, a long string for searching a string");
+
+    REQUIRE(str.find('s') == 3);
+    REQUIRE(str.find("string") == 10);
+    REQUIRE(str.find("string", 11) == 25);
+    REQUIRE(str.find(rayn::string("a string")) == 8);
+    REQUIRE(str.find("") == 0);
+    REQUIRE(str.find("", str.size()) == str.size());
+    REQUIRE(str.find("strings") == rayn::string::npos);
+    // a match at the very end, and a needle running past the end
+    REQUIRE(str.find("a string", 40) == 46);
+    REQUIRE(str.find("stringy", 48) == rayn::string::npos);
+
+    REQUIRE(str.rfind('s') == 48);
+    REQUIRE(str.rfind("string") == 48);
+    REQUIRE(str.rfind("string", 47) == 25);
+    REQUIRE(str.rfind("This") == 0);
+    REQUIRE(str.rfind("This", 0) == 0);
+    REQUIRE(str.rfind('T', 0) == 0);
+    REQUIRE(str.rfind("none") == rayn::string::npos);
+}
+
+TEST_CASE("string find agrees with std::string", "[string]") {
+    // a small alphabet makes many partial matches
+    std::string text;
+    unsigned seed = 12345;
+    for (int i = 0; i < 3000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        text.push_back("abc"[(seed >> 16) % 3]);
+    }
+    rayn::string str(text.c_str());
+
+    bool same = true;
+    for (size_t m = 1; m <= 80; m += (m < 8 ? 1 : 9)) {
+        for (size_t at = 0; at + m <= text.size(); at += 397) {
+            std::string needle = text.substr(at, m);
+            rayn::searcher<char> s(needle.c_str(), m);
+            same = same && str.find(needle.c_str()) == text.find(needle);
+            same = same && str.find(needle.c_str(), at + 1) == text.find(needle, at + 1);
+            same = same && str.find(s, at / 2) == text.find(needle, at / 2);
+            same = same && str.rfind(needle.c_str()) == text.rfind(needle);
+            same = same && str.rfind(needle.c_str(), at + 5) == text.rfind(needle, at + 5);
+        }
+        // long needles that are not in the text
+        std::string missing(m, 'd');
+        same = same && str.find(missing.c_str()) == rayn::string::npos;
+        same = same && str.rfind(missing.c_str()) == rayn::string::npos;
+    }
+    REQUIRE(same);
+}
+
+TEST_CASE("string find_first_of family", "[string]") {
+    rayn::string str("key = value; other=\"x y\"");
+
+    REQUIRE(str.find_first_of("=;") == 4);
+    REQUIRE(str.find_first_of(rayn::string(";"), 5) == 11);
+    REQUIRE(str.find_first_of('=', 5) == 18);
+    REQUIRE(str.find_first_of("#") == rayn::string::npos);
+    REQUIRE(str.find_last_of("=;") == 18);
+    REQUIRE(str.find_last_of("=;", 17) == 11);
+    REQUIRE(str.find_last_of('k') == 0);
+    REQUIRE(str.find_first_not_of("key ") == 4);
+    REQUIRE(str.find_first_not_of('k') == 1);
+    REQUIRE(str.find_last_not_of("\" ") == 22);
+    REQUIRE(str.find_last_not_of('"', 2) == 2);
+    REQUIRE(rayn::string("aaaa").find_first_not_of('a') == rayn::string::npos);
+    REQUIRE(rayn::string("aaaa").find_last_not_of("a") == rayn::string::npos);
+    REQUIRE(rayn::string().find_last_of("a") == rayn::string::npos);
+}
+
+TEST_CASE("string find_first_of agrees with std::string", "[string]") {
+    // long enough for the vector kernels, with characters above 127
+    std::string text;
+    unsigned seed = 54321;
+    for (int i = 0; i < 1000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        text.push_back(static_cast<char>(' ' + (seed >> 16) % 200));
+    }
+    rayn::string str(text.c_str());
+    const char *sets[] = { "\t ,;", "0123456789", "\xe9\xff\x80", "", "!" };
+
+    bool same = true;
+    for (size_t i = 0; i != sizeof(sets) / sizeof(sets[0]); ++i) {
+        const char *set = sets[i];
+        for (size_t pos = 0; pos < text.size() + 10; pos += 37) {
+            same = same && str.find_first_of(set, pos) == text.find_first_of(set, pos);
+            same = same && str.find_last_of(set, pos) == text.find_last_of(set, pos);
+            same = same && str.find_first_not_of(set, pos) == text.find_first_not_of(set, pos);
+            same = same && str.find_last_not_of(set, pos) == text.find_last_not_of(set, pos);
+        }
+    }
+    // a set holding every character but one
+    std::string all;
+    for (int c = 1; c != 256; ++c) {
+        if (c != 'x') all.push_back(static_cast<char>(c));
+    }
+    std::string xs(100, 'x');
+    xs[70] = 'y';
+    rayn::string rxs(xs.c_str());
+    same = same && rxs.find_first_not_of(all.c_str()) == 0;
+    same = same && rxs.find_first_of(all.c_str()) == 70;
+    same = same && rxs.find_last_of(all.c_str()) == 70;
+    same = same && rxs.find_last_not_of(all.c_str()) == 99;
+    REQUIRE(same);
+}
\ No newline at end of file
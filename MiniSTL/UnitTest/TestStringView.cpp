@@ -0,0 +1,169 @@
+/*
+** unit test for string_view
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Set.h"
+#include "../Src/String.h"
+#include "../Src/StringView.h"
+
+#include <string>
+
+TEST_CASE("string_view views part of a buffer", "[string_view]") {
+    const char *buffer = "key=value;next=1";
+    rayn::string_view all(buffer);
+    REQUIRE(all.size() == 16);
+    REQUIRE(all.data() == buffer);
+
+    rayn::string_view key = all.substr(0, all.find('='));
+    REQUIRE(key == "key");
+    REQUIRE(key.data() == buffer);
+    rayn::string_view value = all.substr(4, all.find(';') - 4);
+    REQUIRE(value == "value");
+    REQUIRE(value.data() == buffer + 4);
+
+    rayn::string_view rest = all;
+    rest.remove_prefix(all.find(';') + 1);
+    REQUIRE(rest == "next=1");
+    rest.remove_suffix(2);
+    REQUIRE(rest == "next");
+    REQUIRE(rest.starts_with("ne"));
+    REQUIRE(rest.ends_with('t'));
+    REQUIRE_FALSE(rest.starts_with("next!"));
+
+    REQUIRE(key < value);
+    REQUIRE("abc" < key);
+    REQUIRE(key.compare(rayn::string_view("key=", 3)) == 0);
+    // bytes past 0x7f order after ASCII, as in memcmp, whatever the sign of char
+    const char high[] = { 'a', '\xe4', 'b' };
+    REQUIRE(rayn::string_view(high, 3).compare("azz") > 0);
+    REQUIRE(rayn::string_view("a") < rayn::string_view(high, 2));
+    REQUIRE(rayn::string_view(high, 2).compare(rayn::string_view(high, 3)) < 0);
+    REQUIRE(rayn::string_view().empty());
+    REQUIRE(rayn::string_view() == "");
+    REQUIRE_THROWS_AS(all.at(16), const std::out_of_range&);
+    REQUIRE_THROWS_AS(all.substr(17), const std::out_of_range&);
+
+    char out[8];
+    REQUIRE(all.copy(out, 8, 10) == 6);
+    REQUIRE(std::string(out, 6) == "next=1");
+}
+
+TEST_CASE("string_view search agrees with std::string", "[string_view]") {
+    std::string text;
+    for (int i = 0; i != 300; ++i) {
+        text += static_cast<char>('a' + (i * 7) % 13);
+    }
+    // a slice in the middle of a larger buffer
+    std::string buffer = "###" + text + "###";
+    rayn::string_view v(buffer.data() + 3, text.size());
+    const char *needles[] = { "a", "hov", "bihov", "xyz", "" };
+    bool ok = true;
+    for (int i = 0; i != 5; ++i) {
+        for (size_t pos = 0; pos <= text.size() + 1; pos += 17) {
+            ok = ok && v.find(needles[i], pos) == text.find(needles[i], pos);
+            ok = ok && v.rfind(needles[i], pos) == text.rfind(needles[i], pos);
+            ok = ok && v.find_first_of(needles[i], pos) == text.find_first_of(needles[i], pos);
+            ok = ok && v.find_last_of(needles[i], pos) == text.find_last_of(needles[i], pos);
+            ok = ok && v.find_first_not_of(needles[i], pos) == text.find_first_not_of(needles[i], pos);
+            ok = ok && v.find_last_not_of(needles[i], pos) == text.find_last_not_of(needles[i], pos);
+        }
+    }
+    REQUIRE(ok);
+    REQUIRE(v.find('#') == rayn::string_view::npos);
+}
+
+TEST_CASE("basic_string accepts string_view", "[string_view][string]") {
+    const char *buffer = "Hello World, Hello Rayn";
+    rayn::string_view hello(buffer, 5);
+    rayn::string_view world(buffer + 6, 5);
+
+    rayn::string s(hello);
+    REQUIRE(s == "Hello");
+    s += rayn::string_view(", ", 2);
+    s.append(world);
+    REQUIRE(s == "Hello, World");
+    s.insert(0, rayn::string_view(">> ", 3));
+    REQUIRE(s == ">> Hello, World");
+    s.replace(3, 5, world);
+    REQUIRE(s == ">> World, World");
+
+    REQUIRE(s.find(world) == 3);
+    REQUIRE(s.rfind(world) == 10);
+    REQUIRE(s.find_first_of(rayn::string_view(",!")) == 8);
+    REQUIRE(s.find_first_not_of(rayn::string_view("> ")) == 3);
+    REQUIRE(s.find_last_of(hello) == 13);
+    REQUIRE(s.find_last_not_of(rayn::string_view("dl")) == 12);
+    REQUIRE(s.compare(3, 5, world) == 0);
+    REQUIRE(s.compare(world) < 0);
+
+    rayn::string_view all = s;
+    REQUIRE(all.data() == s.data());
+    REQUIRE(all.size() == s.size());
+    REQUIRE(s == all);
+    REQUIRE(world == rayn::string("World"));
+    REQUIRE(hello < rayn::string("World"));
+    REQUIRE(rayn::string("World") >= world);
+}
+
+TEST_CASE("string and string_view order high bytes alike", "[string_view][string]") {
+    // "\xe4" sorts after "a" and "b" everywhere, whatever the sign of char
+    const char *high = "\xe4";
+    rayn::string s(high);
+    rayn::string_view sv(high);
+    REQUIRE(rayn::string("a") < s);
+    REQUIRE(rayn::string_view("a") < s);
+    REQUIRE(rayn::string("a") < sv);
+    REQUIRE("a" < s);
+    REQUIRE(s > "b");
+    REQUIRE(s.compare("b") > 0);
+    REQUIRE(s.compare(rayn::string_view("b")) > 0);
+    REQUIRE(rayn::string("b").compare(sv) < 0);
+    REQUIRE(s.compare(sv) == 0);
+    REQUIRE(rayn::string("a\xe4").compare(rayn::string("az")) > 0);
+
+    // so transparent lookups find the key through any of the three types
+    rayn::set<rayn::string_view, rayn::less<> > views;
+    views.insert(rayn::string_view("a"));
+    views.insert(sv);
+    views.insert(rayn::string_view("b"));
+    REQUIRE(views.find(s) != views.end());
+    REQUIRE(views.find(sv) != views.end());
+    REQUIRE(views.find(rayn::string("c")) == views.end());
+    REQUIRE(*views.rbegin() == s);
+
+    rayn::set<rayn::string, rayn::less<> > strings;
+    strings.insert(rayn::string("a"));
+    strings.insert(s);
+    strings.insert(rayn::string("b"));
+    REQUIRE(strings.find(sv) != strings.end());
+    REQUIRE(strings.find(high) != strings.end());
+    REQUIRE(strings.lower_bound(rayn::string_view("c"))->compare(sv) == 0);
+}
+
+TEST_CASE("empty string_view has a null data pointer", "[string_view]") {
+    // 默认构造的视图data()为空指针，比较和搜索都不能把它交给memcmp/memchr
+    rayn::string_view a, b;
+    REQUIRE(a.data() == 0);
+    REQUIRE(a == b);
+    REQUIRE_FALSE(a != b);
+    REQUIRE(a.compare(b) == 0);
+    REQUIRE(a.starts_with(b));
+    REQUIRE(a.ends_with(b));
+    REQUIRE(a.find(b) == 0);
+    REQUIRE(a.find('x') == rayn::string_view::npos);
+
+    rayn::string_view text("text");
+    REQUIRE(text.starts_with(a));
+    REQUIRE(text.ends_with(a));
+    REQUIRE(text.find(a) == 0);
+    REQUIRE(text != a);
+
+    rayn::string s("text");
+    s.append(a);
+    s += a;
+    REQUIRE(s == "text");
+    REQUIRE(s.find(a) == 0);
+    REQUIRE(s.compare(a) > 0);
+    REQUIRE(rayn::string(a).empty());
+}
\ No newline at end of file
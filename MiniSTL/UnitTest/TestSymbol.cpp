@@ -0,0 +1,95 @@
+/*
+** unit test for symbol
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "../Src/Map.h"
+#include "../Src/String.h"
+#include "../Src/Symbol.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+TEST_CASE("symbol interns equal strings once", "[symbol]") {
+    rayn::string key("symbol-test-key");
+    rayn::symbol a("symbol-test-key");
+    rayn::symbol b = rayn::symbol(rayn::string_view(key));
+    REQUIRE(a == b);
+    REQUIRE(a.c_str() == b.c_str());
+    REQUIRE(a.id() != 0);
+    REQUIRE(a.str() == "symbol-test-key");
+    REQUIRE(a.size() == 15);
+
+    rayn::symbol c("symbol-test-other");
+    REQUIRE(a != c);
+    REQUIRE(a < c);
+    REQUIRE(rayn::symbol_name_less()(c, a) == false);
+
+    REQUIRE(rayn::symbol::find("symbol-test-key") == a);
+    REQUIRE(rayn::symbol::find("symbol-test-never").empty());
+    REQUIRE(rayn::symbol("").empty());
+    REQUIRE(rayn::symbol() == rayn::symbol(""));
+    REQUIRE(std::string(rayn::symbol().c_str()).empty());
+}
+
+TEST_CASE("symbol_table keeps entries in place", "[symbol]") {
+    rayn::symbol_table table;
+    const rayn::symbol_entry *first = table.intern("first");
+    char buf[32];
+    for (int i = 0; i != 10000; ++i) {
+        sprintf(buf, "name%d", i);
+        table.intern(buf);
+    }
+    REQUIRE(table.size() == 10001);
+    REQUIRE(table.intern("first") == first);
+    REQUIRE(first->id == 1);
+    REQUIRE(std::string(first->chars) == "first");
+
+    bool ok = true;
+    for (int i = 0; i != 10000; ++i) {
+        sprintf(buf, "name%d", i);
+        const rayn::symbol_entry *e = table.find(buf);
+        ok = ok && e && e->id == static_cast<size_t>(i) + 2 && rayn::string_view(e->chars) == buf;
+    }
+    REQUIRE(ok);
+    REQUIRE(table.find("missing") == 0);
+}
+
+TEST_CASE("symbol_table is shared between threads", "[symbol]") {
+    rayn::symbol_table table;
+    const rayn::symbol_entry *seen[4][500];
+    std::thread threads[4];
+    for (int t = 0; t != 4; ++t) {
+        threads[t] = std::thread([&table, &seen, t]() {
+            char buf[32];
+            for (int i = 0; i != 500; ++i) {
+                // every thread interns the same names in a different order
+                int n = (i * 7 + t * 131) % 500;
+                sprintf(buf, "shared%d", n);
+                seen[t][n] = table.intern(buf);
+            }
+        });
+    }
+    for (int t = 0; t != 4; ++t) {
+        threads[t].join();
+    }
+    bool same = true;
+    for (int n = 0; n != 500; ++n) {
+        for (int t = 1; t != 4; ++t) {
+            same = same && seen[t][n] == seen[0][n];
+        }
+    }
+    REQUIRE(same);
+    REQUIRE(table.size() == 500);
+}
+
+TEST_CASE("map keyed on symbols", "[symbol]") {
+    rayn::map<rayn::symbol, int> m;
+    m[rayn::symbol("width")] = 640;
+    m[rayn::symbol("height")] = 480;
+    m[rayn::symbol("width")] = 800;
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[rayn::symbol("width")] == 800);
+    REQUIRE(m.find(rayn::symbol("depth")) == m.end());
+}
\ No newline at end of file
@@ -345,4 +345,10 @@ TEST_CASE("declval", "[type_traits]") {
     };
     bool val = rayn::is_same<int, decltype(rayn::declval<A>().value())>::value;
     REQUIRE(val);
+}
+
+TEST_CASE("aligned_storage", "[type_traits]") {
+    typedef rayn::aligned_storage<sizeof(double) * 3, rayn::alignment_of<double>::value>::type storage;
+    REQUIRE(sizeof(storage) >= sizeof(double) * 3);
+    REQUIRE(rayn::alignment_of<storage>::value >= rayn::alignment_of<double>::value);
 }
\ No newline at end of file
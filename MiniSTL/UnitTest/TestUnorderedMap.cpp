@@ -0,0 +1,240 @@
+/*
+** unit test for unordered_map and unordered_set
+** Created by Rayn on 2026/10/17
+*/
+#include "catch.hpp"
+#include "TestHelper.h"
+#include "../Src/Map.h"
+#include "../Src/MemoryResource.h"
+#include "../Src/String.h"
+#include "../Src/UnorderedMap.h"
+#include "../Src/UnorderedSet.h"
+
+#include <cstdio>
+
+// *************************************
+// unordered_map
+
+TEST_CASE("unordered_map agrees with map", "[unordered_map]") {
+    rayn::unordered_map<int, int> h;
+    rayn::map<int, int> m;
+    REQUIRE(test_helper::agrees_with_map(h, m, 16, 20000, 3000));
+    REQUIRE(h.load_factor() <= h.max_load_factor());
+
+    REQUIRE_THROWS_AS(h.at(-1), const std::out_of_range&);
+    rayn::unordered_map<int, int> copy(h);
+    REQUIRE(copy == h);
+    copy[-1] = 0;
+    REQUIRE(copy != h);
+    copy.erase(copy.find(-1));
+    REQUIRE(copy == h);
+    copy.clear();
+    REQUIRE(copy.empty());
+    REQUIRE(copy.begin() == copy.end());
+}
+
+TEST_CASE("unordered_map reuses erased slots", "[unordered_map]") {
+    rayn::unordered_map<int, int> h;
+    h.reserve(100);
+    size_t buckets = h.bucket_count();
+    // the same number of live keys over and over again must not grow the table
+    for (int round = 0; round != 100; ++round) {
+        for (int i = 0; i != 100; ++i) {
+            h.insert(rayn::pair<const int, int>(round * 100 + i, i));
+        }
+        for (int i = 0; i != 100; ++i) {
+            h.erase(round * 100 + i);
+        }
+    }
+    REQUIRE(h.empty());
+    REQUIRE(h.bucket_count() == buckets);
+
+    for (int i = 0; i != 1000; ++i) {
+        h[i] = i;
+    }
+    h.erase(h.begin(), h.end());
+    REQUIRE(h.empty());
+    h.rehash(0);
+    REQUIRE(h.bucket_count() == 0);
+}
+
+namespace {
+    // every key lands on the same probe sequence and the same H2
+    struct colliding_hash {
+        size_t operator()(int) const { return 42; }
+    };
+}
+
+TEST_CASE("unordered_map probes past deleted slots", "[unordered_map]") {
+    rayn::unordered_map<int, int, colliding_hash> h;
+    h.reserve(100);
+    size_t buckets = h.bucket_count();
+    // three full groups, so erasing in the first one leaves tombstones
+    for (int i = 0; i != 40; ++i) {
+        h[i] = i;
+    }
+    for (int i = 0; i != 16; i += 2) {
+        REQUIRE(h.erase(i) == 1);
+    }
+    bool ok = true;
+    for (int i = 0; i != 40; ++i) {
+        ok = ok && h.count(i) == size_t(i < 16 && i % 2 == 0 ? 0 : 1);
+    }
+    REQUIRE(ok);
+    REQUIRE(h.size() == 32);
+
+    // new keys reuse the deleted slots instead of growing the table
+    for (int i = 100; i != 108; ++i) {
+        h[i] = i;
+    }
+    REQUIRE(h.size() == 40);
+    REQUIRE(h.bucket_count() == buckets);
+    for (int i = 100; i != 108; ++i) {
+        ok = ok && h.at(i) == i;
+    }
+    for (int i = 1; i < 40; i += 2) {
+        ok = ok && h.at(i) == i;
+    }
+    REQUIRE(ok);
+    REQUIRE(h.find(0) == h.end());
+}
+
+TEST_CASE("unordered_map hinted insert and max_size", "[unordered_map]") {
+    typedef rayn::pair<const int, int> value_type;
+    rayn::unordered_map<int, int> h;
+    rayn::unordered_map<int, int>::iterator it = h.insert(h.end(), value_type(1, 10));
+    REQUIRE(it->first == 1);
+    REQUIRE(it->second == 10);
+    // an existing key is found, not overwritten
+    it = h.insert(h.begin(), value_type(1, 20));
+    REQUIRE(it == h.find(1));
+    REQUIRE(it->second == 10);
+    REQUIRE(h.size() == 1);
+
+    // asking for more slots than max_size() throws before allocating
+    REQUIRE_THROWS_AS(h.rehash(h.max_size()), const std::length_error&);
+    REQUIRE_THROWS_AS(h.reserve(h.max_size()), const std::length_error&);
+    REQUIRE(h.size() == 1);
+    REQUIRE(h.at(1) == 10);
+}
+
+TEST_CASE("unordered_map with string keys", "[unordered_map]") {
+    rayn::unordered_map<rayn::string, int> h;
+    char buf[32];
+    for (int i = 0; i != 1000; ++i) {
+        sprintf(buf, "key%d", i);
+        h[rayn::string(buf)] = i;
+    }
+    REQUIRE(h.size() == 1000);
+    bool ok = true;
+    for (int i = 0; i != 1000; ++i) {
+        sprintf(buf, "key%d", i);
+        ok = ok && h.at(rayn::string(buf)) == i;
+    }
+    REQUIRE(ok);
+    REQUIRE(h.find(rayn::string("key1000")) == h.end());
+}
+
+namespace {
+    size_t hash_calls = 0;
+    size_t default_values = 0;
+
+    struct counting_hash {
+        size_t operator()(int k) const {
+            ++hash_calls;
+            return rayn::hash<int>()(k);
+        }
+    };
+    struct counted_value {
+        int v;
+        counted_value() : v(0) { ++default_values; }
+    };
+}
+
+TEST_CASE("unordered_map operator[] probes once", "[unordered_map]") {
+    rayn::unordered_map<int, counted_value, counting_hash> h;
+    h.reserve(100);
+    hash_calls = default_values = 0;
+    for (int i = 0; i != 100; ++i) {
+        h[i].v = i;
+    }
+    // a miss hashes the key once and builds one value
+    REQUIRE(hash_calls == 100);
+    REQUIRE(default_values == 100);
+
+    hash_calls = default_values = 0;
+    bool ok = true;
+    for (int i = 0; i != 100; ++i) {
+        ok = ok && h[i].v == i;
+    }
+    REQUIRE(ok);
+    // a hit builds nothing
+    REQUIRE(hash_calls == 100);
+    REQUIRE(default_values == 0);
+    REQUIRE(h.size() == 100);
+}
+
+TEST_CASE("node layout keeps references across rehash", "[unordered_map]") {
+    typedef rayn::unordered_map<int, int, rayn::hash<int>, rayn::equal_to<int>,
+                                rayn::allocator<rayn::pair<const int, int> >,
+                                rayn::hash_node_layout> node_map;
+    node_map h;
+    int *first = &h[0];
+    for (int i = 1; i != 1000; ++i) {
+        h[i] = i;
+    }
+    *first = -1;
+    REQUIRE(&h[0] == first);
+    REQUIRE(h.at(0) == -1);
+
+    // large values get the node layout by default
+    struct big { char bytes[64]; };
+    REQUIRE((rayn::is_same<rayn::__hash_default_layout<rayn::pair<const int, big> >::type,
+                           rayn::hash_node_layout>::value));
+    REQUIRE((rayn::is_same<rayn::__hash_default_layout<rayn::pair<const int, int> >::type,
+                           rayn::hash_flat_layout>::value));
+}
+
+TEST_CASE("unordered_map allocates from the resource", "[unordered_map]") {
+    rayn::unsynchronized_pool_resource mr;
+    rayn::polymorphic_allocator<rayn::pair<const int, int> > a(&mr);
+    rayn::unordered_map<int, int, rayn::hash<int>, rayn::equal_to<int>,
+                        rayn::polymorphic_allocator<rayn::pair<const int, int> > > h(a);
+    for (int i = 0; i != 500; ++i) {
+        h[i] = i;
+    }
+    REQUIRE(h.get_allocator() == a);
+    rayn::unordered_map<int, int, rayn::hash<int>, rayn::equal_to<int>,
+                        rayn::polymorphic_allocator<rayn::pair<const int, int> > > copy(h);
+    REQUIRE(copy.get_allocator() == a);
+    REQUIRE(copy == h);
+}
+
+// *************************************
+// unordered_set
+
+TEST_CASE("unordered_set", "[unordered_set]") {
+    int values[] = { 5, 3, 5, 8, 3, 1 };
+    rayn::unordered_set<int> s(values, values + 6);
+    REQUIRE(s.size() == 4);
+    REQUIRE(s.insert(8).second == false);
+    REQUIRE(*s.insert(13).first == 13);
+    REQUIRE(s.count(1) == 1);
+    REQUIRE(s.erase(1) == 1);
+    REQUIRE(s.erase(1) == 0);
+    REQUIRE(s.find(1) == s.end());
+
+    int sum = 0;
+    for (rayn::unordered_set<int>::iterator it = s.begin(); it != s.end(); ++it) {
+        sum += *it;
+    }
+    REQUIRE(sum == 5 + 3 + 8 + 13);
+
+    rayn::unordered_set<int> other;
+    other.swap(s);
+    REQUIRE(s.empty());
+    REQUIRE(other.size() == 4);
+    rayn::pair<rayn::unordered_set<int>::iterator, rayn::unordered_set<int>::iterator> r = other.equal_range(3);
+    REQUIRE(*r.first == 3);
+    REQUIRE(++r.first == r.second);
+}
\ No newline at end of file
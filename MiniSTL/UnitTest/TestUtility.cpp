@@ -18,6 +18,16 @@ TEST_CASE("pair", "[pair]") {
     REQUIRE(p2.first == "hello");
 }
 
+TEST_CASE("pair member types", "[pair]") {
+    // select1st and map name these, so they must be public
+    typedef rayn::pair<rayn::string, int> P;
+    P::first_type key("key");
+    P::second_type value = 3;
+    P p(key, value);
+    REQUIRE(p.first == "key");
+    REQUIRE(p.second == 3);
+}
+
 TEST_CASE("swap", "[utility]") {
     int x = 4, y = 24;
     rayn::swap(x, y);
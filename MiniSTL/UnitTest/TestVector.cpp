@@ -3,7 +3,11 @@
 ** Created by Rayn on 2015/12/23
 */
 #include "catch.hpp"
+#include "TestHelper.h"
 #include "../Src/Vector.h"
+#include "../Src/Alloc.h"
+#include "../Src/AlgoBase.h"
+#include "../Src/String.h"
 
 TEST_CASE("vector construct", "[vector]") {
     rayn::vector<double> v1(5, 2.33);
@@ -92,4 +96,221 @@ TEST_CASE("element access function of vector", "[vector]") {
         REQUIRE(v1.front() == 1);
         REQUIRE(v1.back() == 8);
     }
+}
+
+TEST_CASE("vector growth keeps elements", "[vector]") {
+    rayn::vector<int> v;
+    for (int i = 0; i < 1000; ++i) {
+        // grows through the allocator's reallocate, value may alias v
+        v.push_back(v.empty() ? 0 : v.back() + 1);
+    }
+    REQUIRE(v.size() == 1000);
+    bool same = true;
+    for (int i = 0; i < 1000; ++i) {
+        same = same && v[i] == i;
+    }
+    REQUIRE(same);
+
+    SECTION("insert its own range") {
+        v.insert(v.begin() + 1, v.begin(), v.end());
+        REQUIRE(v.size() == 2000);
+        REQUIRE(v[0] == 0);
+        REQUIRE(v[1] == 0);
+        REQUIRE(v[1000] == 999);
+        REQUIRE(v[1001] == 1);
+        REQUIRE(v.back() == 999);
+    }
+
+    SECTION("shrink to fit") {
+        v.erase(v.begin() + 10, v.end());
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() == 10);
+        REQUIRE(v.back() == 9);
+        v.push_back(10);
+        REQUIRE(v.size() == 11);
+        REQUIRE(v.back() == 10);
+    }
+}
+
+TEST_CASE("vector assignment frees the old storage", "[vector]") {
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::vector<int> a(10, 1), b(40, 2), c(7, 3);
+        a = b;
+        REQUIRE(a.size() == 40);
+        REQUIRE(a[39] == 2);
+        a = rayn::move(c);
+        REQUIRE(a.size() == 7);
+        REQUIRE(a[0] == 3);
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+}
+
+TEST_CASE("vector resize", "[vector]") {
+    rayn::vector<int> v(3, 1);
+    v.reserve(10);
+    v.resize(5, 7);
+    int expect[] = { 1, 1, 1, 7, 7 };
+    REQUIRE(v.size() == 5);
+    REQUIRE(rayn::equal(v.begin(), v.end(), expect));
+
+    // growing past capacity must keep capacity() equal to what was
+    // allocated, or the block goes back to the wrong size class
+    rayn::alloc::stats before, after;
+    rayn::alloc::snapshot(before);
+    {
+        rayn::vector<int> w(10, 4);
+        w.resize(11, 5);
+        REQUIRE(w.size() == 11);
+        REQUIRE(w.capacity() >= 11);
+        REQUIRE(w[9] == 4);
+        REQUIRE(w[10] == 5);
+    }
+    rayn::alloc::snapshot(after);
+    REQUIRE(test_helper::same_live_blocks(before, after));
+}
+
+namespace {
+    // counts copies, moves and live objects of T
+    template <class T>
+    struct counters {
+        static int copies, moves, alive;
+        static void reset() { copies = moves = 0; }
+    };
+    template <class T> int counters<T>::copies = 0;
+    template <class T> int counters<T>::moves = 0;
+    template <class T> int counters<T>::alive = 0;
+
+    struct nothrow_item : counters<nothrow_item> {
+        int value;
+        nothrow_item(int v = 0) : value(v) { ++alive; }
+        nothrow_item(int a, int b) : value(a * b) { ++alive; }
+        nothrow_item(const nothrow_item& other) : value(other.value) { ++copies; ++alive; }
+        nothrow_item(nothrow_item&& other) RAYN_NOEXCEPT : value(other.value) { ++moves; ++alive; }
+        ~nothrow_item() { --alive; }
+        nothrow_item& operator= (const nothrow_item& other) { value = other.value; ++copies; return *this; }
+        nothrow_item& operator= (nothrow_item&& other) { value = other.value; ++moves; return *this; }
+    };
+
+    // the move constructor may throw, growth has to copy
+    struct throwing_item : counters<throwing_item> {
+        int value;
+        throwing_item(int v = 0) : value(v) { ++alive; }
+        throwing_item(const throwing_item& other) : value(other.value) { ++copies; ++alive; }
+        throwing_item(throwing_item&& other) : value(other.value) { ++moves; ++alive; }
+        ~throwing_item() { --alive; }
+    };
+
+    // owns a heap object but never points into itself, opts in below
+    struct relocatable_item : counters<relocatable_item> {
+        int *value;
+        relocatable_item(int v = 0) : value(new int(v)) { ++alive; }
+        relocatable_item(const relocatable_item& other) : value(new int(*other.value)) { ++copies; ++alive; }
+        relocatable_item(relocatable_item&& other) : value(other.value) { other.value = 0; ++moves; ++alive; }
+        ~relocatable_item() { delete value; --alive; }
+        relocatable_item& operator= (const relocatable_item& other) { *value = *other.value; ++copies; return *this; }
+    };
+}
+
+namespace rayn {
+    template <>
+    struct is_trivially_relocatable<relocatable_item> : public true_type {};
+}
+
+TEST_CASE("vector moves elements", "[vector]") {
+    typedef nothrow_item item;
+    {
+        rayn::vector<item> v;
+        item::reset();
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(item(i));
+        }
+        // temporaries are moved in and growth moves the old elements
+        REQUIRE(item::copies == 0);
+        REQUIRE(v.back().value == 999);
+
+        item::reset();
+        v.emplace_back(6, 7);
+        v.emplace(v.begin(), 5);
+        v.insert(v.begin() + 1, item(3));
+        REQUIRE(item::copies == 0);
+        REQUIRE(v[0].value == 5);
+        REQUIRE(v[1].value == 3);
+        REQUIRE(v[2].value == 0);
+        REQUIRE(v.back().value == 42);
+
+        v.erase(v.begin(), v.begin() + 2);
+        REQUIRE(v.size() == 1001);
+        REQUIRE(v[0].value == 0);
+        REQUIRE(item::alive == 1001);
+
+        // the argument may refer to an element of the vector itself
+        v.shrink_to_fit();
+        v.push_back(v[0]);
+        v.emplace(v.begin(), v.back());
+        REQUIRE(v.front().value == 0);
+        REQUIRE(v.back().value == 0);
+    }
+    REQUIRE(item::alive == 0);
+}
+
+TEST_CASE("vector copies elements whose move may throw", "[vector]") {
+    typedef throwing_item item;
+    rayn::vector<item> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(item(i));
+    }
+    item::reset();
+    v.reserve(1000);
+    // growth keeps the old elements intact in case a move throws
+    REQUIRE(item::copies == 100);
+    REQUIRE(item::moves == 0);
+}
+
+TEST_CASE("vector of strings does not copy on growth", "[vector]") {
+    rayn::vector<rayn::string> v;
+    // long enough not to be stored inside the string object
+    v.push_back(rayn::string("the first element of the vector"));
+    const char *buffer = &v[0][0];
+    for (int i = 0; i < 1000; ++i) {
+        v.emplace_back(10, 'x');
+    }
+    REQUIRE(&v[0][0] == buffer);
+    REQUIRE(v[0] == "the first element of the vector");
+    REQUIRE(v[1000] == "xxxxxxxxxx");
+}
+
+TEST_CASE("vector relocates trivially relocatable elements", "[vector]") {
+    typedef relocatable_item item;
+    REQUIRE(rayn::is_trivially_relocatable<int>::value);
+    REQUIRE_FALSE(rayn::is_trivially_relocatable<nothrow_item>::value);
+    REQUIRE(rayn::is_trivially_relocatable<rayn::string>::value);
+    REQUIRE(rayn::is_trivially_relocatable<rayn::vector<rayn::string> >::value);
+    {
+        rayn::vector<item> v;
+        item::reset();
+        for (int i = 0; i < 100; ++i) {
+            v.emplace_back(i);
+        }
+        REQUIRE(item::moves == 0);
+
+        // insert and erase shift the bytes, only the new elements and the
+        // guard copy of the fill value are built
+        v.emplace(v.begin(), -1);
+        v.insert(v.begin() + 50, 3, item(7));
+        v.erase(v.begin() + 10, v.begin() + 20);
+        REQUIRE(item::copies == 4);
+        REQUIRE(item::moves == 1);
+        REQUIRE(item::alive == 94);
+        REQUIRE(v.size() == 94);
+        REQUIRE(*v[0].value == -1);
+        REQUIRE(*v[9].value == 8);
+        REQUIRE(*v[10].value == 19);
+        REQUIRE(*v[40].value == 7);
+        REQUIRE(*v[43].value == 49);
+        REQUIRE(*v.back().value == 99);
+    }
+    REQUIRE(item::alive == 0);
 }
\ No newline at end of file